@@ -1,6 +1,10 @@
 #include <list>
 #include <math.h>
 #include "LoopDataCollection.h"
+#include "LoopProjectFileMetrics.h"
+#include "LoopProjectFileTrace.h"
+#include "LoopRecordStorage.h"
+#include "LoopSpatialIndex.h"
 
 namespace LoopProjectFile {
 
@@ -182,227 +186,172 @@ LoopProjectFileResponse DataCollection::CreateDrillholeGroup(netCDF::NcGroup* da
     return resp;
 }
 
-LoopProjectFileResponse DataCollection::GetFaultObservations(netCDF::NcGroup* rootNode, std::vector<FaultObservation>& observations, bool verbose)
+/*****************************************************************************/
+/*  Reads the live records [start, start+count) of a table, one hyperslab    */
+/*  per run of records not deleted, appending to the container. Shared by    */
+/*  the zeroing, bulk load and range getters                                 */
+/*****************************************************************************/
+template <typename T, typename Alloc>
+static LoopProjectFileResponse GetDataCollectionRecords(netCDF::NcGroup* rootNode, std::string groupName, std::string variableName, std::vector<T,Alloc>& records, bool verbose, size_t start = 0, size_t count = LOOP_ALL_RECORDS)
 {
     LoopProjectFileResponse resp = {0,""};
-    auto groups = rootNode->getGroups();
-    if (groups.find("DataCollection") != groups.end()) {
-        netCDF::NcGroup dataCollectionGroup = rootNode->getGroup("DataCollection");
-        auto dcGroups = dataCollectionGroup.getGroups();
-        if (dcGroups.find("Observations") != dcGroups.end()) {
-            netCDF::NcGroup observationGroup = dataCollectionGroup.getGroup("Observations");
-            netCDF::NcVar faultObs = observationGroup.getVar("faultObservations");
-            for (size_t i=0;i<observationGroup.getDim("faultObservationIndex").getSize();i++) {
-                FaultObservation obs;
-                std::vector<size_t> start; start.push_back(i);
-                faultObs.getVar(start,&obs);
-                observations.push_back(obs);
+    try {
+        auto groups = rootNode->getGroups();
+        if (groups.find("DataCollection") != groups.end()) {
+            netCDF::NcGroup dataCollectionGroup = rootNode->getGroup("DataCollection");
+            auto dcGroups = dataCollectionGroup.getGroups();
+            if (dcGroups.find(groupName) != dcGroups.end()) {
+                netCDF::NcGroup group = dataCollectionGroup.getGroup(groupName);
+                netCDF::NcVar recordsVar = group.getVar(variableName);
+                LOOP_TRACE_SPAN("ReadRecords","io");
+                size_t numRecords = RecordStorage::ReadRecords(recordsVar,records,start,count);
+                if (numRecords > 0) Metrics::RecordRead<T>(recordsVar,numRecords);
+            } else {
+                resp = createErrorMsg(1,"No " + groupName + " Group Node Present",verbose);
             }
         } else {
-            resp = createErrorMsg(1,"No Observations Group Node Present",verbose);
+            resp = createErrorMsg(1,"No Data Collection Group Node Present",verbose);
         }
-    } else {
-        resp = createErrorMsg(1,"No Data Collection Group Node Present",verbose);
+    } catch (netCDF::exceptions::NcException& e) {
+        if (verbose) std::cout << e.what() << std::endl;
+        resp = createErrorMsg(1,"Failed to read " + variableName + " from loop project file",verbose);
     }
     return resp;
 }
 
+LoopProjectFileResponse DataCollection::GetFaultObservations(netCDF::NcGroup* rootNode, std::vector<FaultObservation>& observations, bool verbose)
+{
+    return GetDataCollectionRecords(rootNode,"Observations","faultObservations",observations,verbose);
+}
+
+LoopProjectFileResponse DataCollection::GetFaultObservations(netCDF::NcGroup* rootNode, BulkVector<FaultObservation>& observations, bool verbose)
+{
+    return GetDataCollectionRecords(rootNode,"Observations","faultObservations",observations,verbose);
+}
+
 LoopProjectFileResponse DataCollection::GetFoldObservations(netCDF::NcGroup* rootNode, std::vector<FoldObservation>& observations, bool verbose)
 {
-    LoopProjectFileResponse resp = {0,""};
-    auto groups = rootNode->getGroups();
-    if (groups.find("DataCollection") != groups.end()) {
-        netCDF::NcGroup dataCollectionGroup = rootNode->getGroup("DataCollection");
-        auto dcGroups = dataCollectionGroup.getGroups();
-        if (dcGroups.find("Observations") != dcGroups.end()) {
-            netCDF::NcGroup observationGroup = dataCollectionGroup.getGroup("Observations");
-            netCDF::NcVar foldObs = observationGroup.getVar("foldObservations");
-            for (size_t i=0;i<observationGroup.getDim("foldObservationIndex").getSize();i++) {
-                FoldObservation obs;
-                std::vector<size_t> start; start.push_back(i);
-                foldObs.getVar(start,&obs);
-                observations.push_back(obs);
-            }
-        } else {
-            resp = createErrorMsg(1,"No Observations Group Node Present",verbose);
-        }
-    } else {
-        resp = createErrorMsg(1,"No Data Collection Group Node Present",verbose);
-    }
-    return resp;
+    return GetDataCollectionRecords(rootNode,"Observations","foldObservations",observations,verbose);
+}
+
+LoopProjectFileResponse DataCollection::GetFoldObservations(netCDF::NcGroup* rootNode, BulkVector<FoldObservation>& observations, bool verbose)
+{
+    return GetDataCollectionRecords(rootNode,"Observations","foldObservations",observations,verbose);
 }
 
 LoopProjectFileResponse DataCollection::GetFoliationObservations(netCDF::NcGroup* rootNode, std::vector<FoliationObservation>& observations, bool verbose)
 {
-    LoopProjectFileResponse resp = {0,""};
-    auto groups = rootNode->getGroups();
-    if (groups.find("DataCollection") != groups.end()) {
-        netCDF::NcGroup dataCollectionGroup = rootNode->getGroup("DataCollection");
-        auto dcGroups = dataCollectionGroup.getGroups();
-        if (dcGroups.find("Observations") != dcGroups.end()) {
-            netCDF::NcGroup observationGroup = dataCollectionGroup.getGroup("Observations");
-            netCDF::NcVar foliationObs = observationGroup.getVar("foliationObservations");
-            for (size_t i=0;i<observationGroup.getDim("foliationObservationIndex").getSize();i++) {
-                FoliationObservation obs;
-                std::vector<size_t> start; start.push_back(i);
-                foliationObs.getVar(start,&obs);
-                observations.push_back(obs);
-            }
-        } else {
-            resp = createErrorMsg(1,"No Observations Group Node Present",verbose);
-        }
-    } else {
-        resp = createErrorMsg(1,"No Data Collection Group Node Present",verbose);
-    }
-    return resp;
+    return GetDataCollectionRecords(rootNode,"Observations","foliationObservations",observations,verbose);
+}
+
+LoopProjectFileResponse DataCollection::GetFoliationObservations(netCDF::NcGroup* rootNode, BulkVector<FoliationObservation>& observations, bool verbose)
+{
+    return GetDataCollectionRecords(rootNode,"Observations","foliationObservations",observations,verbose);
 }
 
 LoopProjectFileResponse DataCollection::GetDiscontinuityObservations(netCDF::NcGroup* rootNode, std::vector<DiscontinuityObservation>& observations, bool verbose)
 {
-    LoopProjectFileResponse resp = {0,""};
-    auto groups = rootNode->getGroups();
-    if (groups.find("DataCollection") != groups.end()) {
-        netCDF::NcGroup dataCollectionGroup = rootNode->getGroup("DataCollection");
-        auto dcGroups = dataCollectionGroup.getGroups();
-        if (dcGroups.find("Observations") != dcGroups.end()) {
-            netCDF::NcGroup observationGroup = dataCollectionGroup.getGroup("Observations");
-            netCDF::NcVar discontinuityObs = observationGroup.getVar("discontinuityObservations");
-            for (size_t i=0;i<observationGroup.getDim("discontinuityObservationIndex").getSize();i++) {
-                DiscontinuityObservation obs;
-                std::vector<size_t> start; start.push_back(i);
-                discontinuityObs.getVar(start,&obs);
-                observations.push_back(obs);
-            }
-        } else {
-            resp = createErrorMsg(1,"No Observations Group Node Present",verbose);
-        }
-    } else {
-        resp = createErrorMsg(1,"No Data Collection Group Node Present",verbose);
-    }
-    return resp;
+    return GetDataCollectionRecords(rootNode,"Observations","discontinuityObservations",observations,verbose);
+}
+
+LoopProjectFileResponse DataCollection::GetDiscontinuityObservations(netCDF::NcGroup* rootNode, BulkVector<DiscontinuityObservation>& observations, bool verbose)
+{
+    return GetDataCollectionRecords(rootNode,"Observations","discontinuityObservations",observations,verbose);
 }
 
 LoopProjectFileResponse DataCollection::GetStratigraphicObservations(netCDF::NcGroup* rootNode, std::vector<StratigraphicObservation>& observations, bool verbose)
 {
-    LoopProjectFileResponse resp = {0,""};
-    auto groups = rootNode->getGroups();
-    if (groups.find("DataCollection") != groups.end()) {
-        netCDF::NcGroup dataCollectionGroup = rootNode->getGroup("DataCollection");
-        auto dcGroups = dataCollectionGroup.getGroups();
-        if (dcGroups.find("Observations") != dcGroups.end()) {
-            netCDF::NcGroup observationGroup = dataCollectionGroup.getGroup("Observations");
-            netCDF::NcVar stratigraphicObs = observationGroup.getVar("stratigraphicObservations");
-            for (size_t i=0;i<observationGroup.getDim("stratigraphicObservationIndex").getSize();i++) {
-                StratigraphicObservation obs;
-                std::vector<size_t> start; start.push_back(i);
-                stratigraphicObs.getVar(start,&obs);
-                observations.push_back(obs);
-            }
-        } else {
-            resp = createErrorMsg(1,"No Observations Group Node Present",verbose);
-        }
-    } else {
-        resp = createErrorMsg(1,"No Data Collection Group Node Present",verbose);
-    }
-    return resp;
+    return GetDataCollectionRecords(rootNode,"Observations","stratigraphicObservations",observations,verbose);
+}
+
+LoopProjectFileResponse DataCollection::GetStratigraphicObservations(netCDF::NcGroup* rootNode, BulkVector<StratigraphicObservation>& observations, bool verbose)
+{
+    return GetDataCollectionRecords(rootNode,"Observations","stratigraphicObservations",observations,verbose);
 }
 
 LoopProjectFileResponse DataCollection::GetContactObservations(netCDF::NcGroup* rootNode, std::vector<ContactObservation>& observations, bool verbose)
 {
-    LoopProjectFileResponse resp = {0,""};
-    auto groups = rootNode->getGroups();
-    if (groups.find("DataCollection") != groups.end()) {
-        netCDF::NcGroup dataCollectionGroup = rootNode->getGroup("DataCollection");
-        auto dcGroups = dataCollectionGroup.getGroups();
-        if (dcGroups.find("Contacts") != dcGroups.end()) {
-            netCDF::NcGroup contactGroup = dataCollectionGroup.getGroup("Contacts");
-            netCDF::NcVar contactObs = contactGroup.getVar("contacts");
-            for (size_t i=0;i<contactGroup.getDim("index").getSize();i++) {
-                ContactObservation obs;
-                std::vector<size_t> start; start.push_back(i);
-                contactObs.getVar(start,&obs);
-                observations.push_back(obs);
-            }
-        } else {
-            resp = createErrorMsg(1,"No Contacts Group Node Present",verbose);
-        }
-    } else {
-        resp = createErrorMsg(1,"No Data Collection Group Node Present",verbose);
-    }
-    return resp;
+    return GetDataCollectionRecords(rootNode,"Contacts","contacts",observations,verbose);
+}
+
+LoopProjectFileResponse DataCollection::GetContactObservations(netCDF::NcGroup* rootNode, BulkVector<ContactObservation>& observations, bool verbose)
+{
+    return GetDataCollectionRecords(rootNode,"Contacts","contacts",observations,verbose);
 }
 
 LoopProjectFileResponse DataCollection::GetDrillholeObservations(netCDF::NcGroup* rootNode, std::vector<DrillholeObservation>& observations, bool verbose)
 {
-    LoopProjectFileResponse resp = {0,""};
-    auto groups = rootNode->getGroups();
-    if (groups.find("DataCollection") != groups.end()) {
-        netCDF::NcGroup dataCollectionGroup = rootNode->getGroup("DataCollection");
-        auto dcGroups = dataCollectionGroup.getGroups();
-        if (dcGroups.find("Drillholes") != dcGroups.end()) {
-            netCDF::NcGroup drillholeGroup = dataCollectionGroup.getGroup("Drillholes");
-            netCDF::NcVar drillholeObs = drillholeGroup.getVar("drillholeObservations");
-            for (size_t i=0;i<drillholeGroup.getDim("drillholeObservationIndex").getSize();i++) {
-                DrillholeObservation obs;
-                std::vector<size_t> start; start.push_back(i);
-                drillholeObs.getVar(start,&obs);
-                observations.push_back(obs);
-            }
-        } else {
-            resp = createErrorMsg(1,"No Drillholes Group Node Present",verbose);
-        }
-    } else {
-        resp = createErrorMsg(1,"No Data Collection Group Node Present",verbose);
-    }
-    return resp;
+    return GetDataCollectionRecords(rootNode,"Drillholes","drillholeObservations",observations,verbose);
+}
+
+LoopProjectFileResponse DataCollection::GetDrillholeObservations(netCDF::NcGroup* rootNode, BulkVector<DrillholeObservation>& observations, bool verbose)
+{
+    return GetDataCollectionRecords(rootNode,"Drillholes","drillholeObservations",observations,verbose);
 }
+
 LoopProjectFileResponse DataCollection::GetDrillholeProperties(netCDF::NcGroup* rootNode, std::vector<DrillholeProperty>& properties, bool verbose)
 {
-    LoopProjectFileResponse resp = {0,""};
-    auto groups = rootNode->getGroups();
-    if (groups.find("DataCollection") != groups.end()) {
-        netCDF::NcGroup dataCollectionGroup = rootNode->getGroup("DataCollection");
-        auto dcGroups = dataCollectionGroup.getGroups();
-        if (dcGroups.find("Drillholes") != dcGroups.end()) {
-            netCDF::NcGroup drillholeGroup = dataCollectionGroup.getGroup("Drillholes");
-            netCDF::NcVar drillholeProp = drillholeGroup.getVar("drillholeProperties");
-            for (size_t i=0;i<drillholeGroup.getDim("drillholePropertyIndex").getSize();i++) {
-                DrillholeProperty prop;
-                std::vector<size_t> start; start.push_back(i);
-                drillholeProp.getVar(start,&prop);
-                properties.push_back(prop);
-            }
-        } else {
-            resp = createErrorMsg(1,"No Drillholes Group Node Present",verbose);
-        }
-    } else {
-        resp = createErrorMsg(1,"No Data Collection Group Node Present",verbose);
-    }
-    return resp;
+    return GetDataCollectionRecords(rootNode,"Drillholes","drillholeProperties",properties,verbose);
+}
+
+LoopProjectFileResponse DataCollection::GetDrillholeProperties(netCDF::NcGroup* rootNode, BulkVector<DrillholeProperty>& properties, bool verbose)
+{
+    return GetDataCollectionRecords(rootNode,"Drillholes","drillholeProperties",properties,verbose);
 }
+
 LoopProjectFileResponse DataCollection::GetDrillholeSurveys(netCDF::NcGroup* rootNode, std::vector<DrillholeSurvey>& surveys, bool verbose)
 {
-    LoopProjectFileResponse resp = {0,""};
-    auto groups = rootNode->getGroups();
-    if (groups.find("DataCollection") != groups.end()) {
-        netCDF::NcGroup dataCollectionGroup = rootNode->getGroup("DataCollection");
-        auto dcGroups = dataCollectionGroup.getGroups();
-        if (dcGroups.find("Drillholes") != dcGroups.end()) {
-            netCDF::NcGroup drillholeGroup = dataCollectionGroup.getGroup("Drillholes");
-            netCDF::NcVar drillholeSurveys = drillholeGroup.getVar("drillholeSurveys");
-            for (size_t i=0;i<drillholeGroup.getDim("drillholeSurveyIndex").getSize();i++) {
-                DrillholeSurvey survey;
-                std::vector<size_t> start; start.push_back(i);
-                drillholeSurveys.getVar(start,&survey);
-                surveys.push_back(survey);
-            }
-        } else {
-            resp = createErrorMsg(1,"No Drillholes Group Node Present",verbose);
-        }
-    } else {
-        resp = createErrorMsg(1,"No Data Collection Group Node Present",verbose);
-    }
-    return resp;
+    return GetDataCollectionRecords(rootNode,"Drillholes","drillholeSurveys",surveys,verbose);
+}
+
+LoopProjectFileResponse DataCollection::GetDrillholeSurveys(netCDF::NcGroup* rootNode, BulkVector<DrillholeSurvey>& surveys, bool verbose)
+{
+    return GetDataCollectionRecords(rootNode,"Drillholes","drillholeSurveys",surveys,verbose);
+}
+
+LoopProjectFileResponse DataCollection::GetFaultObservations(netCDF::NcGroup* rootNode, std::vector<FaultObservation>& observations, size_t start, size_t count, bool verbose)
+{
+    return GetDataCollectionRecords(rootNode,"Observations","faultObservations",observations,verbose,start,count);
+}
+
+LoopProjectFileResponse DataCollection::GetFoldObservations(netCDF::NcGroup* rootNode, std::vector<FoldObservation>& observations, size_t start, size_t count, bool verbose)
+{
+    return GetDataCollectionRecords(rootNode,"Observations","foldObservations",observations,verbose,start,count);
+}
+
+LoopProjectFileResponse DataCollection::GetFoliationObservations(netCDF::NcGroup* rootNode, std::vector<FoliationObservation>& observations, size_t start, size_t count, bool verbose)
+{
+    return GetDataCollectionRecords(rootNode,"Observations","foliationObservations",observations,verbose,start,count);
+}
+
+LoopProjectFileResponse DataCollection::GetDiscontinuityObservations(netCDF::NcGroup* rootNode, std::vector<DiscontinuityObservation>& observations, size_t start, size_t count, bool verbose)
+{
+    return GetDataCollectionRecords(rootNode,"Observations","discontinuityObservations",observations,verbose,start,count);
+}
+
+LoopProjectFileResponse DataCollection::GetStratigraphicObservations(netCDF::NcGroup* rootNode, std::vector<StratigraphicObservation>& observations, size_t start, size_t count, bool verbose)
+{
+    return GetDataCollectionRecords(rootNode,"Observations","stratigraphicObservations",observations,verbose,start,count);
+}
+
+LoopProjectFileResponse DataCollection::GetContactObservations(netCDF::NcGroup* rootNode, std::vector<ContactObservation>& observations, size_t start, size_t count, bool verbose)
+{
+    return GetDataCollectionRecords(rootNode,"Contacts","contacts",observations,verbose,start,count);
+}
+
+LoopProjectFileResponse DataCollection::GetDrillholeObservations(netCDF::NcGroup* rootNode, std::vector<DrillholeObservation>& observations, size_t start, size_t count, bool verbose)
+{
+    return GetDataCollectionRecords(rootNode,"Drillholes","drillholeObservations",observations,verbose,start,count);
+}
+
+LoopProjectFileResponse DataCollection::GetDrillholeProperties(netCDF::NcGroup* rootNode, std::vector<DrillholeProperty>& properties, size_t start, size_t count, bool verbose)
+{
+    return GetDataCollectionRecords(rootNode,"Drillholes","drillholeProperties",properties,verbose,start,count);
+}
+
+LoopProjectFileResponse DataCollection::GetDrillholeSurveys(netCDF::NcGroup* rootNode, std::vector<DrillholeSurvey>& surveys, size_t start, size_t count, bool verbose)
+{
+    return GetDataCollectionRecords(rootNode,"Drillholes","drillholeSurveys",surveys,verbose,start,count);
 }
 
 LoopProjectFileResponse DataCollection::GetDataCollectionConfiguration(netCDF::NcGroup* rootNode, DataCollectionConfiguration& configuration, bool verbose)
@@ -411,31 +360,34 @@ LoopProjectFileResponse DataCollection::GetDataCollectionConfiguration(netCDF::N
     auto groups = rootNode->getGroups();
     if (groups.find("DataCollection") != groups.end()) {
         netCDF::NcGroup dataCollectionGroup = rootNode->getGroup("DataCollection");
-        dataCollectionGroup.getAtt("quietMode").getValues(&configuration.quietMode);
-        dataCollectionGroup.getAtt("deposits").getValues(&configuration.deposits);
-        dataCollectionGroup.getAtt("dtb").getValues(&configuration.dtb);
-        dataCollectionGroup.getAtt("orientationDecimate").getValues(&configuration.orientationDecimate);
-        dataCollectionGroup.getAtt("contactDecimate").getValues(&configuration.contactDecimate);
-        dataCollectionGroup.getAtt("intrusionMode").getValues(&configuration.intrusionMode);
-        dataCollectionGroup.getAtt("interpolationSpacing").getValues(&configuration.interpolationSpacing);
-        dataCollectionGroup.getAtt("misorientation").getValues(&configuration.misorientation);
-        dataCollectionGroup.getAtt("interpolationScheme").getValues(&configuration.interpolationScheme);
-        dataCollectionGroup.getAtt("faultDecimate").getValues(&configuration.faultDecimate);
-        dataCollectionGroup.getAtt("minFaultLength").getValues(&configuration.minFaultLength);
-        dataCollectionGroup.getAtt("faultDip").getValues(&configuration.faultDip);
-        dataCollectionGroup.getAtt("plutonDip").getValues(&configuration.plutonDip);
-        dataCollectionGroup.getAtt("plutonForm").getValues(&configuration.plutonForm);
-        dataCollectionGroup.getAtt("distBuffer").getValues(&configuration.distBuffer);
-        dataCollectionGroup.getAtt("contactDip").getValues(&configuration.contactDip);
-        dataCollectionGroup.getAtt("contactOrientationDecimate").getValues(&configuration.contactOrientationDecimate);
-        dataCollectionGroup.getAtt("nullScheme").getValues(&configuration.nullScheme);
-        dataCollectionGroup.getAtt("thicknessBuffer").getValues(&configuration.thicknessBuffer);
-        dataCollectionGroup.getAtt("maxThicknessAllowed").getValues(&configuration.maxThicknessAllowed);
-        dataCollectionGroup.getAtt("foldDecimate").getValues(&configuration.foldDecimate);
-        dataCollectionGroup.getAtt("fatStep").getValues(&configuration.fatStep);
-        dataCollectionGroup.getAtt("closeDip").getValues(&configuration.closeDip);
-        dataCollectionGroup.getAtt("useInterpolations").getValues(&configuration.useInterpolations);
-        dataCollectionGroup.getAtt("useFat").getValues(&configuration.useFat);
+        auto atts = dataCollectionGroup.getAtts();
+        bool found = true;
+        found &= GetAttributeValue(atts,"quietMode",&configuration.quietMode);
+        found &= GetAttributeValue(atts,"deposits",&configuration.deposits);
+        found &= GetAttributeValue(atts,"dtb",&configuration.dtb);
+        found &= GetAttributeValue(atts,"orientationDecimate",&configuration.orientationDecimate);
+        found &= GetAttributeValue(atts,"contactDecimate",&configuration.contactDecimate);
+        found &= GetAttributeValue(atts,"intrusionMode",&configuration.intrusionMode);
+        found &= GetAttributeValue(atts,"interpolationSpacing",&configuration.interpolationSpacing);
+        found &= GetAttributeValue(atts,"misorientation",&configuration.misorientation);
+        found &= GetAttributeValue(atts,"interpolationScheme",&configuration.interpolationScheme);
+        found &= GetAttributeValue(atts,"faultDecimate",&configuration.faultDecimate);
+        found &= GetAttributeValue(atts,"minFaultLength",&configuration.minFaultLength);
+        found &= GetAttributeValue(atts,"faultDip",&configuration.faultDip);
+        found &= GetAttributeValue(atts,"plutonDip",&configuration.plutonDip);
+        found &= GetAttributeValue(atts,"plutonForm",&configuration.plutonForm);
+        found &= GetAttributeValue(atts,"distBuffer",&configuration.distBuffer);
+        found &= GetAttributeValue(atts,"contactDip",&configuration.contactDip);
+        found &= GetAttributeValue(atts,"contactOrientationDecimate",&configuration.contactOrientationDecimate);
+        found &= GetAttributeValue(atts,"nullScheme",&configuration.nullScheme);
+        found &= GetAttributeValue(atts,"thicknessBuffer",&configuration.thicknessBuffer);
+        found &= GetAttributeValue(atts,"maxThicknessAllowed",&configuration.maxThicknessAllowed);
+        found &= GetAttributeValue(atts,"foldDecimate",&configuration.foldDecimate);
+        found &= GetAttributeValue(atts,"fatStep",&configuration.fatStep);
+        found &= GetAttributeValue(atts,"closeDip",&configuration.closeDip);
+        found &= GetAttributeValue(atts,"useInterpolations",&configuration.useInterpolations);
+        found &= GetAttributeValue(atts,"useFat",&configuration.useFat);
+        if (!found) resp = createErrorMsg(1,"Missing Data Collection configuration attributes",verbose);
     } else {
         resp = createErrorMsg(1,"No Data Collection Group Node Present",verbose);
     }
@@ -448,13 +400,16 @@ LoopProjectFileResponse DataCollection::GetDataCollectionSources(netCDF::NcGroup
     auto groups = rootNode->getGroups();
     if (groups.find("DataCollection") != groups.end()) {
         netCDF::NcGroup dataCollectionGroup = rootNode->getGroup("DataCollection");
-        dataCollectionGroup.getAtt("structureUrl").getValues(&sources.structureUrl);
-        dataCollectionGroup.getAtt("geologyUrl").getValues(&sources.geologyUrl);
-        dataCollectionGroup.getAtt("faultUrl").getValues(&sources.faultUrl);
-        dataCollectionGroup.getAtt("foldUrl").getValues(&sources.foldUrl);
-        dataCollectionGroup.getAtt("mindepUrl").getValues(&sources.mindepUrl);
-        dataCollectionGroup.getAtt("metadataUrl").getValues(&sources.metadataUrl);
-        dataCollectionGroup.getAtt("sourceTags").getValues(&sources.sourceTags);
+        auto atts = dataCollectionGroup.getAtts();
+        bool found = true;
+        found &= GetAttributeValue(atts,"structureUrl",&sources.structureUrl);
+        found &= GetAttributeValue(atts,"geologyUrl",&sources.geologyUrl);
+        found &= GetAttributeValue(atts,"faultUrl",&sources.faultUrl);
+        found &= GetAttributeValue(atts,"foldUrl",&sources.foldUrl);
+        found &= GetAttributeValue(atts,"mindepUrl",&sources.mindepUrl);
+        found &= GetAttributeValue(atts,"metadataUrl",&sources.metadataUrl);
+        found &= GetAttributeValue(atts,"sourceTags",&sources.sourceTags);
+        if (!found) resp = createErrorMsg(1,"Missing Data Collection source attributes",verbose);
     } else {
         resp = createErrorMsg(1,"No Data Collection Group Node Present",verbose);
     }
@@ -478,7 +433,11 @@ LoopProjectFileResponse DataCollection::SetFaultObservations(netCDF::NcGroup* ro
         std::vector<size_t> start; start.push_back(0);
         std::vector<size_t> count; count.push_back(observations.size());
         netCDF::NcVar faultObs = observationGroup.getVar("faultObservations");
+        LOOP_TRACE_SPAN("WriteRecords","io");
         faultObs.putVar(start,count,&(observations[0]));
+        Metrics::RecordWrite<FaultObservation>(faultObs,observations.size());
+        RecordStorage::ResetDeletedRecords(faultObs,observations.size());
+        RecordStorage::InvalidateDirectory(faultObs);
     } catch (netCDF::exceptions::NcException &e) {
         std::cout << e.what();
         resp = createErrorMsg(1,"Failed to add fault data to loop project file",verbose);
@@ -503,7 +462,11 @@ LoopProjectFileResponse DataCollection::SetFoldObservations(netCDF::NcGroup* roo
         std::vector<size_t> start; start.push_back(0);
         std::vector<size_t> count; count.push_back(observations.size());
         netCDF::NcVar foldObs = observationGroup.getVar("foldObservations");
+        LOOP_TRACE_SPAN("WriteRecords","io");
         foldObs.putVar(start,count,&(observations[0]));
+        Metrics::RecordWrite<FoldObservation>(foldObs,observations.size());
+        RecordStorage::ResetDeletedRecords(foldObs,observations.size());
+        RecordStorage::InvalidateDirectory(foldObs);
     } catch (netCDF::exceptions::NcException &e) {
         std::cout << e.what();
         resp = createErrorMsg(1,"Failed to add fold data to loop project file",verbose);
@@ -528,7 +491,11 @@ LoopProjectFileResponse DataCollection::SetFoliationObservations(netCDF::NcGroup
         std::vector<size_t> start; start.push_back(0);
         std::vector<size_t> count; count.push_back(observations.size());
         netCDF::NcVar foliationObs = observationGroup.getVar("foliationObservations");
+        LOOP_TRACE_SPAN("WriteRecords","io");
         foliationObs.putVar(start,count,&(observations[0]));
+        Metrics::RecordWrite<FoliationObservation>(foliationObs,observations.size());
+        RecordStorage::ResetDeletedRecords(foliationObs,observations.size());
+        RecordStorage::InvalidateDirectory(foliationObs);
     } catch (netCDF::exceptions::NcException &e) {
         std::cout << e.what();
         resp = createErrorMsg(1,"Failed to add foliation data to loop project file",verbose);
@@ -553,7 +520,11 @@ LoopProjectFileResponse DataCollection::SetDiscontinuityObservations(netCDF::NcG
         std::vector<size_t> start; start.push_back(0);
         std::vector<size_t> count; count.push_back(observations.size());
         netCDF::NcVar discontinuityObs = observationGroup.getVar("discontinuityObservations");
+        LOOP_TRACE_SPAN("WriteRecords","io");
         discontinuityObs.putVar(start,count,&(observations[0]));
+        Metrics::RecordWrite<DiscontinuityObservation>(discontinuityObs,observations.size());
+        RecordStorage::ResetDeletedRecords(discontinuityObs,observations.size());
+        RecordStorage::InvalidateDirectory(discontinuityObs);
     } catch (netCDF::exceptions::NcException &e) {
         std::cout << e.what();
         resp = createErrorMsg(1,"Failed to add discontinuity data to loop project file",verbose);
@@ -578,7 +549,11 @@ LoopProjectFileResponse DataCollection::SetStratigraphicObservations(netCDF::NcG
         std::vector<size_t> start; start.push_back(0);
         std::vector<size_t> count; count.push_back(observations.size());
         netCDF::NcVar stratigraphicObs = observationGroup.getVar("stratigraphicObservations");
+        LOOP_TRACE_SPAN("WriteRecords","io");
         stratigraphicObs.putVar(start,count,&(observations[0]));
+        Metrics::RecordWrite<StratigraphicObservation>(stratigraphicObs,observations.size());
+        RecordStorage::ResetDeletedRecords(stratigraphicObs,observations.size());
+        RecordStorage::InvalidateDirectory(stratigraphicObs);
     } catch (netCDF::exceptions::NcException &e) {
         std::cout << e.what();
         resp = createErrorMsg(1,"Failed to add stratigraphic data to loop project file",verbose);
@@ -603,7 +578,11 @@ LoopProjectFileResponse DataCollection::SetContactObservations(netCDF::NcGroup*
         std::vector<size_t> start; start.push_back(0);
         std::vector<size_t> count; count.push_back(observations.size());
         netCDF::NcVar contacts = contactsGroup.getVar("contacts");
+        LOOP_TRACE_SPAN("WriteRecords","io");
         contacts.putVar(start,count,&(observations[0]));
+        Metrics::RecordWrite<ContactObservation>(contacts,observations.size());
+        RecordStorage::ResetDeletedRecords(contacts,observations.size());
+        RecordStorage::InvalidateDirectory(contacts);
     } catch (netCDF::exceptions::NcException &e) {
         std::cout << e.what();
         resp = createErrorMsg(1,"Failed to add stratigraphic contacts data to loop project file",verbose);
@@ -628,13 +607,52 @@ LoopProjectFileResponse DataCollection::SetDrillholeObservations(netCDF::NcGroup
         std::vector<size_t> start; start.push_back(0);
         std::vector<size_t> count; count.push_back(observations.size());
         netCDF::NcVar drillholeObs = observationGroup.getVar("drillholeObservations");
+        LOOP_TRACE_SPAN("WriteRecords","io");
         drillholeObs.putVar(start,count,&(observations[0]));
+        Metrics::RecordWrite<DrillholeObservation>(drillholeObs,observations.size());
+        RecordStorage::ResetDeletedRecords(drillholeObs,observations.size());
+        RecordStorage::InvalidateDirectory(drillholeObs);
     } catch (netCDF::exceptions::NcException &e) {
         std::cout << e.what();
         resp = createErrorMsg(1,"Failed to add drillhole data to loop project file",verbose);
     }
     return resp;
 }
+LoopProjectFileResponse DataCollection::SetFaultObservations(netCDF::NcGroup* rootNode, std::vector<FaultObservation> observations, const ObservationWriteOptions& options, bool verbose)
+{
+    return SpatialIndex::SetOrderedRecords(rootNode, observations, options, verbose);
+}
+
+LoopProjectFileResponse DataCollection::SetFoldObservations(netCDF::NcGroup* rootNode, std::vector<FoldObservation> observations, const ObservationWriteOptions& options, bool verbose)
+{
+    return SpatialIndex::SetOrderedRecords(rootNode, observations, options, verbose);
+}
+
+LoopProjectFileResponse DataCollection::SetFoliationObservations(netCDF::NcGroup* rootNode, std::vector<FoliationObservation> observations, const ObservationWriteOptions& options, bool verbose)
+{
+    return SpatialIndex::SetOrderedRecords(rootNode, observations, options, verbose);
+}
+
+LoopProjectFileResponse DataCollection::SetDiscontinuityObservations(netCDF::NcGroup* rootNode, std::vector<DiscontinuityObservation> observations, const ObservationWriteOptions& options, bool verbose)
+{
+    return SpatialIndex::SetOrderedRecords(rootNode, observations, options, verbose);
+}
+
+LoopProjectFileResponse DataCollection::SetStratigraphicObservations(netCDF::NcGroup* rootNode, std::vector<StratigraphicObservation> observations, const ObservationWriteOptions& options, bool verbose)
+{
+    return SpatialIndex::SetOrderedRecords(rootNode, observations, options, verbose);
+}
+
+LoopProjectFileResponse DataCollection::SetContactObservations(netCDF::NcGroup* rootNode, std::vector<ContactObservation> observations, const ObservationWriteOptions& options, bool verbose)
+{
+    return SpatialIndex::SetOrderedRecords(rootNode, observations, options, verbose);
+}
+
+LoopProjectFileResponse DataCollection::SetDrillholeObservations(netCDF::NcGroup* rootNode, std::vector<DrillholeObservation> observations, const ObservationWriteOptions& options, bool verbose)
+{
+    return SpatialIndex::SetOrderedRecords(rootNode, observations, options, verbose);
+}
+
 LoopProjectFileResponse DataCollection::SetDrillholeProperties(netCDF::NcGroup* rootNode, std::vector<DrillholeProperty> properties, bool verbose)
 {
     LoopProjectFileResponse resp = {0,""};
@@ -652,7 +670,10 @@ LoopProjectFileResponse DataCollection::SetDrillholeProperties(netCDF::NcGroup*
         std::vector<size_t> start; start.push_back(0);
         std::vector<size_t> count; count.push_back(properties.size());
         netCDF::NcVar drillholeProperties = observationGroup.getVar("drillholeProperties");
+        LOOP_TRACE_SPAN("WriteRecords","io");
         drillholeProperties.putVar(start,count,&(properties[0]));
+        Metrics::RecordWrite<DrillholeProperty>(drillholeProperties,properties.size());
+        RecordStorage::ResetDeletedRecords(drillholeProperties,properties.size());
     } catch (netCDF::exceptions::NcException &e) {
         std::cout << e.what();
         resp = createErrorMsg(1,"Failed to add drillhole data to loop project file",verbose);
@@ -676,7 +697,10 @@ LoopProjectFileResponse DataCollection::SetDrillholeSurveys(netCDF::NcGroup* roo
         std::vector<size_t> start; start.push_back(0);
         std::vector<size_t> count; count.push_back(surveys.size());
         netCDF::NcVar drillholeSurveys = observationGroup.getVar("drillholeSurveys");
+        LOOP_TRACE_SPAN("WriteRecords","io");
         drillholeSurveys.putVar(start,count,&(surveys[0]));
+        Metrics::RecordWrite<DrillholeSurvey>(drillholeSurveys,surveys.size());
+        RecordStorage::ResetDeletedRecords(drillholeSurveys,surveys.size());
     } catch (netCDF::exceptions::NcException &e) {
         std::cout << e.what();
         resp = createErrorMsg(1,"Failed to add drillhole data to loop project file",verbose);
@@ -693,6 +717,7 @@ LoopProjectFileResponse DataCollection::SetDataCollectionConfiguration(netCDF::N
             rootNode->addGroup("DataCollection");
         }
         netCDF::NcGroup dataCollectionGroup = rootNode->getGroup("DataCollection");
+        MetadataBatch batch(&dataCollectionGroup);
         dataCollectionGroup.putAtt("quietMode",netCDF::ncInt,configuration.quietMode);
         dataCollectionGroup.putAtt("deposits",netCDF::ncChar,LOOP_CONFIGURATION_DEFAULT_STRING_LENGTH,configuration.deposits);
         dataCollectionGroup.putAtt("dtb",netCDF::ncChar,LOOP_CONFIGURATION_DEFAULT_STRING_LENGTH,configuration.dtb);
@@ -718,6 +743,7 @@ LoopProjectFileResponse DataCollection::SetDataCollectionConfiguration(netCDF::N
         dataCollectionGroup.putAtt("closeDip",netCDF::ncDouble,configuration.closeDip);
         dataCollectionGroup.putAtt("useInterpolations",netCDF::ncInt,configuration.useInterpolations);
         dataCollectionGroup.putAtt("useFat",netCDF::ncInt,configuration.useFat);
+        resp = batch.Commit(verbose);
     } catch (netCDF::exceptions::NcException &e) {
         std::cout << e.what();
         resp = createErrorMsg(1,"Failed to add data collection configuration data to loop project file",verbose);
@@ -734,6 +760,7 @@ LoopProjectFileResponse DataCollection::SetDataCollectionSources(netCDF::NcGroup
             rootNode->addGroup("DataCollection");
         }
         netCDF::NcGroup dataCollectionGroup = rootNode->getGroup("DataCollection");
+        MetadataBatch batch(&dataCollectionGroup);
         dataCollectionGroup.putAtt("structureUrl",netCDF::ncChar,200,sources.structureUrl);
         dataCollectionGroup.putAtt("geologyUrl",netCDF::ncChar,200,sources.geologyUrl);
         dataCollectionGroup.putAtt("faultUrl",netCDF::ncChar,200,sources.faultUrl);
@@ -741,6 +768,7 @@ LoopProjectFileResponse DataCollection::SetDataCollectionSources(netCDF::NcGroup
         dataCollectionGroup.putAtt("mindepUrl",netCDF::ncChar,200,sources.mindepUrl);
         dataCollectionGroup.putAtt("metadataUrl",netCDF::ncChar,200,sources.metadataUrl);
         dataCollectionGroup.putAtt("sourceTags",netCDF::ncChar,200,sources.sourceTags);
+        resp = batch.Commit(verbose);
     } catch (netCDF::exceptions::NcException &e) {
         std::cout << e.what();
         resp = createErrorMsg(1,"Failed to add data collection configuration data to loop project file",verbose);
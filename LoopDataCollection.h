@@ -15,6 +15,7 @@
 #define LOOP_DRILLHOLE_PROPERTY_NAME_LENGTH 120
 #define LOOP_DRILLHOLE_PROPERTY_VALUE_LENGTH 80
 #define LOOP_DRILLHOLE_SURVEY_UNIT_LENGTH 80
+#define LOOP_SPATIAL_DIRECTORY_LEVEL 4
 
 namespace LoopProjectFile
 {
@@ -49,6 +50,8 @@ namespace LoopProjectFile
             northing = 0;
             altitude = 0;
         }
+        /*! Bulk load constructor. Leaves all variables uninitialised */
+        explicit Observation(BulkLoad) {}
     };
 
     /*! \brief A structure describing a single fault observation */
@@ -71,6 +74,8 @@ namespace LoopProjectFile
             displacement = 0;
             posOnly = 0;
         }
+        /*! Bulk load constructor. Leaves all variables uninitialised */
+        explicit FaultObservation(BulkLoad) : Observation(BulkLoad()) {}
     };
 
     /*! \brief A structure describing a single fold observation */
@@ -96,6 +101,8 @@ namespace LoopProjectFile
                 whatIsFolded[i] = 0;
             whatIsFolded[0] = 0;
         }
+        /*! Bulk load constructor. Leaves all variables uninitialised */
+        explicit FoldObservation(BulkLoad) : Observation(BulkLoad()) {}
     };
 
     /*! \brief A structure describing a single foliation observation */
@@ -110,6 +117,8 @@ namespace LoopProjectFile
             dipdir = 0;
             dip = 0;
         }
+        /*! Bulk load constructor. Leaves all variables uninitialised */
+        explicit FoliationObservation(BulkLoad) : Observation(BulkLoad()) {}
     };
 
     /*! \brief A structure describing a single discontinuity observation */
@@ -124,6 +133,8 @@ namespace LoopProjectFile
             dipdir = 0;
             dip = 0;
         }
+        /*! Bulk load constructor. Leaves all variables uninitialised */
+        explicit DiscontinuityObservation(BulkLoad) : Observation(BulkLoad()) {}
     };
 
     struct DataCollectionConfiguration
@@ -231,6 +242,8 @@ namespace LoopProjectFile
             for (auto i = 0; i < LOOP_NAME_LENGTH; i++)
                 layer[i] = 0;
         }
+        /*! Bulk load constructor. Leaves all variables uninitialised */
+        explicit StratigraphicObservation(BulkLoad) : Observation(BulkLoad()) {}
     };
 
     /*! \brief A structure describing a single stratigraphic contact observation */
@@ -240,6 +253,8 @@ namespace LoopProjectFile
         {
             type = CONTACTOBSERVATION;
         }
+        /*! Bulk load constructor. Leaves all variables uninitialised */
+        explicit ContactObservation(BulkLoad) : Observation(BulkLoad()) {}
     };
 
     /*! \brief A structure describing a single drillhole observation */
@@ -271,6 +286,8 @@ namespace LoopProjectFile
             for (auto i = 0; i < LOOP_DRILLHOLE_UNIT_LENGTH; i++)
                 unit[i] = 0;
         }
+        /*! Bulk load constructor. Leaves all variables uninitialised */
+        explicit DrillholeObservation(BulkLoad) : Observation(BulkLoad()) {}
     };
 
     /*! \brief A structure describing a single drillhole property */
@@ -287,6 +304,8 @@ namespace LoopProjectFile
             for (auto i = 0; i < LOOP_DRILLHOLE_PROPERTY_VALUE_LENGTH; i++)
                 propertyValue[i] = 0;
         }
+        /*! Bulk load constructor. Leaves all variables uninitialised */
+        explicit DrillholeProperty(BulkLoad) {}
     };
 
     /*! \brief A structure describing a single drillhole survey observation */
@@ -306,6 +325,31 @@ namespace LoopProjectFile
             for (auto i = 0; i < LOOP_DRILLHOLE_SURVEY_UNIT_LENGTH; i++)
                 unit[i] = 0;
         }
+        /*! Bulk load constructor. Leaves all variables uninitialised */
+        explicit DrillholeSurvey(BulkLoad) {}
+    };
+
+    /*! \brief How an observation table is laid out when it is written
+     *
+     * With spatialOrder set the records are stored sorted by a Morton (Z-order) key of their
+     * position within the project extents, and a directory of the record range held by each
+     * directory cell is stored next to the table (see SpatialIndex). Records close together in
+     * space are then close together in the file, so a region is read as a few contiguous
+     * hyperslabs. The records are not returned in the order they were given.
+     */
+    struct ObservationWriteOptions
+    {
+        bool spatialOrder;           /*!< Sort the records by their Morton key and store a directory */
+        unsigned int directoryLevel; /*!< Bits per axis of a directory cell (up to 8^level cells) */
+        ObservationWriteOptions() : spatialOrder(false), directoryLevel(LOOP_SPATIAL_DIRECTORY_LEVEL) {}
+
+        /*! \brief Options for a spatially ordered table with the default directory level */
+        static ObservationWriteOptions SpatiallyOrdered()
+        {
+            ObservationWriteOptions options;
+            options.spatialOrder = true;
+            return options;
+        }
     };
 
     namespace DataCollection
@@ -451,6 +495,51 @@ namespace LoopProjectFile
          */
         LoopProjectFileResponse GetDrillholeSurveys(netCDF::NcGroup *rootNode, std::vector<DrillholeSurvey> &surveys, bool verbose = false);
 
+        /*! @{
+         * \brief Retrieves a data collection record table into a bulk vector. The records are
+         * not zero filled before the read so this is the preferred path for large tables
+         *
+         * \param rootNode - the rootNode of the netCDF Loop project file
+         * \param records - a reference to where the record data is to be copied
+         * \param verbose - a flag to toggle verbose message printing
+         *
+         * \return Response with success/fail of record data retrieval with an error message if it failed
+         */
+        LoopProjectFileResponse GetFaultObservations(netCDF::NcGroup *rootNode, BulkVector<FaultObservation> &records, bool verbose = false);
+        LoopProjectFileResponse GetFoldObservations(netCDF::NcGroup *rootNode, BulkVector<FoldObservation> &records, bool verbose = false);
+        LoopProjectFileResponse GetFoliationObservations(netCDF::NcGroup *rootNode, BulkVector<FoliationObservation> &records, bool verbose = false);
+        LoopProjectFileResponse GetDiscontinuityObservations(netCDF::NcGroup *rootNode, BulkVector<DiscontinuityObservation> &records, bool verbose = false);
+        LoopProjectFileResponse GetStratigraphicObservations(netCDF::NcGroup *rootNode, BulkVector<StratigraphicObservation> &records, bool verbose = false);
+        LoopProjectFileResponse GetContactObservations(netCDF::NcGroup *rootNode, BulkVector<ContactObservation> &records, bool verbose = false);
+        LoopProjectFileResponse GetDrillholeObservations(netCDF::NcGroup *rootNode, BulkVector<DrillholeObservation> &records, bool verbose = false);
+        LoopProjectFileResponse GetDrillholeProperties(netCDF::NcGroup *rootNode, BulkVector<DrillholeProperty> &records, bool verbose = false);
+        LoopProjectFileResponse GetDrillholeSurveys(netCDF::NcGroup *rootNode, BulkVector<DrillholeSurvey> &records, bool verbose = false);
+        /*!@}*/
+
+        /*! @{
+         * \brief Retrieves part of a data collection record table, the records
+         * [start, start+count) in the order the whole table getters return them. A range past the
+         * end of the table is cut short
+         *
+         * \param rootNode - the rootNode of the netCDF Loop project file
+         * \param records - a reference to where the record data is to be copied
+         * \param start - the position of the first record to retrieve
+         * \param count - the most records to retrieve
+         * \param verbose - a flag to toggle verbose message printing
+         *
+         * \return Response with success/fail of record data retrieval with an error message if it failed
+         */
+        LoopProjectFileResponse GetFaultObservations(netCDF::NcGroup *rootNode, std::vector<FaultObservation> &records, size_t start, size_t count, bool verbose = false);
+        LoopProjectFileResponse GetFoldObservations(netCDF::NcGroup *rootNode, std::vector<FoldObservation> &records, size_t start, size_t count, bool verbose = false);
+        LoopProjectFileResponse GetFoliationObservations(netCDF::NcGroup *rootNode, std::vector<FoliationObservation> &records, size_t start, size_t count, bool verbose = false);
+        LoopProjectFileResponse GetDiscontinuityObservations(netCDF::NcGroup *rootNode, std::vector<DiscontinuityObservation> &records, size_t start, size_t count, bool verbose = false);
+        LoopProjectFileResponse GetStratigraphicObservations(netCDF::NcGroup *rootNode, std::vector<StratigraphicObservation> &records, size_t start, size_t count, bool verbose = false);
+        LoopProjectFileResponse GetContactObservations(netCDF::NcGroup *rootNode, std::vector<ContactObservation> &records, size_t start, size_t count, bool verbose = false);
+        LoopProjectFileResponse GetDrillholeObservations(netCDF::NcGroup *rootNode, std::vector<DrillholeObservation> &records, size_t start, size_t count, bool verbose = false);
+        LoopProjectFileResponse GetDrillholeProperties(netCDF::NcGroup *rootNode, std::vector<DrillholeProperty> &records, size_t start, size_t count, bool verbose = false);
+        LoopProjectFileResponse GetDrillholeSurveys(netCDF::NcGroup *rootNode, std::vector<DrillholeSurvey> &records, size_t start, size_t count, bool verbose = false);
+        /*!@}*/
+
         /*!
          * \brief Retrieves data collection configuration from the loop project file
          *
@@ -550,6 +639,26 @@ namespace LoopProjectFile
          */
         LoopProjectFileResponse SetDrillholeObservations(netCDF::NcGroup *rootNode, std::vector<DrillholeObservation> observations, bool verbose = false);
 
+        /*! @{
+         * \brief Sets observation data to the loop project file with the given layout. Spatial
+         * ordering needs the project extents to be set first
+         *
+         * \param rootNode - the rootNode of the netCDF Loop project file
+         * \param observations - the observation data to be inserted
+         * \param options - the layout of the stored records
+         * \param verbose - a flag to toggle verbose message printing
+         *
+         * \return Response with success/fail of observation data insertion with an error message if it failed
+         */
+        LoopProjectFileResponse SetFaultObservations(netCDF::NcGroup *rootNode, std::vector<FaultObservation> observations, const ObservationWriteOptions &options, bool verbose = false);
+        LoopProjectFileResponse SetFoldObservations(netCDF::NcGroup *rootNode, std::vector<FoldObservation> observations, const ObservationWriteOptions &options, bool verbose = false);
+        LoopProjectFileResponse SetFoliationObservations(netCDF::NcGroup *rootNode, std::vector<FoliationObservation> observations, const ObservationWriteOptions &options, bool verbose = false);
+        LoopProjectFileResponse SetDiscontinuityObservations(netCDF::NcGroup *rootNode, std::vector<DiscontinuityObservation> observations, const ObservationWriteOptions &options, bool verbose = false);
+        LoopProjectFileResponse SetStratigraphicObservations(netCDF::NcGroup *rootNode, std::vector<StratigraphicObservation> observations, const ObservationWriteOptions &options, bool verbose = false);
+        LoopProjectFileResponse SetContactObservations(netCDF::NcGroup *rootNode, std::vector<ContactObservation> observations, const ObservationWriteOptions &options, bool verbose = false);
+        LoopProjectFileResponse SetDrillholeObservations(netCDF::NcGroup *rootNode, std::vector<DrillholeObservation> observations, const ObservationWriteOptions &options, bool verbose = false);
+        /*!@}*/
+
         /*!
          * \brief Sets drillhole property data to the loop project file
          *
@@ -26,6 +26,7 @@ LoopProjectFileResponse LoopExtents::SetExtents(netCDF::NcGroup* rootNode, LoopE
     SwapExtents(extents.minLongitude, extents.maxLongitude);
 
     try {
+        MetadataBatch batch(rootNode);
         rootNode->putAtt("minLatitude",netCDF::ncDouble,extents.minLatitude);
         rootNode->putAtt("maxLatitude",netCDF::ncDouble,extents.maxLatitude);
         rootNode->putAtt("minLongitude",netCDF::ncDouble,extents.minLongitude);
@@ -42,6 +43,7 @@ LoopProjectFileResponse LoopExtents::SetExtents(netCDF::NcGroup* rootNode, LoopE
         rootNode->putAtt("spacingY",netCDF::ncDouble,extents.spacingY);
         rootNode->putAtt("spacingZ",netCDF::ncDouble,extents.spacingZ);
         rootNode->putAtt("workingFormat",netCDF::ncInt,extents.workingFormat);
+        resp = batch.Commit(verbose);
     } catch (netCDF::exceptions::NcException& e) {
         if (verbose) std::cout << e.what();
         resp = createErrorMsg(1,"ERROR: Failure to set extents on netCDF file", verbose);
@@ -57,22 +59,25 @@ LoopProjectFileResponse LoopExtents::GetExtents(netCDF::NcGroup* rootNode, LoopE
         return resp;
     }
     try {
-        rootNode->getAtt("minLatitude").getValues(&extents.minLatitude);
-        rootNode->getAtt("maxLatitude").getValues(&extents.maxLatitude);
-        rootNode->getAtt("minLongitude").getValues(&extents.minLongitude);
-        rootNode->getAtt("maxLongitude").getValues(&extents.maxLongitude);
-        rootNode->getAtt("minNorthing").getValues(&extents.minNorthing);
-        rootNode->getAtt("maxNorthing").getValues(&extents.maxNorthing);
-        rootNode->getAtt("minEasting").getValues(&extents.minEasting);
-        rootNode->getAtt("maxEasting").getValues(&extents.maxEasting);
-        rootNode->getAtt("utmZone").getValues(&extents.utmZone);
-        rootNode->getAtt("utmNorthSouth").getValues(&extents.utmNorthSouth);
-        rootNode->getAtt("topDepth").getValues(&extents.topDepth);
-        rootNode->getAtt("bottomDepth").getValues(&extents.bottomDepth);
-        rootNode->getAtt("spacingX").getValues(&extents.spacingX);
-        rootNode->getAtt("spacingY").getValues(&extents.spacingY);
-        rootNode->getAtt("spacingZ").getValues(&extents.spacingZ);
-        rootNode->getAtt("workingFormat").getValues(&extents.workingFormat);
+        auto atts = rootNode->getAtts();
+        bool found = true;
+        found &= GetAttributeValue(atts,"minLatitude",&extents.minLatitude);
+        found &= GetAttributeValue(atts,"maxLatitude",&extents.maxLatitude);
+        found &= GetAttributeValue(atts,"minLongitude",&extents.minLongitude);
+        found &= GetAttributeValue(atts,"maxLongitude",&extents.maxLongitude);
+        found &= GetAttributeValue(atts,"minNorthing",&extents.minNorthing);
+        found &= GetAttributeValue(atts,"maxNorthing",&extents.maxNorthing);
+        found &= GetAttributeValue(atts,"minEasting",&extents.minEasting);
+        found &= GetAttributeValue(atts,"maxEasting",&extents.maxEasting);
+        found &= GetAttributeValue(atts,"utmZone",&extents.utmZone);
+        found &= GetAttributeValue(atts,"utmNorthSouth",&extents.utmNorthSouth);
+        found &= GetAttributeValue(atts,"topDepth",&extents.topDepth);
+        found &= GetAttributeValue(atts,"bottomDepth",&extents.bottomDepth);
+        found &= GetAttributeValue(atts,"spacingX",&extents.spacingX);
+        found &= GetAttributeValue(atts,"spacingY",&extents.spacingY);
+        found &= GetAttributeValue(atts,"spacingZ",&extents.spacingZ);
+        found &= GetAttributeValue(atts,"workingFormat",&extents.workingFormat);
+        if (!found) return createErrorMsg(1,"No valid Extents in Loop Project File",verbose);
         extents.errored = false;
     } catch (netCDF::exceptions::NcException& e) {
         resp = createErrorMsg(1,"No valid Extents in Loop Project File",verbose);
@@ -1,4 +1,7 @@
 #include "LoopExtractedInformation.h"
+#include "LoopProjectFileMetrics.h"
+#include "LoopProjectFileTrace.h"
+#include "LoopRecordStorage.h"
 
 namespace LoopProjectFile {
 
@@ -153,180 +156,142 @@ LoopProjectFileResponse ExtractedInformation::CreateExtractedInformationGroup(ne
     return resp;
 }
 
-LoopProjectFileResponse ExtractedInformation::GetFaultEvents(netCDF::NcGroup* rootNode, std::vector<FaultEvent>& events, bool verbose)
+/*****************************************************************************/
+/*  Reads the live records [start, start+count) of a table, one hyperslab    */
+/*  per run of records not deleted, appending to the container. Shared by    */
+/*  the zeroing, bulk load and range getters                                 */
+/*****************************************************************************/
+template <typename T, typename Alloc>
+static LoopProjectFileResponse GetExtractedInformationRecords(netCDF::NcGroup* rootNode, std::string groupName, std::string groupDescription, std::string variableName, std::vector<T,Alloc>& records, bool verbose, size_t start = 0, size_t count = LOOP_ALL_RECORDS)
 {
     LoopProjectFileResponse resp = {0,""};
-    auto groups = rootNode->getGroups();
-    if (groups.find("ExtractedInformation") != groups.end()) {
-        netCDF::NcGroup extractedInformationGroup = rootNode->getGroup("ExtractedInformation");
-        auto eiGroups = extractedInformationGroup.getGroups();
-        if (eiGroups.find("EventLog") != eiGroups.end()) {
-            netCDF::NcGroup eventLogGroup = extractedInformationGroup.getGroup("EventLog");
-            netCDF::NcVar faultEvents = eventLogGroup.getVar("faultEvents");
-            for (size_t i=0;i<eventLogGroup.getDim("faultEventIndex").getSize();i++) {
-                FaultEvent event;
-                std::vector<size_t> start; start.push_back(i);
-                faultEvents.getVar(start,&event);
-                events.push_back(event);
+    try {
+        auto groups = rootNode->getGroups();
+        if (groups.find("ExtractedInformation") != groups.end()) {
+            netCDF::NcGroup extractedInformationGroup = rootNode->getGroup("ExtractedInformation");
+            auto eiGroups = extractedInformationGroup.getGroups();
+            if (eiGroups.find(groupName) != eiGroups.end()) {
+                netCDF::NcGroup group = extractedInformationGroup.getGroup(groupName);
+                netCDF::NcVar recordsVar = group.getVar(variableName);
+                LOOP_TRACE_SPAN("ReadRecords","io");
+                size_t numRecords = RecordStorage::ReadRecords(recordsVar,records,start,count);
+                if (numRecords > 0) Metrics::RecordRead<T>(recordsVar,numRecords);
+            } else {
+                resp = createErrorMsg(1,"No " + groupDescription + " Group Node Present",verbose);
             }
         } else {
-            resp = createErrorMsg(1,"No EventLog Group Node Present",verbose);
+            resp = createErrorMsg(1,"No Extracted Information Group Node Present",verbose);
         }
-    } else {
-        resp = createErrorMsg(1,"No Extracted Information Group Node Present",verbose);
+    } catch (netCDF::exceptions::NcException& e) {
+        if (verbose) std::cout << e.what() << std::endl;
+        resp = createErrorMsg(1,"Failed to read " + variableName + " from loop project file",verbose);
     }
     return resp;
 }
 
+LoopProjectFileResponse ExtractedInformation::GetFaultEvents(netCDF::NcGroup* rootNode, std::vector<FaultEvent>& events, bool verbose)
+{
+    return GetExtractedInformationRecords(rootNode,"EventLog","Event Log","faultEvents",events,verbose);
+}
+
+LoopProjectFileResponse ExtractedInformation::GetFaultEvents(netCDF::NcGroup* rootNode, BulkVector<FaultEvent>& events, bool verbose)
+{
+    return GetExtractedInformationRecords(rootNode,"EventLog","Event Log","faultEvents",events,verbose);
+}
+
 LoopProjectFileResponse ExtractedInformation::GetFoldEvents(netCDF::NcGroup* rootNode, std::vector<FoldEvent>& events, bool verbose)
 {
-    LoopProjectFileResponse resp = {0,""};
-    auto groups = rootNode->getGroups();
-    if (groups.find("ExtractedInformation") != groups.end()) {
-        netCDF::NcGroup extractedInformationGroup = rootNode->getGroup("ExtractedInformation");
-        auto eiGroups = extractedInformationGroup.getGroups();
-        if (eiGroups.find("EventLog") != eiGroups.end()) {
-            netCDF::NcGroup eventLogGroup = extractedInformationGroup.getGroup("EventLog");
-            netCDF::NcVar foldEvents = eventLogGroup.getVar("foldEvents");
-            for (size_t i=0;i<eventLogGroup.getDim("foldEventIndex").getSize();i++) {
-                FoldEvent event;
-                std::vector<size_t> start; start.push_back(i);
-                foldEvents.getVar(start,&event);
-                events.push_back(event);
-            }
-        } else {
-            resp = createErrorMsg(1,"No Event Log Group Node Present",verbose);
-        }
-    } else {
-        resp = createErrorMsg(1,"No Extracted Information Group Node Present",verbose);
-    }
-    return resp;
+    return GetExtractedInformationRecords(rootNode,"EventLog","Event Log","foldEvents",events,verbose);
+}
+
+LoopProjectFileResponse ExtractedInformation::GetFoldEvents(netCDF::NcGroup* rootNode, BulkVector<FoldEvent>& events, bool verbose)
+{
+    return GetExtractedInformationRecords(rootNode,"EventLog","Event Log","foldEvents",events,verbose);
 }
 
 LoopProjectFileResponse ExtractedInformation::GetFoliationEvents(netCDF::NcGroup* rootNode, std::vector<FoliationEvent>& events, bool verbose)
 {
-    LoopProjectFileResponse resp = {0,""};
-    auto groups = rootNode->getGroups();
-    if (groups.find("ExtractedInformation") != groups.end()) {
-        netCDF::NcGroup extractedInformationGroup = rootNode->getGroup("ExtractedInformation");
-        auto eiGroups = extractedInformationGroup.getGroups();
-        if (eiGroups.find("EventLog") != eiGroups.end()) {
-            netCDF::NcGroup eventLogGroup = extractedInformationGroup.getGroup("EventLog");
-            netCDF::NcVar foliationEvents = eventLogGroup.getVar("foliationEvents");
-            for (size_t i=0;i<eventLogGroup.getDim("foliationEventIndex").getSize();i++) {
-                FoliationEvent event;
-                std::vector<size_t> start; start.push_back(i);
-                foliationEvents.getVar(start,&event);
-                events.push_back(event);
-            }
-        } else {
-            resp = createErrorMsg(1,"No Event Log Group Node Present",verbose);
-        }
-    } else {
-        resp = createErrorMsg(1,"No Extracted Information Group Node Present",verbose);
-    }
-    return resp;
+    return GetExtractedInformationRecords(rootNode,"EventLog","Event Log","foliationEvents",events,verbose);
+}
+
+LoopProjectFileResponse ExtractedInformation::GetFoliationEvents(netCDF::NcGroup* rootNode, BulkVector<FoliationEvent>& events, bool verbose)
+{
+    return GetExtractedInformationRecords(rootNode,"EventLog","Event Log","foliationEvents",events,verbose);
 }
 
 LoopProjectFileResponse ExtractedInformation::GetDiscontinuityEvents(netCDF::NcGroup* rootNode, std::vector<DiscontinuityEvent>& events, bool verbose)
 {
-    LoopProjectFileResponse resp = {0,""};
-    auto groups = rootNode->getGroups();
-    if (groups.find("ExtractedInformation") != groups.end()) {
-        netCDF::NcGroup extractedInformationGroup = rootNode->getGroup("ExtractedInformation");
-        auto eiGroups = extractedInformationGroup.getGroups();
-        if (eiGroups.find("EventLog") != eiGroups.end()) {
-            netCDF::NcGroup eventLogGroup = extractedInformationGroup.getGroup("EventLog");
-            netCDF::NcVar discontinuityEvents = eventLogGroup.getVar("discontinuityEvents");
-            for (size_t i=0;i<eventLogGroup.getDim("discontinuityEventIndex").getSize();i++) {
-                DiscontinuityEvent event;
-                std::vector<size_t> start; start.push_back(i);
-                discontinuityEvents.getVar(start,&event);
-                events.push_back(event);
-            }
-        } else {
-            resp = createErrorMsg(1,"No Event Log Group Node Present",verbose);
-        }
-    } else {
-        resp = createErrorMsg(1,"No Extracted Information Group Node Present",verbose);
-    }
-    return resp;
+    return GetExtractedInformationRecords(rootNode,"EventLog","Event Log","discontinuityEvents",events,verbose);
+}
+
+LoopProjectFileResponse ExtractedInformation::GetDiscontinuityEvents(netCDF::NcGroup* rootNode, BulkVector<DiscontinuityEvent>& events, bool verbose)
+{
+    return GetExtractedInformationRecords(rootNode,"EventLog","Event Log","discontinuityEvents",events,verbose);
 }
 
 LoopProjectFileResponse ExtractedInformation::GetStratigraphicLayers(netCDF::NcGroup* rootNode, std::vector<StratigraphicLayer>& layers, bool verbose)
 {
-    LoopProjectFileResponse resp = {0,""};
-    auto groups = rootNode->getGroups();
-    if (groups.find("ExtractedInformation") != groups.end()) {
-        netCDF::NcGroup extractedInformationGroup = rootNode->getGroup("ExtractedInformation");
-        auto eiGroups = extractedInformationGroup.getGroups();
-        if (eiGroups.find("StratigraphicInformation") != eiGroups.end()) {
-            netCDF::NcGroup stratigraphicInformationGroup = extractedInformationGroup.getGroup("StratigraphicInformation");
-            netCDF::NcVar stratigraphicLayers = stratigraphicInformationGroup.getVar("stratigraphicLayers");
-            for (size_t i=0;i<stratigraphicInformationGroup.getDim("index").getSize();i++) {
-                StratigraphicLayer layer;
-                std::vector<size_t> start; start.push_back(i);
-                stratigraphicLayers.getVar(start,&layer);
-                layers.push_back(layer);
-            }
-        } else {
-            resp = createErrorMsg(1,"No Stratigraphic Information Group Node Present",verbose);
-        }
-    } else {
-        resp = createErrorMsg(1,"No Extracted Information Group Node Present",verbose);
-    }
-    return resp;
+    return GetExtractedInformationRecords(rootNode,"StratigraphicInformation","Stratigraphic Information","stratigraphicLayers",layers,verbose);
+}
+
+LoopProjectFileResponse ExtractedInformation::GetStratigraphicLayers(netCDF::NcGroup* rootNode, BulkVector<StratigraphicLayer>& layers, bool verbose)
+{
+    return GetExtractedInformationRecords(rootNode,"StratigraphicInformation","Stratigraphic Information","stratigraphicLayers",layers,verbose);
 }
 
 LoopProjectFileResponse ExtractedInformation::GetEventRelationships(netCDF::NcGroup* rootNode, std::vector<EventRelationship>& eventRelationships, bool verbose)
 {
-    LoopProjectFileResponse resp = {0,""};
-    auto groups = rootNode->getGroups();
-    if (groups.find("ExtractedInformation") != groups.end()) {
-        netCDF::NcGroup extractedInformationGroup = rootNode->getGroup("ExtractedInformation");
-        auto eiGroups = extractedInformationGroup.getGroups();
-        if (eiGroups.find("EventRelationships") != eiGroups.end()) {
-            netCDF::NcGroup eventRelationshipsGroup = extractedInformationGroup.getGroup("EventRelationships");
-            netCDF::NcVar links = eventRelationshipsGroup.getVar("eventRelationships");
-            for (size_t i=0;i<eventRelationshipsGroup.getDim("index").getSize();i++) {
-                EventRelationship eventRelationship;
-                std::vector<size_t> start; start.push_back(i);
-                links.getVar(start,&eventRelationship);
-                eventRelationships.push_back(eventRelationship);
-            }
-        } else {
-            resp = createErrorMsg(1,"No Event Relationships Group Node Present",verbose);
-        }
-    } else {
-        resp = createErrorMsg(1,"No Extracted Information Group Node Present",verbose);
-    }
-    return resp;
+    return GetExtractedInformationRecords(rootNode,"EventRelationships","Event Relationships","eventRelationships",eventRelationships,verbose);
+}
+
+LoopProjectFileResponse ExtractedInformation::GetEventRelationships(netCDF::NcGroup* rootNode, BulkVector<EventRelationship>& eventRelationships, bool verbose)
+{
+    return GetExtractedInformationRecords(rootNode,"EventRelationships","Event Relationships","eventRelationships",eventRelationships,verbose);
 }
 
 LoopProjectFileResponse ExtractedInformation::GetDrillholeDescriptions(netCDF::NcGroup* rootNode, std::vector<DrillholeDescription>& drillholeDescriptions, bool verbose)
 {
-    LoopProjectFileResponse resp = {0,""};
-    auto groups = rootNode->getGroups();
-    if (groups.find("ExtractedInformation") != groups.end()) {
-        netCDF::NcGroup extractedInformationGroup = rootNode->getGroup("ExtractedInformation");
-        auto eiGroups = extractedInformationGroup.getGroups();
-        if (eiGroups.find("DrillholeInformation") != eiGroups.end()) {
-            netCDF::NcGroup drillholeInformationGroup = extractedInformationGroup.getGroup("DrillholeInformation");
-            netCDF::NcVar links = drillholeInformationGroup.getVar("drillholeDescriptions");
-            for (size_t i=0;i<drillholeInformationGroup.getDim("index").getSize();i++) {
-                DrillholeDescription drillholeDescription;
-                EventRelationship eventRelationship;
-                std::vector<size_t> start; start.push_back(i);
-                links.getVar(start,&drillholeDescription);
-                drillholeDescriptions.push_back(drillholeDescription);
-            }
-        } else {
-            resp = createErrorMsg(1,"No Drillhole Information Group Node Present",verbose);
-        }
-    } else {
-        resp = createErrorMsg(1,"No Extracted Information Group Node Present",verbose);
-    }
-    return resp;
+    return GetExtractedInformationRecords(rootNode,"DrillholeInformation","Drillhole Information","drillholeDescriptions",drillholeDescriptions,verbose);
+}
+
+LoopProjectFileResponse ExtractedInformation::GetDrillholeDescriptions(netCDF::NcGroup* rootNode, BulkVector<DrillholeDescription>& drillholeDescriptions, bool verbose)
+{
+    return GetExtractedInformationRecords(rootNode,"DrillholeInformation","Drillhole Information","drillholeDescriptions",drillholeDescriptions,verbose);
+}
+
+LoopProjectFileResponse ExtractedInformation::GetFaultEvents(netCDF::NcGroup* rootNode, std::vector<FaultEvent>& events, size_t start, size_t count, bool verbose)
+{
+    return GetExtractedInformationRecords(rootNode,"EventLog","Event Log","faultEvents",events,verbose,start,count);
+}
+
+LoopProjectFileResponse ExtractedInformation::GetFoldEvents(netCDF::NcGroup* rootNode, std::vector<FoldEvent>& events, size_t start, size_t count, bool verbose)
+{
+    return GetExtractedInformationRecords(rootNode,"EventLog","Event Log","foldEvents",events,verbose,start,count);
+}
+
+LoopProjectFileResponse ExtractedInformation::GetFoliationEvents(netCDF::NcGroup* rootNode, std::vector<FoliationEvent>& events, size_t start, size_t count, bool verbose)
+{
+    return GetExtractedInformationRecords(rootNode,"EventLog","Event Log","foliationEvents",events,verbose,start,count);
+}
+
+LoopProjectFileResponse ExtractedInformation::GetDiscontinuityEvents(netCDF::NcGroup* rootNode, std::vector<DiscontinuityEvent>& events, size_t start, size_t count, bool verbose)
+{
+    return GetExtractedInformationRecords(rootNode,"EventLog","Event Log","discontinuityEvents",events,verbose,start,count);
+}
+
+LoopProjectFileResponse ExtractedInformation::GetStratigraphicLayers(netCDF::NcGroup* rootNode, std::vector<StratigraphicLayer>& layers, size_t start, size_t count, bool verbose)
+{
+    return GetExtractedInformationRecords(rootNode,"StratigraphicInformation","Stratigraphic Information","stratigraphicLayers",layers,verbose,start,count);
+}
+
+LoopProjectFileResponse ExtractedInformation::GetEventRelationships(netCDF::NcGroup* rootNode, std::vector<EventRelationship>& eventRelationships, size_t start, size_t count, bool verbose)
+{
+    return GetExtractedInformationRecords(rootNode,"EventRelationships","Event Relationships","eventRelationships",eventRelationships,verbose,start,count);
+}
+
+LoopProjectFileResponse ExtractedInformation::GetDrillholeDescriptions(netCDF::NcGroup* rootNode, std::vector<DrillholeDescription>& drillholeDescriptions, size_t start, size_t count, bool verbose)
+{
+    return GetExtractedInformationRecords(rootNode,"DrillholeInformation","Drillhole Information","drillholeDescriptions",drillholeDescriptions,verbose,start,count);
 }
 
 LoopProjectFileResponse ExtractedInformation::SetFaultEvents(netCDF::NcGroup* rootNode, std::vector<FaultEvent> events, bool verbose)
@@ -346,7 +311,10 @@ LoopProjectFileResponse ExtractedInformation::SetFaultEvents(netCDF::NcGroup* ro
         std::vector<size_t> start; start.push_back(0);
         std::vector<size_t> count; count.push_back(events.size());
         netCDF::NcVar faultEvents = eventLogGroup.getVar("faultEvents");
+        LOOP_TRACE_SPAN("WriteRecords","io");
         faultEvents.putVar(start,count,&(events[0]));
+        Metrics::RecordWrite<FaultEvent>(faultEvents,events.size());
+        RecordStorage::ResetDeletedRecords(faultEvents,events.size());
     } catch (netCDF::exceptions::NcException &e) {
         std::cout << e.what();
         resp = createErrorMsg(1,"Failed to add fault events to loop project file",verbose);
@@ -371,7 +339,10 @@ LoopProjectFileResponse ExtractedInformation::SetFoldEvents(netCDF::NcGroup* roo
         std::vector<size_t> start; start.push_back(0);
         std::vector<size_t> count; count.push_back(events.size());
         netCDF::NcVar foldEvents = eventLogGroup.getVar("foldEvents");
+        LOOP_TRACE_SPAN("WriteRecords","io");
         foldEvents.putVar(start,count,&(events[0]));
+        Metrics::RecordWrite<FoldEvent>(foldEvents,events.size());
+        RecordStorage::ResetDeletedRecords(foldEvents,events.size());
     } catch (netCDF::exceptions::NcException &e) {
         std::cout << e.what();
         resp = createErrorMsg(1,"Failed to add fold events to loop project file",verbose);
@@ -396,7 +367,10 @@ LoopProjectFileResponse ExtractedInformation::SetFoliationEvents(netCDF::NcGroup
         std::vector<size_t> start; start.push_back(0);
         std::vector<size_t> count; count.push_back(events.size());
         netCDF::NcVar foliationEvents = eventLogGroup.getVar("foliationEvents");
+        LOOP_TRACE_SPAN("WriteRecords","io");
         foliationEvents.putVar(start,count,&(events[0]));
+        Metrics::RecordWrite<FoliationEvent>(foliationEvents,events.size());
+        RecordStorage::ResetDeletedRecords(foliationEvents,events.size());
     } catch (netCDF::exceptions::NcException &e) {
         std::cout << e.what();
         resp = createErrorMsg(1,"Failed to add foliation events to loop project file",verbose);
@@ -421,7 +395,10 @@ LoopProjectFileResponse ExtractedInformation::SetDiscontinuityEvents(netCDF::NcG
         std::vector<size_t> start; start.push_back(0);
         std::vector<size_t> count; count.push_back(events.size());
         netCDF::NcVar discontinuityEvents = eventLogGroup.getVar("discontinuityEvents");
+        LOOP_TRACE_SPAN("WriteRecords","io");
         discontinuityEvents.putVar(start,count,&(events[0]));
+        Metrics::RecordWrite<DiscontinuityEvent>(discontinuityEvents,events.size());
+        RecordStorage::ResetDeletedRecords(discontinuityEvents,events.size());
     } catch (netCDF::exceptions::NcException &e) {
         std::cout << e.what();
         resp = createErrorMsg(1,"Failed to add discontinuity events to loop project file",verbose);
@@ -446,7 +423,10 @@ LoopProjectFileResponse ExtractedInformation::SetStratigraphicLayers(netCDF::NcG
         std::vector<size_t> start; start.push_back(0);
         std::vector<size_t> count; count.push_back(layers.size());
         netCDF::NcVar stratigraphicLayers = stratigraphicInformationGroup.getVar("stratigraphicLayers");
+        LOOP_TRACE_SPAN("WriteRecords","io");
         stratigraphicLayers.putVar(start,count,&(layers[0]));
+        Metrics::RecordWrite<StratigraphicLayer>(stratigraphicLayers,layers.size());
+        RecordStorage::ResetDeletedRecords(stratigraphicLayers,layers.size());
     } catch (netCDF::exceptions::NcException &e) {
         std::cout << e.what();
         resp = createErrorMsg(1,"Failed to add stratigraphic layers to loop project file",verbose);
@@ -471,7 +451,10 @@ LoopProjectFileResponse ExtractedInformation::SetEventRelationships(netCDF::NcGr
         std::vector<size_t> start; start.push_back(0);
         std::vector<size_t> count; count.push_back(eventRelationships.size());
         netCDF::NcVar links = eventRelationshipsGroup.getVar("eventRelationships");
+        LOOP_TRACE_SPAN("WriteRecords","io");
         links.putVar(start,count,&(eventRelationships[0]));
+        Metrics::RecordWrite<EventRelationship>(links,eventRelationships.size());
+        RecordStorage::ResetDeletedRecords(links,eventRelationships.size());
     } catch (netCDF::exceptions::NcException &e) {
         std::cout << e.what();
         resp = createErrorMsg(1,"Failed to add event relationships to loop project file",verbose);
@@ -496,7 +479,10 @@ LoopProjectFileResponse ExtractedInformation::SetDrillholeDescriptions(netCDF::N
         std::vector<size_t> start; start.push_back(0);
         std::vector<size_t> count; count.push_back(drillholeDescriptions.size());
         netCDF::NcVar links = drillholeInformationGroup.getVar("drillholeDescriptions");
+        LOOP_TRACE_SPAN("WriteRecords","io");
         links.putVar(start,count,&(drillholeDescriptions[0]));
+        Metrics::RecordWrite<DrillholeDescription>(links,drillholeDescriptions.size());
+        RecordStorage::ResetDeletedRecords(links,drillholeDescriptions.size());
     } catch (netCDF::exceptions::NcException &e) {
         std::cout << e.what();
         resp = createErrorMsg(1,"Failed to add drillhole descriptions to loop project file",verbose);
@@ -49,6 +49,8 @@ struct Event {
         for (auto i=0;i<LOOP_NAME_LENGTH;i++) name[i] = 0;
         for (auto i=0;i<LOOP_SUPERGROUP_NAME_LENGTH;i++) supergroup[i] = 0;
     }
+    /*! Bulk load constructor. Leaves all values uninitialised */
+    explicit Event(BulkLoad) {}
 };
 
 /*! \brief A structure describing a relationship between events */
@@ -63,6 +65,8 @@ struct EventRelationship {
         eventId2 = 0;
         bidirectional = 0;
     }
+    /*! Bulk load constructor. Leaves all values uninitialised */
+    explicit EventRelationship(BulkLoad) {}
 };
 
 /*! \brief A structure describing a fault event */
@@ -101,6 +105,8 @@ struct FaultEvent : public Event {
         avgNormalNorthing = 0;
         avgNormalAltitude = 0;
     }
+    /*! Bulk load constructor. Leaves all values uninitialised */
+    explicit FaultEvent(BulkLoad) : Event(BulkLoad()) {}
 };
 
 /*! \brief A structure describing a fold event */
@@ -123,6 +129,8 @@ struct FoldEvent : public Event {
         secondaryWavelength = 0;
         secondaryAmplitude = 0;
     }
+    /*! Bulk load constructor. Leaves all values uninitialised */
+    explicit FoldEvent(BulkLoad) : Event(BulkLoad()) {}
 };
 
 /*! \brief A structure describing a foliation event */
@@ -137,6 +145,8 @@ struct FoliationEvent : public Event {
         lowerScalarValue = 0;
         upperScalarValue = 0;
     }
+    /*! Bulk load constructor. Leaves all values uninitialised */
+    explicit FoliationEvent(BulkLoad) : Event(BulkLoad()) {}
 };
 
 /*! \brief A structure describing a discontinuity event */
@@ -147,6 +157,8 @@ struct DiscontinuityEvent : public Event {
         type = DISCONTINUITYEVENT;
         scalarValue = 0;
     }
+    /*! Bulk load constructor. Leaves all values uninitialised */
+    explicit DiscontinuityEvent(BulkLoad) : Event(BulkLoad()) {}
 };
 
 /*! \brief A structure describing a stratigraphic layer */
@@ -168,6 +180,8 @@ struct StratigraphicLayer : public Event {
         colour1Red = colour1Green = colour1Blue = 0;
         colour2Red = colour2Green = colour2Blue = 0;
     }
+    /*! Bulk load constructor. Leaves all values uninitialised */
+    explicit StratigraphicLayer(BulkLoad) : Event(BulkLoad()) {}
 };
 
 /*! \brief A structure describing a drillhole */
@@ -184,6 +198,8 @@ struct DrillholeDescription {
         altitude = 0;
         for (auto i=0;i<LOOP_NAME_LENGTH;i++) name[i] = 0;
     }
+    /*! Bulk load constructor. Leaves all values uninitialised */
+    explicit DrillholeDescription(BulkLoad) {}
 };
 
 namespace ExtractedInformation {
@@ -286,6 +302,47 @@ LoopProjectFileResponse GetEventRelationships(netCDF::NcGroup* rootNode, std::ve
  */
 LoopProjectFileResponse GetDrillholeDescriptions(netCDF::NcGroup* rootNode, std::vector<DrillholeDescription>& drillholeDescriptions, bool verbose=false);
 
+/*! @{
+ * \brief Retrieves an extracted information record table into a bulk vector. The records are
+ * not zero filled before the read so this is the preferred path for large tables
+ *
+ * \param rootNode - the rootNode of the netCDF Loop project file
+ * \param records - a reference to where the record data is to be copied
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of record data retrieval with an error message if it failed
+ */
+LoopProjectFileResponse GetFaultEvents(netCDF::NcGroup* rootNode, BulkVector<FaultEvent>& records, bool verbose=false);
+LoopProjectFileResponse GetFoldEvents(netCDF::NcGroup* rootNode, BulkVector<FoldEvent>& records, bool verbose=false);
+LoopProjectFileResponse GetFoliationEvents(netCDF::NcGroup* rootNode, BulkVector<FoliationEvent>& records, bool verbose=false);
+LoopProjectFileResponse GetDiscontinuityEvents(netCDF::NcGroup* rootNode, BulkVector<DiscontinuityEvent>& records, bool verbose=false);
+LoopProjectFileResponse GetStratigraphicLayers(netCDF::NcGroup* rootNode, BulkVector<StratigraphicLayer>& records, bool verbose=false);
+LoopProjectFileResponse GetEventRelationships(netCDF::NcGroup* rootNode, BulkVector<EventRelationship>& records, bool verbose=false);
+LoopProjectFileResponse GetDrillholeDescriptions(netCDF::NcGroup* rootNode, BulkVector<DrillholeDescription>& records, bool verbose=false);
+/*!@}*/
+
+/*! @{
+ * \brief Retrieves part of an extracted information record table, the records
+ * [start, start+count) in the order the whole table getters return them. A range past the
+ * end of the table is cut short
+ *
+ * \param rootNode - the rootNode of the netCDF Loop project file
+ * \param records - a reference to where the record data is to be copied
+ * \param start - the position of the first record to retrieve
+ * \param count - the most records to retrieve
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of record data retrieval with an error message if it failed
+ */
+LoopProjectFileResponse GetFaultEvents(netCDF::NcGroup* rootNode, std::vector<FaultEvent>& records, size_t start, size_t count, bool verbose=false);
+LoopProjectFileResponse GetFoldEvents(netCDF::NcGroup* rootNode, std::vector<FoldEvent>& records, size_t start, size_t count, bool verbose=false);
+LoopProjectFileResponse GetFoliationEvents(netCDF::NcGroup* rootNode, std::vector<FoliationEvent>& records, size_t start, size_t count, bool verbose=false);
+LoopProjectFileResponse GetDiscontinuityEvents(netCDF::NcGroup* rootNode, std::vector<DiscontinuityEvent>& records, size_t start, size_t count, bool verbose=false);
+LoopProjectFileResponse GetStratigraphicLayers(netCDF::NcGroup* rootNode, std::vector<StratigraphicLayer>& records, size_t start, size_t count, bool verbose=false);
+LoopProjectFileResponse GetEventRelationships(netCDF::NcGroup* rootNode, std::vector<EventRelationship>& records, size_t start, size_t count, bool verbose=false);
+LoopProjectFileResponse GetDrillholeDescriptions(netCDF::NcGroup* rootNode, std::vector<DrillholeDescription>& records, size_t start, size_t count, bool verbose=false);
+/*!@}*/
+
 /*!
  * \brief Sets fault event information to the loop project file
  *
@@ -1,5 +1,8 @@
 #include "LoopGeophysicalModels.h"
 #include "LoopExtents.h"
+#include "LoopModelStorage.h"
+#include "LoopProjectFileMetrics.h"
+#include "LoopProjectFileTrace.h"
 
 namespace LoopProjectFile {
 
@@ -49,24 +52,8 @@ LoopProjectFileResponse GeophysicalModels::SetGeophysicalModel(netCDF::NcGroup*
         try {
             auto groups = rootNode->getGroups();
             if (groups.find("GeophysicalModels") == groups.end()) {
-                netCDF::NcGroup gmGroup = rootNode->addGroup("GeophysicalModels");
-                netCDF::NcDim eastingDim = gmGroup.addDim("easting",extents[0]);
-                netCDF::NcDim northingDim = gmGroup.addDim("northing",extents[1]);
-                netCDF::NcDim depthDim = gmGroup.addDim("depth",extents[2]);
-                netCDF::NcDim indexDim = gmGroup.addDim("index");
-                std::vector<netCDF::NcDim> dims;
-                dims.push_back(eastingDim);
-                dims.push_back(northingDim);
-                dims.push_back(depthDim);
-                dims.push_back(indexDim);
-                netCDF::NcVar dataVar = gmGroup.addVar("data",netCDF::ncFloat,dims);
-                dims.clear();
-                dims.push_back(indexDim);
-                netCDF::NcVar minValVar = gmGroup.addVar("minVal",netCDF::ncFloat,dims);
-                netCDF::NcVar maxValVar = gmGroup.addVar("maxVal",netCDF::ncFloat,dims);
-                minValVar.setEndianness(netCDF::NcVar::EndianMode::nc_ENDIAN_LITTLE);
-                maxValVar.setEndianness(netCDF::NcVar::EndianMode::nc_ENDIAN_LITTLE);
-                dataVar.setEndianness(netCDF::NcVar::EndianMode::nc_ENDIAN_LITTLE);
+                resp = ModelStorage::CreateModelGroup(rootNode,GEOPHYSICALMODEL,extents,ModelWriteOptions(),verbose);
+                if (resp.errorCode) return resp;
             }
             netCDF::NcGroup gmGroup = rootNode->getGroup("GeophysicalModels");
             // Check data shape against extents shape
@@ -86,9 +73,12 @@ LoopProjectFileResponse GeophysicalModels::SetGeophysicalModel(netCDF::NcGroup*
             // Add data to project file
             float min = NC_MAX_FLOAT;
             float max = NC_MIN_FLOAT;
-            for (auto i=0;i<data.size();i++) {
-                if (data[i] > max) max = data[i];
-                if (data[i] < min) min = data[i];
+            {
+                LOOP_TRACE_SPAN("ModelStatistics","stats");
+                for (auto i=0;i<data.size();i++) {
+                    if (data[i] > max) max = data[i];
+                    if (data[i] < min) min = data[i];
+                }
             }
             std::vector<size_t> start; start.push_back(index);
             std::vector<size_t> count; count.push_back(1);
@@ -101,7 +91,10 @@ LoopProjectFileResponse GeophysicalModels::SetGeophysicalModel(netCDF::NcGroup*
             start.push_back(0); start.push_back(0); start.push_back(0); start.push_back(index);
             count.clear();
             count.push_back(dataShape[0]); count.push_back(dataShape[1]); count.push_back(dataShape[2]); count.push_back(1);
+            LOOP_TRACE_SPAN("WriteModel","io");
             dataVar.putVar(start,count,&data[0]);
+            Metrics::RecordWrite<float>(dataVar,data.size());
+            ModelStorage::MarkModelValid(gmGroup, index);
         } catch (netCDF::exceptions::NcException& e) {
             if (verbose) std::cout << e.what() << std::endl;
             resp = createErrorMsg(1, "Failed to add Geophysical Model to loop project file",verbose);
@@ -119,6 +112,9 @@ LoopProjectFileResponse GeophysicalModels::GetGeophysicalModel(netCDF::NcGroup*
             resp = createErrorMsg(1,"No Geophysical Models Group in project file",verbose);
         } else {
             netCDF::NcGroup gmGroup = rootNode->getGroup("GeophysicalModels");
+            if (!ModelStorage::IsModelValid(gmGroup, index)) {
+                return createErrorMsg(1,"No geophysical model at index " + std::to_string(index) + " in loop project file",verbose);
+            }
             netCDF::NcDim easting = gmGroup.getDim("easting");
             netCDF::NcDim northing = gmGroup.getDim("northing");
             netCDF::NcDim depth = gmGroup.getDim("depth");
@@ -133,7 +129,9 @@ LoopProjectFileResponse GeophysicalModels::GetGeophysicalModel(netCDF::NcGroup*
             netCDF::NcVar dataVar = gmGroup.getVar("data");
             start.push_back(0); start.push_back(0); start.push_back(0); start.push_back(index);
             count.push_back(dataShape[0]); count.push_back(dataShape[1]); count.push_back(dataShape[2]); count.push_back(1);
+            LOOP_TRACE_SPAN("ReadModel","io");
             dataVar.getVar(start,count,&data[0]);
+            Metrics::RecordRead<float>(dataVar,data.size());
         }
     } catch (netCDF::exceptions::NcException& e) {
         if (verbose) std::cout << e.what() << std::endl;
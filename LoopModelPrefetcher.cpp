@@ -0,0 +1,147 @@
+#include "LoopModelPrefetcher.h"
+#include "LoopProjectFile.h"
+#include "LoopProjectFileAsync.h"
+#include "LoopModelStorage.h"
+
+namespace LoopProjectFile {
+
+ModelPrefetcher::ModelPrefetcher(unsigned int depth)
+    : slots(depth < 2 ? 2 : depth),
+      numModels(0),
+      firstIndex(0),
+      nextRequest(0),
+      nextConsume(0),
+      heldSlot(-1),
+      isOpen(false),
+      verbose(false)
+{
+}
+
+ModelPrefetcher::~ModelPrefetcher()
+{
+    Close();
+}
+
+LoopProjectFileResponse ModelPrefetcher::OpenOnIOThread(std::string filename, std::string groupName)
+{
+    std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+    LoopProjectFileResponse resp = {0,""};
+    if (OpenProjectFile(filename, file, true, verbose)) {
+        return createErrorMsg(1,"Failure to open project file " + filename,verbose);
+    }
+    try {
+        auto groups = file.getGroups();
+        if (groups.find(groupName) == groups.end()) {
+            resp = createErrorMsg(1,"No " + groupName + " Group in project file",verbose);
+        } else {
+            modelGroup = file.getGroup(groupName);
+            dataVar = modelGroup.getVar("data");
+            dataShape.clear();
+            dataShape.push_back(static_cast<int>(modelGroup.getDim("easting").getSize()));
+            dataShape.push_back(static_cast<int>(modelGroup.getDim("northing").getSize()));
+            dataShape.push_back(static_cast<int>(modelGroup.getDim("depth").getSize()));
+            numModels = static_cast<unsigned int>(modelGroup.getDim("index").getSize());
+        }
+    } catch (netCDF::exceptions::NcException& e) {
+        if (verbose) std::cout << e.what() << std::endl;
+        resp = createErrorMsg(1,"Failed to read " + groupName + " layout from loop project file",verbose);
+    }
+    if (resp.errorCode) CloseProjectFile(&file);
+    return resp;
+}
+
+LoopProjectFileResponse ModelPrefetcher::Open(std::string filename, ModelType modelType, unsigned int startIndex, bool verbose)
+{
+    Close();
+    this->verbose = verbose;
+    std::string groupName = GetModelGroupName(modelType);
+    if (groupName.empty()) return createErrorMsg(1,"Invalid model type for prefetching",verbose);
+
+    LoopProjectFileResponse resp = Async::GetIOQueue().Submit([this, filename, groupName]() {
+        return OpenOnIOThread(filename, groupName);
+    }).get();
+    if (resp.errorCode) return resp;
+
+    isOpen = true;
+    firstIndex = startIndex;
+    nextRequest = startIndex;
+    nextConsume = startIndex;
+    heldSlot = -1;
+    // Buffers are sized once here and reused for every model read
+    size_t modelSize = static_cast<size_t>(dataShape[0]) * dataShape[1] * dataShape[2];
+    for (size_t i=0;i<slots.size();i++) slots[i].data.resize(modelSize);
+    for (size_t i=0;i<slots.size() && nextRequest<numModels;i++) Request(i);
+    return resp;
+}
+
+void ModelPrefetcher::Request(size_t slot)
+{
+    slots[slot].index = nextRequest++;
+    slots[slot].pending = Async::GetIOQueue().Submit([this, slot]() { ReadSlot(slot); });
+}
+
+void ModelPrefetcher::ReadSlot(size_t slot)
+{
+    std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+    Slot& target = slots[slot];
+    target.response.errorCode = 0;
+    target.response.errorMessage = "";
+    try {
+        // Unwritten slots hold fill data (or nothing at all with no-fill storage)
+        if (!ModelStorage::IsModelValid(modelGroup, target.index)) {
+            target.response = createErrorMsg(1,"No model at index " + std::to_string(target.index) + " in " + modelGroup.getName(),verbose);
+            return;
+        }
+        std::vector<size_t> start(4,0);
+        start[3] = target.index;
+        std::vector<size_t> count;
+        count.push_back(dataShape[0]);
+        count.push_back(dataShape[1]);
+        count.push_back(dataShape[2]);
+        count.push_back(1);
+        dataVar.getVar(start,count,target.data.data());
+    } catch (netCDF::exceptions::NcException& e) {
+        if (verbose) std::cout << e.what() << std::endl;
+        target.response = createErrorMsg(1,"Failed to prefetch model from loop project file",verbose);
+    }
+}
+
+LoopProjectFileResponse ModelPrefetcher::Next(const float*& data, unsigned int& index)
+{
+    data = NULL;
+    if (!isOpen) return createErrorMsg(1,"Model prefetcher is not open",verbose);
+    // The buffer handed out last time is free again so queue the next read into it
+    if (heldSlot >= 0) {
+        if (nextRequest < numModels) Request(heldSlot);
+        heldSlot = -1;
+    }
+    if (nextConsume >= numModels) return createErrorMsg(1,"No more models to prefetch",verbose);
+
+    size_t slot = (nextConsume - firstIndex) % slots.size();
+    slots[slot].pending.get();
+    heldSlot = static_cast<int>(slot);
+    nextConsume++;
+    data = slots[slot].data.data();
+    index = slots[slot].index;
+    return slots[slot].response;
+}
+
+void ModelPrefetcher::CloseOnIOThread()
+{
+    std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+    CloseProjectFile(&file);
+}
+
+void ModelPrefetcher::Close()
+{
+    if (!isOpen) return;
+    for (size_t i=0;i<slots.size();i++) {
+        if (slots[i].pending.valid()) slots[i].pending.wait();
+    }
+    Async::GetIOQueue().Submit([this]() { CloseOnIOThread(); }).get();
+    isOpen = false;
+    heldSlot = -1;
+    numModels = 0;
+}
+
+} // namespace LoopProjectFile
@@ -0,0 +1,103 @@
+#ifndef __LOOPMODELPREFETCHER_H
+#define __LOOPMODELPREFETCHER_H
+
+#include <netcdf>
+#include <string>
+#include <vector>
+#include <future>
+
+#include "LoopProjectFileUtils.h"
+
+#define LOOP_PREFETCH_DEFAULT_DEPTH 4
+
+namespace LoopProjectFile {
+
+/*! \brief Reads the models of one model group ahead of a sequential consumer
+ *
+ * The models are read into a bounded ring of buffers that are allocated once when the
+ * file is opened and reused for every model. Reads run on the async I/O thread (see
+ * LoopProjectFileAsync.h) so they are serialised with all other async netCDF access.
+ * While a prefetcher is open the synchronous API must not be used from other threads.
+ */
+class ModelPrefetcher {
+public:
+    /*!
+     * \brief Constructor
+     *
+     * \param depth - the number of buffers in the ring. One is held by the caller after Next()
+     * and the rest are filled in the background (at least two are used)
+     */
+    explicit ModelPrefetcher(unsigned int depth = LOOP_PREFETCH_DEFAULT_DEPTH);
+
+    /*! \brief Destructor. Waits for outstanding reads and closes the file */
+    ~ModelPrefetcher();
+
+    /*!
+     * \brief Opens a project file and starts reading models from the given index
+     *
+     * \param filename - the filename of the loop project file
+     * \param modelType - the model group to walk
+     * \param startIndex - the index of the first model to return
+     * \param verbose - a flag to toggle verbose message printing
+     *
+     * \return Response with success/fail of opening the model group with an error message if it failed
+     */
+    LoopProjectFileResponse Open(std::string filename, ModelType modelType, unsigned int startIndex = 0, bool verbose = false);
+
+    /*!
+     * \brief Gets the next model in index order, blocking only if it has not been read yet.
+     * The returned buffer stays valid until the following call to Next() or Close(). An index
+     * with no model written returns an error and the walk carries on with the next index
+     *
+     * \param data - a reference to return a pointer to the model data
+     * \param index - a reference to return the index of the model
+     *
+     * \return Response with success/fail of the read with an error message if it failed
+     */
+    LoopProjectFileResponse Next(const float*& data, unsigned int& index);
+
+    /*! \brief Whether another model remains to be returned by Next() */
+    bool HasNext() const { return isOpen && nextConsume < numModels; }
+
+    /*! \brief Waits for outstanding reads and closes the file */
+    void Close();
+
+    /*! \brief The dimensions of every model (easting, northing, depth) */
+    const std::vector<int>& GetDataShape() const { return dataShape; }
+
+    /*! \brief The number of model slots in the model group */
+    unsigned int GetModelCount() const { return numModels; }
+
+private:
+    struct Slot {
+        std::vector<float> data;
+        unsigned int index;
+        LoopProjectFileResponse response;
+        std::future<void> pending;
+    };
+
+    LoopProjectFileResponse OpenOnIOThread(std::string filename, std::string groupName);
+    void CloseOnIOThread();
+    void Request(size_t slot);
+    void ReadSlot(size_t slot);
+
+    std::vector<Slot> slots;
+    netCDF::NcFile file;
+    netCDF::NcGroup modelGroup;
+    netCDF::NcVar dataVar;
+    std::vector<int> dataShape;
+    unsigned int numModels;
+    unsigned int firstIndex;
+    unsigned int nextRequest;
+    unsigned int nextConsume;
+    int heldSlot;
+    bool isOpen;
+    bool verbose;
+
+    ModelPrefetcher(const ModelPrefetcher&) = delete;
+    ModelPrefetcher& operator=(const ModelPrefetcher&) = delete;
+};
+
+} // namespace LoopProjectFile
+
+#endif
@@ -0,0 +1,184 @@
+#include "LoopModelStorage.h"
+#include "LoopExtents.h"
+#include "LoopProjectFileTrace.h"
+#include <netcdf.h>
+
+namespace LoopProjectFile {
+
+std::vector<size_t> ModelStorage::CalculateChunkShape(std::vector<int> extents, int depthSlab)
+{
+    std::vector<size_t> chunkShape;
+    chunkShape.push_back(static_cast<size_t>(extents[0]));
+    chunkShape.push_back(static_cast<size_t>(extents[1]));
+    size_t layerBytes = static_cast<size_t>(extents[0]) * extents[1] * sizeof(float);
+    size_t slab = 1;
+    if (depthSlab == LOOP_MODEL_CHUNK_AUTO) {
+        slab = layerBytes ? LOOP_MODEL_CHUNK_TARGET_BYTES / layerBytes : 1;
+    } else if (depthSlab > 0) {
+        slab = static_cast<size_t>(depthSlab);
+    }
+    if (slab < 1) slab = 1;
+    if (slab > static_cast<size_t>(extents[2])) slab = static_cast<size_t>(extents[2]);
+    chunkShape.push_back(slab);
+    chunkShape.push_back(1);
+    return chunkShape;
+}
+
+// Adds the per index valid flags to a model group, unset until each model is written
+static netCDF::NcVar AddValidVariable(netCDF::NcGroup& group)
+{
+    std::vector<netCDF::NcDim> dims;
+    dims.push_back(group.getDim("index"));
+    netCDF::NcVar validVar = group.addVar("valid",netCDF::ncChar,dims);
+    validVar.setEndianness(netCDF::NcVar::EndianMode::nc_ENDIAN_LITTLE);
+    char valid = 0;
+    validVar.setFill(true, valid);
+    return validVar;
+}
+
+LoopProjectFileResponse ModelStorage::CreateModelGroup(netCDF::NcGroup* rootNode, ModelType modelType, std::vector<int> extents, const ModelWriteOptions& options, bool verbose)
+{
+    LoopProjectFileResponse resp = {0,""};
+    std::string groupName = GetModelGroupName(modelType);
+    if (groupName.empty()) return createErrorMsg(1,"Invalid model type for creating a model group",verbose);
+    if (extents.size() != 3) return createErrorMsg(1,"Trying to create " + groupName + " without valid project file extents",verbose);
+    try {
+        netCDF::NcGroup group = rootNode->addGroup(groupName);
+        netCDF::NcDim eastingDim = group.addDim("easting",extents[0]);
+        netCDF::NcDim northingDim = group.addDim("northing",extents[1]);
+        netCDF::NcDim depthDim = group.addDim("depth",extents[2]);
+        netCDF::NcDim indexDim = group.addDim("index");
+        std::vector<netCDF::NcDim> dims;
+        dims.push_back(eastingDim);
+        dims.push_back(northingDim);
+        dims.push_back(depthDim);
+        dims.push_back(indexDim);
+        netCDF::NcVar dataVar = group.addVar("data",netCDF::ncFloat,dims);
+        dims.clear();
+        dims.push_back(indexDim);
+        netCDF::NcVar minValVar = group.addVar("minVal",netCDF::ncFloat,dims);
+        netCDF::NcVar maxValVar = group.addVar("maxVal",netCDF::ncFloat,dims);
+        minValVar.setEndianness(netCDF::NcVar::EndianMode::nc_ENDIAN_LITTLE);
+        maxValVar.setEndianness(netCDF::NcVar::EndianMode::nc_ENDIAN_LITTLE);
+        dataVar.setEndianness(netCDF::NcVar::EndianMode::nc_ENDIAN_LITTLE);
+        AddValidVariable(group);
+        if (options.depthSlab != LOOP_MODEL_CHUNK_DEFAULT) {
+            std::vector<size_t> chunkShape = CalculateChunkShape(extents, options.depthSlab);
+            dataVar.setChunking(netCDF::NcVar::nc_CHUNKED, chunkShape);
+        }
+        if (options.noFill) {
+            int status = nc_def_var_fill(group.getId(), dataVar.getId(), 1, NULL);
+            if (status != NC_NOERR) {
+                resp = createErrorMsg(1,"Failed to disable fill for " + groupName + " data: " + nc_strerror(status),verbose);
+            }
+        }
+    } catch (netCDF::exceptions::NcException& e) {
+        if (verbose) std::cout << e.what() << std::endl;
+        resp = createErrorMsg(1,"Failed to create " + groupName + " group",verbose);
+    }
+    return resp;
+}
+
+LoopProjectFileResponse ModelStorage::PrepareModelGroup(netCDF::NcGroup* rootNode, ModelType modelType, const ModelWriteOptions& options, bool verbose)
+{
+    LOOP_TRACE_SPAN("PrepareModelGroup","io");
+    LoopProjectFileResponse resp = {0,""};
+    std::string groupName = GetModelGroupName(modelType);
+    if (groupName.empty()) return createErrorMsg(1,"Invalid model type for preparing a model group",verbose);
+    try {
+        auto groups = rootNode->getGroups();
+        if (groups.find(groupName) == groups.end()) {
+            std::vector<int> extents;
+            LoopExtents::CheckExtentsValid(rootNode,extents,verbose);
+            resp = CreateModelGroup(rootNode, modelType, extents, options, verbose);
+            if (resp.errorCode) return resp;
+        } else if (verbose && (options.noFill || options.depthSlab != LOOP_MODEL_CHUNK_DEFAULT)) {
+            std::cout << groupName << " already exists, its fill and chunking are left unchanged" << std::endl;
+        }
+        netCDF::NcGroup group = rootNode->getGroup(groupName);
+        size_t numModels = group.getDim("index").getSize();
+        auto vars = group.getVars();
+        if (options.preallocate > numModels && vars.find("valid") == vars.end()) {
+            // Groups written before every model group had valid flags hold a model at every
+            // index, so flag those before adding indices that hold none
+            netCDF::NcVar validVar = AddValidVariable(group);
+            if (numModels) {
+                std::vector<char> valid(numModels, 1);
+                std::vector<size_t> start; start.push_back(0);
+                std::vector<size_t> count; count.push_back(numModels);
+                validVar.putVar(start,count,valid.data());
+            }
+        }
+        if (options.preallocate > numModels) {
+            // Writing the last statistics entry extends the unlimited index dimension for
+            // every variable without allocating any model data chunks
+            float empty = 0.0f;
+            std::vector<size_t> start; start.push_back(options.preallocate - 1);
+            std::vector<size_t> count; count.push_back(1);
+            group.getVar("minVal").putVar(start,count,&empty);
+            group.getVar("maxVal").putVar(start,count,&empty);
+        }
+    } catch (netCDF::exceptions::NcException& e) {
+        if (verbose) std::cout << e.what() << std::endl;
+        resp = createErrorMsg(1,"Failed to prepare " + groupName + " group",verbose);
+    }
+    return resp;
+}
+
+LoopProjectFileResponse ModelStorage::ListValidModels(const netCDF::NcGroup& modelGroup, std::vector<char>& valid, bool verbose)
+{
+    LoopProjectFileResponse resp = {0,""};
+    valid.clear();
+    try {
+        size_t numModels = modelGroup.getDim("index").getSize();
+        auto vars = modelGroup.getVars();
+        if (vars.find("valid") == vars.end()) {
+            valid.assign(numModels,1);
+            return resp;
+        }
+        valid.assign(numModels,0);
+        if (numModels == 0) return resp;
+        std::vector<size_t> start; start.push_back(0);
+        std::vector<size_t> count; count.push_back(numModels);
+        modelGroup.getVar("valid").getVar(start,count,valid.data());
+    } catch (netCDF::exceptions::NcException& e) {
+        if (verbose) std::cout << e.what() << std::endl;
+        valid.clear();
+        resp = createErrorMsg(1,"Failed to read the valid models of " + modelGroup.getName(),verbose);
+    }
+    return resp;
+}
+
+LoopProjectFileResponse ModelStorage::ListValidModels(netCDF::NcGroup* rootNode, ModelType modelType, std::vector<char>& valid, bool verbose)
+{
+    valid.clear();
+    std::string groupName = GetModelGroupName(modelType);
+    if (groupName.empty()) return createErrorMsg(1,"Invalid model type for listing models",verbose);
+    auto groups = rootNode->getGroups();
+    if (groups.find(groupName) == groups.end()) return createErrorMsg(1,"No " + groupName + " group in project file",verbose);
+    return ListValidModels(rootNode->getGroup(groupName), valid, verbose);
+}
+
+void ModelStorage::MarkModelValid(const netCDF::NcGroup& modelGroup, unsigned int index)
+{
+    auto vars = modelGroup.getVars();
+    if (vars.find("valid") == vars.end()) return;
+    char valid = 1;
+    std::vector<size_t> start; start.push_back(index);
+    std::vector<size_t> count; count.push_back(1);
+    modelGroup.getVar("valid").putVar(start,count,&valid);
+}
+
+bool ModelStorage::IsModelValid(const netCDF::NcGroup& modelGroup, unsigned int index)
+{
+    if (index >= modelGroup.getDim("index").getSize()) return false;
+    auto vars = modelGroup.getVars();
+    if (vars.find("valid") == vars.end()) return true;
+    char valid = 0;
+    std::vector<size_t> start; start.push_back(index);
+    std::vector<size_t> count; count.push_back(1);
+    modelGroup.getVar("valid").getVar(start,count,&valid);
+    return valid != 0;
+}
+
+} // namespace LoopProjectFile
@@ -0,0 +1,124 @@
+#ifndef __LOOPMODELSTORAGE_H
+#define __LOOPMODELSTORAGE_H
+
+#include <netcdf>
+#include <vector>
+
+#include "LoopProjectFileUtils.h"
+
+#define LOOP_MODEL_CHUNK_DEFAULT 0
+#define LOOP_MODEL_CHUNK_AUTO -1
+#define LOOP_MODEL_CHUNK_TARGET_BYTES (4 * 1024 * 1024)
+
+namespace LoopProjectFile {
+
+/*! \brief How the data variable of a model group is laid out when the group is created
+ *
+ * The defaults reproduce the layout the model setters have always created. For large ensembles
+ * use noFill with slab chunking so that each model is written once as whole chunks, and
+ * preallocate the index dimension to the ensemble size.
+ */
+struct ModelWriteOptions {
+    bool noFill;                /*!< Disable fill values for the model data so new chunks are not written twice */
+    unsigned int preallocate;   /*!< Extend the index dimension to at least this many models */
+    int depthSlab;              /*!< Depth levels per chunk (chunks are easting x northing x depthSlab x 1),
+                                     LOOP_MODEL_CHUNK_DEFAULT for netCDF default chunking or
+                                     LOOP_MODEL_CHUNK_AUTO to size chunks near LOOP_MODEL_CHUNK_TARGET_BYTES */
+    ModelWriteOptions() : noFill(false), preallocate(0), depthSlab(LOOP_MODEL_CHUNK_DEFAULT) {}
+
+    /*! \brief Options for a single-pass write of an ensemble of a known size */
+    static ModelWriteOptions Ensemble(unsigned int numModels)
+    {
+        ModelWriteOptions options;
+        options.noFill = true;
+        options.preallocate = numModels;
+        options.depthSlab = LOOP_MODEL_CHUNK_AUTO;
+        return options;
+    }
+};
+
+namespace ModelStorage {
+/*!
+ * \brief Creates a model group (dimensions easting, northing, depth and unlimited index with
+ * variables data, minVal, maxVal and valid) sized to the extents grid
+ *
+ * \param rootNode - the rootNode of the netCDF Loop project file
+ * \param modelType - the type of model group to create
+ * \param extents - the extents grid size (easting, northing, depth)
+ * \param options - the layout of the data variable
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of creating the group with an error message if it failed
+ */
+LoopProjectFileResponse CreateModelGroup(netCDF::NcGroup* rootNode, ModelType modelType, std::vector<int> extents, const ModelWriteOptions& options, bool verbose=false);
+
+/*!
+ * \brief Prepares a model group for a large write. A missing group is created with the given
+ * options and the index dimension is extended to options.preallocate models. The layout
+ * options cannot be changed once a group exists so they only apply to new groups.
+ *
+ * Preallocated models remain flagged as not valid until written (their data reads back
+ * uninitialised when noFill is set). An existing group without valid flags is given them,
+ * with the models already in it flagged as valid.
+ *
+ * \param rootNode - the rootNode of the netCDF Loop project file
+ * \param modelType - the type of model group to prepare
+ * \param options - the layout of the data variable and the number of models to preallocate
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of preparing the group with an error message if it failed
+ */
+LoopProjectFileResponse PrepareModelGroup(netCDF::NcGroup* rootNode, ModelType modelType, const ModelWriteOptions& options, bool verbose=false);
+
+/*!
+ * \brief Calculates the chunk shape of a model data variable
+ *
+ * \param extents - the extents grid size (easting, northing, depth)
+ * \param depthSlab - the requested depth levels per chunk or LOOP_MODEL_CHUNK_AUTO
+ *
+ * \return The chunk shape (easting, northing, depth, index)
+ */
+std::vector<size_t> CalculateChunkShape(std::vector<int> extents, int depthSlab);
+
+/*! @{
+ * \brief Lists which index locations of a model group hold a model, reading the whole valid
+ * variable in one call so callers scanning an ensemble can probe an index without reading
+ * the model data. Groups without a valid variable (geophysical and uncertainty models in
+ * older files) report every index location as holding a model
+ *
+ * \param modelGroup - the model group to list
+ * \param rootNode - the rootNode of the netCDF Loop project file
+ * \param modelType - the type of model group to list
+ * \param valid - a reference to return one flag per index location (non-zero if it holds a model)
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of reading the flags with an error message if it failed
+ */
+LoopProjectFileResponse ListValidModels(const netCDF::NcGroup& modelGroup, std::vector<char>& valid, bool verbose=false);
+LoopProjectFileResponse ListValidModels(netCDF::NcGroup* rootNode, ModelType modelType, std::vector<char>& valid, bool verbose=false);
+/*!@}*/
+
+/*!
+ * \brief Flags an index location of a model group as holding a model. Called by the model
+ * setters once the model data is written
+ *
+ * \param modelGroup - the model group written to
+ * \param index - the index location written
+ */
+void MarkModelValid(const netCDF::NcGroup& modelGroup, unsigned int index);
+
+/*!
+ * \brief Checks whether an index location of a model group holds a model by reading a
+ * single valid flag, so the model getters can reject missing models without an exception
+ *
+ * \param modelGroup - the model group to check
+ * \param index - the index location to check
+ *
+ * \return Whether the index location is within the group and flagged as valid
+ */
+bool IsModelValid(const netCDF::NcGroup& modelGroup, unsigned int index);
+} // namespace ModelStorage
+
+} // namespace LoopProjectFile
+
+#endif
@@ -0,0 +1,249 @@
+#include "LoopProjectClient.h"
+
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace LoopProjectFile {
+
+static int& ClientSocket()
+{
+    static int clientFd = -1;
+    return clientFd;
+}
+
+static std::mutex& ClientMutex()
+{
+    static std::mutex clientMutex;
+    return clientMutex;
+}
+
+static void DisconnectLocked()
+{
+    if (ClientSocket() >= 0) close(ClientSocket());
+    ClientSocket() = -1;
+}
+
+LoopProjectFileResponse Client::Connect(std::string socketPath, bool verbose)
+{
+    std::lock_guard<std::mutex> lock(ClientMutex());
+    DisconnectLocked();
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        return createErrorMsg(1,"Invalid project server socket path " + socketPath,verbose);
+    }
+    strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return createErrorMsg(1,std::string("Failed to create project client socket: ") + strerror(errno),verbose);
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0) {
+        LoopProjectFileResponse resp = createErrorMsg(1,"Failed to connect to project server on " + socketPath + ": " + strerror(errno),verbose);
+        close(fd);
+        return resp;
+    }
+    ClientSocket() = fd;
+    return {0,""};
+}
+
+void Client::Disconnect()
+{
+    std::lock_guard<std::mutex> lock(ClientMutex());
+    DisconnectLocked();
+}
+
+bool Client::IsConnected()
+{
+    std::lock_guard<std::mutex> lock(ClientMutex());
+    return ClientSocket() >= 0;
+}
+
+// Receives the response header along with the shared payload descriptor if one was sent
+static bool ReceiveResponseHeader(int fd, Server::ResponseHeader& header, int& payloadFd)
+{
+    payloadFd = -1;
+    char* bytes = reinterpret_cast<char*>(&header);
+    size_t remaining = sizeof(header);
+    while (remaining > 0) {
+        struct iovec iov;
+        iov.iov_base = bytes;
+        iov.iov_len = remaining;
+        char control[CMSG_SPACE(sizeof(int))];
+        struct msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = &iov;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+        ssize_t received = recvmsg(fd, &message, 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) {
+            if (payloadFd >= 0) close(payloadFd);
+            return false;
+        }
+        for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+                memcpy(&payloadFd, CMSG_DATA(cmsg), sizeof(int));
+            }
+        }
+        bytes += received;
+        remaining -= static_cast<size_t>(received);
+    }
+    return true;
+}
+
+static bool ReceivePayload(int fd, const Server::ResponseHeader& header, int payloadFd, void* destination)
+{
+    size_t size = static_cast<size_t>(header.payloadSize);
+    if (!header.sharedPayload) return Server::ReceiveAll(fd, destination, size);
+    if (payloadFd < 0) return false;
+    void* memory = mmap(NULL, size, PROT_READ, MAP_SHARED, payloadFd, 0);
+    close(payloadFd);
+    if (memory == MAP_FAILED) return false;
+    memcpy(destination, memory, size);
+    munmap(memory, size);
+    return true;
+}
+
+// Sends one request and receives its response. allocate is given the payload size and
+// returns where to put the payload, or NULL if the size does not fit the expected data
+static LoopProjectFileResponse Transact(Server::RequestType type, const std::string& requestedFilename, int index, bool verbose,
+    std::function<void*(size_t)> allocate, std::vector<int>* dataShape)
+{
+    // The server keeps one session per filename, so send the canonical path so that every
+    // spelling of a file shares it (a missing file is sent as given for the server to report)
+    char resolved[PATH_MAX];
+    std::string filename = realpath(requestedFilename.c_str(), resolved) ? std::string(resolved) : requestedFilename;
+    std::lock_guard<std::mutex> lock(ClientMutex());
+    int fd = ClientSocket();
+    if (fd < 0) return createErrorMsg(1,"Not connected to a project server",verbose);
+
+    Server::RequestHeader request;
+    request.magic = LOOP_SERVER_PROTOCOL_MAGIC;
+    request.type = type;
+    request.index = index;
+    request.filenameLength = static_cast<uint32_t>(filename.size());
+    Server::ResponseHeader header;
+    int payloadFd = -1;
+    if (!Server::SendAll(fd, &request, sizeof(request)) || !Server::SendAll(fd, filename.data(), filename.size())
+        || !ReceiveResponseHeader(fd, header, payloadFd) || header.magic != LOOP_SERVER_PROTOCOL_MAGIC) {
+        DisconnectLocked();
+        return createErrorMsg(1,"Lost connection to the project server",verbose);
+    }
+    std::string message(header.messageLength, '\0');
+    if (header.messageLength && !Server::ReceiveAll(fd, &message[0], header.messageLength)) {
+        if (payloadFd >= 0) close(payloadFd);
+        DisconnectLocked();
+        return createErrorMsg(1,"Lost connection to the project server",verbose);
+    }
+    if (header.errorCode) {
+        if (payloadFd >= 0) close(payloadFd);
+        return createErrorMsg(header.errorCode,message,verbose);
+    }
+    void* destination = header.payloadSize ? allocate(static_cast<size_t>(header.payloadSize)) : NULL;
+    if (header.payloadSize && (!destination || !ReceivePayload(fd, header, payloadFd, destination))) {
+        // The stream can no longer be trusted to be at a message boundary
+        if (payloadFd >= 0 && !destination) close(payloadFd);
+        DisconnectLocked();
+        return createErrorMsg(1,"Invalid response from the project server",verbose);
+    }
+    if (!header.payloadSize && payloadFd >= 0) close(payloadFd);
+    if (dataShape) dataShape->assign(header.dataShape, header.dataShape + 3);
+    return {0,""};
+}
+
+template <typename T>
+static LoopProjectFileResponse RequestStructure(Server::RequestType type, const std::string& filename, T& data, bool verbose)
+{
+    return Transact(type, filename, 0, verbose, [&data](size_t size) -> void* {
+        return size == sizeof(T) ? &data : NULL;
+    }, NULL);
+}
+
+template <typename Container>
+static LoopProjectFileResponse RequestRecords(Server::RequestType type, const std::string& filename, Container& data, bool verbose)
+{
+    typedef typename Container::value_type T;
+    data.clear();
+    return Transact(type, filename, 0, verbose, [&data](size_t size) -> void* {
+        if (size % sizeof(T)) return NULL;
+        data.resize(size / sizeof(T));
+        return data.data();
+    }, NULL);
+}
+
+static LoopProjectFileResponse RequestModel(Server::RequestType type, const std::string& filename, std::vector<float>& data, std::vector<int>& dataShape, int index, bool verbose)
+{
+    data.clear();
+    return Transact(type, filename, index, verbose, [&data](size_t size) -> void* {
+        if (size % sizeof(float)) return NULL;
+        data.resize(size / sizeof(float));
+        return data.data();
+    }, &dataShape);
+}
+
+LoopProjectFileResponse Client::CloseFile(std::string filename, bool verbose)
+{
+    return Transact(Server::CLOSEFILE, filename, 0, verbose, [](size_t) -> void* { return NULL; }, NULL);
+}
+
+bool Client::CheckFileValid(std::string filename, bool verbose)
+{
+    return Transact(Server::CHECKFILEVALID, filename, 0, verbose, [](size_t) -> void* { return NULL; }, NULL).errorCode == 0;
+}
+
+LoopVersion Client::GetVersion(std::string filename, bool verbose)
+{
+    LoopVersion version;
+    if (RequestStructure(Server::GETVERSION, filename, version, verbose).errorCode) version.errored = true;
+    return version;
+}
+
+LoopProjectFileResponse Client::GetConfiguration(std::string filename, DataCollectionConfiguration& data, bool verbose)
+{
+    return Client::GetDataCollectionConfiguration(filename, data, verbose);
+}
+
+#define LPF_CLIENT_STRUCTURE(REQUEST,NAME,TYPE,FUNCTION) \
+LoopProjectFileResponse Client::NAME(std::string filename, TYPE& data, bool verbose)\
+{\
+    return RequestStructure(Server::REQUEST, filename, data, verbose);\
+}
+LOOP_SERVER_STRUCTURES(LPF_CLIENT_STRUCTURE)
+#undef LPF_CLIENT_STRUCTURE
+
+#define LPF_CLIENT_RECORDS(REQUEST,NAME,TYPE,FUNCTION) \
+LoopProjectFileResponse Client::NAME(std::string filename, std::vector<TYPE>& data, bool verbose)\
+{\
+    return RequestRecords(Server::REQUEST, filename, data, verbose);\
+}\
+LoopProjectFileResponse Client::NAME(std::string filename, BulkVector<TYPE>& data, bool verbose)\
+{\
+    return RequestRecords(Server::REQUEST, filename, data, verbose);\
+}
+LOOP_SERVER_RECORD_TABLES(LPF_CLIENT_RECORDS)
+#undef LPF_CLIENT_RECORDS
+
+LoopProjectFileResponse Client::GetStructuralModel(std::string filename, std::vector<float>& data, std::vector<int>& dataShape, int index, bool verbose)
+{
+    return RequestModel(Server::GETSTRUCTURALMODEL, filename, data, dataShape, index, verbose);
+}
+
+LoopProjectFileResponse Client::GetGeophysicalModel(std::string filename, std::vector<float>& data, std::vector<int>& dataShape, int index, bool verbose)
+{
+    return RequestModel(Server::GETGEOPHYSICALMODEL, filename, data, dataShape, index, verbose);
+}
+
+LoopProjectFileResponse Client::GetUncertaintyModel(std::string filename, std::vector<float>& data, std::vector<int>& dataShape, int index, bool verbose)
+{
+    return RequestModel(Server::GETUNCERTAINTYMODEL, filename, data, dataShape, index, verbose);
+}
+
+} // namespace LoopProjectFile
@@ -0,0 +1,133 @@
+#ifndef __LOOPPROJECTCLIENT_H
+#define __LOOPPROJECTCLIENT_H
+
+#include <string>
+#include <vector>
+
+#include "LoopProjectFile.h"
+#include "LoopProjectServer.h"
+
+namespace LoopProjectFile {
+
+/*! \brief Client of a local project server (see LoopProjectServer.h)
+ *
+ * The getters have the same signatures as the filename-level getters in LoopProjectFile.h
+ * so callers can switch between direct file access and the server by namespace. One
+ * connection is shared by the process and requests on it are serialised. Filenames are
+ * sent to the server as canonical absolute paths, so relative paths and links to the same
+ * file share one server session.
+ */
+namespace Client {
+
+/*!
+ * \brief Connects to a project server, replacing any existing connection
+ *
+ * \param socketPath - the path of the server's socket
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of connecting with an error message if it failed
+ */
+LoopProjectFileResponse Connect(std::string socketPath = LOOP_SERVER_DEFAULT_SOCKET, bool verbose = false);
+
+/*! \brief Closes the connection to the project server */
+void Disconnect();
+
+/*! \brief Whether the process is connected to a project server */
+bool IsConnected();
+
+/*!
+ * \brief Asks the server to close its handle on a file, e.g. before the file is rewritten
+ *
+ * \param filename - the filename of the loop project file
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of the request with an error message if it failed
+ */
+LoopProjectFileResponse CloseFile(std::string filename, bool verbose = false);
+
+/*! \brief See LoopProjectFile::CheckFileValid() */
+bool CheckFileValid(std::string filename, bool verbose = false);
+
+/*! \brief See LoopProjectFile::GetVersion() */
+LoopVersion GetVersion(std::string filename, bool verbose = false);
+
+/*! @{
+ * \brief Retrieves specified data from the loop project file through the project server
+ *
+ * \param filename - the filename of the loop project file
+ * \param data - a reference to where the data is to be copied
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of data retrieval with error message if it failed
+ */
+LoopProjectFileResponse GetExtents(std::string filename, LoopExtents& data, bool verbose = false);
+LoopProjectFileResponse GetDataCollectionConfiguration(std::string filename, DataCollectionConfiguration& data, bool verbose = false);
+LoopProjectFileResponse GetDataCollectionSources(std::string filename, DataCollectionSources& data, bool verbose = false);
+LoopProjectFileResponse GetStructuralModelsConfiguration(std::string filename, StructuralModelsConfiguration& data, bool verbose = false);
+LoopProjectFileResponse GetConfiguration(std::string filename, DataCollectionConfiguration& data, bool verbose = false);
+LoopProjectFileResponse GetFaultObservations(std::string filename, std::vector<FaultObservation> &data, bool verbose = false);
+LoopProjectFileResponse GetFoldObservations(std::string filename, std::vector<FoldObservation> &data, bool verbose = false);
+LoopProjectFileResponse GetFoliationObservations(std::string filename, std::vector<FoliationObservation> &data, bool verbose = false);
+LoopProjectFileResponse GetDiscontinuityObservations(std::string filename, std::vector<DiscontinuityObservation> &data, bool verbose = false);
+LoopProjectFileResponse GetStratigraphicObservations(std::string filename, std::vector<StratigraphicObservation> &data, bool verbose = false);
+LoopProjectFileResponse GetContacts(std::string filename, std::vector<ContactObservation> &data, bool verbose = false);
+LoopProjectFileResponse GetDrillholeObservations(std::string filename, std::vector<DrillholeObservation> &data, bool verbose = false);
+LoopProjectFileResponse GetDrillholeProperties(std::string filename, std::vector<DrillholeProperty> &data, bool verbose = false);
+LoopProjectFileResponse GetDrillholeSurveys(std::string filename, std::vector<DrillholeSurvey> &data, bool verbose = false);
+LoopProjectFileResponse GetFaultEvents(std::string filename, std::vector<FaultEvent> &data, bool verbose = false);
+LoopProjectFileResponse GetFoldEvents(std::string filename, std::vector<FoldEvent> &data, bool verbose = false);
+LoopProjectFileResponse GetFoliationEvents(std::string filename, std::vector<FoliationEvent> &data, bool verbose = false);
+LoopProjectFileResponse GetDiscontinuityEvents(std::string filename, std::vector<DiscontinuityEvent> &data, bool verbose = false);
+LoopProjectFileResponse GetStratigraphicLayers(std::string filename, std::vector<StratigraphicLayer> &data, bool verbose = false);
+LoopProjectFileResponse GetEventRelationships(std::string filename, std::vector<EventRelationship> &data, bool verbose = false);
+LoopProjectFileResponse GetDrillholeDescriptions(std::string filename, std::vector<DrillholeDescription> &data, bool verbose = false);
+/*!@}*/
+
+/*! @{
+ * \brief Retrieves specified record data through the project server into a bulk vector
+ *
+ * \param filename - the filename of the loop project file
+ * \param data - a reference to where the data is to be copied
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of data retrieval with error message if it failed
+ */
+LoopProjectFileResponse GetFaultObservations(std::string filename, BulkVector<FaultObservation> &data, bool verbose = false);
+LoopProjectFileResponse GetFoldObservations(std::string filename, BulkVector<FoldObservation> &data, bool verbose = false);
+LoopProjectFileResponse GetFoliationObservations(std::string filename, BulkVector<FoliationObservation> &data, bool verbose = false);
+LoopProjectFileResponse GetDiscontinuityObservations(std::string filename, BulkVector<DiscontinuityObservation> &data, bool verbose = false);
+LoopProjectFileResponse GetStratigraphicObservations(std::string filename, BulkVector<StratigraphicObservation> &data, bool verbose = false);
+LoopProjectFileResponse GetContacts(std::string filename, BulkVector<ContactObservation> &data, bool verbose = false);
+LoopProjectFileResponse GetDrillholeObservations(std::string filename, BulkVector<DrillholeObservation> &data, bool verbose = false);
+LoopProjectFileResponse GetDrillholeProperties(std::string filename, BulkVector<DrillholeProperty> &data, bool verbose = false);
+LoopProjectFileResponse GetDrillholeSurveys(std::string filename, BulkVector<DrillholeSurvey> &data, bool verbose = false);
+LoopProjectFileResponse GetFaultEvents(std::string filename, BulkVector<FaultEvent> &data, bool verbose = false);
+LoopProjectFileResponse GetFoldEvents(std::string filename, BulkVector<FoldEvent> &data, bool verbose = false);
+LoopProjectFileResponse GetFoliationEvents(std::string filename, BulkVector<FoliationEvent> &data, bool verbose = false);
+LoopProjectFileResponse GetDiscontinuityEvents(std::string filename, BulkVector<DiscontinuityEvent> &data, bool verbose = false);
+LoopProjectFileResponse GetStratigraphicLayers(std::string filename, BulkVector<StratigraphicLayer> &data, bool verbose = false);
+LoopProjectFileResponse GetEventRelationships(std::string filename, BulkVector<EventRelationship> &data, bool verbose = false);
+LoopProjectFileResponse GetDrillholeDescriptions(std::string filename, BulkVector<DrillholeDescription> &data, bool verbose = false);
+/*!@}*/
+
+/*! @{
+ * \brief Retrieves a model through the project server
+ *
+ * \param filename - the filename of the loop project file
+ * \param data - a reference to where the data is to be copied
+ * \param dataShape - the dimensions of the data being retrieved
+ * \param index - the index location for the data
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of data retrieval with error message if it failed
+ */
+LoopProjectFileResponse GetStructuralModel(std::string filename, std::vector<float> &data, std::vector<int> &dataShape, int index, bool verbose = false);
+LoopProjectFileResponse GetGeophysicalModel(std::string filename, std::vector<float> &data, std::vector<int> &dataShape, int index, bool verbose = false);
+LoopProjectFileResponse GetUncertaintyModel(std::string filename, std::vector<float> &data, std::vector<int> &dataShape, int index, bool verbose = false);
+/*!@}*/
+
+} // namespace Client
+
+} // namespace LoopProjectFile
+
+#endif
@@ -1,4 +1,5 @@
 #include "LoopProjectFile.h"
+#include "LoopProjectValidation.h"
 
 namespace LoopProjectFile {
 
@@ -21,6 +22,7 @@ LoopProjectFileResponse CreateBasicFile(std::string filename)
 
 bool OpenProjectFile(std::string filename, netCDF::NcFile& file, bool readOnly, bool verbose)
 {
+    LOOP_TRACE_SPAN("OpenProjectFile","open");
     if (verbose) std::cout << "Accessing file named: " << filename << std::endl;
     struct stat buffer;
     if (stat(filename.c_str(),&buffer) != 0) {
@@ -49,18 +51,14 @@ void CloseProjectFile(netCDF::NcFile* file)
 
 bool CheckFileValid(std::string filename, bool verbose)
 {
+    LOOP_METRICS_CALL();
+    LOOP_TRACE_FUNCTION();
     bool valid = true;
     netCDF::NcFile file;
-    if (!OpenProjectFile(filename, file, verbose)) {
+    if (!OpenProjectFile(filename, file, true, verbose)) {
         if (verbose) std::cout << "Checking validity of loop project file " << filename << std::endl;
-        std::vector<int> xyzGridSize;
-        valid = LoopVersion::CheckVersionValid(&file,verbose);
-        valid = LoopExtents::CheckExtentsValid(&file,xyzGridSize,verbose);
-        valid = DataCollection::CheckDataCollectionValid(&file,verbose);
-        valid = ExtractedInformation::CheckExtractedInformationValid(&file,verbose);
-        valid = StructuralModels::CheckStructuralModelsValid(&file,xyzGridSize,verbose);
-        valid = GeophysicalModels::CheckGeophysicalModelsValid(&file,xyzGridSize,verbose);
-        valid = UncertaintyModels::CheckUncertaintyModelsValid(&file,xyzGridSize,verbose);
+        std::vector<std::string> problems;
+        valid = Validation::CheckStructure(&file, problems, verbose);
     } else {
         valid = false;
     }
@@ -69,6 +67,8 @@ bool CheckFileValid(std::string filename, bool verbose)
 
 LoopProjectFileResponse SetVersion(std::string filename, bool verbose)
 {
+    LOOP_METRICS_CALL();
+    LOOP_TRACE_FUNCTION();
     LoopProjectFileResponse resp;
     netCDF::NcFile file;
     if (!OpenProjectFile(filename, file, false, verbose)) {
@@ -82,6 +82,8 @@ LoopProjectFileResponse SetVersion(std::string filename, bool verbose)
 
 LoopVersion GetVersion(std::string filename, bool verbose)
 {
+    LOOP_METRICS_CALL();
+    LOOP_TRACE_FUNCTION();
     LoopVersion version;
     netCDF::NcFile file;
     if (!OpenProjectFile(filename, file, true, verbose)) {
@@ -99,6 +101,8 @@ LoopVersion GetVersion(std::string filename, bool verbose)
 /*****************************************************************************/
 #define LPF_OPEN_RUN(FILENAME,FUNCTION,CONTAINER,READONLY,VERBOSE) \
 {\
+    LOOP_METRICS_CALL();\
+    LOOP_TRACE_FUNCTION();\
     LoopProjectFileResponse resp = {0,""};\
     netCDF::NcFile file;\
     if (!OpenProjectFile(FILENAME, file, READONLY, VERBOSE)) {\
@@ -111,6 +115,8 @@ LoopVersion GetVersion(std::string filename, bool verbose)
 
 #define LPF_OPEN_RUN_WITH_SHAPE(FILENAME,FUNCTION,CONTAINER,SHAPE,INDEX,READONLY,VERBOSE) \
 {\
+    LOOP_METRICS_CALL();\
+    LOOP_TRACE_FUNCTION();\
     LoopProjectFileResponse resp = {0,""};\
     netCDF::NcFile file;\
     if (!OpenProjectFile(FILENAME, file, READONLY, VERBOSE)) {\
@@ -120,6 +126,34 @@ LoopVersion GetVersion(std::string filename, bool verbose)
     }\
     return resp;\
 }
+
+#define LPF_OPEN_RUN_RANGE(FILENAME,FUNCTION,CONTAINER,START,COUNT,VERBOSE) \
+{\
+    LOOP_METRICS_CALL();\
+    LOOP_TRACE_FUNCTION();\
+    LoopProjectFileResponse resp = {0,""};\
+    netCDF::NcFile file;\
+    if (!OpenProjectFile(FILENAME, file, true, VERBOSE)) {\
+        resp = FUNCTION(&file, CONTAINER, START, COUNT, VERBOSE);\
+    } else {\
+        resp = createErrorMsg(1,std::string("Failure to open project file ") + FILENAME,VERBOSE);\
+    }\
+    return resp;\
+}
+
+#define LPF_OPEN_RUN_WITH_OPTIONS(FILENAME,FUNCTION,CONTAINER,OPTIONS,VERBOSE) \
+{\
+    LOOP_METRICS_CALL();\
+    LOOP_TRACE_FUNCTION();\
+    LoopProjectFileResponse resp = {0,""};\
+    netCDF::NcFile file;\
+    if (!OpenProjectFile(FILENAME, file, false, VERBOSE)) {\
+        resp = FUNCTION(&file, CONTAINER, OPTIONS, VERBOSE);\
+    } else {\
+        resp = createErrorMsg(1,std::string("Failure to open project file ") + FILENAME,VERBOSE);\
+    }\
+    return resp;\
+}
 /*****************************************************************************/
 
 LoopProjectFileResponse GetExtents(std::string filename, LoopExtents& data, bool verbose)
@@ -177,7 +211,7 @@ LoopProjectFileResponse GetDrillholeObservations(std::string filename, std::vect
     LPF_OPEN_RUN(filename, DataCollection::GetDrillholeObservations, data, true, verbose);
 }
 
-LoopProjectFileResponse GetDrillholeProperites(std::string filename, std::vector<DrillholeProperty> &data, bool verbose)
+LoopProjectFileResponse GetDrillholeProperties(std::string filename, std::vector<DrillholeProperty> &data, bool verbose)
 {
     LPF_OPEN_RUN(filename, DataCollection::GetDrillholeProperties, data, true, verbose);
 }
@@ -222,6 +256,166 @@ LoopProjectFileResponse GetDrillholeDescriptions(std::string filename, std::vect
     LPF_OPEN_RUN(filename, ExtractedInformation::GetDrillholeDescriptions, data, true, verbose);
 }
 
+LoopProjectFileResponse GetFaultObservations(std::string filename, BulkVector<FaultObservation> &data, bool verbose)
+{
+    LPF_OPEN_RUN(filename, DataCollection::GetFaultObservations, data, true, verbose);
+}
+
+LoopProjectFileResponse GetFoldObservations(std::string filename, BulkVector<FoldObservation> &data, bool verbose)
+{
+    LPF_OPEN_RUN(filename, DataCollection::GetFoldObservations, data, true, verbose);
+}
+
+LoopProjectFileResponse GetFoliationObservations(std::string filename, BulkVector<FoliationObservation> &data, bool verbose)
+{
+    LPF_OPEN_RUN(filename, DataCollection::GetFoliationObservations, data, true, verbose);
+}
+
+LoopProjectFileResponse GetDiscontinuityObservations(std::string filename, BulkVector<DiscontinuityObservation> &data, bool verbose)
+{
+    LPF_OPEN_RUN(filename, DataCollection::GetDiscontinuityObservations, data, true, verbose);
+}
+
+LoopProjectFileResponse GetStratigraphicObservations(std::string filename, BulkVector<StratigraphicObservation> &data, bool verbose)
+{
+    LPF_OPEN_RUN(filename, DataCollection::GetStratigraphicObservations, data, true, verbose);
+}
+
+LoopProjectFileResponse GetContacts(std::string filename, BulkVector<ContactObservation> &data, bool verbose)
+{
+    LPF_OPEN_RUN(filename, DataCollection::GetContactObservations, data, true, verbose);
+}
+
+LoopProjectFileResponse GetDrillholeObservations(std::string filename, BulkVector<DrillholeObservation> &data, bool verbose)
+{
+    LPF_OPEN_RUN(filename, DataCollection::GetDrillholeObservations, data, true, verbose);
+}
+
+LoopProjectFileResponse GetDrillholeProperties(std::string filename, BulkVector<DrillholeProperty> &data, bool verbose)
+{
+    LPF_OPEN_RUN(filename, DataCollection::GetDrillholeProperties, data, true, verbose);
+}
+
+LoopProjectFileResponse GetDrillholeSurveys(std::string filename, BulkVector<DrillholeSurvey> &data, bool verbose)
+{
+    LPF_OPEN_RUN(filename, DataCollection::GetDrillholeSurveys, data, true, verbose);
+}
+
+LoopProjectFileResponse GetFaultEvents(std::string filename, BulkVector<FaultEvent> &data, bool verbose)
+{
+    LPF_OPEN_RUN(filename, ExtractedInformation::GetFaultEvents, data, true, verbose);
+}
+
+LoopProjectFileResponse GetFoldEvents(std::string filename, BulkVector<FoldEvent> &data, bool verbose)
+{
+    LPF_OPEN_RUN(filename, ExtractedInformation::GetFoldEvents, data, true, verbose);
+}
+
+LoopProjectFileResponse GetFoliationEvents(std::string filename, BulkVector<FoliationEvent> &data, bool verbose)
+{
+    LPF_OPEN_RUN(filename, ExtractedInformation::GetFoliationEvents, data, true, verbose);
+}
+
+LoopProjectFileResponse GetDiscontinuityEvents(std::string filename, BulkVector<DiscontinuityEvent> &data, bool verbose)
+{
+    LPF_OPEN_RUN(filename, ExtractedInformation::GetDiscontinuityEvents, data, true, verbose);
+}
+
+LoopProjectFileResponse GetStratigraphicLayers(std::string filename, BulkVector<StratigraphicLayer> &data, bool verbose)
+{
+    LPF_OPEN_RUN(filename, ExtractedInformation::GetStratigraphicLayers, data, true, verbose);
+}
+
+LoopProjectFileResponse GetEventRelationships(std::string filename, BulkVector<EventRelationship> &data, bool verbose)
+{
+    LPF_OPEN_RUN(filename, ExtractedInformation::GetEventRelationships, data, true, verbose);
+}
+
+LoopProjectFileResponse GetDrillholeDescriptions(std::string filename, BulkVector<DrillholeDescription> &data, bool verbose)
+{
+    LPF_OPEN_RUN(filename, ExtractedInformation::GetDrillholeDescriptions, data, true, verbose);
+}
+
+LoopProjectFileResponse GetFaultObservations(std::string filename, std::vector<FaultObservation> &data, size_t start, size_t count, bool verbose)
+{
+    LPF_OPEN_RUN_RANGE(filename, DataCollection::GetFaultObservations, data, start, count, verbose);
+}
+
+LoopProjectFileResponse GetFoldObservations(std::string filename, std::vector<FoldObservation> &data, size_t start, size_t count, bool verbose)
+{
+    LPF_OPEN_RUN_RANGE(filename, DataCollection::GetFoldObservations, data, start, count, verbose);
+}
+
+LoopProjectFileResponse GetFoliationObservations(std::string filename, std::vector<FoliationObservation> &data, size_t start, size_t count, bool verbose)
+{
+    LPF_OPEN_RUN_RANGE(filename, DataCollection::GetFoliationObservations, data, start, count, verbose);
+}
+
+LoopProjectFileResponse GetDiscontinuityObservations(std::string filename, std::vector<DiscontinuityObservation> &data, size_t start, size_t count, bool verbose)
+{
+    LPF_OPEN_RUN_RANGE(filename, DataCollection::GetDiscontinuityObservations, data, start, count, verbose);
+}
+
+LoopProjectFileResponse GetStratigraphicObservations(std::string filename, std::vector<StratigraphicObservation> &data, size_t start, size_t count, bool verbose)
+{
+    LPF_OPEN_RUN_RANGE(filename, DataCollection::GetStratigraphicObservations, data, start, count, verbose);
+}
+
+LoopProjectFileResponse GetContacts(std::string filename, std::vector<ContactObservation> &data, size_t start, size_t count, bool verbose)
+{
+    LPF_OPEN_RUN_RANGE(filename, DataCollection::GetContactObservations, data, start, count, verbose);
+}
+
+LoopProjectFileResponse GetDrillholeObservations(std::string filename, std::vector<DrillholeObservation> &data, size_t start, size_t count, bool verbose)
+{
+    LPF_OPEN_RUN_RANGE(filename, DataCollection::GetDrillholeObservations, data, start, count, verbose);
+}
+
+LoopProjectFileResponse GetDrillholeProperties(std::string filename, std::vector<DrillholeProperty> &data, size_t start, size_t count, bool verbose)
+{
+    LPF_OPEN_RUN_RANGE(filename, DataCollection::GetDrillholeProperties, data, start, count, verbose);
+}
+
+LoopProjectFileResponse GetDrillholeSurveys(std::string filename, std::vector<DrillholeSurvey> &data, size_t start, size_t count, bool verbose)
+{
+    LPF_OPEN_RUN_RANGE(filename, DataCollection::GetDrillholeSurveys, data, start, count, verbose);
+}
+
+LoopProjectFileResponse GetFaultEvents(std::string filename, std::vector<FaultEvent> &data, size_t start, size_t count, bool verbose)
+{
+    LPF_OPEN_RUN_RANGE(filename, ExtractedInformation::GetFaultEvents, data, start, count, verbose);
+}
+
+LoopProjectFileResponse GetFoldEvents(std::string filename, std::vector<FoldEvent> &data, size_t start, size_t count, bool verbose)
+{
+    LPF_OPEN_RUN_RANGE(filename, ExtractedInformation::GetFoldEvents, data, start, count, verbose);
+}
+
+LoopProjectFileResponse GetFoliationEvents(std::string filename, std::vector<FoliationEvent> &data, size_t start, size_t count, bool verbose)
+{
+    LPF_OPEN_RUN_RANGE(filename, ExtractedInformation::GetFoliationEvents, data, start, count, verbose);
+}
+
+LoopProjectFileResponse GetDiscontinuityEvents(std::string filename, std::vector<DiscontinuityEvent> &data, size_t start, size_t count, bool verbose)
+{
+    LPF_OPEN_RUN_RANGE(filename, ExtractedInformation::GetDiscontinuityEvents, data, start, count, verbose);
+}
+
+LoopProjectFileResponse GetStratigraphicLayers(std::string filename, std::vector<StratigraphicLayer> &data, size_t start, size_t count, bool verbose)
+{
+    LPF_OPEN_RUN_RANGE(filename, ExtractedInformation::GetStratigraphicLayers, data, start, count, verbose);
+}
+
+LoopProjectFileResponse GetEventRelationships(std::string filename, std::vector<EventRelationship> &data, size_t start, size_t count, bool verbose)
+{
+    LPF_OPEN_RUN_RANGE(filename, ExtractedInformation::GetEventRelationships, data, start, count, verbose);
+}
+
+LoopProjectFileResponse GetDrillholeDescriptions(std::string filename, std::vector<DrillholeDescription> &data, size_t start, size_t count, bool verbose)
+{
+    LPF_OPEN_RUN_RANGE(filename, ExtractedInformation::GetDrillholeDescriptions, data, start, count, verbose);
+}
+
 LoopProjectFileResponse GetStructuralModel(std::string filename, std::vector<float> &data, std::vector<int> &dataShape, int index, bool verbose)
 {
     LPF_OPEN_RUN_WITH_SHAPE(filename, StructuralModels::GetStructuralModel, data, dataShape, index, true, verbose);
@@ -237,6 +431,54 @@ LoopProjectFileResponse GetUncertaintyModel(std::string filename, std::vector<fl
     LPF_OPEN_RUN_WITH_SHAPE(filename, UncertaintyModels::GetUncertaintyModel, data, dataShape, index, true, verbose);
 }
 
+LoopProjectFileResponse ListValidModels(std::string filename, ModelType modelType, std::vector<char>& valid, bool verbose)
+{
+    LOOP_METRICS_CALL();
+    LOOP_TRACE_FUNCTION();
+    LoopProjectFileResponse resp = {0,""};
+    netCDF::NcFile file;
+    if (!OpenProjectFile(filename, file, true, verbose)) {
+        resp = ModelStorage::ListValidModels(&file, modelType, valid, verbose);
+    } else {
+        resp = createErrorMsg(1,"Failure to open project file " + filename,verbose);
+    }
+    return resp;
+}
+
+LoopProjectFileResponse LoadProjectSnapshot(std::string filename, ProjectSnapshot& snapshot, bool includeModels, bool verbose)
+{
+    LOOP_METRICS_CALL();
+    LOOP_TRACE_FUNCTION();
+    LoopProjectFileResponse resp = {0,""};
+    netCDF::NcFile file;
+    if (!OpenProjectFile(filename, file, true, verbose)) {
+        resp = Snapshot::LoadSnapshot(&file, snapshot, includeModels, verbose);
+    } else {
+        resp = createErrorMsg(1,"Failure to open project file " + filename,verbose);
+    }
+    return resp;
+}
+
+LoopProjectFileResponse GetProjectInventory(std::string filename, ProjectInventory& inventory, bool verbose)
+{
+    LOOP_METRICS_CALL();
+    LOOP_TRACE_FUNCTION();
+    LoopProjectFileResponse resp = {0,""};
+    inventory = ProjectInventory();
+    inventory.filename = filename;
+    netCDF::NcFile file;
+    if (OpenProjectFile(filename, file, true, verbose)) {
+        return createErrorMsg(1, "Failure to open project file " + filename, verbose);
+    }
+    struct stat buffer;
+    if (stat(filename.c_str(), &buffer) == 0) inventory.fileBytes = buffer.st_size;
+    resp = Inventory::LoadInventory(&file, inventory, verbose);
+    CloseProjectFile(&file);
+    // HDF5 is opened separately once netCDF has released the file
+    if (!resp.errorCode) resp = Inventory::LoadStorageSizes(filename, inventory, verbose);
+    return resp;
+}
+
 LoopProjectFileResponse SetExtents(std::string filename, LoopExtents data, bool verbose)
 {
     LPF_OPEN_RUN(filename, LoopExtents::SetExtents, data, false, verbose);
@@ -292,6 +534,41 @@ LoopProjectFileResponse SetDrillholeObservations(std::string filename, std::vect
     LPF_OPEN_RUN(filename, DataCollection::SetDrillholeObservations, data, false, verbose);
 }
 
+LoopProjectFileResponse SetFaultObservations(std::string filename, std::vector<FaultObservation> data, const ObservationWriteOptions& options, bool verbose)
+{
+    LPF_OPEN_RUN_WITH_OPTIONS(filename, DataCollection::SetFaultObservations, data, options, verbose);
+}
+
+LoopProjectFileResponse SetFoldObservations(std::string filename, std::vector<FoldObservation> data, const ObservationWriteOptions& options, bool verbose)
+{
+    LPF_OPEN_RUN_WITH_OPTIONS(filename, DataCollection::SetFoldObservations, data, options, verbose);
+}
+
+LoopProjectFileResponse SetFoliationObservations(std::string filename, std::vector<FoliationObservation> data, const ObservationWriteOptions& options, bool verbose)
+{
+    LPF_OPEN_RUN_WITH_OPTIONS(filename, DataCollection::SetFoliationObservations, data, options, verbose);
+}
+
+LoopProjectFileResponse SetDiscontinuityObservations(std::string filename, std::vector<DiscontinuityObservation> data, const ObservationWriteOptions& options, bool verbose)
+{
+    LPF_OPEN_RUN_WITH_OPTIONS(filename, DataCollection::SetDiscontinuityObservations, data, options, verbose);
+}
+
+LoopProjectFileResponse SetStratigraphicObservations(std::string filename, std::vector<StratigraphicObservation> data, const ObservationWriteOptions& options, bool verbose)
+{
+    LPF_OPEN_RUN_WITH_OPTIONS(filename, DataCollection::SetStratigraphicObservations, data, options, verbose);
+}
+
+LoopProjectFileResponse SetContacts(std::string filename, std::vector<ContactObservation> data, const ObservationWriteOptions& options, bool verbose)
+{
+    LPF_OPEN_RUN_WITH_OPTIONS(filename, DataCollection::SetContactObservations, data, options, verbose);
+}
+
+LoopProjectFileResponse SetDrillholeObservations(std::string filename, std::vector<DrillholeObservation> data, const ObservationWriteOptions& options, bool verbose)
+{
+    LPF_OPEN_RUN_WITH_OPTIONS(filename, DataCollection::SetDrillholeObservations, data, options, verbose);
+}
+
 LoopProjectFileResponse SetDrillholeProperties(std::string filename, std::vector<DrillholeProperty> data, bool verbose)
 {
     LPF_OPEN_RUN(filename, DataCollection::SetDrillholeProperties, data, false, verbose);
@@ -352,5 +629,19 @@ LoopProjectFileResponse SetUncertaintyModel(std::string filename, std::vector<fl
     LPF_OPEN_RUN_WITH_SHAPE(filename, UncertaintyModels::SetUncertaintyModel, data, dataShape, index, false, verbose);
 }
 
+LoopProjectFileResponse PrepareModels(std::string filename, ModelType modelType, ModelWriteOptions options, bool verbose)
+{
+    LOOP_METRICS_CALL();
+    LOOP_TRACE_FUNCTION();
+    LoopProjectFileResponse resp = {0,""};
+    netCDF::NcFile file;
+    if (!OpenProjectFile(filename, file, false, verbose)) {
+        resp = ModelStorage::PrepareModelGroup(&file, modelType, options, verbose);
+    } else {
+        resp = createErrorMsg(1,"Failure to open project file " + filename,verbose);
+    }
+    return resp;
+}
+
 } // namespace LoopProjectFile
 
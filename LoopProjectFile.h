@@ -14,6 +14,15 @@
 #include "LoopStructuralModels.h"
 #include "LoopGeophysicalModels.h"
 #include "LoopUncertaintyModels.h"
+#include "LoopModelStorage.h"
+#include "LoopRecordStorage.h"
+#include "LoopRecordFilter.h"
+#include "LoopSpatialIndex.h"
+#include "LoopProjectSnapshot.h"
+#include "LoopProjectInventory.h"
+#include "LoopProjectFileMetrics.h"
+#include "LoopProjectFileTrace.h"
+#include "LoopProjectSession.h"
 
 /*! \brief The core namespace for Loop Project File functions and structures */
 namespace LoopProjectFile {
@@ -47,7 +56,8 @@ bool OpenProjectFile(std::string filename, netCDF::NcFile& file, bool readOnly=t
 void CloseProjectFile(netCDF::NcFile* file);
 
 /*!
- * \brief Checks the structure of the loop project file is valid
+ * \brief Checks the structure of the loop project file is valid. Every module check is run and
+ * the file is only valid if all pass (see Validation::ValidateFile for the data level checks)
  *
  * \param filename - the name of the file to check
  * \param verbose - a flag to toggle verbose message printing
@@ -110,6 +120,66 @@ LoopProjectFileResponse GetEventRelationships(std::string filename, std::vector<
 LoopProjectFileResponse GetDrillholeDescriptions(std::string filename, std::vector<DrillholeDescription> &data, bool verbose=false);
 /*!@}*/
 
+/*! @{
+ * \brief Retrieves specified record data from the loop project file into a bulk vector.
+ * The bulk vector is sized without zero filling each record so large tables are only
+ * written once, by the read itself
+ *
+ * \param filename - the filename of the loop project file
+ * \param data - a reference to where the data is to be copied
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of data retrieval with error message if it failed
+ */
+LoopProjectFileResponse GetFaultObservations(std::string filename, BulkVector<FaultObservation> &data, bool verbose=false);
+LoopProjectFileResponse GetFoldObservations(std::string filename, BulkVector<FoldObservation> &data, bool verbose=false);
+LoopProjectFileResponse GetFoliationObservations(std::string filename, BulkVector<FoliationObservation> &data, bool verbose=false);
+LoopProjectFileResponse GetDiscontinuityObservations(std::string filename, BulkVector<DiscontinuityObservation> &data, bool verbose=false);
+LoopProjectFileResponse GetStratigraphicObservations(std::string filename, BulkVector<StratigraphicObservation> &data, bool verbose=false);
+LoopProjectFileResponse GetContacts(std::string filename, BulkVector<ContactObservation> &data, bool verbose=false);
+LoopProjectFileResponse GetDrillholeObservations(std::string filename, BulkVector<DrillholeObservation> &data, bool verbose=false);
+LoopProjectFileResponse GetDrillholeProperties(std::string filename, BulkVector<DrillholeProperty> &data, bool verbose=false);
+LoopProjectFileResponse GetDrillholeSurveys(std::string filename, BulkVector<DrillholeSurvey> &data, bool verbose=false);
+LoopProjectFileResponse GetFaultEvents(std::string filename, BulkVector<FaultEvent> &data, bool verbose=false);
+LoopProjectFileResponse GetFoldEvents(std::string filename, BulkVector<FoldEvent> &data, bool verbose=false);
+LoopProjectFileResponse GetFoliationEvents(std::string filename, BulkVector<FoliationEvent> &data, bool verbose=false);
+LoopProjectFileResponse GetDiscontinuityEvents(std::string filename, BulkVector<DiscontinuityEvent> &data, bool verbose=false);
+LoopProjectFileResponse GetStratigraphicLayers(std::string filename, BulkVector<StratigraphicLayer> &data, bool verbose=false);
+LoopProjectFileResponse GetEventRelationships(std::string filename, BulkVector<EventRelationship> &data, bool verbose=false);
+LoopProjectFileResponse GetDrillholeDescriptions(std::string filename, BulkVector<DrillholeDescription> &data, bool verbose=false);
+/*!@}*/
+
+/*! @{
+ * \brief Retrieves the records [start, start+count) of a record table from the loop project
+ * file, in the order the whole table getters return them. A range past the end of the table
+ * is cut short, so pages can be read until fewer than count records come back
+ *
+ * \param filename - the filename of the loop project file
+ * \param data - a reference to where the data is to be copied
+ * \param start - the position of the first record to retrieve
+ * \param count - the most records to retrieve
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of data retrieval with error message if it failed
+ */
+LoopProjectFileResponse GetFaultObservations(std::string filename, std::vector<FaultObservation> &data, size_t start, size_t count, bool verbose=false);
+LoopProjectFileResponse GetFoldObservations(std::string filename, std::vector<FoldObservation> &data, size_t start, size_t count, bool verbose=false);
+LoopProjectFileResponse GetFoliationObservations(std::string filename, std::vector<FoliationObservation> &data, size_t start, size_t count, bool verbose=false);
+LoopProjectFileResponse GetDiscontinuityObservations(std::string filename, std::vector<DiscontinuityObservation> &data, size_t start, size_t count, bool verbose=false);
+LoopProjectFileResponse GetStratigraphicObservations(std::string filename, std::vector<StratigraphicObservation> &data, size_t start, size_t count, bool verbose=false);
+LoopProjectFileResponse GetContacts(std::string filename, std::vector<ContactObservation> &data, size_t start, size_t count, bool verbose=false);
+LoopProjectFileResponse GetDrillholeObservations(std::string filename, std::vector<DrillholeObservation> &data, size_t start, size_t count, bool verbose=false);
+LoopProjectFileResponse GetDrillholeProperties(std::string filename, std::vector<DrillholeProperty> &data, size_t start, size_t count, bool verbose=false);
+LoopProjectFileResponse GetDrillholeSurveys(std::string filename, std::vector<DrillholeSurvey> &data, size_t start, size_t count, bool verbose=false);
+LoopProjectFileResponse GetFaultEvents(std::string filename, std::vector<FaultEvent> &data, size_t start, size_t count, bool verbose=false);
+LoopProjectFileResponse GetFoldEvents(std::string filename, std::vector<FoldEvent> &data, size_t start, size_t count, bool verbose=false);
+LoopProjectFileResponse GetFoliationEvents(std::string filename, std::vector<FoliationEvent> &data, size_t start, size_t count, bool verbose=false);
+LoopProjectFileResponse GetDiscontinuityEvents(std::string filename, std::vector<DiscontinuityEvent> &data, size_t start, size_t count, bool verbose=false);
+LoopProjectFileResponse GetStratigraphicLayers(std::string filename, std::vector<StratigraphicLayer> &data, size_t start, size_t count, bool verbose=false);
+LoopProjectFileResponse GetEventRelationships(std::string filename, std::vector<EventRelationship> &data, size_t start, size_t count, bool verbose=false);
+LoopProjectFileResponse GetDrillholeDescriptions(std::string filename, std::vector<DrillholeDescription> &data, size_t start, size_t count, bool verbose=false);
+/*!@}*/
+
 /*! @{
  * \brief Retrieves specified data from the loop project file
  *
@@ -126,6 +196,44 @@ LoopProjectFileResponse GetGeophysicalModel(std::string filename, std::vector<fl
 LoopProjectFileResponse GetUncertaintyModel(std::string filename, std::vector<float> &data, std::vector<int> &dataShape, int index, bool verbose=false);
 /*!@}*/
 
+/*!
+ * \brief Lists which index locations of a model group hold a model (see ModelStorage::ListValidModels)
+ * so an ensemble can be scanned without reading model data or probing missing indices
+ *
+ * \param filename - the filename of the loop project file
+ * \param modelType - the type of model group to list
+ * \param valid - a reference to return one flag per index location (non-zero if it holds a model)
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of reading the flags with error message if it failed
+ */
+LoopProjectFileResponse ListValidModels(std::string filename, ModelType modelType, std::vector<char>& valid, bool verbose=false);
+
+/*!
+ * \brief Decodes the whole loop project file into an arena backed snapshot
+ *
+ * \param filename - the filename of the loop project file
+ * \param snapshot - a reference to the snapshot to fill (cleared first)
+ * \param includeModels - a flag to toggle loading of the structural, geophysical and uncertainty models
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of data retrieval with error message if it failed
+ */
+LoopProjectFileResponse LoadProjectSnapshot(std::string filename, ProjectSnapshot& snapshot, bool includeModels=true, bool verbose=false);
+
+/*!
+ * \brief Takes an inventory of the loop project file without reading any table or model data:
+ * the live record count of every table, the grid and valid indices of every model group and,
+ * when built with LOOP_HAVE_HDF5, the storage bytes of each in the file
+ *
+ * \param filename - the filename of the loop project file
+ * \param inventory - a reference to the inventory to fill
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of taking the inventory with error message if it failed
+ */
+LoopProjectFileResponse GetProjectInventory(std::string filename, ProjectInventory& inventory, bool verbose=false);
+
 // Setters for Extents/Observation/Events/Layers/Models
 
 /*! @{
@@ -159,6 +267,26 @@ LoopProjectFileResponse SetEventRelationships(std::string filename, std::vector<
 LoopProjectFileResponse SetDrillholeDescriptions(std::string filename, std::vector<DrillholeDescription> data, bool verbose=false);
 /*!@}*/
 
+/*! @{
+ * \brief Adds or overrides observation data in the loop project file with the given layout
+ * (see ObservationWriteOptions). Spatial ordering needs the project extents to be set first
+ *
+ * \param filename - the filename of the loop project file
+ * \param data - the data to be added
+ * \param options - the layout of the stored records
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of data insertion with error message if it failed
+ */
+LoopProjectFileResponse SetFaultObservations(std::string filename, std::vector<FaultObservation> data, const ObservationWriteOptions& options, bool verbose=false);
+LoopProjectFileResponse SetFoldObservations(std::string filename, std::vector<FoldObservation> data, const ObservationWriteOptions& options, bool verbose=false);
+LoopProjectFileResponse SetFoliationObservations(std::string filename, std::vector<FoliationObservation> data, const ObservationWriteOptions& options, bool verbose=false);
+LoopProjectFileResponse SetDiscontinuityObservations(std::string filename, std::vector<DiscontinuityObservation> data, const ObservationWriteOptions& options, bool verbose=false);
+LoopProjectFileResponse SetStratigraphicObservations(std::string filename, std::vector<StratigraphicObservation> data, const ObservationWriteOptions& options, bool verbose=false);
+LoopProjectFileResponse SetContacts(std::string filename, std::vector<ContactObservation> data, const ObservationWriteOptions& options, bool verbose=false);
+LoopProjectFileResponse SetDrillholeObservations(std::string filename, std::vector<DrillholeObservation> data, const ObservationWriteOptions& options, bool verbose=false);
+/*!@}*/
+
 /*! @{
  * \brief Adds or overrides specified data to the loop project file
  *
@@ -175,6 +303,148 @@ LoopProjectFileResponse SetGeophysicalModel(std::string filename, std::vector<fl
 LoopProjectFileResponse SetUncertaintyModel(std::string filename, std::vector<float> data, std::vector<int> dataShape, int index, bool verbose=false);
 /*!@}*/
 
+/*!
+ * \brief Prepares a model group for writing a large ensemble (see ModelStorage::PrepareModelGroup).
+ * Call before the first model of the group is written so that the fill and chunking options apply
+ *
+ * \param filename - the filename of the loop project file
+ * \param modelType - the type of model group to prepare
+ * \param options - the data layout and the number of models to preallocate
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of preparing the group with an error message if it failed
+ */
+LoopProjectFileResponse PrepareModels(std::string filename, ModelType modelType, ModelWriteOptions options, bool verbose=false);
+
+/*!
+ * \brief Gets the number of records in a table (e.g. FaultEvent) from its dimension length,
+ * without reading any records (see RecordStorage::GetRecordCount)
+ *
+ * \param filename - the filename of the loop project file
+ * \param count - a reference to return the number of records
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of the count with error message if it failed
+ */
+template <typename T>
+LoopProjectFileResponse GetRecordCount(std::string filename, size_t& count, bool verbose=false)
+{
+    LOOP_METRICS_CALL();
+    LOOP_TRACE_FUNCTION();
+    count = 0;
+    netCDF::NcFile file;
+    if (OpenProjectFile(filename, file, true, verbose)) return createErrorMsg(1,"Failure to open project file " + filename,verbose);
+    return RecordStorage::GetRecordCount<T>(&file, count, verbose);
+}
+
+/*!
+ * \brief Retrieves the records of a table (e.g. std::vector<FoliationObservation>) that match
+ * a filter, reading the table in batches so only the matches are held in memory
+ * (see RecordStorage::ScanRecords)
+ *
+ * \param filename - the filename of the loop project file
+ * \param filter - the conditions records must meet
+ * \param matches - a reference to return the matching records
+ * \param batchSize - the number of records read per hyperslab
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of the scan with error message if it failed
+ */
+template <typename T>
+LoopProjectFileResponse ScanRecords(std::string filename, const RecordFilter& filter, std::vector<T>& matches, size_t batchSize=LOOP_SCAN_BATCH_RECORDS, bool verbose=false)
+{
+    LOOP_METRICS_CALL();
+    LOOP_TRACE_FUNCTION();
+    matches.clear();
+    netCDF::NcFile file;
+    if (OpenProjectFile(filename, file, true, verbose)) return createErrorMsg(1,"Failure to open project file " + filename,verbose);
+    return RecordStorage::ScanRecords(&file, filter, matches, batchSize, verbose);
+}
+
+/*!
+ * \brief Retrieves the observations (e.g. std::vector<FaultObservation>) within a region,
+ * reading only the directory cells overlapping it when the table is spatially ordered
+ * (see SpatialIndex::ReadRegion)
+ *
+ * \param filename - the filename of the loop project file
+ * \param region - the region (easting, northing and altitude between bottomDepth and topDepth)
+ * \param records - a reference to return the records within the region
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of data retrieval with error message if it failed
+ */
+template <typename T>
+LoopProjectFileResponse ReadRegion(std::string filename, const LoopExtents& region, std::vector<T>& records, bool verbose=false)
+{
+    LOOP_METRICS_CALL();
+    LOOP_TRACE_FUNCTION();
+    records.clear();
+    netCDF::NcFile file;
+    if (OpenProjectFile(filename, file, true, verbose)) return createErrorMsg(1,"Failure to open project file " + filename,verbose);
+    return SpatialIndex::ReadRegion(&file, region, records, verbose);
+}
+
+/*!
+ * \brief Replaces individual records of a table (e.g. std::vector<FaultEvent>) without rewriting
+ * the rest of it (see RecordStorage::UpdateRecords)
+ *
+ * \param filename - the filename of the loop project file
+ * \param indices - the position of each record to replace
+ * \param records - the new records, one per index
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of data insertion with error message if it failed
+ */
+template <typename T>
+LoopProjectFileResponse UpdateRecords(std::string filename, const std::vector<size_t>& indices, const std::vector<T>& records, bool verbose=false)
+{
+    LOOP_METRICS_CALL();
+    LOOP_TRACE_FUNCTION();
+    netCDF::NcFile file;
+    if (OpenProjectFile(filename, file, false, verbose)) return createErrorMsg(1,"Failure to open project file " + filename,verbose);
+    return RecordStorage::UpdateRecords(&file, indices, records, verbose);
+}
+
+/*!
+ * \brief Deletes individual records of a table (e.g. std::vector<FaultEvent>) by flagging them
+ * (see RecordStorage::DeleteRecords)
+ *
+ * \param filename - the filename of the loop project file
+ * \param indices - the positions of the records to delete
+ * \param compact - whether to move the remaining records together afterwards
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of the deletion with error message if it failed
+ */
+template <typename T>
+LoopProjectFileResponse DeleteRecords(std::string filename, const std::vector<size_t>& indices, bool compact=false, bool verbose=false)
+{
+    LOOP_METRICS_CALL();
+    LOOP_TRACE_FUNCTION();
+    netCDF::NcFile file;
+    if (OpenProjectFile(filename, file, false, verbose)) return createErrorMsg(1,"Failure to open project file " + filename,verbose);
+    return RecordStorage::DeleteRecords<T>(&file, indices, compact, verbose);
+}
+
+/*!
+ * \brief Moves the remaining records of a table (e.g. FaultEvent) together after deletions
+ * (see RecordStorage::CompactRecords)
+ *
+ * \param filename - the filename of the loop project file
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of the compaction with error message if it failed
+ */
+template <typename T>
+LoopProjectFileResponse CompactRecords(std::string filename, bool verbose=false)
+{
+    LOOP_METRICS_CALL();
+    LOOP_TRACE_FUNCTION();
+    netCDF::NcFile file;
+    if (OpenProjectFile(filename, file, false, verbose)) return createErrorMsg(1,"Failure to open project file " + filename,verbose);
+    return RecordStorage::CompactRecords<T>(&file, verbose);
+}
+
 } // namespace LoopProjectFile
 
 
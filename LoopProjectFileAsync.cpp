@@ -0,0 +1,391 @@
+#include "LoopProjectFileAsync.h"
+
+#include <cmath>
+
+namespace LoopProjectFile {
+
+TaskQueue::TaskQueue(unsigned int numThreads)
+    : stopping(false)
+{
+    if (numThreads == 0) numThreads = 1;
+    for (unsigned int i=0;i<numThreads;i++) {
+        threads.push_back(std::thread(&TaskQueue::Run, this));
+    }
+}
+
+TaskQueue::~TaskQueue()
+{
+    {
+        std::lock_guard<std::mutex> lock(tasksMutex);
+        stopping = true;
+    }
+    tasksAvailable.notify_all();
+    for (size_t i=0;i<threads.size();i++) threads[i].join();
+}
+
+size_t TaskQueue::GetPendingCount()
+{
+    std::lock_guard<std::mutex> lock(tasksMutex);
+    return tasks.size();
+}
+
+void TaskQueue::Enqueue(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(tasksMutex);
+        tasks.push_back(task);
+    }
+    tasksAvailable.notify_one();
+}
+
+void TaskQueue::Run()
+{
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(tasksMutex);
+            while (!stopping && tasks.empty()) tasksAvailable.wait(lock);
+            // Drain the queue before stopping so no queued future is left unsatisfied
+            if (tasks.empty()) return;
+            task = tasks.front();
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+TaskQueue& Async::GetIOQueue()
+{
+    // The netCDF mutex and the worker pool are created first so they outlive the I/O queue at
+    // exit, as its tasks take the mutex and hand decoded models on to the pool
+    GetNetCDFMutex();
+    GetWorkerPool();
+    static TaskQueue ioQueue(1);
+    return ioQueue;
+}
+
+TaskQueue& Async::GetWorkerPool()
+{
+    // Created first so the mutex outlives the pool threads at exit
+    GetNetCDFMutex();
+    static TaskQueue workerPool(std::thread::hardware_concurrency());
+    return workerPool;
+}
+
+TaskQueue& Async::GetWaiterQueue()
+{
+    // The worker pool is created first so it outlives the waiter queue at exit, as the waiter
+    // hands every completed operation on to it
+    GetWorkerPool();
+    static TaskQueue waiterQueue(1);
+    return waiterQueue;
+}
+
+typedef LoopProjectFileResponse (*ModelGetter)(std::string, std::vector<float>&, std::vector<int>&, int, bool);
+
+static void CalculateModelStatistics(Async::ModelData& model)
+{
+    bool found = false;
+    for (size_t i=0;i<model.data.size();i++) {
+        float value = model.data[i];
+        if (!std::isfinite(value)) continue;
+        if (!found || value < model.minValue) model.minValue = value;
+        if (!found || value > model.maxValue) model.maxValue = value;
+        found = true;
+    }
+}
+
+// Only the netCDF read holds the lock on the I/O thread. The statistics are then computed on the
+// worker pool so the next read can start straight away
+static std::future<Async::Result<Async::ModelData> > GetModelAsync(std::string filename, ModelGetter getter, int index, bool verbose)
+{
+    std::shared_ptr<std::promise<Async::Result<Async::ModelData> > > promise(new std::promise<Async::Result<Async::ModelData> >());
+    Async::GetIOQueue().Submit([filename, getter, index, verbose, promise]() {
+        std::shared_ptr<Async::Result<Async::ModelData> > result(new Async::Result<Async::ModelData>());
+        try {
+            std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+            result->response = getter(filename, result->data.data, result->data.dataShape, index, verbose);
+        } catch (...) {
+            promise->set_exception(std::current_exception());
+            return;
+        }
+        Async::GetWorkerPool().Submit([result, promise]() {
+            if (!result->response.errorCode) CalculateModelStatistics(result->data);
+            promise->set_value(std::move(*result));
+        });
+    });
+    return promise->get_future();
+}
+
+/*****************************************************************************/
+/*        FUNCTION MACROS USED TO STREAMLINE ASYNC GETTER/SETTER FUNCTIONS   */
+/*****************************************************************************/
+#define LPF_ASYNC_GET(FILENAME,FUNCTION,TYPE,VERBOSE) \
+{\
+    return GetIOQueue().Submit([FILENAME,VERBOSE]() {\
+        std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());\
+        Result<TYPE> result;\
+        result.response = FUNCTION(FILENAME, result.data, VERBOSE);\
+        return result;\
+    });\
+}
+
+#define LPF_ASYNC_GET_MODEL(FILENAME,FUNCTION,INDEX,VERBOSE) \
+{\
+    return GetModelAsync(FILENAME, FUNCTION, INDEX, VERBOSE);\
+}
+
+// The data is moved into a shared holder so large tables are not copied into the queue
+#define LPF_ASYNC_SET(FILENAME,FUNCTION,TYPE,CONTAINER,VERBOSE) \
+{\
+    std::shared_ptr<TYPE> holder(new TYPE(std::move(CONTAINER)));\
+    return GetIOQueue().Submit([FILENAME,holder,VERBOSE]() {\
+        std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());\
+        return FUNCTION(FILENAME, std::move(*holder), VERBOSE);\
+    });\
+}
+
+#define LPF_ASYNC_SET_MODEL(FILENAME,FUNCTION,CONTAINER,SHAPE,INDEX,VERBOSE) \
+{\
+    std::shared_ptr<std::vector<float> > holder(new std::vector<float>(std::move(CONTAINER)));\
+    return GetIOQueue().Submit([FILENAME,holder,SHAPE,INDEX,VERBOSE]() {\
+        std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());\
+        return FUNCTION(FILENAME, std::move(*holder), SHAPE, INDEX, VERBOSE);\
+    });\
+}
+/*****************************************************************************/
+
+namespace Async {
+
+std::future<Result<LoopExtents> > GetExtents(std::string filename, bool verbose)
+{
+    LPF_ASYNC_GET(filename, LoopProjectFile::GetExtents, LoopExtents, verbose);
+}
+
+std::future<Result<DataCollectionConfiguration> > GetDataCollectionConfiguration(std::string filename, bool verbose)
+{
+    LPF_ASYNC_GET(filename, LoopProjectFile::GetDataCollectionConfiguration, DataCollectionConfiguration, verbose);
+}
+
+std::future<Result<DataCollectionSources> > GetDataCollectionSources(std::string filename, bool verbose)
+{
+    LPF_ASYNC_GET(filename, LoopProjectFile::GetDataCollectionSources, DataCollectionSources, verbose);
+}
+
+std::future<Result<StructuralModelsConfiguration> > GetStructuralModelsConfiguration(std::string filename, bool verbose)
+{
+    LPF_ASYNC_GET(filename, LoopProjectFile::GetStructuralModelsConfiguration, StructuralModelsConfiguration, verbose);
+}
+
+std::future<Result<std::vector<FaultObservation> > > GetFaultObservations(std::string filename, bool verbose)
+{
+    LPF_ASYNC_GET(filename, LoopProjectFile::GetFaultObservations, std::vector<FaultObservation>, verbose);
+}
+
+std::future<Result<std::vector<FoldObservation> > > GetFoldObservations(std::string filename, bool verbose)
+{
+    LPF_ASYNC_GET(filename, LoopProjectFile::GetFoldObservations, std::vector<FoldObservation>, verbose);
+}
+
+std::future<Result<std::vector<FoliationObservation> > > GetFoliationObservations(std::string filename, bool verbose)
+{
+    LPF_ASYNC_GET(filename, LoopProjectFile::GetFoliationObservations, std::vector<FoliationObservation>, verbose);
+}
+
+std::future<Result<std::vector<DiscontinuityObservation> > > GetDiscontinuityObservations(std::string filename, bool verbose)
+{
+    LPF_ASYNC_GET(filename, LoopProjectFile::GetDiscontinuityObservations, std::vector<DiscontinuityObservation>, verbose);
+}
+
+std::future<Result<std::vector<StratigraphicObservation> > > GetStratigraphicObservations(std::string filename, bool verbose)
+{
+    LPF_ASYNC_GET(filename, LoopProjectFile::GetStratigraphicObservations, std::vector<StratigraphicObservation>, verbose);
+}
+
+std::future<Result<std::vector<ContactObservation> > > GetContacts(std::string filename, bool verbose)
+{
+    LPF_ASYNC_GET(filename, LoopProjectFile::GetContacts, std::vector<ContactObservation>, verbose);
+}
+
+std::future<Result<std::vector<DrillholeObservation> > > GetDrillholeObservations(std::string filename, bool verbose)
+{
+    LPF_ASYNC_GET(filename, LoopProjectFile::GetDrillholeObservations, std::vector<DrillholeObservation>, verbose);
+}
+
+std::future<Result<std::vector<DrillholeProperty> > > GetDrillholeProperties(std::string filename, bool verbose)
+{
+    LPF_ASYNC_GET(filename, LoopProjectFile::GetDrillholeProperties, std::vector<DrillholeProperty>, verbose);
+}
+
+std::future<Result<std::vector<DrillholeSurvey> > > GetDrillholeSurveys(std::string filename, bool verbose)
+{
+    LPF_ASYNC_GET(filename, LoopProjectFile::GetDrillholeSurveys, std::vector<DrillholeSurvey>, verbose);
+}
+
+std::future<Result<std::vector<FaultEvent> > > GetFaultEvents(std::string filename, bool verbose)
+{
+    LPF_ASYNC_GET(filename, LoopProjectFile::GetFaultEvents, std::vector<FaultEvent>, verbose);
+}
+
+std::future<Result<std::vector<FoldEvent> > > GetFoldEvents(std::string filename, bool verbose)
+{
+    LPF_ASYNC_GET(filename, LoopProjectFile::GetFoldEvents, std::vector<FoldEvent>, verbose);
+}
+
+std::future<Result<std::vector<FoliationEvent> > > GetFoliationEvents(std::string filename, bool verbose)
+{
+    LPF_ASYNC_GET(filename, LoopProjectFile::GetFoliationEvents, std::vector<FoliationEvent>, verbose);
+}
+
+std::future<Result<std::vector<DiscontinuityEvent> > > GetDiscontinuityEvents(std::string filename, bool verbose)
+{
+    LPF_ASYNC_GET(filename, LoopProjectFile::GetDiscontinuityEvents, std::vector<DiscontinuityEvent>, verbose);
+}
+
+std::future<Result<std::vector<StratigraphicLayer> > > GetStratigraphicLayers(std::string filename, bool verbose)
+{
+    LPF_ASYNC_GET(filename, LoopProjectFile::GetStratigraphicLayers, std::vector<StratigraphicLayer>, verbose);
+}
+
+std::future<Result<std::vector<EventRelationship> > > GetEventRelationships(std::string filename, bool verbose)
+{
+    LPF_ASYNC_GET(filename, LoopProjectFile::GetEventRelationships, std::vector<EventRelationship>, verbose);
+}
+
+std::future<Result<std::vector<DrillholeDescription> > > GetDrillholeDescriptions(std::string filename, bool verbose)
+{
+    LPF_ASYNC_GET(filename, LoopProjectFile::GetDrillholeDescriptions, std::vector<DrillholeDescription>, verbose);
+}
+
+std::future<Result<ModelData> > GetStructuralModel(std::string filename, int index, bool verbose)
+{
+    LPF_ASYNC_GET_MODEL(filename, LoopProjectFile::GetStructuralModel, index, verbose);
+}
+
+std::future<Result<ModelData> > GetGeophysicalModel(std::string filename, int index, bool verbose)
+{
+    LPF_ASYNC_GET_MODEL(filename, LoopProjectFile::GetGeophysicalModel, index, verbose);
+}
+
+std::future<Result<ModelData> > GetUncertaintyModel(std::string filename, int index, bool verbose)
+{
+    LPF_ASYNC_GET_MODEL(filename, LoopProjectFile::GetUncertaintyModel, index, verbose);
+}
+
+std::future<LoopProjectFileResponse> SetExtents(std::string filename, LoopExtents data, bool verbose)
+{
+    LPF_ASYNC_SET(filename, LoopProjectFile::SetExtents, LoopExtents, data, verbose);
+}
+
+std::future<LoopProjectFileResponse> SetDataCollectionConfiguration(std::string filename, DataCollectionConfiguration data, bool verbose)
+{
+    LPF_ASYNC_SET(filename, LoopProjectFile::SetDataCollectionConfiguration, DataCollectionConfiguration, data, verbose);
+}
+
+std::future<LoopProjectFileResponse> SetDataCollectionSources(std::string filename, DataCollectionSources data, bool verbose)
+{
+    LPF_ASYNC_SET(filename, LoopProjectFile::SetDataCollectionSources, DataCollectionSources, data, verbose);
+}
+
+std::future<LoopProjectFileResponse> SetStructuralModelsConfiguration(std::string filename, StructuralModelsConfiguration data, bool verbose)
+{
+    LPF_ASYNC_SET(filename, LoopProjectFile::SetStructuralModelsConfiguration, StructuralModelsConfiguration, data, verbose);
+}
+
+std::future<LoopProjectFileResponse> SetFaultObservations(std::string filename, std::vector<FaultObservation> data, bool verbose)
+{
+    LPF_ASYNC_SET(filename, LoopProjectFile::SetFaultObservations, std::vector<FaultObservation>, data, verbose);
+}
+
+std::future<LoopProjectFileResponse> SetFoldObservations(std::string filename, std::vector<FoldObservation> data, bool verbose)
+{
+    LPF_ASYNC_SET(filename, LoopProjectFile::SetFoldObservations, std::vector<FoldObservation>, data, verbose);
+}
+
+std::future<LoopProjectFileResponse> SetFoliationObservations(std::string filename, std::vector<FoliationObservation> data, bool verbose)
+{
+    LPF_ASYNC_SET(filename, LoopProjectFile::SetFoliationObservations, std::vector<FoliationObservation>, data, verbose);
+}
+
+std::future<LoopProjectFileResponse> SetDiscontinuityObservations(std::string filename, std::vector<DiscontinuityObservation> data, bool verbose)
+{
+    LPF_ASYNC_SET(filename, LoopProjectFile::SetDiscontinuityObservations, std::vector<DiscontinuityObservation>, data, verbose);
+}
+
+std::future<LoopProjectFileResponse> SetStratigraphicObservations(std::string filename, std::vector<StratigraphicObservation> data, bool verbose)
+{
+    LPF_ASYNC_SET(filename, LoopProjectFile::SetStratigraphicObservations, std::vector<StratigraphicObservation>, data, verbose);
+}
+
+std::future<LoopProjectFileResponse> SetContacts(std::string filename, std::vector<ContactObservation> data, bool verbose)
+{
+    LPF_ASYNC_SET(filename, LoopProjectFile::SetContacts, std::vector<ContactObservation>, data, verbose);
+}
+
+std::future<LoopProjectFileResponse> SetDrillholeObservations(std::string filename, std::vector<DrillholeObservation> data, bool verbose)
+{
+    LPF_ASYNC_SET(filename, LoopProjectFile::SetDrillholeObservations, std::vector<DrillholeObservation>, data, verbose);
+}
+
+std::future<LoopProjectFileResponse> SetDrillholeProperties(std::string filename, std::vector<DrillholeProperty> data, bool verbose)
+{
+    LPF_ASYNC_SET(filename, LoopProjectFile::SetDrillholeProperties, std::vector<DrillholeProperty>, data, verbose);
+}
+
+std::future<LoopProjectFileResponse> SetDrillholeSurveys(std::string filename, std::vector<DrillholeSurvey> data, bool verbose)
+{
+    LPF_ASYNC_SET(filename, LoopProjectFile::SetDrillholeSurveys, std::vector<DrillholeSurvey>, data, verbose);
+}
+
+std::future<LoopProjectFileResponse> SetFaultEvents(std::string filename, std::vector<FaultEvent> data, bool verbose)
+{
+    LPF_ASYNC_SET(filename, LoopProjectFile::SetFaultEvents, std::vector<FaultEvent>, data, verbose);
+}
+
+std::future<LoopProjectFileResponse> SetFoldEvents(std::string filename, std::vector<FoldEvent> data, bool verbose)
+{
+    LPF_ASYNC_SET(filename, LoopProjectFile::SetFoldEvents, std::vector<FoldEvent>, data, verbose);
+}
+
+std::future<LoopProjectFileResponse> SetFoliationEvents(std::string filename, std::vector<FoliationEvent> data, bool verbose)
+{
+    LPF_ASYNC_SET(filename, LoopProjectFile::SetFoliationEvents, std::vector<FoliationEvent>, data, verbose);
+}
+
+std::future<LoopProjectFileResponse> SetDiscontinuityEvents(std::string filename, std::vector<DiscontinuityEvent> data, bool verbose)
+{
+    LPF_ASYNC_SET(filename, LoopProjectFile::SetDiscontinuityEvents, std::vector<DiscontinuityEvent>, data, verbose);
+}
+
+std::future<LoopProjectFileResponse> SetStratigraphicLayers(std::string filename, std::vector<StratigraphicLayer> data, bool verbose)
+{
+    LPF_ASYNC_SET(filename, LoopProjectFile::SetStratigraphicLayers, std::vector<StratigraphicLayer>, data, verbose);
+}
+
+std::future<LoopProjectFileResponse> SetEventRelationships(std::string filename, std::vector<EventRelationship> data, bool verbose)
+{
+    LPF_ASYNC_SET(filename, LoopProjectFile::SetEventRelationships, std::vector<EventRelationship>, data, verbose);
+}
+
+std::future<LoopProjectFileResponse> SetDrillholeDescriptions(std::string filename, std::vector<DrillholeDescription> data, bool verbose)
+{
+    LPF_ASYNC_SET(filename, LoopProjectFile::SetDrillholeDescriptions, std::vector<DrillholeDescription>, data, verbose);
+}
+
+std::future<LoopProjectFileResponse> SetStructuralModel(std::string filename, std::vector<float> data, std::vector<int> dataShape, int index, bool verbose)
+{
+    LPF_ASYNC_SET_MODEL(filename, LoopProjectFile::SetStructuralModel, data, dataShape, index, verbose);
+}
+
+std::future<LoopProjectFileResponse> SetGeophysicalModel(std::string filename, std::vector<float> data, std::vector<int> dataShape, int index, bool verbose)
+{
+    LPF_ASYNC_SET_MODEL(filename, LoopProjectFile::SetGeophysicalModel, data, dataShape, index, verbose);
+}
+
+std::future<LoopProjectFileResponse> SetUncertaintyModel(std::string filename, std::vector<float> data, std::vector<int> dataShape, int index, bool verbose)
+{
+    LPF_ASYNC_SET_MODEL(filename, LoopProjectFile::SetUncertaintyModel, data, dataShape, index, verbose);
+}
+
+} // namespace Async
+} // namespace LoopProjectFile
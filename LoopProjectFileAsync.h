@@ -0,0 +1,251 @@
+#ifndef __LOOPPROJECTFILEASYNC_H
+#define __LOOPPROJECTFILEASYNC_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <type_traits>
+
+#include "LoopProjectFile.h"
+
+namespace LoopProjectFile {
+
+/*! \brief A fixed set of threads consuming a first in first out queue of tasks */
+class TaskQueue {
+public:
+    /*!
+     * \brief Constructor. Starts the worker threads
+     *
+     * \param numThreads - the number of threads servicing the queue (at least one is started)
+     */
+    explicit TaskQueue(unsigned int numThreads);
+
+    /*! \brief Destructor. Runs any tasks still queued then joins the worker threads */
+    ~TaskQueue();
+
+    /*!
+     * \brief Queues a callable to run on one of the worker threads
+     *
+     * \param task - the callable to run. Any exception it throws is rethrown by the returned future
+     *
+     * \return A future holding the value returned by the callable
+     */
+    template <typename F>
+    std::future<typename std::result_of<F()>::type> Submit(F task)
+    {
+        typedef typename std::result_of<F()>::type ResultType;
+        std::shared_ptr<std::packaged_task<ResultType()> > packaged(new std::packaged_task<ResultType()>(task));
+        std::future<ResultType> result = packaged->get_future();
+        Enqueue([packaged]() { (*packaged)(); });
+        return result;
+    }
+
+    /*! \brief The number of worker threads servicing this queue */
+    unsigned int GetThreadCount() const { return static_cast<unsigned int>(threads.size()); }
+
+    /*! \brief The number of tasks waiting to start */
+    size_t GetPendingCount();
+
+private:
+    void Enqueue(std::function<void()> task);
+    void Run();
+
+    std::vector<std::thread> threads;
+    std::deque<std::function<void()> > tasks;
+    std::mutex tasksMutex;
+    std::condition_variable tasksAvailable;
+    bool stopping;
+
+    TaskQueue(const TaskQueue&) = delete;
+    TaskQueue& operator=(const TaskQueue&) = delete;
+};
+
+/*! \brief Asynchronous variants of the loop project file getters and setters
+ *
+ * Every file operation is queued on a single dedicated I/O thread and runs under
+ * GetNetCDFMutex() so netCDF (which is not thread-safe) is only ever entered from one thread.
+ * While async operations are outstanding the synchronous functions must not be called from
+ * other threads without holding that lock; queue custom netCDF work with RunOnIOThread
+ * instead. The model getters compute the value range on the worker pool once the read is
+ * done, and further processing of the returned data can be overlapped with the next read by
+ * handing it to RunOnWorkerPool.
+ */
+namespace Async {
+
+    /*! \brief The outcome of an asynchronous get: the response and the data retrieved */
+    template <typename T>
+    struct Result {
+        LoopProjectFileResponse response; /*!< Success/fail of the retrieval with error message if it failed */
+        T data;                           /*!< The data retrieved from the project file */
+        Result() { response.errorCode = 0; }
+    };
+
+    /*! \brief A model, its dimensions (easting, northing, depth) and value range */
+    struct ModelData {
+        std::vector<float> data;      /*!< The model values */
+        std::vector<int> dataShape;   /*!< The dimensions of the model */
+        float minValue;               /*!< The smallest finite value in the model (0 if there are none) */
+        float maxValue;               /*!< The largest finite value in the model (0 if there are none) */
+        ModelData() : minValue(0), maxValue(0) {}
+    };
+
+    /*! \brief The queue with the single thread that performs all asynchronous netCDF access */
+    TaskQueue& GetIOQueue();
+
+    /*! \brief The queue with one thread per hardware thread for decoding and statistics work */
+    TaskQueue& GetWorkerPool();
+
+    /*! \brief The queue with the single thread that waits for operations passed to OnComplete */
+    TaskQueue& GetWaiterQueue();
+
+    /*!
+     * \brief Queues custom work on the netCDF I/O thread, serialised with all other async operations
+     *
+     * \param task - the callable to run
+     *
+     * \return A future holding the value returned by the callable
+     */
+    template <typename F>
+    std::future<typename std::result_of<F()>::type> RunOnIOThread(F task)
+    {
+        return GetIOQueue().Submit([task]() {
+            std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+            return task();
+        });
+    }
+
+    /*!
+     * \brief Queues work that does not touch netCDF on the worker pool
+     *
+     * \param task - the callable to run
+     *
+     * \return A future holding the value returned by the callable
+     */
+    template <typename F>
+    std::future<typename std::result_of<F()>::type> RunOnWorkerPool(F task)
+    {
+        return GetWorkerPool().Submit(task);
+    }
+
+    /*!
+     * \brief Runs a callback on the worker pool once an asynchronous operation completes. The
+     * wait happens on the waiter thread rather than a worker, so any number of chained callbacks
+     * can be outstanding without starving the pool. Operations are waited for in the order they
+     * are passed, which is the order the I/O thread completes them
+     *
+     * \param operation - the future returned by one of the async operations
+     * \param callback - the completion callback, given the result of the operation
+     */
+    template <typename T>
+    void OnComplete(std::future<T> operation, std::function<void(T)> callback)
+    {
+        std::shared_ptr<std::future<T> > pending(new std::future<T>(std::move(operation)));
+        GetWaiterQueue().Submit([pending, callback]() {
+            std::shared_ptr<T> result(new T(pending->get()));
+            GetWorkerPool().Submit([result, callback]() { callback(std::move(*result)); });
+        });
+    }
+
+    /*! @{
+     * \brief Queues retrieval of the specified data from the loop project file
+     *
+     * \param filename - the filename of the loop project file
+     * \param verbose - a flag to toggle verbose message printing
+     *
+     * \return A future holding the response and the data retrieved
+     */
+    std::future<Result<LoopExtents> > GetExtents(std::string filename, bool verbose=false);
+    std::future<Result<DataCollectionConfiguration> > GetDataCollectionConfiguration(std::string filename, bool verbose=false);
+    std::future<Result<DataCollectionSources> > GetDataCollectionSources(std::string filename, bool verbose=false);
+    std::future<Result<StructuralModelsConfiguration> > GetStructuralModelsConfiguration(std::string filename, bool verbose=false);
+    std::future<Result<std::vector<FaultObservation> > > GetFaultObservations(std::string filename, bool verbose=false);
+    std::future<Result<std::vector<FoldObservation> > > GetFoldObservations(std::string filename, bool verbose=false);
+    std::future<Result<std::vector<FoliationObservation> > > GetFoliationObservations(std::string filename, bool verbose=false);
+    std::future<Result<std::vector<DiscontinuityObservation> > > GetDiscontinuityObservations(std::string filename, bool verbose=false);
+    std::future<Result<std::vector<StratigraphicObservation> > > GetStratigraphicObservations(std::string filename, bool verbose=false);
+    std::future<Result<std::vector<ContactObservation> > > GetContacts(std::string filename, bool verbose=false);
+    std::future<Result<std::vector<DrillholeObservation> > > GetDrillholeObservations(std::string filename, bool verbose=false);
+    std::future<Result<std::vector<DrillholeProperty> > > GetDrillholeProperties(std::string filename, bool verbose=false);
+    std::future<Result<std::vector<DrillholeSurvey> > > GetDrillholeSurveys(std::string filename, bool verbose=false);
+    std::future<Result<std::vector<FaultEvent> > > GetFaultEvents(std::string filename, bool verbose=false);
+    std::future<Result<std::vector<FoldEvent> > > GetFoldEvents(std::string filename, bool verbose=false);
+    std::future<Result<std::vector<FoliationEvent> > > GetFoliationEvents(std::string filename, bool verbose=false);
+    std::future<Result<std::vector<DiscontinuityEvent> > > GetDiscontinuityEvents(std::string filename, bool verbose=false);
+    std::future<Result<std::vector<StratigraphicLayer> > > GetStratigraphicLayers(std::string filename, bool verbose=false);
+    std::future<Result<std::vector<EventRelationship> > > GetEventRelationships(std::string filename, bool verbose=false);
+    std::future<Result<std::vector<DrillholeDescription> > > GetDrillholeDescriptions(std::string filename, bool verbose=false);
+    /*!@}*/
+
+    /*! @{
+     * \brief Queues retrieval of a model from the loop project file
+     *
+     * \param filename - the filename of the loop project file
+     * \param index - the index location for the data
+     * \param verbose - a flag to toggle verbose message printing
+     *
+     * \return A future holding the response, the model data, its dimensions and value range. The
+     * read holds the I/O thread only; the value range is computed afterwards on the worker pool
+     */
+    std::future<Result<ModelData> > GetStructuralModel(std::string filename, int index, bool verbose=false);
+    std::future<Result<ModelData> > GetGeophysicalModel(std::string filename, int index, bool verbose=false);
+    std::future<Result<ModelData> > GetUncertaintyModel(std::string filename, int index, bool verbose=false);
+    /*!@}*/
+
+    /*! @{
+     * \brief Queues adding or overriding specified data in the loop project file. The data is
+     * moved into the queued operation so the caller may discard its copy immediately
+     *
+     * \param filename - the filename of the loop project file
+     * \param data - the data to be added
+     * \param verbose - a flag to toggle verbose message printing
+     *
+     * \return A future holding the response with success/fail of data insertion
+     */
+    std::future<LoopProjectFileResponse> SetExtents(std::string filename, LoopExtents data, bool verbose=false);
+    std::future<LoopProjectFileResponse> SetDataCollectionConfiguration(std::string filename, DataCollectionConfiguration data, bool verbose=false);
+    std::future<LoopProjectFileResponse> SetDataCollectionSources(std::string filename, DataCollectionSources data, bool verbose=false);
+    std::future<LoopProjectFileResponse> SetStructuralModelsConfiguration(std::string filename, StructuralModelsConfiguration data, bool verbose=false);
+    std::future<LoopProjectFileResponse> SetFaultObservations(std::string filename, std::vector<FaultObservation> data, bool verbose=false);
+    std::future<LoopProjectFileResponse> SetFoldObservations(std::string filename, std::vector<FoldObservation> data, bool verbose=false);
+    std::future<LoopProjectFileResponse> SetFoliationObservations(std::string filename, std::vector<FoliationObservation> data, bool verbose=false);
+    std::future<LoopProjectFileResponse> SetDiscontinuityObservations(std::string filename, std::vector<DiscontinuityObservation> data, bool verbose=false);
+    std::future<LoopProjectFileResponse> SetStratigraphicObservations(std::string filename, std::vector<StratigraphicObservation> data, bool verbose=false);
+    std::future<LoopProjectFileResponse> SetContacts(std::string filename, std::vector<ContactObservation> data, bool verbose=false);
+    std::future<LoopProjectFileResponse> SetDrillholeObservations(std::string filename, std::vector<DrillholeObservation> data, bool verbose=false);
+    std::future<LoopProjectFileResponse> SetDrillholeProperties(std::string filename, std::vector<DrillholeProperty> data, bool verbose=false);
+    std::future<LoopProjectFileResponse> SetDrillholeSurveys(std::string filename, std::vector<DrillholeSurvey> data, bool verbose=false);
+    std::future<LoopProjectFileResponse> SetFaultEvents(std::string filename, std::vector<FaultEvent> data, bool verbose=false);
+    std::future<LoopProjectFileResponse> SetFoldEvents(std::string filename, std::vector<FoldEvent> data, bool verbose=false);
+    std::future<LoopProjectFileResponse> SetFoliationEvents(std::string filename, std::vector<FoliationEvent> data, bool verbose=false);
+    std::future<LoopProjectFileResponse> SetDiscontinuityEvents(std::string filename, std::vector<DiscontinuityEvent> data, bool verbose=false);
+    std::future<LoopProjectFileResponse> SetStratigraphicLayers(std::string filename, std::vector<StratigraphicLayer> data, bool verbose=false);
+    std::future<LoopProjectFileResponse> SetEventRelationships(std::string filename, std::vector<EventRelationship> data, bool verbose=false);
+    std::future<LoopProjectFileResponse> SetDrillholeDescriptions(std::string filename, std::vector<DrillholeDescription> data, bool verbose=false);
+    /*!@}*/
+
+    /*! @{
+     * \brief Queues adding or overriding a model in the loop project file
+     *
+     * \param filename - the filename of the loop project file
+     * \param data - the model data to be added
+     * \param dataShape - the dimensions of the data being added
+     * \param index - the index location for the data
+     * \param verbose - a flag to toggle verbose message printing
+     *
+     * \return A future holding the response with success/fail of data insertion
+     */
+    std::future<LoopProjectFileResponse> SetStructuralModel(std::string filename, std::vector<float> data, std::vector<int> dataShape, int index, bool verbose=false);
+    std::future<LoopProjectFileResponse> SetGeophysicalModel(std::string filename, std::vector<float> data, std::vector<int> dataShape, int index, bool verbose=false);
+    std::future<LoopProjectFileResponse> SetUncertaintyModel(std::string filename, std::vector<float> data, std::vector<int> dataShape, int index, bool verbose=false);
+    /*!@}*/
+
+} // namespace Async
+} // namespace LoopProjectFile
+
+#endif
@@ -0,0 +1,153 @@
+#include "LoopProjectFileMetrics.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <mutex>
+
+namespace LoopProjectFile {
+namespace Metrics {
+
+std::atomic<bool> metricsEnabled(false);
+
+static std::mutex metricsMutex;
+static std::map<std::string, MetricsEntry> functionMetrics;
+static std::map<std::string, MetricsEntry> variableMetrics;
+
+// The innermost instrumented call on each thread, which transfers are attributed to
+static thread_local ScopedCall* currentCall = NULL;
+
+void Enable(bool enable)
+{
+    metricsEnabled.store(enable, std::memory_order_relaxed);
+}
+
+void Reset()
+{
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    functionMetrics.clear();
+    variableMetrics.clear();
+}
+
+std::map<std::string, MetricsEntry> GetFunctionMetrics()
+{
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    return functionMetrics;
+}
+
+std::map<std::string, MetricsEntry> GetVariableMetrics()
+{
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    return variableMetrics;
+}
+
+bool GetMetrics(std::string name, MetricsEntry& entry)
+{
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    auto it = functionMetrics.find(name);
+    if (it != functionMetrics.end()) {
+        entry = it->second;
+        return true;
+    }
+    it = variableMetrics.find(name);
+    if (it != variableMetrics.end()) {
+        entry = it->second;
+        return true;
+    }
+    return false;
+}
+
+static void AppendEntries(std::ostringstream& out, const std::map<std::string, MetricsEntry>& entries)
+{
+    out << "{";
+    for (auto it=entries.begin(); it!=entries.end(); it++) {
+        if (it != entries.begin()) out << ",";
+        const MetricsEntry& entry = it->second;
+        out << "\n    \"" << it->first << "\": {\"calls\": " << entry.calls
+            << ", \"seconds\": " << entry.seconds
+            << ", \"bytesRead\": " << entry.bytesRead
+            << ", \"bytesWritten\": " << entry.bytesWritten
+            << ", \"recordsRead\": " << entry.recordsRead
+            << ", \"recordsWritten\": " << entry.recordsWritten << "}";
+    }
+    out << (entries.empty() ? "}" : "\n  }");
+}
+
+std::string ToJson()
+{
+    std::ostringstream out;
+    out.precision(9);
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    out << "{\n  \"functions\": ";
+    AppendEntries(out, functionMetrics);
+    out << ",\n  \"variables\": ";
+    AppendEntries(out, variableMetrics);
+    out << "\n}\n";
+    return out.str();
+}
+
+LoopProjectFileResponse DumpJson(std::string filename, bool verbose)
+{
+    LoopProjectFileResponse resp = {0,""};
+    std::ofstream file(filename.c_str());
+    if (!file) return createErrorMsg(1,"Failed to open metrics file " + filename,verbose);
+    file << ToJson();
+    if (!file) resp = createErrorMsg(1,"Failed to write metrics file " + filename,verbose);
+    else if (verbose) std::cout << "Metrics written to " << filename << std::endl;
+    return resp;
+}
+
+std::string VariablePath(const netCDF::NcVar& var)
+{
+    std::string groupPath = var.getParentGroup().getName(true);
+    if (groupPath.empty() || groupPath[groupPath.size()-1] != '/') groupPath += "/";
+    return groupPath + var.getName();
+}
+
+void RecordTransfer(const std::string& variable, size_t bytesRead, size_t bytesWritten, size_t recordsRead, size_t recordsWritten)
+{
+    if (currentCall) currentCall->AddTransfer(bytesRead, bytesWritten, recordsRead, recordsWritten);
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    MetricsEntry& entry = variableMetrics[variable];
+    entry.calls++;
+    entry.bytesRead += bytesRead;
+    entry.bytesWritten += bytesWritten;
+    entry.recordsRead += recordsRead;
+    entry.recordsWritten += recordsWritten;
+}
+
+ScopedCall::ScopedCall(const char* name)
+    : name(name),
+      active(IsEnabled()),
+      parent(NULL)
+{
+    if (!active) return;
+    parent = currentCall;
+    currentCall = this;
+    start = std::chrono::steady_clock::now();
+}
+
+ScopedCall::~ScopedCall()
+{
+    if (!active) return;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    currentCall = parent;
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    MetricsEntry& entry = functionMetrics[name];
+    entry.calls++;
+    entry.seconds += seconds;
+    entry.bytesRead += totals.bytesRead;
+    entry.bytesWritten += totals.bytesWritten;
+    entry.recordsRead += totals.recordsRead;
+    entry.recordsWritten += totals.recordsWritten;
+}
+
+void ScopedCall::AddTransfer(size_t bytesRead, size_t bytesWritten, size_t recordsRead, size_t recordsWritten)
+{
+    totals.bytesRead += bytesRead;
+    totals.bytesWritten += bytesWritten;
+    totals.recordsRead += recordsRead;
+    totals.recordsWritten += recordsWritten;
+}
+
+} // namespace Metrics
+} // namespace LoopProjectFile
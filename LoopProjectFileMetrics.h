@@ -0,0 +1,129 @@
+#ifndef __LOOPPROJECTFILEMETRICS_H
+#define __LOOPPROJECTFILEMETRICS_H
+
+#include <netcdf>
+#include <string>
+#include <map>
+#include <atomic>
+#include <chrono>
+
+#include "LoopProjectFileUtils.h"
+
+namespace LoopProjectFile {
+namespace Metrics {
+
+/*! \brief Accumulated counters for one API function or one netCDF variable */
+struct MetricsEntry {
+    unsigned long long calls;          /*!< Number of calls (functions) or transfers (variables) */
+    double seconds;                    /*!< Total wall time spent in the function (functions only) */
+    unsigned long long bytesRead;      /*!< Bytes read from the project file */
+    unsigned long long bytesWritten;   /*!< Bytes written to the project file */
+    unsigned long long recordsRead;    /*!< Records (or model voxels) read */
+    unsigned long long recordsWritten; /*!< Records (or model voxels) written */
+    MetricsEntry() : calls(0), seconds(0.0), bytesRead(0), bytesWritten(0), recordsRead(0), recordsWritten(0) {}
+};
+
+/*! \brief The collection flag, read directly by IsEnabled() so disabled metrics cost one relaxed load */
+extern std::atomic<bool> metricsEnabled;
+
+/*! \brief Whether metrics are currently being collected */
+inline bool IsEnabled() { return metricsEnabled.load(std::memory_order_relaxed); }
+
+/*!
+ * \brief Turns metrics collection on or off. Collection is off by default
+ *
+ * \param enable - whether to collect metrics
+ */
+void Enable(bool enable = true);
+
+/*! \brief Discards all collected metrics */
+void Reset();
+
+/*! \brief A copy of the per API function metrics keyed by function name */
+std::map<std::string, MetricsEntry> GetFunctionMetrics();
+
+/*! \brief A copy of the per variable metrics keyed by full variable path (e.g. /DataCollection/Observations/faultObservations) */
+std::map<std::string, MetricsEntry> GetVariableMetrics();
+
+/*!
+ * \brief Queries the metrics of a single function or variable
+ *
+ * \param name - the function name or full variable path
+ * \param entry - a reference to where the metrics are to be copied
+ *
+ * \return Whether any metrics have been recorded under that name
+ */
+bool GetMetrics(std::string name, MetricsEntry& entry);
+
+/*! \brief All collected metrics as a JSON document with "functions" and "variables" objects */
+std::string ToJson();
+
+/*!
+ * \brief Writes the collected metrics as JSON to a file
+ *
+ * \param filename - the file to write
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of writing the file with an error message if it failed
+ */
+LoopProjectFileResponse DumpJson(std::string filename, bool verbose = false);
+
+/*!
+ * \brief Records a transfer against a variable and against the innermost API call active on
+ * this thread. Callers should check IsEnabled() first (the RecordRead/RecordWrite helpers do)
+ *
+ * \param variable - the full path of the variable
+ * \param bytesRead - bytes read from the file
+ * \param bytesWritten - bytes written to the file
+ * \param recordsRead - records read from the file
+ * \param recordsWritten - records written to the file
+ */
+void RecordTransfer(const std::string& variable, size_t bytesRead, size_t bytesWritten, size_t recordsRead, size_t recordsWritten);
+
+/*! \brief The full path of a netCDF variable as used for the variable metrics keys */
+std::string VariablePath(const netCDF::NcVar& var);
+
+/*! @{ \brief Record a read or write of records of type T (or model voxels) from a netCDF variable */
+template <typename T>
+inline void RecordRead(const netCDF::NcVar& var, size_t records)
+{
+    if (IsEnabled()) RecordTransfer(VariablePath(var), records * sizeof(T), 0, records, 0);
+}
+template <typename T>
+inline void RecordWrite(const netCDF::NcVar& var, size_t records)
+{
+    if (IsEnabled()) RecordTransfer(VariablePath(var), 0, records * sizeof(T), 0, records);
+}
+/*!@}*/
+
+/*! \brief Times an API function call and collects the transfers made during it
+ *
+ * Construct one at the top of an instrumented function (see LOOP_METRICS_CALL). When metrics
+ * are disabled at construction nothing else is done.
+ */
+class ScopedCall {
+public:
+    explicit ScopedCall(const char* name);
+    ~ScopedCall();
+
+    /*! \brief Adds a transfer to this call's totals */
+    void AddTransfer(size_t bytesRead, size_t bytesWritten, size_t recordsRead, size_t recordsWritten);
+
+private:
+    const char* name;
+    bool active;
+    std::chrono::steady_clock::time_point start;
+    ScopedCall* parent;
+    MetricsEntry totals;
+
+    ScopedCall(const ScopedCall&) = delete;
+    ScopedCall& operator=(const ScopedCall&) = delete;
+};
+
+} // namespace Metrics
+} // namespace LoopProjectFile
+
+/*! \brief Instruments the enclosing API function under its own name */
+#define LOOP_METRICS_CALL() LoopProjectFile::Metrics::ScopedCall loopMetricsCall(__func__)
+
+#endif
@@ -0,0 +1,120 @@
+#include "LoopProjectFileTrace.h"
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace LoopProjectFile {
+namespace Trace {
+
+std::atomic<bool> traceRecording(false);
+
+struct TraceEvent {
+    const char* name;
+    const char* category;
+    long long startMicroseconds;
+    long long durationMicroseconds;
+    unsigned int threadId;
+};
+
+static std::mutex traceMutex;
+static std::vector<TraceEvent> traceEvents;
+static std::map<std::thread::id, unsigned int> traceThreadIds;
+static std::string traceFilename;
+static std::chrono::steady_clock::time_point traceStart;
+
+bool IsCompiledIn()
+{
+#ifdef LOOP_TRACING
+    return true;
+#else
+    return false;
+#endif
+}
+
+LoopProjectFileResponse Start(std::string filename, bool verbose)
+{
+    LoopProjectFileResponse resp = {0,""};
+    if (!IsCompiledIn()) return createErrorMsg(1,"Tracing is not compiled in, rebuild with LOOP_TRACING defined",verbose);
+    std::lock_guard<std::mutex> lock(traceMutex);
+    if (IsRecording()) return createErrorMsg(1,"A trace is already being recorded to " + traceFilename,verbose);
+    traceEvents.clear();
+    traceThreadIds.clear();
+    traceFilename = filename;
+    traceStart = std::chrono::steady_clock::now();
+    traceRecording.store(true);
+    return resp;
+}
+
+static void WriteString(std::ofstream& file, const char* value)
+{
+    file << '"';
+    for (const char* c=value; *c; c++) {
+        if (*c == '"' || *c == '\\') file << '\\';
+        file << *c;
+    }
+    file << '"';
+}
+
+LoopProjectFileResponse Stop(bool verbose)
+{
+    LoopProjectFileResponse resp = {0,""};
+    traceRecording.store(false);
+    std::lock_guard<std::mutex> lock(traceMutex);
+    if (traceFilename.empty()) return createErrorMsg(1,"No trace is being recorded",verbose);
+    std::ofstream file(traceFilename.c_str());
+    if (!file) {
+        resp = createErrorMsg(1,"Failed to open trace file " + traceFilename,verbose);
+    } else {
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        for (size_t i=0; i<traceEvents.size(); i++) {
+            const TraceEvent& event = traceEvents[i];
+            file << (i ? ",\n" : "\n") << "{\"name\":";
+            WriteString(file, event.name);
+            file << ",\"cat\":";
+            WriteString(file, event.category);
+            file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.threadId
+                << ",\"ts\":" << event.startMicroseconds << ",\"dur\":" << event.durationMicroseconds << "}";
+        }
+        file << "\n]}\n";
+        if (!file) resp = createErrorMsg(1,"Failed to write trace file " + traceFilename,verbose);
+        else if (verbose) std::cout << traceEvents.size() << " trace events written to " << traceFilename << std::endl;
+    }
+    traceEvents.clear();
+    traceThreadIds.clear();
+    traceFilename.clear();
+    return resp;
+}
+
+Span::Span(const char* name, const char* category)
+    : name(name),
+      category(category),
+      active(IsRecording())
+{
+    if (active) start = std::chrono::steady_clock::now();
+}
+
+Span::~Span()
+{
+    if (!active) return;
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(traceMutex);
+    // The trace may have been stopped (and restarted) while this span was open
+    if (!IsRecording() || start < traceStart) return;
+    TraceEvent event;
+    event.name = name;
+    event.category = category;
+    event.startMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(start - traceStart).count();
+    event.durationMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    auto it = traceThreadIds.find(std::this_thread::get_id());
+    if (it == traceThreadIds.end()) {
+        it = traceThreadIds.insert(std::make_pair(std::this_thread::get_id(), static_cast<unsigned int>(traceThreadIds.size() + 1))).first;
+    }
+    event.threadId = it->second;
+    traceEvents.push_back(event);
+}
+
+} // namespace Trace
+} // namespace LoopProjectFile
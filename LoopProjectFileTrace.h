@@ -0,0 +1,86 @@
+#ifndef __LOOPPROJECTFILETRACE_H
+#define __LOOPPROJECTFILETRACE_H
+
+#include <string>
+#include <atomic>
+#include <chrono>
+
+#include "LoopProjectFileUtils.h"
+
+namespace LoopProjectFile {
+namespace Trace {
+
+/*!
+ * \brief Starts recording trace spans. The spans are held in memory until Stop() writes them
+ * out as a Chrome trace-event JSON file that chrome://tracing and Perfetto can load.
+ * Spans are only recorded by builds compiled with LOOP_TRACING defined (the CMake option
+ * LOOP_ENABLE_TRACING), otherwise this returns an error
+ *
+ * \param filename - the trace file written by Stop()
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of starting the trace with an error message if it failed
+ */
+LoopProjectFileResponse Start(std::string filename, bool verbose = false);
+
+/*!
+ * \brief Stops recording and writes the recorded spans to the file given to Start()
+ *
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of writing the trace with an error message if it failed
+ */
+LoopProjectFileResponse Stop(bool verbose = false);
+
+/*! \brief Whether this build records trace spans */
+bool IsCompiledIn();
+
+/*! \brief The recording flag, read directly by IsRecording() */
+extern std::atomic<bool> traceRecording;
+
+/*! \brief Whether spans are currently being recorded */
+inline bool IsRecording() { return traceRecording.load(std::memory_order_relaxed); }
+
+/*! \brief Records the lifetime of a scope as a complete ("X") trace event
+ *
+ * Use the LOOP_TRACE_SPAN macros rather than constructing spans directly so that they
+ * compile away in builds without LOOP_TRACING.
+ */
+class Span {
+public:
+    /*!
+     * \brief Constructor
+     *
+     * \param name - the span name, which must outlive the span (normally a literal or __func__)
+     * \param category - the span category (api, open, io or stats)
+     */
+    Span(const char* name, const char* category);
+    ~Span();
+
+private:
+    const char* name;
+    const char* category;
+    bool active;
+    std::chrono::steady_clock::time_point start;
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+};
+
+} // namespace Trace
+} // namespace LoopProjectFile
+
+#define LOOP_TRACE_CONCAT_INNER(A,B) A##B
+#define LOOP_TRACE_CONCAT(A,B) LOOP_TRACE_CONCAT_INNER(A,B)
+
+#ifdef LOOP_TRACING
+/*! \brief Traces the enclosing scope under the given name and category */
+#define LOOP_TRACE_SPAN(NAME,CATEGORY) LoopProjectFile::Trace::Span LOOP_TRACE_CONCAT(loopTraceSpan,__LINE__)(NAME,CATEGORY)
+#else
+#define LOOP_TRACE_SPAN(NAME,CATEGORY) do {} while (0)
+#endif
+
+/*! \brief Traces the enclosing API function under its own name */
+#define LOOP_TRACE_FUNCTION() LOOP_TRACE_SPAN(__func__,"api")
+
+#endif
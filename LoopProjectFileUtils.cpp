@@ -1,6 +1,9 @@
 #include "LoopProjectFileUtils.h"
 #include <string>
 #include <iostream>
+#include <netcdf>
+#include <netcdf.h>
+#include <sys/stat.h>
 
 namespace LoopProjectFile {
  
@@ -11,4 +14,142 @@ LoopProjectFileResponse createErrorMsg(int errorCode, std::string errorMsg, bool
     return resp;
 }
 
+std::string GetModelGroupName(ModelType modelType)
+{
+    switch (modelType) {
+        case STRUCTURALMODEL: return "StructuralModels";
+        case GEOPHYSICALMODEL: return "GeophysicalModels";
+        case UNCERTAINTYMODEL: return "UncertaintyModels";
+        default: return "";
+    }
+}
+
+bool GetFileIdentity(const std::string& filename, FileIdentity& identity)
+{
+    struct stat buffer;
+    if (stat(filename.c_str(), &buffer) != 0) return false;
+    identity.device = static_cast<unsigned long long>(buffer.st_dev);
+    identity.inode = static_cast<unsigned long long>(buffer.st_ino);
+    identity.size = static_cast<unsigned long long>(buffer.st_size);
+#if defined(__APPLE__)
+    identity.modifiedSec = static_cast<long long>(buffer.st_mtimespec.tv_sec);
+    identity.modifiedNsec = static_cast<long long>(buffer.st_mtimespec.tv_nsec);
+#elif defined(_WIN32)
+    identity.modifiedSec = static_cast<long long>(buffer.st_mtime);
+    identity.modifiedNsec = 0;
+#else
+    identity.modifiedSec = static_cast<long long>(buffer.st_mtim.tv_sec);
+    identity.modifiedNsec = static_cast<long long>(buffer.st_mtim.tv_nsec);
+#endif
+    return true;
+}
+
+std::recursive_mutex& GetNetCDFMutex()
+{
+    static std::recursive_mutex netCDFMutex;
+    return netCDFMutex;
+}
+
+MetadataBatch::MetadataBatch(netCDF::NcGroup* group)
+    : ncid(group->getId()),
+      active(false)
+{
+    // NC_EINDEFINE means an outer batch (or the library) is already in define mode
+    active = nc_redef(ncid) == NC_NOERR;
+}
+
+MetadataBatch::~MetadataBatch()
+{
+    if (active) nc_enddef(ncid);
+}
+
+LoopProjectFileResponse MetadataBatch::Commit(bool verbose)
+{
+    LoopProjectFileResponse resp = {0,""};
+    if (!active) return resp;
+    active = false;
+    int status = nc_enddef(ncid);
+    // A write of variable data inside the batch already left define mode
+    if (status != NC_NOERR && status != NC_ENOTINDEFINE) resp = createErrorMsg(1,std::string("Failed to commit metadata: ") + nc_strerror(status),verbose);
+    return resp;
+}
+
+ProjectArena::ProjectArena(size_t blockSize)
+    : blockSize(blockSize)
+{
+}
+
+ProjectArena::~ProjectArena()
+{
+    Release();
+}
+
+void ProjectArena::AddBlock(size_t size)
+{
+    Block block;
+    block.memory = static_cast<char*>(::operator new(size));
+    block.size = size;
+    block.used = 0;
+    blocks.push_back(block);
+}
+
+void* ProjectArena::Allocate(size_t bytes, size_t alignment)
+{
+    if (bytes == 0) bytes = 1;
+    if (!blocks.empty()) {
+        Block& block = blocks.back();
+        size_t offset = (block.used + alignment - 1) & ~(alignment - 1);
+        if (offset + bytes <= block.size) {
+            block.used = offset + bytes;
+            return block.memory + offset;
+        }
+    }
+    // Blocks from operator new are aligned for any fundamental type
+    AddBlock(bytes > blockSize ? bytes : blockSize);
+    blocks.back().used = bytes;
+    return blocks.back().memory;
+}
+
+void ProjectArena::Reserve(size_t bytes)
+{
+    if (!blocks.empty() && blocks.back().size - blocks.back().used >= bytes) return;
+    AddBlock(bytes > blockSize ? bytes : blockSize);
+}
+
+void ProjectArena::Reset()
+{
+    if (blocks.empty()) return;
+    size_t largest = 0;
+    for (size_t i=1;i<blocks.size();i++) {
+        if (blocks[i].size > blocks[largest].size) largest = i;
+    }
+    for (size_t i=0;i<blocks.size();i++) {
+        if (i != largest) ::operator delete(blocks[i].memory);
+    }
+    Block kept = blocks[largest];
+    kept.used = 0;
+    blocks.clear();
+    blocks.push_back(kept);
+}
+
+void ProjectArena::Release()
+{
+    for (size_t i=0;i<blocks.size();i++) ::operator delete(blocks[i].memory);
+    blocks.clear();
+}
+
+size_t ProjectArena::GetBytesUsed() const
+{
+    size_t used = 0;
+    for (size_t i=0;i<blocks.size();i++) used += blocks[i].used;
+    return used;
+}
+
+size_t ProjectArena::GetBytesReserved() const
+{
+    size_t reserved = 0;
+    for (size_t i=0;i<blocks.size();i++) reserved += blocks[i].size;
+    return reserved;
+}
+
 }; // namespace LoopProjectFile
\ No newline at end of file
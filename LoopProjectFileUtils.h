@@ -2,16 +2,28 @@
 #define __LOOPPROJECTFILEUTILS_H
 
 #include <string>
+#include <vector>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <mutex>
 
 #define LOOP_NAME_LENGTH 120
 #define LOOP_GROUP_NAME_LENGTH 120
 #define LOOP_SUPERGROUP_NAME_LENGTH 120
 #define LOOP_CONFIGURATION_DEFAULT_STRING_LENGTH 120
+#define LOOP_ARENA_DEFAULT_BLOCK_SIZE (16 * 1024 * 1024)
 
 #ifdef __linux__
 #define strncpy_s strncpy
 #endif
 
+namespace netCDF
+{
+    class NcGroup;
+}
+
 /*! \brief A structure for returning an error code and message for loop project files */
 struct LoopProjectFileResponse
 {
@@ -22,6 +34,153 @@ struct LoopProjectFileResponse
 namespace LoopProjectFile
 {
 
+    /*! \brief A tag type selecting the non-zeroing constructors of the record structures
+     *
+     * Records constructed with this tag are left uninitialised and must only be used as
+     * a destination buffer for a bulk read from a project file. User built records should
+     * always use the default (zeroing) constructors.
+     */
+    struct BulkLoad
+    {
+    };
+
+    /*! \brief A monotonic memory arena for decoded project contents
+     *
+     * Allocations are carved sequentially out of a few large blocks and are never freed
+     * individually. Everything is released together by Reset() (which keeps the largest
+     * block for the next load) or Release(). An arena is not thread safe.
+     */
+    class ProjectArena
+    {
+    public:
+        /*!
+         * \brief Constructor
+         *
+         * \param blockSize - the size of each block allocated when the current block is exhausted
+         */
+        explicit ProjectArena(size_t blockSize = LOOP_ARENA_DEFAULT_BLOCK_SIZE);
+        ~ProjectArena();
+
+        /*!
+         * \brief Allocates memory from the arena
+         *
+         * \param bytes - the number of bytes required
+         * \param alignment - the required alignment of the returned pointer (a power of two)
+         *
+         * \return A pointer to the allocated memory, valid until the arena is reset or released
+         */
+        void *Allocate(size_t bytes, size_t alignment);
+
+        /*!
+         * \brief Ensures the current block has at least the given number of bytes free so that
+         * the allocations that follow share a single block
+         *
+         * \param bytes - the number of bytes to have free
+         */
+        void Reserve(size_t bytes);
+
+        /*! \brief Discards every allocation, keeping the largest block for reuse */
+        void Reset();
+
+        /*! \brief Discards every allocation and frees all blocks */
+        void Release();
+
+        /*! @{ \brief Usage statistics of the arena */
+        size_t GetBytesUsed() const;
+        size_t GetBytesReserved() const;
+        size_t GetBlockCount() const { return blocks.size(); }
+        /*!@}*/
+
+    private:
+        struct Block
+        {
+            char *memory;
+            size_t size;
+            size_t used;
+        };
+        void AddBlock(size_t size);
+
+        std::vector<Block> blocks;
+        size_t blockSize;
+
+        ProjectArena(const ProjectArena &) = delete;
+        ProjectArena &operator=(const ProjectArena &) = delete;
+    };
+
+    /*! \brief An allocator that skips constructor work when a vector is resized
+     *
+     * Resizing a vector with this allocator constructs records with the BulkLoad tag (and
+     * leaves arithmetic types default initialised) so that the buffer is not zero filled
+     * immediately before netCDF overwrites it. Copies and explicit values are constructed
+     * as normal.
+     *
+     * When constructed with a ProjectArena the memory is taken from that arena and is only
+     * returned when the arena is reset or released.
+     */
+    template <typename T>
+    class BulkLoadAllocator : public std::allocator<T>
+    {
+    public:
+        typedef std::true_type propagate_on_container_copy_assignment;
+        typedef std::true_type propagate_on_container_move_assignment;
+        typedef std::true_type propagate_on_container_swap;
+
+        template <typename U>
+        struct rebind
+        {
+            typedef BulkLoadAllocator<U> other;
+        };
+
+        BulkLoadAllocator() : arena(NULL) {}
+        explicit BulkLoadAllocator(ProjectArena *projectArena) : arena(projectArena) {}
+        template <typename U>
+        BulkLoadAllocator(const BulkLoadAllocator<U> &other) : arena(other.GetArena()) {}
+
+        T *allocate(size_t n)
+        {
+            if (!arena)
+                return std::allocator<T>::allocate(n);
+            if (n > static_cast<size_t>(-1) / sizeof(T))
+                throw std::bad_alloc();
+            return static_cast<T *>(arena->Allocate(n * sizeof(T), alignof(T)));
+        }
+        void deallocate(T *ptr, size_t n)
+        {
+            if (!arena)
+                std::allocator<T>::deallocate(ptr, n);
+        }
+
+        template <typename U>
+        void construct(U *ptr)
+        {
+            BulkConstruct(ptr, typename std::is_class<U>::type());
+        }
+        template <typename U, typename... Args>
+        void construct(U *ptr, Args &&...args)
+        {
+            ::new ((void *)ptr) U(std::forward<Args>(args)...);
+        }
+
+        ProjectArena *GetArena() const { return arena; }
+
+    private:
+        template <typename U>
+        static void BulkConstruct(U *ptr, std::true_type) { ::new ((void *)ptr) U(BulkLoad()); }
+        template <typename U>
+        static void BulkConstruct(U *ptr, std::false_type) { ::new ((void *)ptr) U; }
+
+        ProjectArena *arena;
+    };
+
+    template <typename T, typename U>
+    bool operator==(const BulkLoadAllocator<T> &lhs, const BulkLoadAllocator<U> &rhs) { return lhs.GetArena() == rhs.GetArena(); }
+    template <typename T, typename U>
+    bool operator!=(const BulkLoadAllocator<T> &lhs, const BulkLoadAllocator<U> &rhs) { return lhs.GetArena() != rhs.GetArena(); }
+
+    /*! \brief A vector of records that is sized without zero filling, for use with the bulk getters */
+    template <typename T>
+    using BulkVector = std::vector<T, BulkLoadAllocator<T> >;
+
     /*!
      * \brief Utility function to create a Loop Project File Response
      *
@@ -33,6 +192,119 @@ namespace LoopProjectFile
      */
     LoopProjectFileResponse createErrorMsg(int errorCode, std::string errorMsg, bool echo = true);
 
+    /*! \brief The groups of gridded models held in a loop project file */
+    enum ModelType
+    {
+        INVALIDMODEL = -1,
+        STRUCTURALMODEL,
+        GEOPHYSICALMODEL,
+        UNCERTAINTYMODEL,
+        NUM_MODEL_TYPES
+    };
+
+    /*!
+     * \brief Gets the name of the netCDF group holding a type of model
+     *
+     * \param modelType - the type of model
+     *
+     * \return The group name or an empty string for an invalid model type
+     */
+    std::string GetModelGroupName(ModelType modelType);
+
+    /*! \brief The identity of one version of a file on disk. Rewriting or replacing the file
+     * changes its inode, size or modification time */
+    struct FileIdentity
+    {
+        unsigned long long device;  /*!< The device holding the file */
+        unsigned long long inode;   /*!< The inode of the file */
+        unsigned long long size;    /*!< The size of the file in bytes */
+        long long modifiedSec;      /*!< The modification time in seconds */
+        long long modifiedNsec;     /*!< The nanoseconds of the modification time (0 on platforms without them) */
+        bool operator==(const FileIdentity& other) const
+        {
+            return device == other.device && inode == other.inode && size == other.size
+                && modifiedSec == other.modifiedSec && modifiedNsec == other.modifiedNsec;
+        }
+        bool operator!=(const FileIdentity& other) const { return !(*this == other); }
+    };
+
+    /*!
+     * \brief Gets the identity of the current version of a file
+     *
+     * \param filename - the file to identify
+     * \param identity - a reference to return the identity
+     *
+     * \return Whether the file exists
+     */
+    bool GetFileIdentity(const std::string& filename, FileIdentity& identity);
+
+    /*!
+     * \brief Gets the process wide lock serialising netCDF/HDF5 calls made from library threads.
+     * netCDF-C is not thread safe so the async API, the model prefetcher and the reader pool all
+     * hold this lock while inside netCDF. Callers mixing their own threads with netCDF access
+     * should hold it too
+     *
+     * \return The netCDF lock
+     */
+    std::recursive_mutex& GetNetCDFMutex();
+
+    /*! \brief Commits a block of attribute writes as one metadata update
+     *
+     * Puts the file into define mode for the lifetime of the batch so that the attributes
+     * written are flushed to the file together when the batch is committed (or destroyed)
+     * rather than each write updating the object headers. Batches nest: a batch created while
+     * the file is already in define mode leaves it to the outer batch to commit.
+     */
+    class MetadataBatch
+    {
+    public:
+        /*!
+         * \brief Constructor. Enters define mode
+         *
+         * \param group - any group of the file being written
+         */
+        explicit MetadataBatch(netCDF::NcGroup *group);
+
+        /*! \brief Destructor. Commits the batch if Commit() was not called */
+        ~MetadataBatch();
+
+        /*!
+         * \brief Leaves define mode, writing the batched attributes
+         *
+         * \param verbose - a flag to toggle verbose message printing
+         *
+         * \return Response with success/fail of the commit with an error message if it failed
+         */
+        LoopProjectFileResponse Commit(bool verbose = false);
+
+    private:
+        int ncid;
+        bool active;
+
+        MetadataBatch(const MetadataBatch &) = delete;
+        MetadataBatch &operator=(const MetadataBatch &) = delete;
+    };
+
+    /*!
+     * \brief Reads an attribute from a map returned by getAtts(), so that a block of attributes is
+     * looked up with a single enumeration of the group rather than one lookup per attribute
+     *
+     * \param atts - the attributes of the group
+     * \param name - the attribute name
+     * \param value - where the attribute value is to be copied
+     *
+     * \return Whether the attribute was present
+     */
+    template <typename Atts, typename T>
+    bool GetAttributeValue(const Atts &atts, const std::string &name, T *value)
+    {
+        auto it = atts.find(name);
+        if (it == atts.end())
+            return false;
+        it->second.getValues(value);
+        return true;
+    }
+
 }; // namespace LoopProjectFile
 
 #endif
@@ -0,0 +1,238 @@
+#include "LoopProjectIntegrity.h"
+#include "LoopProjectFile.h"
+#include "LoopProjectFileAsync.h"
+#include "LoopRecordTables.h"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+
+namespace LoopProjectFile {
+
+size_t IntegrityReport::GetOrphanCount() const
+{
+    size_t total = 0;
+    for (auto it=checks.begin(); it!=checks.end(); it++) total += it->orphans;
+    return total;
+}
+
+void IdSet::Build(const std::vector<long long>& ids)
+{
+    bitmap.clear();
+    hashed.clear();
+    minId = 0;
+    if (ids.empty()) return;
+    auto bounds = std::minmax_element(ids.begin(), ids.end());
+    minId = *bounds.first;
+    unsigned long long span = static_cast<unsigned long long>(*bounds.second - *bounds.first) + 1;
+    if (span / 64 <= ids.size()) {
+        bitmap.assign(static_cast<size_t>(span), false);
+        for (auto it=ids.begin(); it!=ids.end(); it++) bitmap[static_cast<size_t>(*it - minId)] = true;
+    } else {
+        hashed.reserve(ids.size());
+        hashed.insert(ids.begin(), ids.end());
+    }
+}
+
+// Drillhole surveys and properties store their collarId as a double
+static bool CollarIdToId(double collarId, long long& id)
+{
+    if (!(std::floor(collarId) == collarId) || std::fabs(collarId) > 9.0e15) return false;
+    id = static_cast<long long>(collarId);
+    return true;
+}
+
+// Reads the live records of a table in batches, holding the netCDF lock only for each read,
+// and hands each batch and the table position of its first record to the observer and a callback
+template <typename T, typename Callback>
+static bool ReadBatches(netCDF::NcGroup* rootNode, size_t batchSize, RecordBatchObserver* observer, Callback callback)
+{
+    netCDF::NcVar recordsVar;
+    std::vector<RecordStorage::RecordRange> ranges;
+    {
+        std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+        netCDF::NcGroup group;
+        if (!RecordStorage::FindGroup(rootNode, RecordTable<T>::GroupPath(), group)) return false;
+        auto vars = group.getVars();
+        auto var = vars.find(RecordTable<T>::Variable());
+        if (var == vars.end()) return false;
+        recordsVar = var->second;
+        RecordStorage::GetLiveRanges(recordsVar, ranges);
+    }
+    size_t index = 0;
+    for (auto it=ranges.begin(); it!=ranges.end(); it++) {
+        for (size_t pos=0; pos<it->count; pos+=batchSize) {
+            size_t numRead = std::min(batchSize, it->count - pos);
+            std::shared_ptr<BulkVector<T> > batch(new BulkVector<T>(numRead));
+            {
+                std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+                LOOP_TRACE_SPAN("CheckReferences","io");
+                std::vector<size_t> start; start.push_back(it->start + pos);
+                std::vector<size_t> count; count.push_back(numRead);
+                recordsVar.getVar(start,count,batch->data());
+                Metrics::RecordRead<T>(recordsVar,numRead);
+            }
+            if (observer) observer->OnBatch(batch->data(), batch->size(), index);
+            callback(batch, index);
+            index += numRead;
+        }
+    }
+    return true;
+}
+
+// Gathers the identifiers of a referenced table
+template <typename T, typename GetId>
+static bool GatherIds(netCDF::NcGroup* rootNode, size_t batchSize, RecordBatchObserver* observer, GetId getId, std::vector<long long>& ids)
+{
+    return ReadBatches<T>(rootNode, batchSize, observer, [&ids, getId](std::shared_ptr<BulkVector<T> > batch, size_t) {
+        for (auto it=batch->begin(); it!=batch->end(); it++) ids.push_back(getId(*it));
+    });
+}
+
+template <typename T>
+static bool GatherEventIds(netCDF::NcGroup* rootNode, size_t batchSize, RecordBatchObserver* observer, std::vector<long long>& ids)
+{
+    return GatherIds<T>(rootNode, batchSize, observer, [](const T& e) { return static_cast<long long>(e.eventId); }, ids);
+}
+
+// The orphans found in one batch
+struct BatchOrphans {
+    size_t orphans;
+    std::vector<size_t> indices;
+};
+
+// Reads a referencing table in batches while the queue's threads look up each batch read
+template <typename T, typename IsOrphan>
+static void ScanTable(netCDF::NcGroup* rootNode, const std::string& member, const std::string& reference, bool referencePresent,
+    IsOrphan isOrphan, TaskQueue& queue, size_t batchSize, RecordBatchObserver* observer, IntegrityReport& report)
+{
+    OrphanReport check;
+    check.variable = RecordTable<T>::Variable();
+    check.member = member;
+    check.reference = reference;
+    check.referencePresent = referencePresent;
+    std::deque<std::future<BatchOrphans> > pending;
+    // Batches are collected in order so the orphan indices are the first in the table
+    auto collect = [&check, &pending]() {
+        BatchOrphans batchOrphans = pending.front().get();
+        pending.pop_front();
+        check.orphans += batchOrphans.orphans;
+        for (auto it=batchOrphans.indices.begin(); it!=batchOrphans.indices.end() && check.orphanIndices.size() < LOOP_INTEGRITY_MAX_ORPHAN_INDICES; it++) {
+            check.orphanIndices.push_back(*it);
+        }
+    };
+    bool present = ReadBatches<T>(rootNode, batchSize, observer, [&](std::shared_ptr<BulkVector<T> > batch, size_t firstIndex) {
+        check.records += batch->size();
+        pending.push_back(queue.Submit([batch, firstIndex, isOrphan]() {
+            BatchOrphans batchOrphans = {0, std::vector<size_t>()};
+            for (size_t i=0; i<batch->size(); i++) {
+                if (!isOrphan((*batch)[i])) continue;
+                if (batchOrphans.indices.size() < LOOP_INTEGRITY_MAX_ORPHAN_INDICES) batchOrphans.indices.push_back(firstIndex + i);
+                batchOrphans.orphans++;
+            }
+            return batchOrphans;
+        }));
+        // Bound the batches held in memory to a couple per thread
+        while (pending.size() > 2 * queue.GetThreadCount()) collect();
+    });
+    while (!pending.empty()) collect();
+    if (present) report.checks.push_back(check);
+}
+
+template <typename T>
+static void ScanEventIds(netCDF::NcGroup* rootNode, const IdSet& ids, const std::string& reference, bool referencePresent,
+    TaskQueue& queue, size_t batchSize, RecordBatchObserver* observer, IntegrityReport& report)
+{
+    const IdSet* idSet = &ids;
+    ScanTable<T>(rootNode, "eventId", reference, referencePresent,
+        [idSet](const T& o) { return !idSet->Contains(o.eventId); }, queue, batchSize, observer, report);
+}
+
+template <typename T>
+static void ScanCollarIds(netCDF::NcGroup* rootNode, const IdSet& ids, bool referencePresent,
+    TaskQueue& queue, size_t batchSize, RecordBatchObserver* observer, IntegrityReport& report)
+{
+    const IdSet* idSet = &ids;
+    ScanTable<T>(rootNode, "collarId", RecordTable<DrillholeDescription>::Variable(), referencePresent,
+        [idSet](const T& o) { long long id; return !CollarIdToId(o.collarId, id) || !idSet->Contains(id); }, queue, batchSize, observer, report);
+}
+
+LoopProjectFileResponse Integrity::CheckReferences(netCDF::NcGroup* rootNode, IntegrityReport& report, unsigned int numThreads, size_t batchSize, bool verbose, RecordBatchObserver* observer)
+{
+    report = IntegrityReport();
+    if (batchSize == 0) batchSize = LOOP_INTEGRITY_BATCH_RECORDS;
+    if (numThreads == 0) numThreads = std::thread::hardware_concurrency();
+    LoopProjectFileResponse resp = {0,""};
+    // The sets are declared before the queue so they outlive any lookups still running
+    IdSet faultEventIds, foldEventIds, foliationEventIds, discontinuityEventIds, layerIds, eventLogIds, collarIds;
+    try {
+        std::vector<long long> ids;
+        std::vector<long long> eventLog;
+        bool faultEventsPresent = GatherEventIds<FaultEvent>(rootNode, batchSize, observer, ids);
+        faultEventIds.Build(ids);
+        eventLog.insert(eventLog.end(), ids.begin(), ids.end());
+        ids.clear();
+        bool foldEventsPresent = GatherEventIds<FoldEvent>(rootNode, batchSize, observer, ids);
+        foldEventIds.Build(ids);
+        eventLog.insert(eventLog.end(), ids.begin(), ids.end());
+        ids.clear();
+        bool foliationEventsPresent = GatherEventIds<FoliationEvent>(rootNode, batchSize, observer, ids);
+        foliationEventIds.Build(ids);
+        eventLog.insert(eventLog.end(), ids.begin(), ids.end());
+        ids.clear();
+        bool discontinuityEventsPresent = GatherEventIds<DiscontinuityEvent>(rootNode, batchSize, observer, ids);
+        discontinuityEventIds.Build(ids);
+        eventLog.insert(eventLog.end(), ids.begin(), ids.end());
+        ids.clear();
+        bool layersPresent = GatherEventIds<StratigraphicLayer>(rootNode, batchSize, observer, ids);
+        layerIds.Build(ids);
+        eventLog.insert(eventLog.end(), ids.begin(), ids.end());
+        ids.clear();
+        eventLogIds.Build(eventLog);
+        eventLog.clear();
+        bool eventLogPresent = faultEventsPresent || foldEventsPresent || foliationEventsPresent || discontinuityEventsPresent || layersPresent;
+        bool collarsPresent = GatherIds<DrillholeDescription>(rootNode, batchSize, observer,
+            [](const DrillholeDescription& d) { return static_cast<long long>(d.collarId); }, ids);
+        collarIds.Build(ids);
+        ids.clear();
+
+        TaskQueue queue(numThreads);
+        ScanEventIds<FaultObservation>(rootNode, faultEventIds, RecordTable<FaultEvent>::Variable(), faultEventsPresent, queue, batchSize, observer, report);
+        ScanEventIds<FoldObservation>(rootNode, foldEventIds, RecordTable<FoldEvent>::Variable(), foldEventsPresent, queue, batchSize, observer, report);
+        ScanEventIds<FoliationObservation>(rootNode, foliationEventIds, RecordTable<FoliationEvent>::Variable(), foliationEventsPresent, queue, batchSize, observer, report);
+        ScanEventIds<DiscontinuityObservation>(rootNode, discontinuityEventIds, RecordTable<DiscontinuityEvent>::Variable(), discontinuityEventsPresent, queue, batchSize, observer, report);
+        ScanEventIds<StratigraphicObservation>(rootNode, layerIds, RecordTable<StratigraphicLayer>::Variable(), layersPresent, queue, batchSize, observer, report);
+        ScanEventIds<ContactObservation>(rootNode, layerIds, RecordTable<StratigraphicLayer>::Variable(), layersPresent, queue, batchSize, observer, report);
+        ScanEventIds<DrillholeObservation>(rootNode, collarIds, RecordTable<DrillholeDescription>::Variable(), collarsPresent, queue, batchSize, observer, report);
+        ScanCollarIds<DrillholeSurvey>(rootNode, collarIds, collarsPresent, queue, batchSize, observer, report);
+        ScanCollarIds<DrillholeProperty>(rootNode, collarIds, collarsPresent, queue, batchSize, observer, report);
+        const IdSet* eventLogSet = &eventLogIds;
+        ScanTable<EventRelationship>(rootNode, "eventId", "the event log", eventLogPresent,
+            [eventLogSet](const EventRelationship& r) { return !eventLogSet->Contains(r.eventId1) || !eventLogSet->Contains(r.eventId2); },
+            queue, batchSize, observer, report);
+    } catch (netCDF::exceptions::NcException& e) {
+        if (verbose) std::cout << e.what() << std::endl;
+        report = IntegrityReport();
+        resp = createErrorMsg(1,"Failed to read the tables of loop project file for the integrity check",verbose);
+    }
+    return resp;
+}
+
+LoopProjectFileResponse Integrity::CheckReferences(std::string filename, IntegrityReport& report, unsigned int numThreads, bool verbose)
+{
+    LOOP_METRICS_CALL();
+    LOOP_TRACE_FUNCTION();
+    report = IntegrityReport();
+    netCDF::NcFile file;
+    {
+        std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+        if (OpenProjectFile(filename, file, true, verbose)) return createErrorMsg(1,"Failure to open project file " + filename,verbose);
+    }
+    // The lock is only taken around each read so other threads' netCDF work can interleave
+    LoopProjectFileResponse resp = CheckReferences(&file, report, numThreads, LOOP_INTEGRITY_BATCH_RECORDS, verbose);
+    std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+    CloseProjectFile(&file);
+    return resp;
+}
+
+} // namespace LoopProjectFile
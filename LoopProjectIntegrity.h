@@ -0,0 +1,127 @@
+#ifndef __LOOPPROJECTINTEGRITY_H
+#define __LOOPPROJECTINTEGRITY_H
+
+#include <netcdf>
+#include <string>
+#include <vector>
+#include <unordered_set>
+
+#include "LoopProjectFileUtils.h"
+#include "LoopRecordTables.h"
+
+#define LOOP_INTEGRITY_BATCH_RECORDS (1 << 16)
+#define LOOP_INTEGRITY_MAX_ORPHAN_INDICES 100
+
+namespace LoopProjectFile {
+
+/*! \brief The records of one table whose references do not exist in the table they refer to */
+struct OrphanReport
+{
+    std::string variable;             /*!< The table holding the references (e.g. "faultObservations") */
+    std::string member;               /*!< The referencing member (e.g. "eventId" or "collarId") */
+    std::string reference;            /*!< What the references should exist in (e.g. "faultEvents") */
+    bool referencePresent;            /*!< Whether the referenced table has been written. Without it every record is an orphan */
+    size_t records;                   /*!< The number of records checked */
+    size_t orphans;                   /*!< The number of records with a missing reference */
+    std::vector<size_t> orphanIndices; /*!< The table positions of the first LOOP_INTEGRITY_MAX_ORPHAN_INDICES orphans */
+    /*! Constructor. Zeros all values */
+    OrphanReport() : referencePresent(false), records(0), orphans(0) {}
+};
+
+/*! \brief The outcome of a referential-integrity pass over a project file */
+struct IntegrityReport
+{
+    std::vector<OrphanReport> checks; /*!< One entry per referencing table present in the file */
+    /*! \brief The number of orphan records across every table */
+    size_t GetOrphanCount() const;
+};
+
+/*! \brief A set of identifiers built once and then queried concurrently without locking.
+ * Identifiers spanning a range no more than 64 times their number are held in a bitmap,
+ * anything sparser in a hash set
+ */
+class IdSet
+{
+public:
+    IdSet() : minId(0) {}
+
+    /*!
+     * \brief Builds the set, replacing its contents
+     *
+     * \param ids - the identifiers (may hold duplicates)
+     */
+    void Build(const std::vector<long long>& ids);
+
+    /*! \brief Whether the set holds an identifier */
+    bool Contains(long long id) const
+    {
+        if (!hashed.empty()) return hashed.find(id) != hashed.end();
+        return id >= minId && static_cast<unsigned long long>(id - minId) < bitmap.size() && bitmap[static_cast<size_t>(id - minId)];
+    }
+
+private:
+    long long minId;
+    std::vector<bool> bitmap;
+    std::unordered_set<long long> hashed;
+};
+
+/*! \brief Receives the batches of records read by Integrity::CheckReferences so further
+ * per-record checks can share its single pass over the tables instead of reading them again.
+ * OnBatch() is overloaded for every record type in LOOP_RECORD_TABLES and does nothing unless
+ * overridden. Each table's batches arrive in table order on the thread that called
+ * CheckReferences, while it holds no netCDF lock
+ */
+class RecordBatchObserver
+{
+public:
+    virtual ~RecordBatchObserver() {}
+
+#define LPF_BATCH_OBSERVER(TYPE,GROUP,VARIABLE,INDEX,GETTER,SETTER) \
+    virtual void OnBatch(const TYPE* records, size_t count, size_t firstIndex) { (void)records; (void)count; (void)firstIndex; }
+    LOOP_RECORD_TABLES(LPF_BATCH_OBSERVER)
+#undef LPF_BATCH_OBSERVER
+};
+
+/*! \brief Checks that the references between tables resolve
+ *
+ * Observation eventIds are checked against their event table (stratigraphic and contact
+ * observations against the stratigraphic layers), drillhole observation eventIds and drillhole
+ * survey and property collarIds against the drillhole descriptions, and both eventIds of every
+ * event relationship against the whole event log. The identifiers of each referenced table are
+ * gathered once into an IdSet; the referencing tables are then read in batches of live records
+ * while a pool of threads looks up the batches already read, so memory follows the batch size
+ * rather than the size of the tables. netCDF access is serialised by GetNetCDFMutex().
+ */
+namespace Integrity {
+
+/*!
+ * \brief Finds the orphan records of every referencing table in a project file
+ *
+ * \param rootNode - the rootNode of the netCDF Loop project file
+ * \param report - a reference to return an entry for each referencing table present
+ * \param numThreads - the number of threads looking up references (0 for one per hardware thread)
+ * \param batchSize - the number of records read per hyperslab
+ * \param verbose - a flag to toggle verbose message printing
+ * \param observer - given every batch read, or NULL
+ *
+ * \return Response with success/fail of reading the tables with error message if it failed
+ */
+LoopProjectFileResponse CheckReferences(netCDF::NcGroup* rootNode, IntegrityReport& report, unsigned int numThreads=0, size_t batchSize=LOOP_INTEGRITY_BATCH_RECORDS, bool verbose=false, RecordBatchObserver* observer=NULL);
+
+/*!
+ * \brief Finds the orphan records of every referencing table in a project file
+ *
+ * \param filename - the filename of the loop project file
+ * \param report - a reference to return an entry for each referencing table present
+ * \param numThreads - the number of threads looking up references (0 for one per hardware thread)
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of reading the tables with error message if it failed
+ */
+LoopProjectFileResponse CheckReferences(std::string filename, IntegrityReport& report, unsigned int numThreads=0, bool verbose=false);
+
+} // namespace Integrity
+
+} // namespace LoopProjectFile
+
+#endif
@@ -0,0 +1,160 @@
+#include "LoopProjectInventory.h"
+#include "LoopRecordTables.h"
+#include "LoopRecordStorage.h"
+#include "LoopModelStorage.h"
+#include "LoopProjectFileTrace.h"
+
+#include <iostream>
+
+#ifdef LOOP_HAVE_HDF5
+#include <hdf5.h>
+#endif
+
+namespace LoopProjectFile {
+
+size_t ModelInventory::GetModelBytes() const
+{
+    if (dataShape.size() != 3) return 0;
+    return static_cast<size_t>(dataShape[0]) * dataShape[1] * dataShape[2] * sizeof(float);
+}
+
+size_t ProjectInventory::GetDecodedTableBytes() const
+{
+    size_t total = 0;
+    for (auto it=tables.begin(); it!=tables.end(); it++) total += it->GetDecodedBytes();
+    return total;
+}
+
+size_t ProjectInventory::GetDecodedModelBytes() const
+{
+    size_t total = 0;
+    for (int i=0; i<NUM_MODEL_TYPES; i++) total += models[i].validIndices.size() * models[i].GetModelBytes();
+    return total;
+}
+
+// Fills the inventory of one record table from its dimension and tombstone count
+template <typename T>
+static void LoadTableInventory(netCDF::NcGroup* rootNode, TableInventory& table)
+{
+    table = TableInventory();
+    table.group = RecordTable<T>::GroupPath();
+    table.variable = RecordTable<T>::Variable();
+    table.recordSize = sizeof(T);
+    netCDF::NcGroup group;
+    if (!RecordStorage::FindGroup(rootNode, table.group, group)) return;
+    auto vars = group.getVars();
+    if (vars.find(table.variable) == vars.end()) return;
+    netCDF::NcVar var = group.getVar(table.variable);
+    table.present = true;
+    table.storedRecords = var.getDim(0).getSize();
+    table.records = RecordStorage::CountRecords(var);
+}
+
+// Fills the inventory of one model group from its dimensions and valid flags
+static LoopProjectFileResponse LoadModelInventory(netCDF::NcGroup* rootNode, ModelType modelType, ModelInventory& model, bool verbose)
+{
+    LoopProjectFileResponse resp = {0,""};
+    model = ModelInventory();
+    model.group = GetModelGroupName(modelType);
+    auto groups = rootNode->getGroups();
+    if (groups.find(model.group) == groups.end()) return resp;
+    netCDF::NcGroup modelGroup = rootNode->getGroup(model.group);
+    model.present = true;
+    model.dataShape.push_back(modelGroup.getDim("easting").getSize());
+    model.dataShape.push_back(modelGroup.getDim("northing").getSize());
+    model.dataShape.push_back(modelGroup.getDim("depth").getSize());
+    model.slots = modelGroup.getDim("index").getSize();
+    if (model.slots == 0) return resp;
+
+    std::vector<char> valid;
+    resp = ModelStorage::ListValidModels(modelGroup, valid, verbose);
+    for (size_t i=0; i<valid.size(); i++) {
+        if (valid[i]) model.validIndices.push_back(static_cast<unsigned int>(i));
+    }
+    return resp;
+}
+
+LoopProjectFileResponse Inventory::LoadInventory(netCDF::NcGroup* rootNode, ProjectInventory& inventory, bool verbose)
+{
+    LOOP_TRACE_SPAN("LoadInventory","io");
+    LoopProjectFileResponse resp = {0,""};
+    inventory.tables.clear();
+    inventory.storageSizesKnown = false;
+    try {
+#define LPF_INVENTORY_TABLE(TYPE,GROUP,VARIABLE,INDEX,GETTER,SETTER) \
+        inventory.tables.push_back(TableInventory()); \
+        LoadTableInventory<TYPE>(rootNode, inventory.tables.back());
+        LOOP_RECORD_TABLES(LPF_INVENTORY_TABLE)
+#undef LPF_INVENTORY_TABLE
+        for (int i=0; i<NUM_MODEL_TYPES && !resp.errorCode; i++) {
+            resp = LoadModelInventory(rootNode, static_cast<ModelType>(i), inventory.models[i], verbose);
+        }
+    } catch (netCDF::exceptions::NcException& e) {
+        if (verbose) std::cout << e.what() << std::endl;
+        resp = createErrorMsg(1, "Failed to take inventory of loop project file", verbose);
+    }
+    return resp;
+}
+
+#ifdef LOOP_HAVE_HDF5
+// Checks each component of a path so missing intermediate groups do not raise HDF5 errors
+static bool PathExists(hid_t file, std::string path)
+{
+    size_t pos = 1;
+    while (pos <= path.size()) {
+        size_t next = path.find('/', pos);
+        if (next == std::string::npos) next = path.size();
+        if (H5Lexists(file, path.substr(0, next).c_str(), H5P_DEFAULT) <= 0) return false;
+        pos = next + 1;
+    }
+    return true;
+}
+
+// Returns the allocated storage of a dataset given its full path or 0 if it does not exist
+static unsigned long long GetDatasetStorageSize(hid_t file, std::string path)
+{
+    if (!PathExists(file, path)) return 0;
+    hid_t dataset = H5Dopen2(file, path.c_str(), H5P_DEFAULT);
+    if (dataset < 0) return 0;
+    unsigned long long size = H5Dget_storage_size(dataset);
+    H5Dclose(dataset);
+    return size;
+}
+#endif
+
+LoopProjectFileResponse Inventory::LoadStorageSizes(std::string filename, ProjectInventory& inventory, bool verbose)
+{
+    LoopProjectFileResponse resp = {0,""};
+#ifdef LOOP_HAVE_HDF5
+    LOOP_TRACE_SPAN("LoadStorageSizes","io");
+    hid_t file = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+    if (file < 0) {
+        return createErrorMsg(1, "Failed to open " + filename + " to read storage sizes", verbose);
+    }
+    for (auto it=inventory.tables.begin(); it!=inventory.tables.end(); it++) {
+        it->storageBytes = 0;
+        if (!it->present) continue;
+        std::string path = "/" + it->group + "/" + it->variable;
+        it->storageBytes = GetDatasetStorageSize(file, path)
+            + GetDatasetStorageSize(file, path + LOOP_RECORD_TOMBSTONE_SUFFIX);
+    }
+    const char* modelVariables[] = {"data", "minVal", "maxVal", "valid"};
+    for (int i=0; i<NUM_MODEL_TYPES; i++) {
+        ModelInventory& model = inventory.models[i];
+        model.storageBytes = 0;
+        if (!model.present) continue;
+        for (size_t v=0; v<sizeof(modelVariables)/sizeof(modelVariables[0]); v++) {
+            model.storageBytes += GetDatasetStorageSize(file, "/" + model.group + "/" + modelVariables[v]);
+        }
+    }
+    H5Fclose(file);
+    inventory.storageSizesKnown = true;
+#else
+    (void)filename;
+    (void)verbose;
+    inventory.storageSizesKnown = false;
+#endif
+    return resp;
+}
+
+} // namespace LoopProjectFile
@@ -0,0 +1,94 @@
+#ifndef __LOOPPROJECTINVENTORY_H
+#define __LOOPPROJECTINVENTORY_H
+
+#include <netcdf>
+#include <string>
+#include <vector>
+
+#include "LoopProjectFileUtils.h"
+
+namespace LoopProjectFile
+{
+
+    /*! \brief The size of one record table */
+    struct TableInventory
+    {
+        std::string group;               /*!< The full group path of the table (e.g. "DataCollection/Observations") */
+        std::string variable;            /*!< The name of the table's variable */
+        bool present;                    /*!< Whether the table exists in the file */
+        size_t records;                  /*!< The number of records the getters return */
+        size_t storedRecords;            /*!< The number of records stored, including deleted records */
+        size_t recordSize;               /*!< The size of one decoded record in bytes */
+        unsigned long long storageBytes; /*!< The bytes the table occupies in the file */
+        /*! Constructor. Zeros all values */
+        TableInventory() : present(false), records(0), storedRecords(0), recordSize(0), storageBytes(0) {}
+        /*! \brief The memory needed to hold the decoded table */
+        size_t GetDecodedBytes() const { return records * recordSize; }
+    };
+
+    /*! \brief The size of one model group */
+    struct ModelInventory
+    {
+        std::string group;                      /*!< The name of the model group */
+        bool present;                           /*!< Whether the group exists in the file */
+        std::vector<int> dataShape;             /*!< The model grid (easting, northing, depth) */
+        size_t slots;                           /*!< The length of the index dimension */
+        std::vector<unsigned int> validIndices; /*!< The indices holding a model (every slot for groups without a valid flag) */
+        unsigned long long storageBytes;        /*!< The bytes the model data occupies in the file */
+        /*! Constructor. Zeros all values */
+        ModelInventory() : present(false), slots(0), storageBytes(0) {}
+        /*! \brief The memory needed to hold one decoded model */
+        size_t GetModelBytes() const;
+    };
+
+    /*! \brief The sizes of everything in a loop project file, for planning memory and sharding jobs
+     * before any data is read
+     */
+    struct ProjectInventory
+    {
+        std::string filename;                   /*!< The file the inventory was taken from */
+        unsigned long long fileBytes;           /*!< The size of the file */
+        bool storageSizesKnown;                 /*!< Whether the storage bytes were read (requires LOOP_HAVE_HDF5) */
+        std::vector<TableInventory> tables;     /*!< Every record table in LOOP_RECORD_TABLES order */
+        ModelInventory models[NUM_MODEL_TYPES]; /*!< Every model group, indexed by ModelType */
+        /*! Constructor. Zeros all values */
+        ProjectInventory() : fileBytes(0), storageSizesKnown(false) {}
+        /*! \brief The memory needed to decode every record table */
+        size_t GetDecodedTableBytes() const;
+        /*! \brief The memory needed to decode every valid model */
+        size_t GetDecodedModelBytes() const;
+    };
+
+    namespace Inventory
+    {
+
+        /*!
+         * \brief Takes an inventory of the record tables and model groups from the file metadata.
+         * Only the dimension lengths, deleted record counts and the model valid flags
+         * are read; storage sizes are left at zero
+         *
+         * \param rootNode - the rootNode of the netCDF Loop project file
+         * \param inventory - a reference to the inventory to fill
+         * \param verbose - a flag to toggle verbose message printing
+         *
+         * \return Response with success/fail of taking the inventory with an error message if it failed
+         */
+        LoopProjectFileResponse LoadInventory(netCDF::NcGroup *rootNode, ProjectInventory &inventory, bool verbose = false);
+
+        /*!
+         * \brief Fills in the storage bytes of the tables and models present in an inventory
+         * from the HDF5 dataset storage sizes. The file should not be open for writing. Without
+         * LOOP_HAVE_HDF5 this does nothing and storageSizesKnown stays false
+         *
+         * \param filename - the filename of the loop project file
+         * \param inventory - a reference to an inventory filled by LoadInventory
+         * \param verbose - a flag to toggle verbose message printing
+         *
+         * \return Response with success/fail of reading the sizes with an error message if it failed
+         */
+        LoopProjectFileResponse LoadStorageSizes(std::string filename, ProjectInventory &inventory, bool verbose = false);
+
+    } // namespace Inventory
+} // namespace LoopProjectFile
+
+#endif
@@ -0,0 +1,127 @@
+#include "LoopProjectReaderPool.h"
+#include "LoopProjectFile.h"
+
+namespace LoopProjectFile {
+
+// The handles of one pool keyed by the thread using them
+struct ProjectReaderPool::HandleTable {
+    std::map<std::thread::id, std::shared_ptr<netCDF::NcFile> > files;
+    std::mutex mutex;
+};
+
+// Held thread_local by each reading thread. Closes the thread's handle in every pool still
+// alive when the thread exits
+struct ProjectReaderPool::ThreadRelease {
+    std::vector<std::weak_ptr<HandleTable> > tables;
+
+    void Register(const std::shared_ptr<HandleTable>& table)
+    {
+        for (auto it=tables.begin(); it!=tables.end();) {
+            std::shared_ptr<HandleTable> registered = it->lock();
+            if (registered == table) return;
+            if (!registered) it = tables.erase(it);
+            else it++;
+        }
+        tables.push_back(table);
+    }
+
+    ~ThreadRelease()
+    {
+        for (auto it=tables.begin(); it!=tables.end(); it++) {
+            std::shared_ptr<HandleTable> table = it->lock();
+            if (!table) continue;
+            std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+            std::lock_guard<std::mutex> handlesLock(table->mutex);
+            auto file = table->files.find(std::this_thread::get_id());
+            if (file == table->files.end()) continue;
+            CloseProjectFile(file->second.get());
+            table->files.erase(file);
+        }
+    }
+};
+
+ProjectReaderPool::ProjectReaderPool()
+    : handles(new HandleTable()),
+      isOpen(false),
+      verbose(false)
+{
+}
+
+ProjectReaderPool::~ProjectReaderPool()
+{
+    Close();
+}
+
+LoopProjectFileResponse ProjectReaderPool::Open(std::string filename, bool verbose)
+{
+    Close();
+    this->filename = filename;
+    this->verbose = verbose;
+    isOpen = true;
+    netCDF::NcFile* handle = NULL;
+    LoopProjectFileResponse resp = GetHandle(handle);
+    if (resp.errorCode) Close();
+    return resp;
+}
+
+void ProjectReaderPool::Close()
+{
+    std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+    std::lock_guard<std::mutex> handlesLock(handles->mutex);
+    for (auto it=handles->files.begin(); it!=handles->files.end(); it++) CloseProjectFile(it->second.get());
+    handles->files.clear();
+    isOpen = false;
+}
+
+size_t ProjectReaderPool::GetHandleCount()
+{
+    std::lock_guard<std::mutex> handlesLock(handles->mutex);
+    return handles->files.size();
+}
+
+LoopProjectFileResponse ProjectReaderPool::GetHandle(netCDF::NcFile*& handle)
+{
+    LoopProjectFileResponse resp = {0,""};
+    if (!isOpen) return createErrorMsg(1,"Reader pool is not open",verbose);
+    {
+        std::lock_guard<std::mutex> handlesLock(handles->mutex);
+        auto it = handles->files.find(std::this_thread::get_id());
+        if (it != handles->files.end()) {
+            handle = it->second.get();
+            return resp;
+        }
+    }
+    // Only this thread adds its own entry so the handle can be opened without holding
+    // the handles mutex (a caller may already hold the netCDF lock)
+    std::shared_ptr<netCDF::NcFile> file(new netCDF::NcFile());
+    {
+        std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+        if (OpenProjectFile(filename, *file, true, verbose)) {
+            return createErrorMsg(1,"Failure to open project file " + filename,verbose);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> handlesLock(handles->mutex);
+        handles->files[std::this_thread::get_id()] = file;
+    }
+    static thread_local ThreadRelease release;
+    release.Register(handles);
+    handle = file.get();
+    return resp;
+}
+
+LoopProjectFileResponse ProjectReaderPool::ReadModel(ModelType modelType, unsigned int index, std::vector<float>& data, std::vector<int>& dataShape)
+{
+    netCDF::NcFile* handle = NULL;
+    LoopProjectFileResponse resp = GetHandle(handle);
+    if (resp.errorCode) return resp;
+    std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+    switch (modelType) {
+        case STRUCTURALMODEL: return StructuralModels::GetStructuralModel(handle, data, dataShape, index, verbose);
+        case GEOPHYSICALMODEL: return GeophysicalModels::GetGeophysicalModel(handle, data, dataShape, index, verbose);
+        case UNCERTAINTYMODEL: return UncertaintyModels::GetUncertaintyModel(handle, data, dataShape, index, verbose);
+        default: return createErrorMsg(1,"Invalid model type for reading",verbose);
+    }
+}
+
+} // namespace LoopProjectFile
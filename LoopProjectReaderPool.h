@@ -0,0 +1,101 @@
+#ifndef __LOOPPROJECTREADERPOOL_H
+#define __LOOPPROJECTREADERPOOL_H
+
+#include <netcdf>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "LoopProjectFileUtils.h"
+
+namespace LoopProjectFile {
+
+/*! \brief A thread-safe set of read only handles onto one loop project file
+ *
+ * Any number of threads may call Read() and ReadModel() concurrently. Each calling thread
+ * is given its own netCDF handle (opened on first use) so threads reading different groups
+ * or model indices do not share variable state or HDF5 chunk caches. netCDF-C itself is not
+ * thread safe so the calls into it are serialised by GetNetCDFMutex(); the lock is held only
+ * for the read itself, so work done on the returned data by each thread runs in parallel.
+ * A thread's handle is closed when the thread exits, so pools used from short lived threads
+ * do not accumulate handles. Open() and Close() must not be called while reads are in flight.
+ */
+class ProjectReaderPool {
+public:
+    ProjectReaderPool();
+
+    /*! \brief Destructor. Closes every handle */
+    ~ProjectReaderPool();
+
+    /*!
+     * \brief Opens the pool onto a project file. The calling thread's handle is opened immediately
+     *
+     * \param filename - the filename of the loop project file
+     * \param verbose - a flag to toggle verbose message printing
+     *
+     * \return Response with success/fail of opening the file with an error message if it failed
+     */
+    LoopProjectFileResponse Open(std::string filename, bool verbose = false);
+
+    /*! \brief Closes every handle in the pool */
+    void Close();
+
+    /*! \brief Whether the pool is open onto a project file */
+    bool IsOpen() const { return isOpen; }
+
+    /*! \brief The number of per-thread handles currently open */
+    size_t GetHandleCount();
+
+    /*!
+     * \brief Runs one of the module getters (e.g. DataCollection::GetFaultObservations) against
+     * the calling thread's handle
+     *
+     * \param getter - the module getter to run
+     * \param data - a reference to where the data is to be copied
+     *
+     * \return Response with success/fail of data retrieval with error message if it failed
+     */
+    template <typename Container>
+    LoopProjectFileResponse Read(LoopProjectFileResponse (*getter)(netCDF::NcGroup*, Container&, bool), Container& data)
+    {
+        netCDF::NcFile* handle = NULL;
+        LoopProjectFileResponse resp = GetHandle(handle);
+        if (resp.errorCode) return resp;
+        std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+        return getter(handle, data, verbose);
+    }
+
+    /*!
+     * \brief Retrieves a model using the calling thread's handle
+     *
+     * \param modelType - the model group to read from
+     * \param index - the index location for the data
+     * \param data - a reference to where the data is to be copied
+     * \param dataShape - a reference to return the dimensions of the data
+     *
+     * \return Response with success/fail of data retrieval with error message if it failed
+     */
+    LoopProjectFileResponse ReadModel(ModelType modelType, unsigned int index, std::vector<float>& data, std::vector<int>& dataShape);
+
+private:
+    struct HandleTable;
+    struct ThreadRelease;
+
+    LoopProjectFileResponse GetHandle(netCDF::NcFile*& handle);
+
+    std::string filename;
+    // Shared with the threads holding a handle so they can close it on exit
+    std::shared_ptr<HandleTable> handles;
+    bool isOpen;
+    bool verbose;
+
+    ProjectReaderPool(const ProjectReaderPool&) = delete;
+    ProjectReaderPool& operator=(const ProjectReaderPool&) = delete;
+};
+
+} // namespace LoopProjectFile
+
+#endif
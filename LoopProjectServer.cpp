@@ -0,0 +1,319 @@
+#include "LoopProjectServer.h"
+#include "LoopProjectFile.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace LoopProjectFile {
+
+bool Server::SendAll(int fd, const void* data, size_t size)
+{
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t sent = send(fd, bytes, size, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        bytes += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+bool Server::ReceiveAll(int fd, void* data, size_t size)
+{
+    char* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t received = recv(fd, bytes, size, 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) return false;
+        bytes += received;
+        size -= static_cast<size_t>(received);
+    }
+    return true;
+}
+
+// Writes a payload to an unlinked shared memory segment, returning its descriptor or -1
+static int CreatePayloadSegment(const void* payload, size_t size)
+{
+    static std::atomic<unsigned int> counter(0);
+    char name[64];
+    snprintf(name, sizeof(name), "/loopserver_%d_%u", static_cast<int>(getpid()), counter++);
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) return -1;
+    shm_unlink(name);
+    void* memory = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(size)) == 0) {
+        memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (memory == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+    memcpy(memory, payload, size);
+    munmap(memory, size);
+    return fd;
+}
+
+static bool SendResponse(int fd, LoopProjectFileResponse resp, const void* payload, size_t payloadSize, const std::vector<int>* dataShape)
+{
+    Server::ResponseHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = LOOP_SERVER_PROTOCOL_MAGIC;
+    header.errorCode = resp.errorCode;
+    header.messageLength = static_cast<uint32_t>(resp.errorMessage.size());
+    header.payloadSize = resp.errorCode ? 0 : payloadSize;
+    if (dataShape) {
+        for (size_t i=0; i<3 && i<dataShape->size(); i++) header.dataShape[i] = (*dataShape)[i];
+    }
+
+    int payloadFd = -1;
+    if (header.payloadSize > LOOP_SERVER_INLINE_PAYLOAD) {
+        payloadFd = CreatePayloadSegment(payload, payloadSize);
+        // Without shared memory the payload still goes through the socket
+        header.sharedPayload = payloadFd >= 0 ? 1 : 0;
+    }
+
+    bool sent = false;
+    if (payloadFd >= 0) {
+        struct iovec iov;
+        iov.iov_base = &header;
+        iov.iov_len = sizeof(header);
+        char control[CMSG_SPACE(sizeof(int))];
+        memset(control, 0, sizeof(control));
+        struct msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = &iov;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&message);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &payloadFd, sizeof(int));
+        ssize_t result;
+        do {
+            result = sendmsg(fd, &message, MSG_NOSIGNAL);
+        } while (result < 0 && errno == EINTR);
+        close(payloadFd);
+        // The descriptor travels with the first byte so any remainder is sent plainly
+        sent = result > 0 && Server::SendAll(fd, reinterpret_cast<char*>(&header) + result, sizeof(header) - result);
+    } else {
+        sent = Server::SendAll(fd, &header, sizeof(header));
+    }
+    if (!sent) return false;
+    if (!Server::SendAll(fd, resp.errorMessage.data(), resp.errorMessage.size())) return false;
+    if (header.payloadSize && !header.sharedPayload) return Server::SendAll(fd, payload, payloadSize);
+    return true;
+}
+
+struct ProjectServer::OpenProject {
+    ProjectSession session;
+    FileIdentity identity;
+};
+
+ProjectServer::ProjectServer()
+    : listenFd(-1),
+      running(false),
+      verbose(false)
+{
+}
+
+ProjectServer::~ProjectServer()
+{
+    Stop();
+}
+
+LoopProjectFileResponse ProjectServer::Start(std::string socketPath, bool verbose)
+{
+    Stop();
+    this->socketPath = socketPath;
+    this->verbose = verbose;
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        return createErrorMsg(1,"Invalid project server socket path " + socketPath,verbose);
+    }
+    strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) return createErrorMsg(1,std::string("Failed to create project server socket: ") + strerror(errno),verbose);
+    // A socket file left by a server that did not stop cleanly would stop bind
+    unlink(socketPath.c_str());
+    if (bind(listenFd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0 || listen(listenFd, SOMAXCONN) != 0) {
+        LoopProjectFileResponse resp = createErrorMsg(1,"Failed to listen on " + socketPath + ": " + strerror(errno),verbose);
+        close(listenFd);
+        listenFd = -1;
+        return resp;
+    }
+    running = true;
+    acceptThread = std::thread(&ProjectServer::AcceptLoop, this);
+    if (verbose) std::cout << "Project server listening on " << socketPath << std::endl;
+    return {0,""};
+}
+
+void ProjectServer::Stop()
+{
+    if (!running && listenFd < 0) return;
+    running = false;
+    // Shutting the sockets down wakes the threads blocked in accept and recv
+    shutdown(listenFd, SHUT_RDWR);
+    if (acceptThread.joinable()) acceptThread.join();
+    close(listenFd);
+    listenFd = -1;
+    unlink(socketPath.c_str());
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        for (auto it=connections.begin(); it!=connections.end(); it++) {
+            if (!it->finished) shutdown(it->fd, SHUT_RDWR);
+        }
+    }
+    for (auto it=connections.begin(); it!=connections.end(); it++) {
+        if (it->thread.joinable()) it->thread.join();
+    }
+    connections.clear();
+    std::lock_guard<std::mutex> lock(projectsMutex);
+    projects.clear();
+    if (verbose) std::cout << "Project server on " << socketPath << " stopped" << std::endl;
+}
+
+void ProjectServer::AcceptLoop()
+{
+    while (running) {
+        int fd = accept(listenFd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            break;
+        }
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        // Reap the threads of clients that have disconnected
+        for (auto it=connections.begin(); it!=connections.end();) {
+            if (it->finished) {
+                it->thread.join();
+                it = connections.erase(it);
+            } else {
+                it++;
+            }
+        }
+        connections.push_back(Connection());
+        Connection* connection = &connections.back();
+        connection->fd = fd;
+        connection->finished = false;
+        connection->thread = std::thread(&ProjectServer::ServeConnection, this, connection);
+    }
+}
+
+void ProjectServer::ServeConnection(Connection* connection)
+{
+    int fd = connection->fd;
+    Server::RequestHeader header;
+    while (running && Server::ReceiveAll(fd, &header, sizeof(header))) {
+        if (header.magic != LOOP_SERVER_PROTOCOL_MAGIC || header.filenameLength > 4096) {
+            if (verbose) std::cout << "Project server dropping a client that sent an invalid request" << std::endl;
+            break;
+        }
+        std::string filename(header.filenameLength, '\0');
+        if (header.filenameLength && !Server::ReceiveAll(fd, &filename[0], header.filenameLength)) break;
+        if (!HandleRequest(fd, header, filename)) break;
+    }
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    close(fd);
+    connection->finished = true;
+}
+
+ProjectSession* ProjectServer::GetSession(const std::string& filename, LoopProjectFileResponse& resp)
+{
+    FileIdentity identity;
+    if (!GetFileIdentity(filename, identity)) {
+        projects.erase(filename);
+        resp = createErrorMsg(1,"File " + filename + " does not exist",verbose);
+        return NULL;
+    }
+    auto it = projects.find(filename);
+    if (it != projects.end() && it->second->identity == identity) {
+        return &it->second->session;
+    }
+    // First request for the file, or it has been rewritten or replaced since it was opened
+    std::unique_ptr<OpenProject> project(new OpenProject());
+    project->identity = identity;
+    resp = project->session.Open(filename, true, verbose);
+    if (resp.errorCode) {
+        projects.erase(filename);
+        return NULL;
+    }
+    ProjectSession* session = &project->session;
+    projects[filename] = std::move(project);
+    return session;
+}
+
+bool ProjectServer::HandleRequest(int fd, const Server::RequestHeader& header, const std::string& filename)
+{
+    LoopProjectFileResponse resp = {0,""};
+    if (header.type == Server::CHECKFILEVALID) {
+        resp.errorCode = CheckFileValid(filename, verbose) ? 0 : 1;
+        return SendResponse(fd, resp, NULL, 0, NULL);
+    }
+    if (header.type == Server::CLOSEFILE) {
+        std::lock_guard<std::mutex> lock(projectsMutex);
+        projects.erase(filename);
+        return SendResponse(fd, resp, NULL, 0, NULL);
+    }
+
+    std::unique_lock<std::mutex> lock(projectsMutex);
+    ProjectSession* session = GetSession(filename, resp);
+    if (!session) return SendResponse(fd, resp, NULL, 0, NULL);
+
+    // The data is read under the lock and sent after it is released
+    switch (header.type) {
+        case Server::GETVERSION: {
+            LoopVersion version;
+            {
+                std::lock_guard<std::recursive_mutex> netCDFLock(GetNetCDFMutex());
+                version = LoopVersion::GetVersion(session->GetRootNode(), verbose);
+            }
+            lock.unlock();
+            return SendResponse(fd, resp, &version, sizeof(version), NULL);
+        }
+#define LPF_SERVE_STRUCTURE(REQUEST,NAME,TYPE,FUNCTION) \
+        case Server::REQUEST: {\
+            TYPE data;\
+            resp = session->Read<TYPE>(FUNCTION, data);\
+            lock.unlock();\
+            return SendResponse(fd, resp, &data, sizeof(data), NULL);\
+        }
+        LOOP_SERVER_STRUCTURES(LPF_SERVE_STRUCTURE)
+#undef LPF_SERVE_STRUCTURE
+#define LPF_SERVE_RECORDS(REQUEST,NAME,TYPE,FUNCTION) \
+        case Server::REQUEST: {\
+            BulkVector<TYPE> data;\
+            resp = session->Read<BulkVector<TYPE> >(FUNCTION, data);\
+            lock.unlock();\
+            return SendResponse(fd, resp, data.data(), data.size() * sizeof(TYPE), NULL);\
+        }
+        LOOP_SERVER_RECORD_TABLES(LPF_SERVE_RECORDS)
+#undef LPF_SERVE_RECORDS
+        case Server::GETSTRUCTURALMODEL:
+        case Server::GETGEOPHYSICALMODEL:
+        case Server::GETUNCERTAINTYMODEL: {
+            ModelType modelType = header.type == Server::GETSTRUCTURALMODEL ? STRUCTURALMODEL
+                : (header.type == Server::GETGEOPHYSICALMODEL ? GEOPHYSICALMODEL : UNCERTAINTYMODEL);
+            std::vector<float> data;
+            std::vector<int> dataShape;
+            resp = session->ReadModel(modelType, header.index, data, dataShape);
+            lock.unlock();
+            return SendResponse(fd, resp, data.data(), data.size() * sizeof(float), &dataShape);
+        }
+        default:
+            lock.unlock();
+            return SendResponse(fd, createErrorMsg(1,"Unknown project server request",verbose), NULL, 0, NULL);
+    }
+}
+
+} // namespace LoopProjectFile
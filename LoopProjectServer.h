@@ -0,0 +1,183 @@
+#ifndef __LOOPPROJECTSERVER_H
+#define __LOOPPROJECTSERVER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+
+#include "LoopProjectFileUtils.h"
+
+#define LOOP_SERVER_DEFAULT_SOCKET "/tmp/loopprojectserver.sock"
+#define LOOP_SERVER_PROTOCOL_MAGIC 0x4C505331u
+#define LOOP_SERVER_INLINE_PAYLOAD (64 * 1024)
+
+/*!
+ * The record tables served by the project server as
+ * X(request, client function name, record type, module getter)
+ */
+#define LOOP_SERVER_RECORD_TABLES(X) \
+    X(GETFAULTOBSERVATIONS, GetFaultObservations, FaultObservation, DataCollection::GetFaultObservations) \
+    X(GETFOLDOBSERVATIONS, GetFoldObservations, FoldObservation, DataCollection::GetFoldObservations) \
+    X(GETFOLIATIONOBSERVATIONS, GetFoliationObservations, FoliationObservation, DataCollection::GetFoliationObservations) \
+    X(GETDISCONTINUITYOBSERVATIONS, GetDiscontinuityObservations, DiscontinuityObservation, DataCollection::GetDiscontinuityObservations) \
+    X(GETSTRATIGRAPHICOBSERVATIONS, GetStratigraphicObservations, StratigraphicObservation, DataCollection::GetStratigraphicObservations) \
+    X(GETCONTACTS, GetContacts, ContactObservation, DataCollection::GetContactObservations) \
+    X(GETDRILLHOLEOBSERVATIONS, GetDrillholeObservations, DrillholeObservation, DataCollection::GetDrillholeObservations) \
+    X(GETDRILLHOLEPROPERTIES, GetDrillholeProperties, DrillholeProperty, DataCollection::GetDrillholeProperties) \
+    X(GETDRILLHOLESURVEYS, GetDrillholeSurveys, DrillholeSurvey, DataCollection::GetDrillholeSurveys) \
+    X(GETFAULTEVENTS, GetFaultEvents, FaultEvent, ExtractedInformation::GetFaultEvents) \
+    X(GETFOLDEVENTS, GetFoldEvents, FoldEvent, ExtractedInformation::GetFoldEvents) \
+    X(GETFOLIATIONEVENTS, GetFoliationEvents, FoliationEvent, ExtractedInformation::GetFoliationEvents) \
+    X(GETDISCONTINUITYEVENTS, GetDiscontinuityEvents, DiscontinuityEvent, ExtractedInformation::GetDiscontinuityEvents) \
+    X(GETSTRATIGRAPHICLAYERS, GetStratigraphicLayers, StratigraphicLayer, ExtractedInformation::GetStratigraphicLayers) \
+    X(GETEVENTRELATIONSHIPS, GetEventRelationships, EventRelationship, ExtractedInformation::GetEventRelationships) \
+    X(GETDRILLHOLEDESCRIPTIONS, GetDrillholeDescriptions, DrillholeDescription, ExtractedInformation::GetDrillholeDescriptions)
+
+/*!
+ * The single structures served by the project server as
+ * X(request, client function name, structure type, module getter)
+ */
+#define LOOP_SERVER_STRUCTURES(X) \
+    X(GETEXTENTS, GetExtents, LoopExtents, LoopExtents::GetExtents) \
+    X(GETDATACOLLECTIONCONFIGURATION, GetDataCollectionConfiguration, DataCollectionConfiguration, DataCollection::GetDataCollectionConfiguration) \
+    X(GETDATACOLLECTIONSOURCES, GetDataCollectionSources, DataCollectionSources, DataCollection::GetDataCollectionSources) \
+    X(GETSTRUCTURALMODELSCONFIGURATION, GetStructuralModelsConfiguration, StructuralModelsConfiguration, StructuralModels::GetStructuralModelsConfiguration)
+
+namespace LoopProjectFile {
+
+class ProjectSession;
+
+namespace Server {
+
+/*! \brief The requests understood by the project server */
+enum RequestType {
+    INVALIDREQUEST = -1,
+    GETVERSION,
+    CHECKFILEVALID,
+    GETEXTENTS,
+    GETDATACOLLECTIONCONFIGURATION,
+    GETDATACOLLECTIONSOURCES,
+    GETSTRUCTURALMODELSCONFIGURATION,
+    GETFAULTOBSERVATIONS,
+    GETFOLDOBSERVATIONS,
+    GETFOLIATIONOBSERVATIONS,
+    GETDISCONTINUITYOBSERVATIONS,
+    GETSTRATIGRAPHICOBSERVATIONS,
+    GETCONTACTS,
+    GETDRILLHOLEOBSERVATIONS,
+    GETDRILLHOLEPROPERTIES,
+    GETDRILLHOLESURVEYS,
+    GETFAULTEVENTS,
+    GETFOLDEVENTS,
+    GETFOLIATIONEVENTS,
+    GETDISCONTINUITYEVENTS,
+    GETSTRATIGRAPHICLAYERS,
+    GETEVENTRELATIONSHIPS,
+    GETDRILLHOLEDESCRIPTIONS,
+    GETSTRUCTURALMODEL,
+    GETGEOPHYSICALMODEL,
+    GETUNCERTAINTYMODEL,
+    CLOSEFILE, /*!< Drops the server's open handle on a file, e.g. before rewriting it */
+    NUM_REQUESTS
+};
+
+/*! \brief Sent by the client, followed by filenameLength bytes of filename */
+struct RequestHeader {
+    uint32_t magic;
+    int32_t type;
+    int32_t index;
+    uint32_t filenameLength;
+};
+
+/*! \brief Sent by the server, followed by messageLength bytes of error message.
+ *
+ * Payloads up to LOOP_SERVER_INLINE_PAYLOAD bytes follow the message in the stream. Larger
+ * payloads are written to an unlinked shared memory segment whose descriptor is passed with
+ * the header (SCM_RIGHTS), so bulk data is not copied through the socket.
+ */
+struct ResponseHeader {
+    uint32_t magic;
+    int32_t errorCode;
+    uint32_t messageLength;
+    uint32_t sharedPayload;
+    uint64_t payloadSize;
+    int32_t dataShape[3];
+};
+
+/*! \brief Writes all of a buffer to a socket, retrying partial and interrupted writes */
+bool SendAll(int fd, const void* data, size_t size);
+
+/*! \brief Reads a buffer's worth of bytes from a socket, retrying partial and interrupted reads */
+bool ReceiveAll(int fd, void* data, size_t size);
+
+} // namespace Server
+
+/*! \brief A local daemon serving project file reads over a Unix domain socket
+ *
+ * The server keeps a read only ProjectSession open for every file it has been asked
+ * about, so clients (see LoopProjectClient.h) skip the open and metadata cost of each call.
+ * A session is reopened when its file's inode, size or nanosecond modification time changes. Each client
+ * connection is served on its own thread; netCDF access is serialised by GetNetCDFMutex().
+ */
+class ProjectServer {
+public:
+    ProjectServer();
+
+    /*! \brief Destructor. Stops the server */
+    ~ProjectServer();
+
+    /*!
+     * \brief Starts listening on a Unix domain socket and serving clients in the background
+     *
+     * \param socketPath - the path of the socket to create (an existing socket file is replaced)
+     * \param verbose - a flag to toggle verbose message printing
+     *
+     * \return Response with success/fail of starting the server with an error message if it failed
+     */
+    LoopProjectFileResponse Start(std::string socketPath = LOOP_SERVER_DEFAULT_SOCKET, bool verbose = false);
+
+    /*! \brief Disconnects all clients, closes every open file and removes the socket */
+    void Stop();
+
+    /*! \brief Whether the server is listening */
+    bool IsRunning() const { return running; }
+
+    /*! \brief The path of the socket the server listens on */
+    std::string GetSocketPath() const { return socketPath; }
+
+private:
+    struct OpenProject;
+    struct Connection {
+        int fd;
+        bool finished;
+        std::thread thread;
+    };
+
+    void AcceptLoop();
+    void ServeConnection(Connection* connection);
+    bool HandleRequest(int fd, const Server::RequestHeader& header, const std::string& filename);
+    ProjectSession* GetSession(const std::string& filename, LoopProjectFileResponse& resp);
+
+    std::string socketPath;
+    int listenFd;
+    std::atomic<bool> running;
+    bool verbose;
+    std::thread acceptThread;
+    std::mutex connectionsMutex;
+    std::list<Connection> connections;
+    std::mutex projectsMutex;
+    std::map<std::string, std::unique_ptr<OpenProject> > projects;
+
+    ProjectServer(const ProjectServer&) = delete;
+    ProjectServer& operator=(const ProjectServer&) = delete;
+};
+
+} // namespace LoopProjectFile
+
+#endif
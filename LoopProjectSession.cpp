@@ -0,0 +1,512 @@
+#include "LoopProjectSession.h"
+#include "LoopProjectFile.h"
+#include <netcdf.h>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+namespace LoopProjectFile {
+
+// A decoded model held by the session cache
+struct CachedModel {
+    std::vector<float> data;
+    std::vector<int> dataShape;
+};
+
+ProjectSession::ProjectSession()
+    : isOpen(false),
+      readOnly(true),
+      verbose(false),
+      writeBack(false),
+      memoryId(-1),
+      callerBuffer(NULL),
+      callerBufferSize(0)
+{
+}
+
+ProjectSession::~ProjectSession()
+{
+    // Nothing can take the tables that failed to flush any more
+    if (Close().errorCode) {
+        if (verbose) std::cout << "Discarding " << pendingTables.size() << " unflushed tables of " << filename << std::endl;
+        CloseFile();
+    }
+}
+
+LoopProjectFileResponse ProjectSession::Open(std::string filename, bool readOnly, bool verbose)
+{
+    LoopProjectFileResponse resp = Close();
+    if (resp.errorCode) return resp;
+    std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+    this->filename = filename;
+    this->readOnly = readOnly;
+    this->verbose = verbose;
+    if (OpenProjectFile(filename, file, readOnly, verbose)) {
+        return createErrorMsg(1,"Failure to open project file " + filename,verbose);
+    }
+    root = file;
+    isOpen = true;
+    return ReapplyChunkCaches();
+}
+
+LoopProjectFileResponse ProjectSession::ReapplyChunkCaches()
+{
+    // Reapply the chunk caches configured before (or during an earlier) open
+    LoopProjectFileResponse resp = {0,""};
+    for (auto it=chunkCaches.begin(); it!=chunkCaches.end(); it++) {
+        LoopProjectFileResponse cacheResp = ApplyChunkCache(it->first.first, it->first.second, it->second);
+        if (cacheResp.errorCode) resp = cacheResp;
+    }
+    return resp;
+}
+
+LoopProjectFileResponse ProjectSession::OpenFromMemory(const void* buffer, size_t size, bool readOnly, bool verbose, std::string name)
+{
+    LoopProjectFileResponse resp = Close();
+    if (resp.errorCode) return resp;
+    std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+    this->filename = name;
+    this->readOnly = readOnly;
+    this->verbose = verbose;
+    if (!buffer || !size) return createErrorMsg(1,"No project file data to open",verbose);
+    int status = NC_NOERR;
+    if (readOnly) {
+        // netCDF only reads from the buffer in this mode so the caller's copy is used directly
+        status = nc_open_mem(name.c_str(), NC_NOWRITE, size, const_cast<void*>(buffer), &memoryId);
+        if (status == NC_NOERR) {
+            callerBuffer = buffer;
+            callerBufferSize = size;
+        }
+    } else {
+        // A writable file may be grown by netCDF so it works on (and takes ownership of) a copy
+        NC_memio memio;
+        memio.size = size;
+        memio.memory = malloc(size);
+        memio.flags = 0;
+        if (!memio.memory) return createErrorMsg(1,"Failed to allocate memory for project file " + name,verbose);
+        memcpy(memio.memory, buffer, size);
+        status = nc_open_memio(name.c_str(), NC_WRITE, &memio, &memoryId);
+        if (status != NC_NOERR) free(memio.memory);
+    }
+    if (status != NC_NOERR) {
+        memoryId = -1;
+        return createErrorMsg(1,"Failure to open project file " + name + " from memory: " + nc_strerror(status),verbose);
+    }
+    root = netCDF::NcGroup(memoryId);
+    isOpen = true;
+    return ReapplyChunkCaches();
+}
+
+LoopProjectFileResponse ProjectSession::CreateInMemory(bool verbose, std::string name)
+{
+    LoopProjectFileResponse resp = Close();
+    if (resp.errorCode) return resp;
+    std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+    this->filename = name;
+    this->readOnly = false;
+    this->verbose = verbose;
+    int status = nc_create_mem(name.c_str(), NC_NETCDF4, LOOP_SESSION_MEMORY_INITIAL_SIZE, &memoryId);
+    if (status != NC_NOERR) {
+        memoryId = -1;
+        return createErrorMsg(1,"Failure to create in memory project file " + name + ": " + nc_strerror(status),verbose);
+    }
+    root = netCDF::NcGroup(memoryId);
+    isOpen = true;
+    return LoopVersion::SetVersion(&root, verbose);
+}
+
+LoopProjectFileResponse ProjectSession::ToBuffer(std::vector<char>& buffer)
+{
+    std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+    if (!isOpen) return createErrorMsg(1,"Project session is not open",verbose);
+    if (memoryId < 0) return createErrorMsg(1,"Project session " + filename + " is not in memory",verbose);
+    if (callerBuffer) {
+        const char* bytes = static_cast<const char*>(callerBuffer);
+        buffer.assign(bytes, bytes + callerBufferSize);
+        return {0,""};
+    }
+    LoopProjectFileResponse resp = Flush();
+    if (resp.errorCode) return resp;
+    if (metadataBatch) CommitMetadataBatch();
+    // netCDF only hands back the file image on closing, so close it, copy the image and reopen
+    // the same memory (which netCDF takes ownership of again)
+    NC_memio memio;
+    int status = nc_close_memio(memoryId, &memio);
+    memoryId = -1;
+    isOpen = false;
+    if (status != NC_NOERR) {
+        return createErrorMsg(1,"Failed to retrieve in memory project file " + filename + ": " + nc_strerror(status),verbose);
+    }
+    const char* bytes = static_cast<const char*>(memio.memory);
+    buffer.assign(bytes, bytes + memio.size);
+    memio.flags = 0;
+    status = nc_open_memio(filename.c_str(), NC_WRITE, &memio, &memoryId);
+    if (status != NC_NOERR) {
+        free(memio.memory);
+        memoryId = -1;
+        return createErrorMsg(1,"Failed to reopen in memory project file " + filename + ": " + nc_strerror(status),verbose);
+    }
+    root = netCDF::NcGroup(memoryId);
+    isOpen = true;
+    return ReapplyChunkCaches();
+}
+
+LoopProjectFileResponse ProjectSession::PersistTo(std::string filename)
+{
+    std::vector<char> buffer;
+    LoopProjectFileResponse resp = ToBuffer(buffer);
+    if (resp.errorCode) return resp;
+    std::ofstream out(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out) return createErrorMsg(1,"Failed to open " + filename + " for writing",verbose);
+    out.write(buffer.data(), buffer.size());
+    out.close();
+    if (!out) return createErrorMsg(1,"Failed to write project file " + filename,verbose);
+    return {0,""};
+}
+
+LoopProjectFileResponse ProjectSession::Close()
+{
+    std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+    LoopProjectFileResponse resp = {0,""};
+    if (isOpen) resp = Flush();
+    if (resp.errorCode) return resp;
+    if (metadataBatch) resp = CommitMetadataBatch();
+    CloseFile();
+    return resp;
+}
+
+void ProjectSession::CloseFile()
+{
+    std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+    pendingTables.clear();
+    if (metadataBatch) CommitMetadataBatch();
+    if (isOpen && memoryId >= 0) {
+        if (callerBuffer) {
+            nc_close(memoryId);
+        } else {
+            NC_memio memio;
+            if (nc_close_memio(memoryId, &memio) == NC_NOERR) free(memio.memory);
+        }
+    } else if (isOpen) {
+        CloseProjectFile(&file);
+    }
+    memoryId = -1;
+    callerBuffer = NULL;
+    callerBufferSize = 0;
+    root = netCDF::NcGroup();
+    isOpen = false;
+    cache.Clear();
+}
+
+LoopProjectFileResponse ProjectSession::ReadModel(ModelType modelType, unsigned int index, std::vector<float>& data, std::vector<int>& dataShape)
+{
+    std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+    if (!isOpen) return createErrorMsg(1,"Project session is not open",verbose);
+    SessionCacheKey key(GetModelGroupName(modelType), "data", index);
+    std::shared_ptr<const CachedModel> cached = cache.Find<CachedModel>(key);
+    if (cached) {
+        data = cached->data;
+        dataShape = cached->dataShape;
+        return {0,""};
+    }
+    LoopProjectFileResponse resp = {0,""};
+    switch (modelType) {
+        case STRUCTURALMODEL: resp = StructuralModels::GetStructuralModel(&root, data, dataShape, index, verbose); break;
+        case GEOPHYSICALMODEL: resp = GeophysicalModels::GetGeophysicalModel(&root, data, dataShape, index, verbose); break;
+        case UNCERTAINTYMODEL: resp = UncertaintyModels::GetUncertaintyModel(&root, data, dataShape, index, verbose); break;
+        default: return createErrorMsg(1,"Invalid model type for reading",verbose);
+    }
+    if (!resp.errorCode && cache.IsEnabled()) {
+        std::shared_ptr<CachedModel> model = std::make_shared<CachedModel>();
+        model->data = data;
+        model->dataShape = dataShape;
+        cache.Insert(key, model, data.size() * sizeof(float));
+    }
+    return resp;
+}
+
+LoopProjectFileResponse ProjectSession::ListValidModels(ModelType modelType, std::vector<char>& valid)
+{
+    std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+    if (!isOpen) return createErrorMsg(1,"Project session is not open",verbose);
+    return ModelStorage::ListValidModels(&root, modelType, valid, verbose);
+}
+
+LoopProjectFileResponse ProjectSession::WriteModel(ModelType modelType, unsigned int index, const std::vector<float>& data, const std::vector<int>& dataShape)
+{
+    std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+    if (!isOpen) return createErrorMsg(1,"Project session is not open",verbose);
+    if (readOnly) return createErrorMsg(1,"Project session is read only",verbose);
+    cache.Invalidate(SessionCacheKey(GetModelGroupName(modelType), "data", index));
+    switch (modelType) {
+        case STRUCTURALMODEL: return StructuralModels::SetStructuralModel(&root, data, dataShape, index, verbose);
+        case GEOPHYSICALMODEL: return GeophysicalModels::SetGeophysicalModel(&root, data, dataShape, index, verbose);
+        case UNCERTAINTYMODEL: return UncertaintyModels::SetUncertaintyModel(&root, data, dataShape, index, verbose);
+        default: return createErrorMsg(1,"Invalid model type for writing",verbose);
+    }
+}
+
+LoopProjectFileResponse ProjectSession::PrepareModels(ModelType modelType, const ModelWriteOptions& options)
+{
+    std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+    if (!isOpen) return createErrorMsg(1,"Project session is not open",verbose);
+    if (readOnly) return createErrorMsg(1,"Project session is read only",verbose);
+    cache.InvalidateGroup(GetModelGroupName(modelType));
+    LoopProjectFileResponse resp = ModelStorage::PrepareModelGroup(&root, modelType, options, verbose);
+    // A newly created data variable picks up any chunk cache configured for it
+    auto it = chunkCaches.find(std::make_pair(GetModelGroupName(modelType), std::string("data")));
+    if (!resp.errorCode && it != chunkCaches.end()) resp = ApplyChunkCache(it->first.first, it->first.second, it->second);
+    return resp;
+}
+
+LoopProjectFileResponse ProjectSession::BeginMetadataBatch()
+{
+    std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+    if (!isOpen) return createErrorMsg(1,"Project session is not open",verbose);
+    if (readOnly) return createErrorMsg(1,"Project session is read only",verbose);
+    if (metadataBatch) return createErrorMsg(1,"A metadata batch is already in progress",verbose);
+    metadataBatch.reset(new MetadataBatch(&root));
+    return {0,""};
+}
+
+LoopProjectFileResponse ProjectSession::CommitMetadataBatch()
+{
+    std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+    if (!metadataBatch) return createErrorMsg(1,"No metadata batch is in progress",verbose);
+    LoopProjectFileResponse resp = metadataBatch->Commit(verbose);
+    metadataBatch.reset();
+    return resp;
+}
+
+LoopProjectFileResponse ProjectSession::SetWriteBack(bool enabled)
+{
+    std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+    writeBack = enabled;
+    if (enabled || !isOpen) return {0,""};
+    return Flush();
+}
+
+LoopProjectFileResponse ProjectSession::Flush()
+{
+    std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+    if (pendingTables.empty()) return {0,""};
+    if (!isOpen) return createErrorMsg(1,"Project session is not open",verbose);
+    LoopProjectFileResponse resp = {0,""};
+    for (auto it=pendingTables.begin(); it!=pendingTables.end();) {
+        LoopProjectFileResponse tableResp = it->second.flush(&root, verbose);
+        if (tableResp.errorCode) {
+            resp = createErrorMsg(1,"Failed to flush " + it->first.first + "/" + it->first.second + ": " + tableResp.errorMessage,verbose);
+            it++;
+        } else {
+            it = pendingTables.erase(it);
+        }
+    }
+    return resp;
+}
+
+size_t ProjectSession::GetPendingTableCount()
+{
+    std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+    return pendingTables.size();
+}
+
+void ProjectSession::SetCacheLimit(size_t bytes)
+{
+    std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+    cache.SetLimit(bytes);
+}
+
+SessionCacheStatistics ProjectSession::GetCacheStatistics()
+{
+    std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+    return cache.GetStatistics();
+}
+
+void ProjectSession::ResetCacheStatistics()
+{
+    std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+    cache.ResetStatistics();
+}
+
+void ProjectSession::ClearCache()
+{
+    std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+    cache.Clear();
+}
+
+// Finds a variable from a slash separated group path below the root group
+static bool FindVariable(netCDF::NcGroup root, std::string groupName, std::string variableName, netCDF::NcVar& var)
+{
+    netCDF::NcGroup group = root;
+    size_t pos = 0;
+    while (pos < groupName.size()) {
+        size_t next = groupName.find('/', pos);
+        if (next == std::string::npos) next = groupName.size();
+        if (next > pos) {
+            auto groups = group.getGroups();
+            if (groups.find(groupName.substr(pos, next - pos)) == groups.end()) return false;
+            group = group.getGroup(groupName.substr(pos, next - pos));
+        }
+        pos = next + 1;
+    }
+    auto vars = group.getVars();
+    if (vars.find(variableName) == vars.end()) return false;
+    var = group.getVar(variableName);
+    return true;
+}
+
+LoopProjectFileResponse ProjectSession::ApplyChunkCache(std::string groupName, std::string variableName, const ChunkCacheSettings& settings)
+{
+    LoopProjectFileResponse resp = {0,""};
+    try {
+        netCDF::NcVar var;
+        if (!FindVariable(root, groupName, variableName, var)) {
+            // The variable may be created by a later write, the setting is applied on reopening
+            if (verbose) std::cout << "No variable " << groupName << "/" << variableName << " to set chunk cache on yet" << std::endl;
+            return resp;
+        }
+        int status = nc_set_var_chunk_cache(var.getParentGroup().getId(), var.getId(), settings.size, settings.slots, settings.preemption);
+        if (status != NC_NOERR) {
+            resp = createErrorMsg(1,"Failed to set chunk cache of " + groupName + "/" + variableName + ": " + nc_strerror(status),verbose);
+        }
+    } catch (netCDF::exceptions::NcException& e) {
+        if (verbose) std::cout << e.what() << std::endl;
+        resp = createErrorMsg(1,"Failed to set chunk cache of " + groupName + "/" + variableName,verbose);
+    }
+    return resp;
+}
+
+LoopProjectFileResponse ProjectSession::SetChunkCache(std::string groupName, std::string variableName, const ChunkCacheSettings& settings)
+{
+    std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+    if (settings.size == 0 || settings.slots == 0 || settings.preemption < 0.0f || settings.preemption > 1.0f) {
+        return createErrorMsg(1,"Invalid chunk cache settings",verbose);
+    }
+    chunkCaches[std::make_pair(groupName, variableName)] = settings;
+    if (!isOpen) return LoopProjectFileResponse{0,""};
+    return ApplyChunkCache(groupName, variableName, settings);
+}
+
+LoopProjectFileResponse ProjectSession::SetChunkCache(ModelType modelType, const ChunkCacheSettings& settings)
+{
+    std::string groupName = GetModelGroupName(modelType);
+    if (groupName.empty()) return createErrorMsg(1,"Invalid model type for chunk cache",verbose);
+    return SetChunkCache(groupName, "data", settings);
+}
+
+LoopProjectFileResponse ProjectSession::GetChunkCache(std::string groupName, std::string variableName, ChunkCacheSettings& settings)
+{
+    std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+    if (!isOpen) return createErrorMsg(1,"Project session is not open",verbose);
+    LoopProjectFileResponse resp = {0,""};
+    try {
+        netCDF::NcVar var;
+        if (!FindVariable(root, groupName, variableName, var)) {
+            return createErrorMsg(1,"No variable " + groupName + "/" + variableName + " in project file",verbose);
+        }
+        int status = nc_get_var_chunk_cache(var.getParentGroup().getId(), var.getId(), &settings.size, &settings.slots, &settings.preemption);
+        if (status != NC_NOERR) {
+            resp = createErrorMsg(1,"Failed to get chunk cache of " + groupName + "/" + variableName + ": " + nc_strerror(status),verbose);
+        }
+    } catch (netCDF::exceptions::NcException& e) {
+        if (verbose) std::cout << e.what() << std::endl;
+        resp = createErrorMsg(1,"Failed to get chunk cache of " + groupName + "/" + variableName,verbose);
+    }
+    return resp;
+}
+
+static size_t ChunksAlong(size_t gridSize, size_t chunkSize)
+{
+    if (gridSize == 0) gridSize = 1;
+    return (gridSize + chunkSize - 1) / chunkSize;
+}
+
+static size_t NextPrime(size_t value)
+{
+    if (value < 3) return 3;
+    if (value % 2 == 0) value++;
+    for (;; value += 2) {
+        bool prime = true;
+        for (size_t d=3; d*d<=value && prime; d+=2) prime = (value % d) != 0;
+        if (prime) return value;
+    }
+}
+
+ChunkCacheSettings ProjectSession::CalculateChunkCachePreset(ChunkCachePreset preset, const std::vector<size_t>& chunkShape, const std::vector<size_t>& gridShape, size_t elementSize)
+{
+    ChunkCacheSettings settings(0, 0, 0.75f);
+    if (chunkShape.size() != 4 || gridShape.size() != 4) return settings;
+    size_t chunkBytes = elementSize;
+    for (size_t i=0; i<4; i++) {
+        if (chunkShape[i] == 0) return settings;
+        chunkBytes *= chunkShape[i];
+    }
+    size_t eastingChunks = ChunksAlong(gridShape[0], chunkShape[0]);
+    size_t northingChunks = ChunksAlong(gridShape[1], chunkShape[1]);
+    size_t depthChunks = ChunksAlong(gridShape[2], chunkShape[2]);
+    size_t indexChunks = ChunksAlong(gridShape[3], chunkShape[3]);
+
+    // Hold every chunk touched by one access so no chunk is decompressed twice
+    size_t numChunks = 0;
+    switch (preset) {
+        case WHOLEMODEL:
+            // All chunks of one model index, each used once per model
+            numChunks = eastingChunks * northingChunks * depthChunks;
+            settings.preemption = 1.0f;
+            break;
+        case SLICESWEEP:
+            // One layer of chunks across the grid, reused by every slice within the layer
+            numChunks = eastingChunks * northingChunks;
+            settings.preemption = 1.0f;
+            break;
+        case ENSEMBLEVOXELSERIES:
+            // The chunks along the index of a voxel column, reused by neighbouring voxels
+            numChunks = indexChunks * depthChunks;
+            settings.preemption = 0.0f;
+            break;
+        default:
+            return settings;
+    }
+    const size_t minimumSize = 1024 * 1024;
+    settings.size = numChunks * chunkBytes > minimumSize ? numChunks * chunkBytes : minimumSize;
+    // HDF5 recommends a prime number of slots around 100 times the chunks held
+    settings.slots = NextPrime(numChunks * 100 > 521 ? numChunks * 100 : 521);
+    return settings;
+}
+
+LoopProjectFileResponse ProjectSession::ApplyChunkCachePreset(ModelType modelType, ChunkCachePreset preset, ChunkCacheSettings* applied)
+{
+    std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+    if (!isOpen) return createErrorMsg(1,"Project session is not open",verbose);
+    std::string groupName = GetModelGroupName(modelType);
+    if (groupName.empty()) return createErrorMsg(1,"Invalid model type for chunk cache",verbose);
+    ChunkCacheSettings settings;
+    try {
+        netCDF::NcVar var;
+        if (!FindVariable(root, groupName, "data", var)) {
+            return createErrorMsg(1,"No " + groupName + " data in project file to size a chunk cache from",verbose);
+        }
+        netCDF::NcVar::ChunkMode chunkMode;
+        std::vector<size_t> chunkShape;
+        var.getChunkingParameters(chunkMode, chunkShape);
+        if (chunkMode != netCDF::NcVar::nc_CHUNKED) {
+            return createErrorMsg(1,groupName + " data is not chunked",verbose);
+        }
+        std::vector<netCDF::NcDim> dims = var.getDims();
+        std::vector<size_t> gridShape;
+        for (size_t i=0; i<dims.size(); i++) gridShape.push_back(dims[i].getSize());
+        settings = CalculateChunkCachePreset(preset, chunkShape, gridShape, var.getType().getSize());
+    } catch (netCDF::exceptions::NcException& e) {
+        if (verbose) std::cout << e.what() << std::endl;
+        return createErrorMsg(1,"Failed to read chunking of " + groupName + " data",verbose);
+    }
+    if (settings.size == 0) return createErrorMsg(1,"Invalid chunk cache preset",verbose);
+    if (applied) *applied = settings;
+    if (verbose) {
+        std::cout << "Setting " << groupName << " data chunk cache to " << settings.size << " bytes, "
+            << settings.slots << " slots, preemption " << settings.preemption << std::endl;
+    }
+    return SetChunkCache(groupName, "data", settings);
+}
+
+} // namespace LoopProjectFile
@@ -0,0 +1,547 @@
+#ifndef __LOOPPROJECTSESSION_H
+#define __LOOPPROJECTSESSION_H
+
+#include <netcdf>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <memory>
+#include <functional>
+
+#include "LoopProjectFileUtils.h"
+#include "LoopModelStorage.h"
+#include "LoopRecordTables.h"
+#include "LoopRecordStorage.h"
+#include "LoopRecordFilter.h"
+#include "LoopSessionCache.h"
+
+#define LOOP_SESSION_MEMORY_NAME "inmemory.loop3d"
+#define LOOP_SESSION_MEMORY_INITIAL_SIZE (1024 * 1024)
+
+namespace LoopProjectFile {
+
+/*! \brief HDF5 chunk cache parameters for one variable */
+struct ChunkCacheSettings {
+    size_t size;      /*!< Cache size in bytes */
+    size_t slots;     /*!< Number of hash slots (a prime well above the number of cached chunks) */
+    float preemption; /*!< 0.0 to 1.0, how strongly fully read chunks are evicted first */
+    ChunkCacheSettings() : size(0), slots(0), preemption(0.75f) {}
+    ChunkCacheSettings(size_t size, size_t slots, float preemption) : size(size), slots(slots), preemption(preemption) {}
+};
+
+/*! \brief Access patterns that a model data chunk cache can be sized for */
+enum ChunkCachePreset {
+    INVALIDCHUNKCACHEPRESET = -1,
+    WHOLEMODEL,          /*!< Reading complete models, one index at a time */
+    SLICESWEEP,          /*!< Reading depth slices of a model in order */
+    ENSEMBLEVOXELSERIES, /*!< Reading the same voxels across every model index */
+    NUM_CHUNK_CACHE_PRESETS
+};
+
+/*! \brief An open handle onto a loop project file that is reused across calls
+ *
+ * The filename-level functions open and close the file on every call. A session keeps one
+ * handle open so metadata and HDF5 chunk caches survive between reads and writes, and
+ * holds per-variable chunk cache settings that are reapplied whenever the file is reopened.
+ * A session can also hold a project file entirely in memory (see OpenFromMemory() and
+ * CreateInMemory()) which is only written out on an explicit ToBuffer() or PersistTo().
+ * ReadModel() and ReadTable() can be served from a memory bounded cache of decoded data
+ * (see SetCacheLimit()) which the session's own writes keep up to date. In write back mode
+ * (see SetWriteBack()) WriteTable() only keeps the table in memory until Flush() or Close().
+ * All calls into netCDF hold GetNetCDFMutex().
+ */
+class ProjectSession {
+public:
+    ProjectSession();
+
+    /*! \brief Destructor. Closes the file, discarding any tables that fail to flush */
+    ~ProjectSession();
+
+    /*!
+     * \brief Opens the session onto an existing project file
+     *
+     * \param filename - the filename of the loop project file
+     * \param readOnly - whether to open the file without write access
+     * \param verbose - a flag to toggle verbose message printing
+     *
+     * \return Response with success/fail of opening the file with an error message if it failed
+     */
+    LoopProjectFileResponse Open(std::string filename, bool readOnly = true, bool verbose = false);
+
+    /*!
+     * \brief Opens the session onto a project file image held in memory
+     *
+     * A read only session reads the caller's buffer in place, so it must stay valid until the
+     * session is closed. A writable session works on its own copy of the buffer.
+     *
+     * \param buffer - the bytes of a loop project file
+     * \param size - the number of bytes in the buffer
+     * \param readOnly - whether to open the file without write access
+     * \param verbose - a flag to toggle verbose message printing
+     * \param name - the name reported by netCDF and GetFilename() for the in memory file
+     *
+     * \return Response with success/fail of opening the file with an error message if it failed
+     */
+    LoopProjectFileResponse OpenFromMemory(const void* buffer, size_t size, bool readOnly = true, bool verbose = false, std::string name = LOOP_SESSION_MEMORY_NAME);
+
+    /*!
+     * \brief Creates a new, writable project file in memory with only the version set
+     *
+     * \param verbose - a flag to toggle verbose message printing
+     * \param name - the name reported by netCDF and GetFilename() for the in memory file
+     *
+     * \return Response with success/fail of creating the file with an error message if it failed
+     */
+    LoopProjectFileResponse CreateInMemory(bool verbose = false, std::string name = LOOP_SESSION_MEMORY_NAME);
+
+    /*!
+     * \brief Copies the current image of an in memory project file
+     *
+     * \param buffer - a reference to where the file bytes are to be copied
+     *
+     * \return Response with success/fail of the copy with an error message if it failed
+     */
+    LoopProjectFileResponse ToBuffer(std::vector<char>& buffer);
+
+    /*!
+     * \brief Writes the current image of an in memory project file to disk, replacing any
+     * existing file. The session stays in memory.
+     *
+     * \param filename - the filename to write the loop project file to
+     *
+     * \return Response with success/fail of writing the file with an error message if it failed
+     */
+    LoopProjectFileResponse PersistTo(std::string filename);
+
+    /*!
+     * \brief Flushes any pending tables and closes the file. If a table fails to flush the
+     * session is left open with the failed tables still held, so they can be retried or read
+     * back. Open() closes the current file first and fails in the same way. Chunk cache
+     * settings are kept for the next Open()
+     *
+     * \return Response with success/fail of flushing and closing with an error message if it failed
+     */
+    LoopProjectFileResponse Close();
+
+    /*! \brief Whether the session has a file open */
+    bool IsOpen() const { return isOpen; }
+
+    /*! \brief Whether the session was opened read only */
+    bool IsReadOnly() const { return readOnly; }
+
+    /*! \brief The filename the session was last opened on */
+    std::string GetFilename() const { return filename; }
+
+    /*! \brief Whether the session holds its project file in memory */
+    bool IsInMemory() const { return memoryId >= 0; }
+
+    /*! \brief The root group of the open file, for use with the module functions while holding GetNetCDFMutex() */
+    netCDF::NcGroup* GetRootNode() { return &root; }
+
+    /*!
+     * \brief Runs one of the module getters (e.g. DataCollection::GetFaultObservations) on the session
+     *
+     * \param getter - the module getter to run
+     * \param data - a reference to where the data is to be copied
+     *
+     * \return Response with success/fail of data retrieval with error message if it failed
+     */
+    template <typename Container>
+    LoopProjectFileResponse Read(LoopProjectFileResponse (*getter)(netCDF::NcGroup*, Container&, bool), Container& data)
+    {
+        std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+        if (!isOpen) return createErrorMsg(1,"Project session is not open",verbose);
+        // The getter may read a table that is only held in memory
+        LoopProjectFileResponse resp = Flush();
+        if (resp.errorCode) return resp;
+        return getter(&root, data, verbose);
+    }
+
+    /*!
+     * \brief Runs one of the module setters (e.g. DataCollection::SetFaultObservations) on the session
+     *
+     * \param setter - the module setter to run
+     * \param data - the data to write
+     *
+     * \return Response with success/fail of data insertion with error message if it failed
+     */
+    template <typename Container>
+    LoopProjectFileResponse Write(LoopProjectFileResponse (*setter)(netCDF::NcGroup*, Container, bool), const Container& data)
+    {
+        std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+        if (!isOpen) return createErrorMsg(1,"Project session is not open",verbose);
+        if (readOnly) return createErrorMsg(1,"Project session is read only",verbose);
+        // Pending tables go first so a table written by the setter is not overwritten later
+        LoopProjectFileResponse resp = Flush();
+        if (resp.errorCode) return resp;
+        // The setter is not known to write any particular table so none can be trusted
+        cache.InvalidateTables();
+        return setter(&root, data, verbose);
+    }
+
+    /*!
+     * \brief Retrieves a record table (e.g. std::vector<FaultObservation>), from the unflushed
+     * writes or the cache if either holds it
+     *
+     * \param data - a reference to where the data is to be copied
+     *
+     * \return Response with success/fail of data retrieval with error message if it failed
+     */
+    template <typename T>
+    LoopProjectFileResponse ReadTable(std::vector<T>& data)
+    {
+        std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+        if (!isOpen) return createErrorMsg(1,"Project session is not open",verbose);
+        std::shared_ptr<const std::vector<T> > table = FindTable<T>();
+        if (table) {
+            data = *table;
+            return {0,""};
+        }
+        data.clear();
+        LoopProjectFileResponse resp = RecordTable<T>::Get(&root, data, verbose);
+        if (!resp.errorCode && cache.IsEnabled()) {
+            SessionCacheKey key(RecordTable<T>::GroupPath(), RecordTable<T>::Variable());
+            cache.Insert(key, std::make_shared<const std::vector<T> >(data), data.size() * sizeof(T));
+        }
+        return resp;
+    }
+
+    /*!
+     * \brief Retrieves the records [start, start+count) of a record table, sliced from the
+     * unflushed writes or the cache if either holds the whole table
+     *
+     * \param start - the position of the first record to retrieve
+     * \param count - the most records to retrieve, cut short at the end of the table
+     * \param data - a reference to where the data is to be copied
+     *
+     * \return Response with success/fail of data retrieval with error message if it failed
+     */
+    template <typename T>
+    LoopProjectFileResponse ReadTableRange(size_t start, size_t count, std::vector<T>& data)
+    {
+        std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+        if (!isOpen) return createErrorMsg(1,"Project session is not open",verbose);
+        std::shared_ptr<const std::vector<T> > table = FindTable<T>();
+        if (!table) {
+            data.clear();
+            return RecordTable<T>::GetRange(&root, data, start, count, verbose);
+        }
+        if (start > table->size()) start = table->size();
+        if (count > table->size() - start) count = table->size() - start;
+        data.assign(table->begin() + start, table->begin() + start + count);
+        return {0,""};
+    }
+
+    /*!
+     * \brief Gets the number of records in a record table without reading them from the file
+     *
+     * \param count - a reference to return the number of records
+     *
+     * \return Response with success/fail of the count with error message if it failed
+     */
+    template <typename T>
+    LoopProjectFileResponse GetRecordCount(size_t& count)
+    {
+        std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+        if (!isOpen) return createErrorMsg(1,"Project session is not open",verbose);
+        std::shared_ptr<const std::vector<T> > table = FindTable<T>();
+        if (table) {
+            count = table->size();
+            return {0,""};
+        }
+        return RecordStorage::GetRecordCount<T>(&root, count, verbose);
+    }
+
+    /*!
+     * \brief Replaces a record table (e.g. std::vector<FaultObservation>). In write back mode the
+     * table is held in memory, replacing any earlier unflushed write of it, until Flush()
+     *
+     * \param data - the records to write
+     *
+     * \return Response with success/fail of data insertion with error message if it failed
+     */
+    template <typename T>
+    LoopProjectFileResponse WriteTable(const std::vector<T>& data)
+    {
+        std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+        if (!isOpen) return createErrorMsg(1,"Project session is not open",verbose);
+        if (readOnly) return createErrorMsg(1,"Project session is read only",verbose);
+        cache.Invalidate(SessionCacheKey(RecordTable<T>::GroupPath(), RecordTable<T>::Variable()));
+        if (!writeBack) return RecordTable<T>::Set(&root, data, verbose);
+        std::shared_ptr<const std::vector<T> > table = std::make_shared<const std::vector<T> >(data);
+        PendingTable& pending = pendingTables[std::make_pair(std::string(RecordTable<T>::GroupPath()), std::string(RecordTable<T>::Variable()))];
+        pending.data = table;
+        pending.flush = [table](netCDF::NcGroup* rootNode, bool verbose) { return RecordTable<T>::Set(rootNode, *table, verbose); };
+        return {0,""};
+    }
+
+    /*!
+     * \brief Retrieves the records of a table that match a filter, reading the table in batches
+     * (see RecordStorage::ScanRecords). Pending write back tables are flushed first
+     *
+     * \param filter - the conditions records must meet
+     * \param matches - a reference to return the matching records
+     * \param batchSize - the number of records read per hyperslab
+     *
+     * \return Response with success/fail of the scan with error message if it failed
+     */
+    template <typename T>
+    LoopProjectFileResponse ScanTable(const RecordFilter& filter, std::vector<T>& matches, size_t batchSize = LOOP_SCAN_BATCH_RECORDS)
+    {
+        std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+        if (!isOpen) return createErrorMsg(1,"Project session is not open",verbose);
+        LoopProjectFileResponse resp = Flush();
+        if (resp.errorCode) return resp;
+        return RecordStorage::ScanRecords(&root, filter, matches, batchSize, verbose);
+    }
+
+    /*!
+     * \brief Replaces individual records of a table (see RecordStorage::UpdateRecords). Pending
+     * write back tables are flushed first
+     *
+     * \param indices - the position of each record to replace
+     * \param records - the new records, one per index
+     *
+     * \return Response with success/fail of data insertion with error message if it failed
+     */
+    template <typename T>
+    LoopProjectFileResponse UpdateRecords(const std::vector<size_t>& indices, const std::vector<T>& records)
+    {
+        std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+        if (!isOpen) return createErrorMsg(1,"Project session is not open",verbose);
+        if (readOnly) return createErrorMsg(1,"Project session is read only",verbose);
+        LoopProjectFileResponse resp = Flush();
+        if (resp.errorCode) return resp;
+        cache.Invalidate(SessionCacheKey(RecordTable<T>::GroupPath(), RecordTable<T>::Variable()));
+        return RecordStorage::UpdateRecords(&root, indices, records, verbose);
+    }
+
+    /*!
+     * \brief Deletes individual records of a table (see RecordStorage::DeleteRecords). Pending
+     * write back tables are flushed first
+     *
+     * \param indices - the positions of the records to delete
+     * \param compact - whether to move the remaining records together afterwards
+     *
+     * \return Response with success/fail of the deletion with error message if it failed
+     */
+    template <typename T>
+    LoopProjectFileResponse DeleteRecords(const std::vector<size_t>& indices, bool compact = false)
+    {
+        std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+        if (!isOpen) return createErrorMsg(1,"Project session is not open",verbose);
+        if (readOnly) return createErrorMsg(1,"Project session is read only",verbose);
+        LoopProjectFileResponse resp = Flush();
+        if (resp.errorCode) return resp;
+        cache.Invalidate(SessionCacheKey(RecordTable<T>::GroupPath(), RecordTable<T>::Variable()));
+        return RecordStorage::DeleteRecords<T>(&root, indices, compact, verbose);
+    }
+
+    /*!
+     * \brief Moves the remaining records of a table together after deletions (see RecordStorage::CompactRecords)
+     *
+     * \return Response with success/fail of the compaction with error message if it failed
+     */
+    template <typename T>
+    LoopProjectFileResponse CompactRecords()
+    {
+        std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+        if (!isOpen) return createErrorMsg(1,"Project session is not open",verbose);
+        if (readOnly) return createErrorMsg(1,"Project session is read only",verbose);
+        LoopProjectFileResponse resp = Flush();
+        if (resp.errorCode) return resp;
+        return RecordStorage::CompactRecords<T>(&root, verbose);
+    }
+
+    /*!
+     * \brief Turns write back of record tables on or off (off by default). Turning it off flushes
+     *
+     * \param enabled - whether WriteTable() holds tables in memory until Flush()
+     *
+     * \return Response with success/fail of the flush with an error message if it failed
+     */
+    LoopProjectFileResponse SetWriteBack(bool enabled);
+
+    /*! \brief Whether WriteTable() holds tables in memory until Flush() */
+    bool IsWriteBack() const { return writeBack; }
+
+    /*!
+     * \brief Writes each table held by write back to the file once, grouped by group path so
+     * each group's metadata is loaded and updated together. Tables that fail to write stay held
+     *
+     * \return Response with success/fail of the writes with an error message if any failed
+     */
+    LoopProjectFileResponse Flush();
+
+    /*! \brief The number of tables written in write back mode and not yet flushed */
+    size_t GetPendingTableCount();
+
+    /*!
+     * \brief Retrieves a model
+     *
+     * \param modelType - the model group to read from
+     * \param index - the index location for the data
+     * \param data - a reference to where the data is to be copied
+     * \param dataShape - a reference to return the dimensions of the data
+     *
+     * \return Response with success/fail of data retrieval with error message if it failed
+     */
+    LoopProjectFileResponse ReadModel(ModelType modelType, unsigned int index, std::vector<float>& data, std::vector<int>& dataShape);
+
+    /*!
+     * \brief Lists which index locations of a model group hold a model (see ModelStorage::ListValidModels)
+     *
+     * \param modelType - the model group to list
+     * \param valid - a reference to return one flag per index location (non-zero if it holds a model)
+     *
+     * \return Response with success/fail of reading the flags with error message if it failed
+     */
+    LoopProjectFileResponse ListValidModels(ModelType modelType, std::vector<char>& valid);
+
+    /*!
+     * \brief Inserts a model
+     *
+     * \param modelType - the model group to write to
+     * \param index - the index location for the data
+     * \param data - the model data
+     * \param dataShape - the dimensions of the data
+     *
+     * \return Response with success/fail of data insertion with error message if it failed
+     */
+    LoopProjectFileResponse WriteModel(ModelType modelType, unsigned int index, const std::vector<float>& data, const std::vector<int>& dataShape);
+
+    /*!
+     * \brief Prepares a model group for writing a large ensemble (see ModelStorage::PrepareModelGroup)
+     *
+     * \param modelType - the type of model group to prepare
+     * \param options - the data layout and the number of models to preallocate
+     *
+     * \return Response with success/fail of preparing the group with an error message if it failed
+     */
+    LoopProjectFileResponse PrepareModels(ModelType modelType, const ModelWriteOptions& options);
+
+    /*!
+     * \brief Enters define mode so the attributes written by following configuration setters
+     * (extents, data collection and structural model configuration) are committed together
+     *
+     * \return Response with success/fail of starting the batch with an error message if it failed
+     */
+    LoopProjectFileResponse BeginMetadataBatch();
+
+    /*!
+     * \brief Commits the attributes written since BeginMetadataBatch()
+     *
+     * \return Response with success/fail of the commit with an error message if it failed
+     */
+    LoopProjectFileResponse CommitMetadataBatch();
+
+    /*!
+     * \brief Sets the memory limit of the decoded model and table cache, evicting the least
+     * recently used data to fit. The cache is disabled (0) by default and is emptied on closing
+     *
+     * \param bytes - the most bytes of decoded data to hold
+     */
+    void SetCacheLimit(size_t bytes);
+
+    /*! \brief The hit, miss and size counters of the decoded model and table cache */
+    SessionCacheStatistics GetCacheStatistics();
+
+    /*! \brief Zeros the hit, miss, eviction and invalidation counters of the cache */
+    void ResetCacheStatistics();
+
+    /*! \brief Drops everything held by the cache */
+    void ClearCache();
+
+    /*!
+     * \brief Sets the chunk cache of a variable. The setting is kept and reapplied on reopening
+     *
+     * \param groupName - the full group path of the variable (e.g. "StructuralModels")
+     * \param variableName - the name of the variable
+     * \param settings - the chunk cache parameters
+     *
+     * \return Response with success/fail of setting the cache with an error message if it failed
+     */
+    LoopProjectFileResponse SetChunkCache(std::string groupName, std::string variableName, const ChunkCacheSettings& settings);
+
+    /*! \brief Sets the chunk cache of a model group's data variable (see above) */
+    LoopProjectFileResponse SetChunkCache(ModelType modelType, const ChunkCacheSettings& settings);
+
+    /*!
+     * \brief Gets the chunk cache currently in use by a variable
+     *
+     * \param groupName - the full group path of the variable
+     * \param variableName - the name of the variable
+     * \param settings - a reference to where the parameters are to be copied
+     *
+     * \return Response with success/fail of the query with an error message if it failed
+     */
+    LoopProjectFileResponse GetChunkCache(std::string groupName, std::string variableName, ChunkCacheSettings& settings);
+
+    /*!
+     * \brief Sizes and sets the chunk cache of a model group's data variable for an access pattern,
+     * using the variable's chunk shape and the extents grid
+     *
+     * \param modelType - the model group to configure
+     * \param preset - the access pattern
+     * \param applied - optionally, where to copy the settings that were applied
+     *
+     * \return Response with success/fail of setting the cache with an error message if it failed
+     */
+    LoopProjectFileResponse ApplyChunkCachePreset(ModelType modelType, ChunkCachePreset preset, ChunkCacheSettings* applied = NULL);
+
+    /*!
+     * \brief Calculates the chunk cache for an access pattern from a chunk shape and a model grid
+     *
+     * \param preset - the access pattern
+     * \param chunkShape - the chunk sizes of the data variable (easting, northing, depth, index)
+     * \param gridShape - the sizes of the data variable (easting, northing, depth, index)
+     * \param elementSize - the size of one value in bytes
+     *
+     * \return The chunk cache settings (size 0 for an invalid preset or shape)
+     */
+    static ChunkCacheSettings CalculateChunkCachePreset(ChunkCachePreset preset, const std::vector<size_t>& chunkShape, const std::vector<size_t>& gridShape, size_t elementSize);
+
+private:
+    LoopProjectFileResponse ApplyChunkCache(std::string groupName, std::string variableName, const ChunkCacheSettings& settings);
+    LoopProjectFileResponse ReapplyChunkCaches();
+    void CloseFile();
+
+    // The whole of a record table from the unflushed writes or the cache, if either holds it
+    template <typename T>
+    std::shared_ptr<const std::vector<T> > FindTable()
+    {
+        auto pending = pendingTables.find(std::make_pair(std::string(RecordTable<T>::GroupPath()), std::string(RecordTable<T>::Variable())));
+        if (pending != pendingTables.end()) return std::static_pointer_cast<const std::vector<T> >(pending->second.data);
+        return cache.Find<std::vector<T> >(SessionCacheKey(RecordTable<T>::GroupPath(), RecordTable<T>::Variable()));
+    }
+
+    // A table written in write back mode along with how to write it out
+    struct PendingTable {
+        std::shared_ptr<const void> data;
+        std::function<LoopProjectFileResponse(netCDF::NcGroup*, bool)> flush;
+    };
+
+    netCDF::NcFile file;
+    netCDF::NcGroup root;
+    std::string filename;
+    bool isOpen;
+    bool readOnly;
+    bool verbose;
+    std::map<std::pair<std::string, std::string>, ChunkCacheSettings> chunkCaches;
+    std::unique_ptr<MetadataBatch> metadataBatch;
+    SessionCache cache;
+    bool writeBack;
+    // Keyed by group path and variable so flushing visits each group once
+    std::map<std::pair<std::string, std::string>, PendingTable> pendingTables;
+    int memoryId;
+    const void* callerBuffer;
+    size_t callerBufferSize;
+
+    ProjectSession(const ProjectSession&) = delete;
+    ProjectSession& operator=(const ProjectSession&) = delete;
+};
+
+} // namespace LoopProjectFile
+
+#endif
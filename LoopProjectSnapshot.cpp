@@ -0,0 +1,298 @@
+#include "LoopProjectSnapshot.h"
+#include "LoopGeophysicalModels.h"
+#include "LoopUncertaintyModels.h"
+#include "LoopModelStorage.h"
+#include "LoopProjectFileMetrics.h"
+#include "LoopProjectFileTrace.h"
+
+namespace LoopProjectFile {
+
+SnapshotModels::SnapshotModels(ProjectArena* arena)
+    : dataShape(BulkLoadAllocator<int>(arena)),
+      indices(BulkLoadAllocator<unsigned int>(arena)),
+      data(BulkLoadAllocator<float>(arena))
+{
+}
+
+size_t SnapshotModels::GetModelSize() const
+{
+    if (dataShape.size() != 3) return 0;
+    return static_cast<size_t>(dataShape[0]) * dataShape[1] * dataShape[2];
+}
+
+const float* SnapshotModels::GetModel(size_t i) const
+{
+    if (i >= indices.size()) return NULL;
+    return &data[i * GetModelSize()];
+}
+
+ProjectSnapshot::ProjectSnapshot(size_t blockSize)
+    : arena(blockSize),
+      faultObservations(BulkLoadAllocator<FaultObservation>(&arena)),
+      foldObservations(BulkLoadAllocator<FoldObservation>(&arena)),
+      foliationObservations(BulkLoadAllocator<FoliationObservation>(&arena)),
+      discontinuityObservations(BulkLoadAllocator<DiscontinuityObservation>(&arena)),
+      stratigraphicObservations(BulkLoadAllocator<StratigraphicObservation>(&arena)),
+      contacts(BulkLoadAllocator<ContactObservation>(&arena)),
+      drillholeObservations(BulkLoadAllocator<DrillholeObservation>(&arena)),
+      drillholeProperties(BulkLoadAllocator<DrillholeProperty>(&arena)),
+      drillholeSurveys(BulkLoadAllocator<DrillholeSurvey>(&arena)),
+      faultEvents(BulkLoadAllocator<FaultEvent>(&arena)),
+      foldEvents(BulkLoadAllocator<FoldEvent>(&arena)),
+      foliationEvents(BulkLoadAllocator<FoliationEvent>(&arena)),
+      discontinuityEvents(BulkLoadAllocator<DiscontinuityEvent>(&arena)),
+      stratigraphicLayers(BulkLoadAllocator<StratigraphicLayer>(&arena)),
+      eventRelationships(BulkLoadAllocator<EventRelationship>(&arena)),
+      drillholeDescriptions(BulkLoadAllocator<DrillholeDescription>(&arena)),
+      structuralModels(&arena),
+      geophysicalModels(&arena),
+      uncertaintyModels(&arena)
+{
+}
+
+// Replaces the vector with an empty one on the same arena. Arena deallocation is a
+// no-op so this only drops the reference; the memory is reclaimed by arena.Reset()
+template <typename T>
+static void ClearBulkVector(BulkVector<T>& records)
+{
+    BulkVector<T> empty(records.get_allocator());
+    records.swap(empty);
+}
+
+static void ClearSnapshotModels(SnapshotModels& models)
+{
+    ClearBulkVector(models.dataShape);
+    ClearBulkVector(models.indices);
+    ClearBulkVector(models.data);
+}
+
+void ProjectSnapshot::Clear()
+{
+    version = LoopVersion();
+    extents = LoopExtents();
+    dataCollectionConfiguration = DataCollectionConfiguration();
+    dataCollectionSources = DataCollectionSources();
+    structuralModelsConfiguration = StructuralModelsConfiguration();
+    ClearBulkVector(faultObservations);
+    ClearBulkVector(foldObservations);
+    ClearBulkVector(foliationObservations);
+    ClearBulkVector(discontinuityObservations);
+    ClearBulkVector(stratigraphicObservations);
+    ClearBulkVector(contacts);
+    ClearBulkVector(drillholeObservations);
+    ClearBulkVector(drillholeProperties);
+    ClearBulkVector(drillholeSurveys);
+    ClearBulkVector(faultEvents);
+    ClearBulkVector(foldEvents);
+    ClearBulkVector(foliationEvents);
+    ClearBulkVector(discontinuityEvents);
+    ClearBulkVector(stratigraphicLayers);
+    ClearBulkVector(eventRelationships);
+    ClearBulkVector(drillholeDescriptions);
+    ClearSnapshotModels(structuralModels);
+    ClearSnapshotModels(geophysicalModels);
+    ClearSnapshotModels(uncertaintyModels);
+    arena.Reset();
+}
+
+// Returns the number of records in a table or 0 if the table is not present in the file
+static size_t CountTableRecords(netCDF::NcGroup* rootNode, std::string parentName, std::string groupName, std::string dimensionName)
+{
+    try {
+        auto groups = rootNode->getGroups();
+        if (groups.find(parentName) == groups.end()) return 0;
+        netCDF::NcGroup parentGroup = rootNode->getGroup(parentName);
+        auto subGroups = parentGroup.getGroups();
+        if (subGroups.find(groupName) == subGroups.end()) return 0;
+        netCDF::NcDim dim = parentGroup.getGroup(groupName).getDim(dimensionName);
+        return dim.isNull() ? 0 : dim.getSize();
+    } catch (netCDF::exceptions::NcException&) {
+        return 0;
+    }
+}
+
+// Returns the number of model slots in a model group (and the size of each) or 0 if not present
+static size_t CountModels(netCDF::NcGroup* rootNode, std::string groupName, size_t& modelSize)
+{
+    modelSize = 0;
+    try {
+        auto groups = rootNode->getGroups();
+        if (groups.find(groupName) == groups.end()) return 0;
+        netCDF::NcGroup modelGroup = rootNode->getGroup(groupName);
+        modelSize = modelGroup.getDim("easting").getSize()
+            * modelGroup.getDim("northing").getSize()
+            * modelGroup.getDim("depth").getSize();
+        return modelGroup.getDim("index").getSize();
+    } catch (netCDF::exceptions::NcException&) {
+        modelSize = 0;
+        return 0;
+    }
+}
+
+// Worst case padding added by the arena when aligning each table
+#define LOOP_SNAPSHOT_TABLE_PADDING 16
+
+template <typename T>
+static size_t TableBytes(size_t numRecords)
+{
+    return numRecords > 0 ? numRecords * sizeof(T) + LOOP_SNAPSHOT_TABLE_PADDING : 0;
+}
+
+static LoopProjectFileResponse LoadSnapshotModels(netCDF::NcGroup* rootNode, std::string groupName, SnapshotModels& models, bool verbose)
+{
+    LoopProjectFileResponse resp = {0,""};
+    try {
+        netCDF::NcGroup modelGroup = rootNode->getGroup(groupName);
+        size_t numModels = modelGroup.getDim("index").getSize();
+        models.dataShape.resize(3);
+        models.dataShape[0] = static_cast<int>(modelGroup.getDim("easting").getSize());
+        models.dataShape[1] = static_cast<int>(modelGroup.getDim("northing").getSize());
+        models.dataShape[2] = static_cast<int>(modelGroup.getDim("depth").getSize());
+        size_t modelSize = models.GetModelSize();
+        if (numModels == 0 || modelSize == 0) return resp;
+
+        // Only the slots flagged as written are read (groups from older files without flags report every slot)
+        std::vector<char> valid;
+        resp = ModelStorage::ListValidModels(modelGroup, valid, verbose);
+        if (resp.errorCode) return resp;
+        size_t numValid = 0;
+        for (size_t i=0;i<numModels;i++) if (valid[i]) numValid++;
+
+        models.indices.resize(numValid);
+        models.data.resize(numValid * modelSize);
+        netCDF::NcVar dataVar = modelGroup.getVar("data");
+        std::vector<size_t> start(4,0);
+        std::vector<size_t> count;
+        count.push_back(models.dataShape[0]);
+        count.push_back(models.dataShape[1]);
+        count.push_back(models.dataShape[2]);
+        count.push_back(1);
+        size_t pos = 0;
+        for (size_t i=0;i<numModels;i++) {
+            if (!valid[i]) continue;
+            start[3] = i;
+            LOOP_TRACE_SPAN("ReadModel","io");
+            dataVar.getVar(start,count,&models.data[pos * modelSize]);
+            Metrics::RecordRead<float>(dataVar,modelSize);
+            models.indices[pos] = static_cast<unsigned int>(i);
+            pos++;
+        }
+    } catch (netCDF::exceptions::NcException& e) {
+        if (verbose) std::cout << e.what() << std::endl;
+        resp = createErrorMsg(1,"Failed to read " + groupName + " into project snapshot",verbose);
+    }
+    return resp;
+}
+
+// Runs a table getter only when the table exists so absent tables are not errors
+#define LOOP_SNAPSHOT_LOAD_TABLE(NUMRECORDS,FUNCTION,CONTAINER) \
+    if (NUMRECORDS > 0) { \
+        resp = FUNCTION(rootNode, CONTAINER, verbose); \
+        if (resp.errorCode) return resp; \
+    }
+
+LoopProjectFileResponse Snapshot::LoadSnapshot(netCDF::NcGroup* rootNode, ProjectSnapshot& snapshot, bool includeModels, bool verbose)
+{
+    LoopProjectFileResponse resp = {0,""};
+    snapshot.Clear();
+
+    // Size every table first so the whole project lands in a single arena block
+    size_t numFaultObservations = CountTableRecords(rootNode,"DataCollection","Observations","faultObservationIndex");
+    size_t numFoldObservations = CountTableRecords(rootNode,"DataCollection","Observations","foldObservationIndex");
+    size_t numFoliationObservations = CountTableRecords(rootNode,"DataCollection","Observations","foliationObservationIndex");
+    size_t numDiscontinuityObservations = CountTableRecords(rootNode,"DataCollection","Observations","discontinuityObservationIndex");
+    size_t numStratigraphicObservations = CountTableRecords(rootNode,"DataCollection","Observations","stratigraphicObservationIndex");
+    size_t numContacts = CountTableRecords(rootNode,"DataCollection","Contacts","index");
+    size_t numDrillholeObservations = CountTableRecords(rootNode,"DataCollection","Drillholes","drillholeObservationIndex");
+    size_t numDrillholeProperties = CountTableRecords(rootNode,"DataCollection","Drillholes","drillholePropertyIndex");
+    size_t numDrillholeSurveys = CountTableRecords(rootNode,"DataCollection","Drillholes","drillholeSurveyIndex");
+    size_t numFaultEvents = CountTableRecords(rootNode,"ExtractedInformation","EventLog","faultEventIndex");
+    size_t numFoldEvents = CountTableRecords(rootNode,"ExtractedInformation","EventLog","foldEventIndex");
+    size_t numFoliationEvents = CountTableRecords(rootNode,"ExtractedInformation","EventLog","foliationEventIndex");
+    size_t numDiscontinuityEvents = CountTableRecords(rootNode,"ExtractedInformation","EventLog","discontinuityEventIndex");
+    size_t numStratigraphicLayers = CountTableRecords(rootNode,"ExtractedInformation","StratigraphicInformation","index");
+    size_t numEventRelationships = CountTableRecords(rootNode,"ExtractedInformation","EventRelationships","index");
+    size_t numDrillholeDescriptions = CountTableRecords(rootNode,"ExtractedInformation","DrillholeInformation","index");
+
+    size_t totalBytes = TableBytes<FaultObservation>(numFaultObservations)
+        + TableBytes<FoldObservation>(numFoldObservations)
+        + TableBytes<FoliationObservation>(numFoliationObservations)
+        + TableBytes<DiscontinuityObservation>(numDiscontinuityObservations)
+        + TableBytes<StratigraphicObservation>(numStratigraphicObservations)
+        + TableBytes<ContactObservation>(numContacts)
+        + TableBytes<DrillholeObservation>(numDrillholeObservations)
+        + TableBytes<DrillholeProperty>(numDrillholeProperties)
+        + TableBytes<DrillholeSurvey>(numDrillholeSurveys)
+        + TableBytes<FaultEvent>(numFaultEvents)
+        + TableBytes<FoldEvent>(numFoldEvents)
+        + TableBytes<FoliationEvent>(numFoliationEvents)
+        + TableBytes<DiscontinuityEvent>(numDiscontinuityEvents)
+        + TableBytes<StratigraphicLayer>(numStratigraphicLayers)
+        + TableBytes<EventRelationship>(numEventRelationships)
+        + TableBytes<DrillholeDescription>(numDrillholeDescriptions);
+
+    size_t numStructuralModels = 0, numGeophysicalModels = 0, numUncertaintyModels = 0;
+    if (includeModels) {
+        size_t modelSize = 0;
+        numStructuralModels = CountModels(rootNode,"StructuralModels",modelSize);
+        if (numStructuralModels) totalBytes += numStructuralModels * (modelSize * sizeof(float) + sizeof(unsigned int)) + 3 * sizeof(int) + 3 * LOOP_SNAPSHOT_TABLE_PADDING;
+        numGeophysicalModels = CountModels(rootNode,"GeophysicalModels",modelSize);
+        if (numGeophysicalModels) totalBytes += numGeophysicalModels * (modelSize * sizeof(float) + sizeof(unsigned int)) + 3 * sizeof(int) + 3 * LOOP_SNAPSHOT_TABLE_PADDING;
+        numUncertaintyModels = CountModels(rootNode,"UncertaintyModels",modelSize);
+        if (numUncertaintyModels) totalBytes += numUncertaintyModels * (modelSize * sizeof(float) + sizeof(unsigned int)) + 3 * sizeof(int) + 3 * LOOP_SNAPSHOT_TABLE_PADDING;
+    }
+    if (totalBytes > 0) snapshot.arena.Reserve(totalBytes);
+    if (verbose) std::cout << "Project snapshot reserved " << totalBytes << " bytes" << std::endl;
+
+    snapshot.version = LoopVersion::GetVersion(rootNode,verbose);
+    LoopExtents::GetExtents(rootNode,snapshot.extents,verbose);
+    // Configuration attributes are optional so a missing attribute leaves the defaults in place
+    try {
+        DataCollection::GetDataCollectionConfiguration(rootNode,snapshot.dataCollectionConfiguration,verbose);
+    } catch (netCDF::exceptions::NcException&) {
+        snapshot.dataCollectionConfiguration = DataCollectionConfiguration();
+    }
+    try {
+        DataCollection::GetDataCollectionSources(rootNode,snapshot.dataCollectionSources,verbose);
+    } catch (netCDF::exceptions::NcException&) {
+        snapshot.dataCollectionSources = DataCollectionSources();
+    }
+    try {
+        StructuralModels::GetStructuralModelsConfiguration(rootNode,snapshot.structuralModelsConfiguration,verbose);
+    } catch (netCDF::exceptions::NcException&) {
+        snapshot.structuralModelsConfiguration = StructuralModelsConfiguration();
+    }
+
+    LOOP_SNAPSHOT_LOAD_TABLE(numFaultObservations,DataCollection::GetFaultObservations,snapshot.faultObservations);
+    LOOP_SNAPSHOT_LOAD_TABLE(numFoldObservations,DataCollection::GetFoldObservations,snapshot.foldObservations);
+    LOOP_SNAPSHOT_LOAD_TABLE(numFoliationObservations,DataCollection::GetFoliationObservations,snapshot.foliationObservations);
+    LOOP_SNAPSHOT_LOAD_TABLE(numDiscontinuityObservations,DataCollection::GetDiscontinuityObservations,snapshot.discontinuityObservations);
+    LOOP_SNAPSHOT_LOAD_TABLE(numStratigraphicObservations,DataCollection::GetStratigraphicObservations,snapshot.stratigraphicObservations);
+    LOOP_SNAPSHOT_LOAD_TABLE(numContacts,DataCollection::GetContactObservations,snapshot.contacts);
+    LOOP_SNAPSHOT_LOAD_TABLE(numDrillholeObservations,DataCollection::GetDrillholeObservations,snapshot.drillholeObservations);
+    LOOP_SNAPSHOT_LOAD_TABLE(numDrillholeProperties,DataCollection::GetDrillholeProperties,snapshot.drillholeProperties);
+    LOOP_SNAPSHOT_LOAD_TABLE(numDrillholeSurveys,DataCollection::GetDrillholeSurveys,snapshot.drillholeSurveys);
+    LOOP_SNAPSHOT_LOAD_TABLE(numFaultEvents,ExtractedInformation::GetFaultEvents,snapshot.faultEvents);
+    LOOP_SNAPSHOT_LOAD_TABLE(numFoldEvents,ExtractedInformation::GetFoldEvents,snapshot.foldEvents);
+    LOOP_SNAPSHOT_LOAD_TABLE(numFoliationEvents,ExtractedInformation::GetFoliationEvents,snapshot.foliationEvents);
+    LOOP_SNAPSHOT_LOAD_TABLE(numDiscontinuityEvents,ExtractedInformation::GetDiscontinuityEvents,snapshot.discontinuityEvents);
+    LOOP_SNAPSHOT_LOAD_TABLE(numStratigraphicLayers,ExtractedInformation::GetStratigraphicLayers,snapshot.stratigraphicLayers);
+    LOOP_SNAPSHOT_LOAD_TABLE(numEventRelationships,ExtractedInformation::GetEventRelationships,snapshot.eventRelationships);
+    LOOP_SNAPSHOT_LOAD_TABLE(numDrillholeDescriptions,ExtractedInformation::GetDrillholeDescriptions,snapshot.drillholeDescriptions);
+
+    if (numStructuralModels) {
+        resp = LoadSnapshotModels(rootNode,"StructuralModels",snapshot.structuralModels,verbose);
+        if (resp.errorCode) return resp;
+    }
+    if (numGeophysicalModels) {
+        resp = LoadSnapshotModels(rootNode,"GeophysicalModels",snapshot.geophysicalModels,verbose);
+        if (resp.errorCode) return resp;
+    }
+    if (numUncertaintyModels) {
+        resp = LoadSnapshotModels(rootNode,"UncertaintyModels",snapshot.uncertaintyModels,verbose);
+        if (resp.errorCode) return resp;
+    }
+    return resp;
+}
+
+} // namespace LoopProjectFile
@@ -0,0 +1,113 @@
+#ifndef __LOOPPROJECTSNAPSHOT_H
+#define __LOOPPROJECTSNAPSHOT_H
+
+#include <netcdf>
+#include "LoopProjectFileUtils.h"
+#include "LoopVersion.h"
+#include "LoopExtents.h"
+#include "LoopDataCollection.h"
+#include "LoopExtractedInformation.h"
+#include "LoopStructuralModels.h"
+
+namespace LoopProjectFile
+{
+
+    /*! \brief The models of one model group stored back to back in a single buffer */
+    struct SnapshotModels
+    {
+        BulkVector<int> dataShape;        /*!< The dimensions of every model (easting, northing, depth) */
+        BulkVector<unsigned int> indices; /*!< The project file index of each model loaded */
+        BulkVector<float> data;           /*!< The model data, one model after another in the order of indices */
+
+        /*! Constructor. Places all buffers in the given arena */
+        explicit SnapshotModels(ProjectArena *arena);
+
+        /*! \brief The number of values in a single model */
+        size_t GetModelSize() const;
+
+        /*!
+         * \brief Gets a model from the buffer
+         *
+         * \param i - the position of the model in indices (not the project file index)
+         *
+         * \return A pointer to the first value of the model
+         */
+        const float *GetModel(size_t i) const;
+    };
+
+    /*! \brief The decoded contents of a whole loop project file
+     *
+     * Every table and model is placed in a single arena, sized before the first read so a
+     * complete project normally occupies one allocation. Clear() (or destruction) releases
+     * everything together which keeps long-lived batch workers free of allocator churn and
+     * fragmentation. A snapshot can be reused across files; the largest arena block is kept.
+     */
+    struct ProjectSnapshot
+    {
+        ProjectArena arena; /*!< The arena holding every table below. Declared first so it outlives them */
+
+        LoopVersion version;
+        LoopExtents extents;
+        DataCollectionConfiguration dataCollectionConfiguration;
+        DataCollectionSources dataCollectionSources;
+        StructuralModelsConfiguration structuralModelsConfiguration;
+
+        /*! @{ Data collection tables */
+        BulkVector<FaultObservation> faultObservations;
+        BulkVector<FoldObservation> foldObservations;
+        BulkVector<FoliationObservation> foliationObservations;
+        BulkVector<DiscontinuityObservation> discontinuityObservations;
+        BulkVector<StratigraphicObservation> stratigraphicObservations;
+        BulkVector<ContactObservation> contacts;
+        BulkVector<DrillholeObservation> drillholeObservations;
+        BulkVector<DrillholeProperty> drillholeProperties;
+        BulkVector<DrillholeSurvey> drillholeSurveys;
+        /*!@}*/
+
+        /*! @{ Extracted information tables */
+        BulkVector<FaultEvent> faultEvents;
+        BulkVector<FoldEvent> foldEvents;
+        BulkVector<FoliationEvent> foliationEvents;
+        BulkVector<DiscontinuityEvent> discontinuityEvents;
+        BulkVector<StratigraphicLayer> stratigraphicLayers;
+        BulkVector<EventRelationship> eventRelationships;
+        BulkVector<DrillholeDescription> drillholeDescriptions;
+        /*!@}*/
+
+        /*! @{ Models */
+        SnapshotModels structuralModels;
+        SnapshotModels geophysicalModels;
+        SnapshotModels uncertaintyModels;
+        /*!@}*/
+
+        /*!
+         * \brief Constructor
+         *
+         * \param blockSize - the arena block size used when a load outgrows its initial reservation
+         */
+        explicit ProjectSnapshot(size_t blockSize = LOOP_ARENA_DEFAULT_BLOCK_SIZE);
+
+        /*! \brief Empties every table and releases the arena contents together */
+        void Clear();
+    };
+
+    namespace Snapshot
+    {
+
+        /*!
+         * \brief Decodes the whole loop project file into a snapshot. The snapshot is cleared
+         * first and the arena is sized from the table and model dimensions before any data is read
+         *
+         * \param rootNode - the rootNode of the netCDF Loop project file
+         * \param snapshot - a reference to the snapshot to fill
+         * \param includeModels - a flag to toggle loading of the structural, geophysical and uncertainty models
+         * \param verbose - a flag to toggle verbose message printing
+         *
+         * \return Response with success/fail of the load with an error message if it failed
+         */
+        LoopProjectFileResponse LoadSnapshot(netCDF::NcGroup *rootNode, ProjectSnapshot &snapshot, bool includeModels = true, bool verbose = false);
+
+    } // namespace Snapshot
+} // namespace LoopProjectFile
+
+#endif
@@ -0,0 +1,357 @@
+#include "LoopProjectValidation.h"
+#include "LoopProjectFile.h"
+#include "LoopProjectFileAsync.h"
+#include "LoopProjectIntegrity.h"
+#include "LoopRecordTables.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#ifndef _WIN32
+#define LOOP_VALIDATION_CACHE_SUPPORTED
+#endif
+
+namespace LoopProjectFile {
+
+/*****************************************************************************/
+/*                             VALIDATION CACHE                              */
+/*****************************************************************************/
+
+// The first line of a cache file, naming the version of the project file it was computed for
+static std::string CacheKey(const FileIdentity& identity)
+{
+    std::ostringstream key;
+    key << "loopvalidation " << LOOP_VALIDATION_VERSION << " " << identity.device << " " << identity.inode << " "
+        << identity.size << " " << identity.modifiedSec << "." << identity.modifiedNsec;
+    return key.str();
+}
+
+static bool ReadCachedResult(const std::string& filename, const FileIdentity& identity, ValidationReport& report)
+{
+    std::ifstream in((filename + LOOP_VALIDATION_CACHE_SUFFIX).c_str());
+    std::string line;
+    if (!in || !std::getline(in, line) || line != CacheKey(identity)) return false;
+    if (!std::getline(in, line) || (line != "0" && line != "1")) return false;
+    report.valid = line == "1";
+    report.problems.clear();
+    while (std::getline(in, line)) {
+        if (!line.empty()) report.problems.push_back(line);
+    }
+    report.cached = true;
+    return true;
+}
+
+static void WriteCachedResult(const std::string& filename, const FileIdentity& identity, const ValidationReport& report, bool verbose)
+{
+    // Leave the cache alone if the file changed while it was being validated
+    FileIdentity current;
+    if (!GetFileIdentity(filename, current) || current != identity) return;
+    // Written aside and renamed into place so readers never see a partial cache
+    std::string cacheFilename = filename + LOOP_VALIDATION_CACHE_SUFFIX;
+    std::ostringstream tempFilename;
+    tempFilename << cacheFilename << "." << std::hash<std::thread::id>()(std::this_thread::get_id()) << ".tmp";
+    std::ofstream out(tempFilename.str().c_str(), std::ios::out | std::ios::trunc);
+    out << CacheKey(identity) << "\n" << (report.valid ? 1 : 0) << "\n";
+    for (auto it=report.problems.begin(); it!=report.problems.end(); it++) out << *it << "\n";
+    out.close();
+    if (!out || std::rename(tempFilename.str().c_str(), cacheFilename.c_str()) != 0) {
+        // Files in directories that cannot be written are simply not cached
+        if (verbose) std::cout << "Failed to write the validation cache " << cacheFilename << std::endl;
+        std::remove(tempFilename.str().c_str());
+    }
+}
+
+/*****************************************************************************/
+/*                               DATA CHECKS                                 */
+/*****************************************************************************/
+
+// Sanity checks of record values, run on the batches read by the integrity check so each
+// table is read once
+class RecordChecks : public RecordBatchObserver
+{
+public:
+    using RecordBatchObserver::OnBatch;
+    void OnBatch(const FaultObservation* records, size_t count, size_t firstIndex) { CheckOrientations(records, count, firstIndex); }
+    void OnBatch(const FoldObservation* records, size_t count, size_t firstIndex) { CheckPositions(records, count, firstIndex); }
+    void OnBatch(const FoliationObservation* records, size_t count, size_t firstIndex) { CheckOrientations(records, count, firstIndex); }
+    void OnBatch(const DiscontinuityObservation* records, size_t count, size_t firstIndex) { CheckOrientations(records, count, firstIndex); }
+    void OnBatch(const StratigraphicObservation* records, size_t count, size_t firstIndex) { CheckOrientations(records, count, firstIndex); }
+    void OnBatch(const ContactObservation* records, size_t count, size_t firstIndex) { CheckPositions(records, count, firstIndex); }
+    void OnBatch(const DrillholeObservation* records, size_t count, size_t firstIndex)
+    {
+        CheckPositions(records, count, firstIndex);
+        Check(records, count, firstIndex, "end before they start", [](const DrillholeObservation& o) { return o.from > o.to; });
+    }
+    void OnBatch(const FaultEvent* records, size_t count, size_t firstIndex) { CheckAges(records, count, firstIndex); }
+    void OnBatch(const FoldEvent* records, size_t count, size_t firstIndex) { CheckAges(records, count, firstIndex); }
+    void OnBatch(const FoliationEvent* records, size_t count, size_t firstIndex) { CheckAges(records, count, firstIndex); }
+    void OnBatch(const DiscontinuityEvent* records, size_t count, size_t firstIndex) { CheckAges(records, count, firstIndex); }
+    void OnBatch(const StratigraphicLayer* records, size_t count, size_t firstIndex) { CheckAges(records, count, firstIndex); }
+
+    // Adds one problem summarising the records of a table that fail each test
+    bool Report(std::vector<std::string>& problems) const
+    {
+        for (auto it=failures.begin(); it!=failures.end(); it++) {
+            std::ostringstream problem;
+            problem << it->count << " " << it->variable << " records " << it->description << " (first at record " << it->first << ")";
+            problems.push_back(problem.str());
+        }
+        return failures.empty();
+    }
+
+private:
+    struct Failures {
+        std::string variable;
+        std::string description;
+        size_t count;
+        size_t first;
+    };
+    std::vector<Failures> failures;
+
+    template <typename T, typename Predicate>
+    void Check(const T* records, size_t count, size_t firstIndex, const char* description, Predicate isBad)
+    {
+        Failures* failed = NULL;
+        for (size_t i=0; i<count; i++) {
+            if (!isBad(records[i])) continue;
+            if (!failed) failed = &Find(RecordTable<T>::Variable(), description, firstIndex + i);
+            failed->count++;
+        }
+    }
+
+    // The failures of a test, added with the position of its first failure when first seen.
+    // Batches arrive in table order so that is the first in the table
+    Failures& Find(const char* variable, const char* description, size_t first)
+    {
+        for (auto it=failures.begin(); it!=failures.end(); it++) {
+            if (it->variable == variable && it->description == description) return *it;
+        }
+        Failures added = {variable, description, 0, first};
+        failures.push_back(added);
+        return failures.back();
+    }
+
+    template <typename T>
+    void CheckPositions(const T* records, size_t count, size_t firstIndex)
+    {
+        Check(records, count, firstIndex, "have a position that is not a number",
+            [](const T& o) { return !std::isfinite(o.easting) || !std::isfinite(o.northing) || !std::isfinite(o.altitude); });
+    }
+
+    template <typename T>
+    void CheckOrientations(const T* records, size_t count, size_t firstIndex)
+    {
+        CheckPositions(records, count, firstIndex);
+        Check(records, count, firstIndex, "have a dip outside 0 to 90 degrees",
+            [](const T& o) { return !(o.dip >= 0 && o.dip <= 90); });
+        Check(records, count, firstIndex, "have a dip direction outside 0 to 360 degrees",
+            [](const T& o) { return !(o.dipdir >= 0 && o.dipdir <= 360); });
+    }
+
+    template <typename T>
+    void CheckAges(const T* records, size_t count, size_t firstIndex)
+    {
+        Check(records, count, firstIndex, "have a minimum age after their maximum age",
+            [](const T& e) { return e.minAge > e.maxAge; });
+    }
+};
+
+// The contents of a file needed by the data checks
+struct ValidationData {
+    bool extentsPresent;
+    LoopExtents extents;
+    ProjectInventory inventory;
+    RecordChecks records;
+    IntegrityReport integrity;
+    ValidationData() : extentsPresent(false) {}
+};
+
+// Reads the extents and the inventory, which are small, under the netCDF lock held by the caller
+static bool LoadMetadata(netCDF::NcGroup* rootNode, ValidationData& data, std::vector<std::string>& problems, bool verbose)
+{
+    data.extentsPresent = !LoopExtents::GetExtents(rootNode, data.extents, verbose).errorCode;
+    LoopProjectFileResponse resp = Inventory::LoadInventory(rootNode, data.inventory, verbose);
+    if (resp.errorCode) {
+        problems.push_back("Cannot take an inventory of the file: " + resp.errorMessage);
+        return false;
+    }
+    return true;
+}
+
+// Reads the tables in one batched pass, checking record values and references between tables.
+// The netCDF lock is only held for each read so the checks overlap other files' reads
+static bool LoadTables(netCDF::NcGroup* rootNode, ValidationData& data, std::vector<std::string>& problems, bool verbose)
+{
+    // The files are already validated in parallel so the references are looked up on one thread
+    LoopProjectFileResponse resp = Integrity::CheckReferences(rootNode, data.integrity, 1, LOOP_INTEGRITY_BATCH_RECORDS, verbose, &data.records);
+    if (resp.errorCode) {
+        problems.push_back("Cannot check the tables: " + resp.errorMessage);
+        return false;
+    }
+    return true;
+}
+
+// Reports the orphans of the references whose table has been written
+static bool CheckReferences(const IntegrityReport& integrity, std::vector<std::string>& problems)
+{
+    bool valid = true;
+    for (auto it=integrity.checks.begin(); it!=integrity.checks.end(); it++) {
+        if (!it->referencePresent || !it->orphans) continue;
+        std::ostringstream problem;
+        problem << it->orphans << " " << it->variable << " records have an unknown " << it->member
+            << " (not in " << it->reference << ", first at record " << it->orphanIndices.front() << ")";
+        problems.push_back(problem.str());
+        valid = false;
+    }
+    return valid;
+}
+
+static bool CheckGrid(const ValidationData& data, std::vector<std::string>& problems)
+{
+    // Missing extents are reported by the structural checks
+    if (!data.extentsPresent) return true;
+    const LoopExtents& extents = data.extents;
+    bool valid = true;
+    if (!(extents.maxEasting > extents.minEasting) || !(extents.maxNorthing > extents.minNorthing) || !(extents.topDepth > extents.bottomDepth)) {
+        problems.push_back("Extents do not enclose a volume");
+        valid = false;
+    }
+    if (!(extents.spacingX > 0) || !(extents.spacingY > 0) || !(extents.spacingZ > 0)) {
+        problems.push_back("Extents spacing is not positive");
+        return false;
+    }
+    std::vector<int> grid;
+    grid.push_back((int)((extents.maxEasting-extents.minEasting)/extents.spacingX + 1));
+    grid.push_back((int)((extents.maxNorthing-extents.minNorthing)/extents.spacingY + 1));
+    grid.push_back((int)((extents.topDepth-extents.bottomDepth)/extents.spacingZ + 1));
+    for (int i=0; i<NUM_MODEL_TYPES; i++) {
+        const ModelInventory& model = data.inventory.models[i];
+        if (!model.present || model.validIndices.empty() || model.dataShape == grid) continue;
+        std::ostringstream problem;
+        problem << model.group << " grid does not match the extents grid of "
+            << grid[0] << " x " << grid[1] << " x " << grid[2];
+        problems.push_back(problem.str());
+        valid = false;
+    }
+    return valid;
+}
+
+static bool CheckData(const ValidationData& data, std::vector<std::string>& problems)
+{
+    bool valid = CheckGrid(data, problems);
+    valid = data.records.Report(problems) && valid;
+    valid = CheckReferences(data.integrity, problems) && valid;
+    return valid;
+}
+
+/*****************************************************************************/
+/*                                VALIDATION                                 */
+/*****************************************************************************/
+
+bool Validation::CheckStructure(netCDF::NcGroup* rootNode, std::vector<std::string>& problems, bool verbose)
+{
+    bool valid = true;
+    std::vector<int> xyzGridSize;
+    if (!LoopVersion::CheckVersionValid(rootNode,verbose)) {
+        problems.push_back("Version is missing or invalid");
+        valid = false;
+    }
+    if (!LoopExtents::CheckExtentsValid(rootNode,xyzGridSize,verbose)) {
+        problems.push_back("Extents are incomplete");
+        valid = false;
+    }
+    if (!DataCollection::CheckDataCollectionValid(rootNode,verbose)) {
+        problems.push_back("Data collection group is invalid");
+        valid = false;
+    }
+    if (!ExtractedInformation::CheckExtractedInformationValid(rootNode,verbose)) {
+        problems.push_back("Extracted information group is invalid");
+        valid = false;
+    }
+    if (!StructuralModels::CheckStructuralModelsValid(rootNode,xyzGridSize,verbose)) {
+        problems.push_back("Structural models group is invalid");
+        valid = false;
+    }
+    if (!GeophysicalModels::CheckGeophysicalModelsValid(rootNode,xyzGridSize,verbose)) {
+        problems.push_back("Geophysical models group is invalid");
+        valid = false;
+    }
+    if (!UncertaintyModels::CheckUncertaintyModelsValid(rootNode,xyzGridSize,verbose)) {
+        problems.push_back("Uncertainty models group is invalid");
+        valid = false;
+    }
+    return valid;
+}
+
+LoopProjectFileResponse Validation::ValidateFile(std::string filename, ValidationReport& report, bool useCache, bool verbose)
+{
+    LOOP_METRICS_CALL();
+    LOOP_TRACE_FUNCTION();
+    report = ValidationReport();
+    report.filename = filename;
+    FileIdentity identity;
+    bool cacheable = false;
+#ifdef LOOP_VALIDATION_CACHE_SUPPORTED
+    cacheable = useCache && GetFileIdentity(filename, identity);
+#endif
+    if (cacheable && ReadCachedResult(filename, identity, report)) return {0,""};
+    ValidationData data;
+    netCDF::NcFile file;
+    bool loaded = false;
+    {
+        std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+        if (OpenProjectFile(filename, file, true, verbose)) {
+            report.problems.push_back("Cannot open the file");
+            return createErrorMsg(1,"Failure to open project file " + filename,verbose);
+        }
+        try {
+            report.valid = Validation::CheckStructure(&file, report.problems, verbose);
+            loaded = LoadMetadata(&file, data, report.problems, verbose);
+        } catch (netCDF::exceptions::NcException& e) {
+            if (verbose) std::cout << e.what() << std::endl;
+            CloseProjectFile(&file);
+            report.valid = false;
+            report.problems.push_back("Cannot read the file");
+            return createErrorMsg(1,"Failed to read project file " + filename + " for validation",verbose);
+        }
+    }
+    // The tables are read without holding the netCDF lock between batches
+    if (loaded) loaded = LoadTables(&file, data, report.problems, verbose);
+    {
+        std::lock_guard<std::recursive_mutex> lock(GetNetCDFMutex());
+        CloseProjectFile(&file);
+    }
+    report.valid = CheckData(data, report.problems) && loaded && report.valid;
+    if (cacheable) WriteCachedResult(filename, identity, report, verbose);
+    return {0,""};
+}
+
+LoopProjectFileResponse Validation::ValidateFiles(const std::vector<std::string>& filenames, std::vector<ValidationReport>& reports, unsigned int numThreads, bool useCache, bool verbose)
+{
+    LOOP_METRICS_CALL();
+    LOOP_TRACE_FUNCTION();
+    reports.assign(filenames.size(), ValidationReport());
+    if (numThreads == 0) numThreads = std::thread::hardware_concurrency();
+    if (numThreads > filenames.size()) numThreads = static_cast<unsigned int>(filenames.size());
+    std::vector<std::future<LoopProjectFileResponse> > results;
+    {
+        TaskQueue queue(numThreads);
+        for (size_t i=0; i<filenames.size(); i++) {
+            std::string filename = filenames[i];
+            ValidationReport* report = &reports[i];
+            results.push_back(queue.Submit([filename, report, useCache, verbose]() {
+                return Validation::ValidateFile(filename, *report, useCache, verbose);
+            }));
+        }
+    }
+    std::string failed;
+    for (size_t i=0; i<results.size(); i++) {
+        if (results[i].get().errorCode) failed += " " + filenames[i];
+    }
+    if (!failed.empty()) return createErrorMsg(1,"Failed to validate project files" + failed,verbose);
+    return {0,""};
+}
+
+} // namespace LoopProjectFile
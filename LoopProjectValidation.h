@@ -0,0 +1,87 @@
+#ifndef __LOOPPROJECTVALIDATION_H
+#define __LOOPPROJECTVALIDATION_H
+
+#include <netcdf>
+#include <string>
+#include <vector>
+
+#include "LoopProjectFileUtils.h"
+
+#define LOOP_VALIDATION_VERSION 2
+#define LOOP_VALIDATION_CACHE_SUFFIX ".validation"
+
+namespace LoopProjectFile {
+
+/*! \brief The outcome of validating one loop project file */
+struct ValidationReport
+{
+    std::string filename;              /*!< The file that was validated */
+    bool valid;                        /*!< Whether every structural and data check passed */
+    bool cached;                       /*!< Whether the result was taken from the validation cache */
+    std::vector<std::string> problems; /*!< A description of each failed check */
+    /*! Constructor. Marks the file as not validated */
+    ValidationReport() : valid(false), cached(false) {}
+};
+
+/*! \brief Structural and data level validation of loop project files
+ *
+ * A file is valid when every module Check* function passes and its data is consistent: the
+ * extents describe a non-empty grid that every valid model matches, observations and events
+ * hold sane values, and the references between tables resolve (see Integrity::CheckReferences;
+ * references are only checked once the table they refer to has been written, as the event log
+ * is extracted after data collection).
+ *
+ * The tables are read once, in batches, by the reference check, with the value checks run on
+ * each batch as it is read. netCDF access is serialised by GetNetCDFMutex() and only held for
+ * each read, so the checks of one file run while another is being read.
+ *
+ * Validation never writes to the project file. When asked to, the result is cached in a file
+ * alongside it (the filename followed by LOOP_VALIDATION_CACHE_SUFFIX) keyed by the device,
+ * inode, size and nanosecond modification time of the project file, so a file that has not
+ * changed since it was last validated is not read again. Caching is not available on Windows.
+ */
+namespace Validation {
+
+/*!
+ * \brief Runs every module Check* function against a project file
+ *
+ * \param rootNode - the rootNode of the netCDF Loop project file
+ * \param problems - the container to append a description of each failed check to
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Whether every check passed
+ */
+bool CheckStructure(netCDF::NcGroup* rootNode, std::vector<std::string>& problems, bool verbose=false);
+
+/*!
+ * \brief Validates a project file, optionally using the cached result when the file is
+ * unchanged since it was last validated
+ *
+ * \param filename - the filename of the loop project file
+ * \param report - a reference to return the outcome of the validation
+ * \param useCache - whether to read and write the validation cache file alongside the file
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of reading the file with error message if it failed. An
+ * invalid file that could be read is reported through the report, not the response
+ */
+LoopProjectFileResponse ValidateFile(std::string filename, ValidationReport& report, bool useCache=false, bool verbose=false);
+
+/*!
+ * \brief Validates a set of project files on a pool of threads
+ *
+ * \param filenames - the filenames of the loop project files
+ * \param reports - a reference to return the outcome for each file in the order given
+ * \param numThreads - the number of threads validating files (0 for one per hardware thread)
+ * \param useCache - whether to read and write the validation cache file alongside each file
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail with error message listing the files that could not be read
+ */
+LoopProjectFileResponse ValidateFiles(const std::vector<std::string>& filenames, std::vector<ValidationReport>& reports, unsigned int numThreads=0, bool useCache=false, bool verbose=false);
+
+} // namespace Validation
+
+} // namespace LoopProjectFile
+
+#endif
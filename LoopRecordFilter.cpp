@@ -0,0 +1,156 @@
+#include "LoopRecordFilter.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace LoopProjectFile {
+
+RecordFilter& RecordFilter::Range(std::string member, double min, double max)
+{
+    Condition condition = Condition();
+    condition.type = RANGECONDITION;
+    condition.member = member;
+    condition.min = min;
+    condition.max = max;
+    conditions.push_back(condition);
+    return *this;
+}
+
+RecordFilter& RecordFilter::In(std::string member, const std::vector<int>& values)
+{
+    Condition condition = Condition();
+    condition.type = INCONDITION;
+    condition.member = member;
+    condition.values.assign(values.begin(), values.end());
+    std::sort(condition.values.begin(), condition.values.end());
+    conditions.push_back(condition);
+    return *this;
+}
+
+RecordFilter& RecordFilter::Equals(std::string member, std::string value)
+{
+    Condition condition = Condition();
+    condition.type = EQUALSCONDITION;
+    condition.member = member;
+    condition.text = value;
+    conditions.push_back(condition);
+    return *this;
+}
+
+RecordFilter& RecordFilter::Within(const LoopExtents& extents)
+{
+    Range("easting", extents.minEasting, extents.maxEasting);
+    Range("northing", extents.minNorthing, extents.maxNorthing);
+    return Range("altitude", std::min(extents.bottomDepth, extents.topDepth), std::max(extents.bottomDepth, extents.topDepth));
+}
+
+// Whether a compound member type can be read as a number
+static bool IsNumericType(nc_type memberType)
+{
+    switch (memberType) {
+        case NC_BYTE: case NC_UBYTE: case NC_CHAR:
+        case NC_SHORT: case NC_USHORT: case NC_INT: case NC_UINT:
+        case NC_INT64: case NC_UINT64: case NC_FLOAT: case NC_DOUBLE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+LoopProjectFileResponse RecordFilter::Bind(const netCDF::NcVar& recordsVar, bool verbose)
+{
+    if (conditions.empty()) return {0,""};
+    netCDF::NcType varType = recordsVar.getType();
+    if (varType.getTypeClass() != netCDF::NcType::nc_COMPOUND) {
+        return createErrorMsg(1,"Cannot filter " + recordsVar.getName() + " as it is not a compound type",verbose);
+    }
+    netCDF::NcCompoundType compound(varType);
+    int numMembers = static_cast<int>(compound.getMemberCount());
+    for (auto it=conditions.begin(); it!=conditions.end(); it++) {
+        int index = -1;
+        for (int i=0; i<numMembers && index < 0; i++) {
+            if (compound.getMemberName(i) == it->member) index = i;
+        }
+        if (index < 0) {
+            return createErrorMsg(1,"No member " + it->member + " in " + recordsVar.getName() + " to filter on",verbose);
+        }
+        it->offset = compound.getMemberOffset(index);
+        it->memberType = compound.getMember(index).getId();
+        it->length = 1;
+        std::vector<int> shape = compound.getMemberShape(index);
+        for (auto dim=shape.begin(); dim!=shape.end(); dim++) it->length *= static_cast<size_t>(*dim);
+
+        if (it->type == EQUALSCONDITION) {
+            if (it->memberType != NC_CHAR) {
+                return createErrorMsg(1,"Member " + it->member + " of " + recordsVar.getName() + " is not a string",verbose);
+            }
+        } else if (!IsNumericType(it->memberType) || it->length != 1
+            || (it->type == INCONDITION && (it->memberType == NC_FLOAT || it->memberType == NC_DOUBLE))) {
+            return createErrorMsg(1,"Member " + it->member + " of " + recordsVar.getName() + " cannot be compared as a number",verbose);
+        }
+    }
+    return {0,""};
+}
+
+// Reads a numeric member at the start of ptr
+template <typename V>
+static V ReadMember(const char* ptr)
+{
+    V value;
+    memcpy(&value, ptr, sizeof(V));
+    return value;
+}
+
+static double GetNumber(const char* ptr, nc_type memberType)
+{
+    switch (memberType) {
+        case NC_BYTE: return ReadMember<signed char>(ptr);
+        case NC_UBYTE: return ReadMember<unsigned char>(ptr);
+        case NC_CHAR: return ReadMember<char>(ptr);
+        case NC_SHORT: return ReadMember<short>(ptr);
+        case NC_USHORT: return ReadMember<unsigned short>(ptr);
+        case NC_INT: return ReadMember<int>(ptr);
+        case NC_UINT: return ReadMember<unsigned int>(ptr);
+        case NC_INT64: return static_cast<double>(ReadMember<long long>(ptr));
+        case NC_UINT64: return static_cast<double>(ReadMember<unsigned long long>(ptr));
+        case NC_FLOAT: return ReadMember<float>(ptr);
+        default: return ReadMember<double>(ptr);
+    }
+}
+
+static long long GetInteger(const char* ptr, nc_type memberType)
+{
+    switch (memberType) {
+        case NC_INT64: return ReadMember<long long>(ptr);
+        case NC_UINT64: return static_cast<long long>(ReadMember<unsigned long long>(ptr));
+        default: return static_cast<long long>(GetNumber(ptr, memberType));
+    }
+}
+
+bool RecordFilter::Matches(const void* record) const
+{
+    const char* bytes = static_cast<const char*>(record);
+    for (auto it=conditions.begin(); it!=conditions.end(); it++) {
+        const char* ptr = bytes + it->offset;
+        switch (it->type) {
+            case RANGECONDITION: {
+                double value = GetNumber(ptr, it->memberType);
+                if (value < it->min || value > it->max) return false;
+                break;
+            }
+            case INCONDITION:
+                if (!std::binary_search(it->values.begin(), it->values.end(), GetInteger(ptr, it->memberType))) return false;
+                break;
+            case EQUALSCONDITION: {
+                // Strings fill their member and are only null terminated when shorter
+                size_t length = 0;
+                while (length < it->length && ptr[length]) length++;
+                if (length != it->text.size() || memcmp(ptr, it->text.data(), length) != 0) return false;
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace LoopProjectFile
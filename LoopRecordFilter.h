@@ -0,0 +1,195 @@
+#ifndef __LOOPRECORDFILTER_H
+#define __LOOPRECORDFILTER_H
+
+#include <netcdf>
+#include <vector>
+#include <string>
+
+#include "LoopProjectFileUtils.h"
+#include "LoopExtents.h"
+#include "LoopRecordTables.h"
+#include "LoopRecordStorage.h"
+#include "LoopProjectFileMetrics.h"
+#include "LoopProjectFileTrace.h"
+
+#define LOOP_SCAN_BATCH_RECORDS 4096
+
+namespace LoopProjectFile {
+
+/*! \brief Conditions on the compound members of a record table, tested against each record
+ * while the table is scanned (see RecordStorage::ScanRecords)
+ *
+ * Members are named as in the table's netCDF compound type (e.g. "dip", "eventId",
+ * "propertyCode"). The names are resolved to member offsets once when the scan starts, so each
+ * test reads the member straight from the decoded record. A record matches when it meets
+ * every condition; an empty filter matches every record.
+ */
+class RecordFilter {
+public:
+    /*!
+     * \brief Requires a numeric member to lie within [min, max]
+     *
+     * \param member - the name of the compound member
+     * \param min - the smallest value to accept
+     * \param max - the largest value to accept
+     *
+     * \return This filter, so conditions can be chained
+     */
+    RecordFilter& Range(std::string member, double min, double max);
+
+    /*!
+     * \brief Requires an integer member (e.g. eventId) to be one of a set of values
+     *
+     * \param member - the name of the compound member
+     * \param values - the values to accept
+     *
+     * \return This filter, so conditions can be chained
+     */
+    RecordFilter& In(std::string member, const std::vector<int>& values);
+
+    /*!
+     * \brief Requires a fixed length string member (e.g. propertyCode) to equal a value
+     *
+     * \param member - the name of the compound member
+     * \param value - the string to accept
+     *
+     * \return This filter, so conditions can be chained
+     */
+    RecordFilter& Equals(std::string member, std::string value);
+
+    /*!
+     * \brief Requires the easting, northing and altitude members to lie within the extents
+     * (altitude between bottomDepth and topDepth)
+     *
+     * \param extents - the extents to accept
+     *
+     * \return This filter, so conditions can be chained
+     */
+    RecordFilter& Within(const LoopExtents& extents);
+
+    /*!
+     * \brief Resolves the member names of every condition against the compound type of a table
+     *
+     * \param recordsVar - the variable holding the records
+     * \param verbose - a flag to toggle verbose message printing
+     *
+     * \return Response with success/fail of resolving the members with an error message if a
+     * member is missing or of the wrong type for its condition
+     */
+    LoopProjectFileResponse Bind(const netCDF::NcVar& recordsVar, bool verbose=false);
+
+    /*!
+     * \brief Tests a decoded record against every condition. Bind() must have succeeded for
+     * the table the record was read from
+     *
+     * \param record - the decoded record
+     *
+     * \return Whether the record meets every condition
+     */
+    bool Matches(const void* record) const;
+
+    /*! \brief Whether the filter has no conditions */
+    bool IsEmpty() const { return conditions.empty(); }
+
+private:
+    enum ConditionType { RANGECONDITION, INCONDITION, EQUALSCONDITION };
+    struct Condition {
+        ConditionType type;
+        std::string member;
+        double min;
+        double max;
+        std::vector<long long> values; /*!< Sorted values accepted by an In condition */
+        std::string text;
+        // Resolved by Bind()
+        size_t offset;
+        nc_type memberType;
+        size_t length;
+    };
+    std::vector<Condition> conditions;
+};
+
+namespace RecordStorage {
+
+/*!
+ * \brief Reads runs of stored records in batches, appending those matching a bound filter.
+ * Throws on netCDF errors
+ *
+ * \param recordsVar - the variable holding the records
+ * \param ranges - the runs of stored records to read, in storage order
+ * \param filter - the conditions records must meet, bound to recordsVar
+ * \param matches - the container to append the matching records to
+ * \param batchSize - the most records read per hyperslab (0 to read each run whole)
+ *
+ * \return The number of records read
+ */
+template <typename T>
+size_t ScanRanges(const netCDF::NcVar& recordsVar, const std::vector<RecordRange>& ranges, const RecordFilter& filter, std::vector<T>& matches, size_t batchSize)
+{
+    size_t numRecords = 0;
+    size_t largest = 0;
+    for (auto it=ranges.begin(); it!=ranges.end(); it++) {
+        numRecords += it->count;
+        largest = std::max(largest, it->count);
+    }
+    if (batchSize == 0 || batchSize > largest) batchSize = largest;
+    LOOP_TRACE_SPAN("ScanRecords","io");
+    std::vector<T> batch(batchSize);
+    for (auto it=ranges.begin(); it!=ranges.end(); it++) {
+        for (size_t pos=0; pos<it->count; pos+=batchSize) {
+            size_t numRead = std::min(batchSize, it->count - pos);
+            std::vector<size_t> start; start.push_back(it->start + pos);
+            std::vector<size_t> count; count.push_back(numRead);
+            recordsVar.getVar(start,count,batch.data());
+            for (size_t i=0; i<numRead; i++) {
+                if (filter.Matches(&batch[i])) matches.push_back(batch[i]);
+            }
+        }
+    }
+    return numRecords;
+}
+
+/*!
+ * \brief Scans a table (e.g. std::vector<FoliationObservation>) in batches of records and keeps
+ * only the records matching a filter, so memory follows the batch size and the number of
+ * matches rather than the size of the table. Deleted records are skipped
+ *
+ * \param rootNode - the rootNode of the netCDF Loop project file
+ * \param filter - the conditions records must meet
+ * \param matches - a reference to return the matching records in table order (cleared first)
+ * \param batchSize - the number of records read per hyperslab
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of the scan with error message if it failed
+ */
+template <typename T>
+LoopProjectFileResponse ScanRecords(netCDF::NcGroup* rootNode, RecordFilter filter, std::vector<T>& matches, size_t batchSize=LOOP_SCAN_BATCH_RECORDS, bool verbose=false)
+{
+    std::string variableName = RecordTable<T>::Variable();
+    matches.clear();
+    if (batchSize == 0) batchSize = LOOP_SCAN_BATCH_RECORDS;
+    LoopProjectFileResponse resp = {0,""};
+    try {
+        netCDF::NcGroup group;
+        if (!FindGroup(rootNode, RecordTable<T>::GroupPath(), group)) {
+            return createErrorMsg(1,"No " + std::string(RecordTable<T>::GroupPath()) + " Group Node Present",verbose);
+        }
+        netCDF::NcVar recordsVar = group.getVar(variableName);
+        resp = filter.Bind(recordsVar, verbose);
+        if (resp.errorCode) return resp;
+        std::vector<RecordRange> ranges;
+        GetLiveRanges(recordsVar, ranges);
+        size_t numRecords = ScanRanges(recordsVar, ranges, filter, matches, batchSize);
+        Metrics::RecordRead<T>(recordsVar,numRecords);
+    } catch (netCDF::exceptions::NcException& e) {
+        if (verbose) std::cout << e.what() << std::endl;
+        matches.clear();
+        resp = createErrorMsg(1,"Failed to scan " + variableName + " in loop project file",verbose);
+    }
+    return resp;
+}
+
+} // namespace RecordStorage
+
+} // namespace LoopProjectFile
+
+#endif
@@ -0,0 +1,178 @@
+#include "LoopRecordStorage.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace LoopProjectFile {
+
+bool RecordStorage::FindGroup(netCDF::NcGroup* rootNode, std::string groupPath, netCDF::NcGroup& group)
+{
+    group = *rootNode;
+    size_t pos = 0;
+    while (pos < groupPath.size()) {
+        size_t next = groupPath.find('/', pos);
+        if (next == std::string::npos) next = groupPath.size();
+        if (next > pos) {
+            auto groups = group.getGroups();
+            if (groups.find(groupPath.substr(pos, next - pos)) == groups.end()) return false;
+            group = group.getGroup(groupPath.substr(pos, next - pos));
+        }
+        pos = next + 1;
+    }
+    return true;
+}
+
+// Finds the tombstone variable of a table, returning false if nothing has been deleted from it
+static bool FindTombstones(const netCDF::NcVar& recordsVar, netCDF::NcVar& tombstones)
+{
+    netCDF::NcGroup group = recordsVar.getParentGroup();
+    std::string name = recordsVar.getName() + LOOP_RECORD_TOMBSTONE_SUFFIX;
+    auto vars = group.getVars();
+    if (vars.find(name) == vars.end()) return false;
+    tombstones = group.getVar(name);
+    return true;
+}
+
+static unsigned long long GetDeletedCount(const netCDF::NcVar& tombstones)
+{
+    unsigned long long deleted = 0;
+    GetAttributeValue(tombstones.getAtts(), LOOP_RECORD_DELETED_ATTRIBUTE, &deleted);
+    return deleted;
+}
+
+// Writes the same flag over a run of storage indices
+static void WriteFlags(netCDF::NcVar& tombstones, size_t start, size_t count, unsigned char flag)
+{
+    if (count == 0) return;
+    std::vector<unsigned char> flags(count, flag);
+    std::vector<size_t> starts; starts.push_back(start);
+    std::vector<size_t> counts; counts.push_back(count);
+    tombstones.putVar(starts,counts,flags.data());
+}
+
+// Reads the flags of the first limit stored records (all of them by default), or returns
+// false if none are deleted
+static bool ReadFlags(const netCDF::NcVar& recordsVar, std::vector<unsigned char>& flags, size_t limit = LOOP_ALL_RECORDS)
+{
+    netCDF::NcVar tombstones;
+    if (!FindTombstones(recordsVar, tombstones) || GetDeletedCount(tombstones) == 0) return false;
+    size_t numStored = std::min(static_cast<size_t>(recordsVar.getDim(0).getSize()), limit);
+    flags.assign(numStored, 0);
+    if (numStored == 0) return true;
+    std::vector<size_t> start; start.push_back(0);
+    std::vector<size_t> count; count.push_back(numStored);
+    tombstones.getVar(start,count,flags.data());
+    return true;
+}
+
+size_t RecordStorage::GetLiveRanges(const netCDF::NcVar& recordsVar, std::vector<RecordRange>& ranges, size_t start, size_t count)
+{
+    ranges.clear();
+    std::vector<unsigned char> flags;
+    if (!ReadFlags(recordsVar, flags)) {
+        size_t numStored = recordsVar.getDim(0).getSize();
+        if (start >= numStored || count == 0) return 0;
+        if (count > numStored - start) count = numStored - start;
+        ranges.push_back({start, count});
+        return count;
+    }
+    // Skip the first start live records and take up to count after them
+    size_t numLive = 0;
+    size_t numIncluded = 0;
+    for (size_t i=0; i<flags.size() && numIncluded < count; i++) {
+        if (flags[i]) continue;
+        if (numLive++ < start) continue;
+        if (!ranges.empty() && ranges.back().start + ranges.back().count == i) ranges.back().count++;
+        else ranges.push_back({i, 1});
+        numIncluded++;
+    }
+    return numIncluded;
+}
+
+size_t RecordStorage::CountRecords(const netCDF::NcVar& recordsVar)
+{
+    size_t numStored = recordsVar.getDim(0).getSize();
+    netCDF::NcVar tombstones;
+    if (!FindTombstones(recordsVar, tombstones)) return numStored;
+    unsigned long long deleted = GetDeletedCount(tombstones);
+    return deleted < numStored ? numStored - static_cast<size_t>(deleted) : 0;
+}
+
+bool RecordStorage::GetStorageIndices(const netCDF::NcVar& recordsVar, const std::vector<size_t>& indices, std::vector<size_t>& storageIndices)
+{
+    storageIndices.clear();
+    if (indices.empty()) return true;
+    size_t maxIndex = *std::max_element(indices.begin(), indices.end());
+    if (maxIndex >= CountRecords(recordsVar)) return false;
+    // Live record k is stored at most deleted places after k, so only the flags up to the
+    // largest index plus the deleted count are read
+    netCDF::NcVar tombstones;
+    size_t limit = maxIndex + 1;
+    if (FindTombstones(recordsVar, tombstones)) limit += static_cast<size_t>(GetDeletedCount(tombstones));
+    std::vector<unsigned char> flags;
+    if (!ReadFlags(recordsVar, flags, limit)) {
+        storageIndices = indices;
+        return true;
+    }
+    // Resolve the indices in ascending order in one pass over the flags
+    std::vector<size_t> order(indices.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&indices](size_t a, size_t b) { return indices[a] < indices[b]; });
+    storageIndices.assign(indices.size(), 0);
+    size_t numLive = 0;
+    size_t next = 0;
+    for (size_t i=0; i<flags.size() && next<order.size(); i++) {
+        if (flags[i]) continue;
+        while (next < order.size() && indices[order[next]] == numLive) storageIndices[order[next++]] = i;
+        numLive++;
+    }
+    if (next < order.size()) {
+        storageIndices.clear();
+        return false;
+    }
+    return true;
+}
+
+void RecordStorage::MarkDeleted(const netCDF::NcVar& recordsVar, const std::vector<size_t>& storageIndices)
+{
+    netCDF::NcVar tombstones;
+    if (!FindTombstones(recordsVar, tombstones)) {
+        netCDF::NcGroup group = recordsVar.getParentGroup();
+        tombstones = group.addVar(recordsVar.getName() + LOOP_RECORD_TOMBSTONE_SUFFIX, netCDF::ncUbyte, recordsVar.getDim(0));
+        // Records appended to the table later read back as live
+        unsigned char live = 0;
+        tombstones.setFill(true, live);
+    }
+    for (size_t i=0; i<storageIndices.size();) {
+        size_t j = i;
+        while (j+1 < storageIndices.size() && storageIndices[j+1] == storageIndices[j] + 1) j++;
+        WriteFlags(tombstones, storageIndices[i], j - i + 1, 1);
+        i = j + 1;
+    }
+    unsigned long long deleted = GetDeletedCount(tombstones) + storageIndices.size();
+    tombstones.putAtt(LOOP_RECORD_DELETED_ATTRIBUTE, netCDF::ncUint64, deleted);
+}
+
+void RecordStorage::ResetDeletedRecords(const netCDF::NcVar& recordsVar, size_t numRecords)
+{
+    netCDF::NcVar tombstones;
+    if (!FindTombstones(recordsVar, tombstones)) return;
+    size_t numStored = recordsVar.getDim(0).getSize();
+    if (numRecords > numStored) numRecords = numStored;
+    WriteFlags(tombstones, 0, numRecords, 0);
+    WriteFlags(tombstones, numRecords, numStored - numRecords, 1);
+    unsigned long long deleted = numStored - numRecords;
+    tombstones.putAtt(LOOP_RECORD_DELETED_ATTRIBUTE, netCDF::ncUint64, deleted);
+}
+
+void RecordStorage::InvalidateDirectory(const netCDF::NcVar& recordsVar)
+{
+    netCDF::NcGroup group = recordsVar.getParentGroup();
+    auto vars = group.getVars();
+    auto it = vars.find(recordsVar.getName() + LOOP_RECORD_DIRECTORY_SUFFIX);
+    if (it == vars.end()) return;
+    unsigned long long entries = 0;
+    it->second.putAtt(LOOP_RECORD_DIRECTORY_ENTRIES_ATTRIBUTE, netCDF::ncUint64, entries);
+}
+
+} // namespace LoopProjectFile
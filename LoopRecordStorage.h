@@ -0,0 +1,312 @@
+#ifndef __LOOPRECORDSTORAGE_H
+#define __LOOPRECORDSTORAGE_H
+
+#include <netcdf>
+#include <vector>
+#include <string>
+#include <numeric>
+#include <algorithm>
+
+#include "LoopProjectFileUtils.h"
+#include "LoopRecordTables.h"
+#include "LoopProjectFileMetrics.h"
+#include "LoopProjectFileTrace.h"
+
+#define LOOP_RECORD_TOMBSTONE_SUFFIX "Deleted"
+#define LOOP_RECORD_DELETED_ATTRIBUTE "deletedRecords"
+#define LOOP_ALL_RECORDS ((size_t)-1)
+#define LOOP_RECORD_DIRECTORY_SUFFIX "Directory"
+#define LOOP_RECORD_DIRECTORY_ENTRIES_ATTRIBUTE "directoryEntries"
+
+namespace LoopProjectFile {
+
+/*! \brief Record level access to the record tables
+ *
+ * Deleting records does not move the records after them. Each deleted record is flagged in a
+ * tombstone variable (the table's variable name followed by LOOP_RECORD_TOMBSTONE_SUFFIX,
+ * created on the first delete) and the module getters skip flagged records. Record indices
+ * given to these functions are always positions in the table as the getters return it.
+ * CompactRecords() moves the remaining records to the front of the table so they are read in
+ * one hyperslab again. The unlimited index dimension cannot shrink, so compaction does not
+ * reduce the size of the file.
+ */
+namespace RecordStorage {
+
+/*! \brief A run of consecutive stored records */
+struct RecordRange {
+    size_t start; /*!< The storage index of the first record */
+    size_t count; /*!< The number of records */
+};
+
+/*!
+ * \brief Finds a group from a slash separated path below the root group
+ *
+ * \param rootNode - the rootNode of the netCDF Loop project file
+ * \param groupPath - the group path (e.g. "DataCollection/Observations")
+ * \param group - a reference to return the group
+ *
+ * \return Whether every group along the path is present
+ */
+bool FindGroup(netCDF::NcGroup* rootNode, std::string groupPath, netCDF::NcGroup& group);
+
+/*!
+ * \brief Gets the runs of records of a table that have not been deleted. Throws on netCDF errors
+ *
+ * \param recordsVar - the variable holding the records
+ * \param ranges - a reference to return the runs of live records in storage order
+ * \param start - the position of the first live record to include
+ * \param count - the most live records to include (LOOP_ALL_RECORDS for the rest of the table)
+ *
+ * \return The number of live records included
+ */
+size_t GetLiveRanges(const netCDF::NcVar& recordsVar, std::vector<RecordRange>& ranges, size_t start = 0, size_t count = LOOP_ALL_RECORDS);
+
+/*!
+ * \brief Counts the live records of a table from the index dimension length and the deleted
+ * record count, without reading any records. Throws on netCDF errors
+ *
+ * \param recordsVar - the variable holding the records
+ *
+ * \return The number of live records
+ */
+size_t CountRecords(const netCDF::NcVar& recordsVar);
+
+/*!
+ * \brief Converts record indices into storage indices, reading the tombstone flags only up
+ * to the largest index plus the number of deleted records. Throws on netCDF errors
+ *
+ * \param recordsVar - the variable holding the records
+ * \param indices - positions of records in the table as returned by the getters
+ * \param storageIndices - a reference to return the storage index of each record
+ *
+ * \return Whether every index refers to a live record
+ */
+bool GetStorageIndices(const netCDF::NcVar& recordsVar, const std::vector<size_t>& indices, std::vector<size_t>& storageIndices);
+
+/*!
+ * \brief Flags records as deleted, creating the tombstone variable if needed. Throws on netCDF errors
+ *
+ * \param recordsVar - the variable holding the records
+ * \param storageIndices - the distinct storage indices of live records to delete
+ */
+void MarkDeleted(const netCDF::NcVar& recordsVar, const std::vector<size_t>& storageIndices);
+
+/*!
+ * \brief Marks the first numRecords stored records live and any after them deleted, after the
+ * whole table has been rewritten. Does nothing for a table that has never had records deleted.
+ * Throws on netCDF errors
+ *
+ * \param recordsVar - the variable holding the records
+ * \param numRecords - the number of records just written from the start of the table
+ */
+void ResetDeletedRecords(const netCDF::NcVar& recordsVar, size_t numRecords);
+
+/*!
+ * \brief Marks the spatial directory of a table (see SpatialIndex) out of date once records
+ * have been rewritten, replaced or moved. Does nothing for a table without a directory.
+ * Throws on netCDF errors
+ *
+ * \param recordsVar - the variable holding the records
+ */
+void InvalidateDirectory(const netCDF::NcVar& recordsVar);
+
+/*!
+ * \brief Reads live records of a table, appending them to a container with one hyperslab
+ * read per run of live records. Throws on netCDF errors, leaving the container as it was
+ *
+ * \param recordsVar - the variable holding the records
+ * \param records - the container to append to
+ * \param start - the position of the first record to read
+ * \param count - the most records to read (LOOP_ALL_RECORDS for the rest of the table)
+ *
+ * \return The number of records read
+ */
+template <typename T, typename Alloc>
+size_t ReadRecords(const netCDF::NcVar& recordsVar, std::vector<T,Alloc>& records, size_t start = 0, size_t count = LOOP_ALL_RECORDS)
+{
+    std::vector<RecordRange> ranges;
+    size_t numRecords = GetLiveRanges(recordsVar, ranges, start, count);
+    if (numRecords == 0) return 0;
+    size_t initialSize = records.size();
+    size_t offset = initialSize;
+    records.resize(offset + numRecords);
+    try {
+        for (auto it=ranges.begin(); it!=ranges.end(); it++) {
+            std::vector<size_t> starts; starts.push_back(it->start);
+            std::vector<size_t> counts; counts.push_back(it->count);
+            recordsVar.getVar(starts,counts,&records[offset]);
+            offset += it->count;
+        }
+    } catch (netCDF::exceptions::NcException&) {
+        // Drop the records added for this read so no undecoded (BulkLoad) records are returned
+        records.resize(initialSize);
+        throw;
+    }
+    return numRecords;
+}
+
+/*!
+ * \brief Gets the number of records in a table (e.g. FaultEvent) without reading them
+ *
+ * \param rootNode - the rootNode of the netCDF Loop project file
+ * \param count - a reference to return the number of records
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of the count with error message if it failed
+ */
+template <typename T>
+LoopProjectFileResponse GetRecordCount(netCDF::NcGroup* rootNode, size_t& count, bool verbose=false)
+{
+    std::string variableName = RecordTable<T>::Variable();
+    count = 0;
+    try {
+        netCDF::NcGroup group;
+        if (!FindGroup(rootNode, RecordTable<T>::GroupPath(), group)) {
+            return createErrorMsg(1,"No " + std::string(RecordTable<T>::GroupPath()) + " Group Node Present",verbose);
+        }
+        count = CountRecords(group.getVar(variableName));
+    } catch (netCDF::exceptions::NcException& e) {
+        if (verbose) std::cout << e.what() << std::endl;
+        return createErrorMsg(1,"Failed to count " + variableName + " in loop project file",verbose);
+    }
+    return {0,""};
+}
+
+/*!
+ * \brief Replaces individual records of a table (e.g. std::vector<FaultEvent>). Records that are
+ * neighbours in the table are written together, so the cost follows the number of records
+ * replaced rather than the size of the table
+ *
+ * \param rootNode - the rootNode of the netCDF Loop project file
+ * \param indices - the position of each record to replace (a repeated index takes the last record)
+ * \param records - the new records, one per index
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of data insertion with error message if it failed
+ */
+template <typename T>
+LoopProjectFileResponse UpdateRecords(netCDF::NcGroup* rootNode, const std::vector<size_t>& indices, const std::vector<T>& records, bool verbose=false)
+{
+    std::string variableName = RecordTable<T>::Variable();
+    if (indices.size() != records.size()) return createErrorMsg(1,"Number of indices and records to update " + variableName + " differ",verbose);
+    LoopProjectFileResponse resp = {0,""};
+    try {
+        netCDF::NcGroup group;
+        if (!FindGroup(rootNode, RecordTable<T>::GroupPath(), group)) {
+            return createErrorMsg(1,"No " + std::string(RecordTable<T>::GroupPath()) + " Group Node Present",verbose);
+        }
+        netCDF::NcVar recordsVar = group.getVar(variableName);
+        std::vector<size_t> storageIndices;
+        if (!GetStorageIndices(recordsVar, indices, storageIndices)) {
+            return createErrorMsg(1,"Record index out of range updating " + variableName,verbose);
+        }
+        // Visit the records in storage order (keeping repeats in the order given) and write
+        // each run of neighbouring records as one hyperslab
+        std::vector<size_t> order(indices.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&storageIndices](size_t a, size_t b) { return storageIndices[a] < storageIndices[b]; });
+        LOOP_TRACE_SPAN("WriteRecords","io");
+        std::vector<T> run;
+        for (size_t i=0; i<order.size();) {
+            size_t j = i;
+            run.assign(1, records[order[i]]);
+            while (j+1 < order.size() && storageIndices[order[j+1]] == storageIndices[order[j]] + 1) {
+                run.push_back(records[order[++j]]);
+            }
+            std::vector<size_t> start; start.push_back(storageIndices[order[i]]);
+            std::vector<size_t> count; count.push_back(run.size());
+            recordsVar.putVar(start,count,run.data());
+            i = j + 1;
+        }
+        Metrics::RecordWrite<T>(recordsVar,records.size());
+        InvalidateDirectory(recordsVar);
+    } catch (netCDF::exceptions::NcException& e) {
+        if (verbose) std::cout << e.what() << std::endl;
+        resp = createErrorMsg(1,"Failed to update " + variableName + " in loop project file",verbose);
+    }
+    return resp;
+}
+
+/*!
+ * \brief Moves the live records of a table (e.g. std::vector<FaultEvent>) to the front so they
+ * are stored contiguously again
+ *
+ * \param rootNode - the rootNode of the netCDF Loop project file
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of the compaction with error message if it failed
+ */
+template <typename T>
+LoopProjectFileResponse CompactRecords(netCDF::NcGroup* rootNode, bool verbose=false)
+{
+    std::string variableName = RecordTable<T>::Variable();
+    LoopProjectFileResponse resp = {0,""};
+    try {
+        netCDF::NcGroup group;
+        if (!FindGroup(rootNode, RecordTable<T>::GroupPath(), group)) {
+            return createErrorMsg(1,"No " + std::string(RecordTable<T>::GroupPath()) + " Group Node Present",verbose);
+        }
+        netCDF::NcVar recordsVar = group.getVar(variableName);
+        std::vector<RecordRange> ranges;
+        GetLiveRanges(recordsVar, ranges);
+        // Already contiguous from the start, only a deleted tail (if any) remains
+        if (ranges.size() <= 1 && (ranges.empty() || ranges[0].start == 0)) return resp;
+        std::vector<T> records;
+        size_t numRecords = ReadRecords(recordsVar, records);
+        Metrics::RecordRead<T>(recordsVar,numRecords);
+        LOOP_TRACE_SPAN("WriteRecords","io");
+        std::vector<size_t> start; start.push_back(0);
+        std::vector<size_t> count; count.push_back(numRecords);
+        if (numRecords) recordsVar.putVar(start,count,records.data());
+        ResetDeletedRecords(recordsVar, numRecords);
+        InvalidateDirectory(recordsVar);
+        Metrics::RecordWrite<T>(recordsVar,numRecords);
+    } catch (netCDF::exceptions::NcException& e) {
+        if (verbose) std::cout << e.what() << std::endl;
+        resp = createErrorMsg(1,"Failed to compact " + variableName + " in loop project file",verbose);
+    }
+    return resp;
+}
+
+/*!
+ * \brief Deletes individual records of a table (e.g. std::vector<FaultEvent>) by flagging them,
+ * so the records after them keep their storage and the cost follows the number deleted
+ *
+ * \param rootNode - the rootNode of the netCDF Loop project file
+ * \param indices - the positions of the records to delete
+ * \param compact - whether to compact the table afterwards (see CompactRecords)
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of the deletion with error message if it failed
+ */
+template <typename T>
+LoopProjectFileResponse DeleteRecords(netCDF::NcGroup* rootNode, const std::vector<size_t>& indices, bool compact=false, bool verbose=false)
+{
+    std::string variableName = RecordTable<T>::Variable();
+    LoopProjectFileResponse resp = {0,""};
+    try {
+        netCDF::NcGroup group;
+        if (!FindGroup(rootNode, RecordTable<T>::GroupPath(), group)) {
+            return createErrorMsg(1,"No " + std::string(RecordTable<T>::GroupPath()) + " Group Node Present",verbose);
+        }
+        netCDF::NcVar recordsVar = group.getVar(variableName);
+        std::vector<size_t> storageIndices;
+        if (!GetStorageIndices(recordsVar, indices, storageIndices)) {
+            return createErrorMsg(1,"Record index out of range deleting from " + variableName,verbose);
+        }
+        std::sort(storageIndices.begin(), storageIndices.end());
+        storageIndices.erase(std::unique(storageIndices.begin(), storageIndices.end()), storageIndices.end());
+        if (!storageIndices.empty()) MarkDeleted(recordsVar, storageIndices);
+    } catch (netCDF::exceptions::NcException& e) {
+        if (verbose) std::cout << e.what() << std::endl;
+        return createErrorMsg(1,"Failed to delete from " + variableName + " in loop project file",verbose);
+    }
+    if (compact) resp = CompactRecords<T>(rootNode, verbose);
+    return resp;
+}
+
+} // namespace RecordStorage
+
+} // namespace LoopProjectFile
+
+#endif
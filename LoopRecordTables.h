@@ -0,0 +1,55 @@
+#ifndef __LOOPRECORDTABLES_H
+#define __LOOPRECORDTABLES_H
+
+#include <netcdf>
+#include <vector>
+
+#include "LoopProjectFileUtils.h"
+#include "LoopDataCollection.h"
+#include "LoopExtractedInformation.h"
+
+/*!
+ * The record tables of a loop project file as
+ * X(record type, group path, variable, index dimension, module getter, module setter)
+ */
+#define LOOP_RECORD_TABLES(X) \
+    X(FaultObservation, "DataCollection/Observations", "faultObservations", "faultObservationIndex", DataCollection::GetFaultObservations, DataCollection::SetFaultObservations) \
+    X(FoldObservation, "DataCollection/Observations", "foldObservations", "foldObservationIndex", DataCollection::GetFoldObservations, DataCollection::SetFoldObservations) \
+    X(FoliationObservation, "DataCollection/Observations", "foliationObservations", "foliationObservationIndex", DataCollection::GetFoliationObservations, DataCollection::SetFoliationObservations) \
+    X(DiscontinuityObservation, "DataCollection/Observations", "discontinuityObservations", "discontinuityObservationIndex", DataCollection::GetDiscontinuityObservations, DataCollection::SetDiscontinuityObservations) \
+    X(StratigraphicObservation, "DataCollection/Observations", "stratigraphicObservations", "stratigraphicObservationIndex", DataCollection::GetStratigraphicObservations, DataCollection::SetStratigraphicObservations) \
+    X(ContactObservation, "DataCollection/Contacts", "contacts", "index", DataCollection::GetContactObservations, DataCollection::SetContactObservations) \
+    X(DrillholeObservation, "DataCollection/Drillholes", "drillholeObservations", "drillholeObservationIndex", DataCollection::GetDrillholeObservations, DataCollection::SetDrillholeObservations) \
+    X(DrillholeProperty, "DataCollection/Drillholes", "drillholeProperties", "drillholePropertyIndex", DataCollection::GetDrillholeProperties, DataCollection::SetDrillholeProperties) \
+    X(DrillholeSurvey, "DataCollection/Drillholes", "drillholeSurveys", "drillholeSurveyIndex", DataCollection::GetDrillholeSurveys, DataCollection::SetDrillholeSurveys) \
+    X(FaultEvent, "ExtractedInformation/EventLog", "faultEvents", "faultEventIndex", ExtractedInformation::GetFaultEvents, ExtractedInformation::SetFaultEvents) \
+    X(FoldEvent, "ExtractedInformation/EventLog", "foldEvents", "foldEventIndex", ExtractedInformation::GetFoldEvents, ExtractedInformation::SetFoldEvents) \
+    X(FoliationEvent, "ExtractedInformation/EventLog", "foliationEvents", "foliationEventIndex", ExtractedInformation::GetFoliationEvents, ExtractedInformation::SetFoliationEvents) \
+    X(DiscontinuityEvent, "ExtractedInformation/EventLog", "discontinuityEvents", "discontinuityEventIndex", ExtractedInformation::GetDiscontinuityEvents, ExtractedInformation::SetDiscontinuityEvents) \
+    X(StratigraphicLayer, "ExtractedInformation/StratigraphicInformation", "stratigraphicLayers", "index", ExtractedInformation::GetStratigraphicLayers, ExtractedInformation::SetStratigraphicLayers) \
+    X(EventRelationship, "ExtractedInformation/EventRelationships", "eventRelationships", "index", ExtractedInformation::GetEventRelationships, ExtractedInformation::SetEventRelationships) \
+    X(DrillholeDescription, "ExtractedInformation/DrillholeInformation", "drillholeDescriptions", "index", ExtractedInformation::GetDrillholeDescriptions, ExtractedInformation::SetDrillholeDescriptions)
+
+namespace LoopProjectFile {
+
+/*! \brief Where a record type is stored and the module functions that read and write it.
+ * Specialised for every record type in LOOP_RECORD_TABLES */
+template <typename T>
+struct RecordTable;
+
+#define LPF_RECORD_TABLE(TYPE,GROUP,VARIABLE,INDEX,GETTER,SETTER) \
+template <>\
+struct RecordTable<TYPE> {\
+    static const char* GroupPath() { return GROUP; }\
+    static const char* Variable() { return VARIABLE; }\
+    static const char* IndexDimension() { return INDEX; }\
+    static LoopProjectFileResponse Get(netCDF::NcGroup* rootNode, std::vector<TYPE>& data, bool verbose) { return GETTER(rootNode, data, verbose); }\
+    static LoopProjectFileResponse GetRange(netCDF::NcGroup* rootNode, std::vector<TYPE>& data, size_t start, size_t count, bool verbose) { return GETTER(rootNode, data, start, count, verbose); }\
+    static LoopProjectFileResponse Set(netCDF::NcGroup* rootNode, const std::vector<TYPE>& data, bool verbose) { return SETTER(rootNode, data, verbose); }\
+};
+LOOP_RECORD_TABLES(LPF_RECORD_TABLE)
+#undef LPF_RECORD_TABLE
+
+} // namespace LoopProjectFile
+
+#endif
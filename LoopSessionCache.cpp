@@ -0,0 +1,108 @@
+#include "LoopSessionCache.h"
+
+namespace LoopProjectFile {
+
+SessionCache::SessionCache(size_t limit)
+{
+    statistics.limit = limit;
+}
+
+void SessionCache::SetLimit(size_t limit)
+{
+    statistics.limit = limit;
+    EvictToFit(0);
+}
+
+std::shared_ptr<const void> SessionCache::FindEntry(const SessionCacheKey& key)
+{
+    if (!IsEnabled()) return std::shared_ptr<const void>();
+    auto it = index.find(key);
+    if (it == index.end()) {
+        statistics.misses++;
+        return std::shared_ptr<const void>();
+    }
+    statistics.hits++;
+    entries.splice(entries.begin(), entries, it->second);
+    return it->second->value;
+}
+
+void SessionCache::Insert(const SessionCacheKey& key, std::shared_ptr<const void> value, size_t bytes)
+{
+    auto it = index.find(key);
+    if (it != index.end()) Erase(it);
+    if (!IsEnabled() || bytes > statistics.limit) return;
+    EvictToFit(bytes);
+    Entry entry = {key, value, bytes};
+    entries.push_front(entry);
+    index[key] = entries.begin();
+    statistics.bytes += bytes;
+    statistics.entries = entries.size();
+}
+
+void SessionCache::Erase(std::map<SessionCacheKey, std::list<Entry>::iterator>::iterator it)
+{
+    statistics.bytes -= it->second->bytes;
+    entries.erase(it->second);
+    index.erase(it);
+    statistics.entries = entries.size();
+}
+
+void SessionCache::EvictToFit(size_t bytes)
+{
+    while (!entries.empty() && statistics.bytes + bytes > statistics.limit) {
+        Erase(index.find(entries.back().key));
+        statistics.evictions++;
+    }
+}
+
+void SessionCache::Invalidate(const SessionCacheKey& key)
+{
+    auto it = index.find(key);
+    if (it == index.end()) return;
+    Erase(it);
+    statistics.invalidations++;
+}
+
+void SessionCache::InvalidateGroup(const std::string& group)
+{
+    for (auto it=index.begin(); it!=index.end();) {
+        auto next = it;
+        next++;
+        if (it->first.group == group) {
+            Erase(it);
+            statistics.invalidations++;
+        }
+        it = next;
+    }
+}
+
+void SessionCache::InvalidateTables()
+{
+    for (auto it=index.begin(); it!=index.end();) {
+        auto next = it;
+        next++;
+        if (it->first.index == LOOP_SESSION_CACHE_TABLE) {
+            Erase(it);
+            statistics.invalidations++;
+        }
+        it = next;
+    }
+}
+
+void SessionCache::Clear()
+{
+    entries.clear();
+    index.clear();
+    statistics.bytes = 0;
+    statistics.entries = 0;
+}
+
+void SessionCache::ResetStatistics()
+{
+    statistics.hits = 0;
+    statistics.misses = 0;
+    statistics.evictions = 0;
+    statistics.invalidations = 0;
+}
+
+} // namespace LoopProjectFile
@@ -0,0 +1,120 @@
+#ifndef __LOOPSESSIONCACHE_H
+#define __LOOPSESSIONCACHE_H
+
+#include <string>
+#include <list>
+#include <map>
+#include <memory>
+#include <cstdint>
+
+#define LOOP_SESSION_CACHE_TABLE -1
+
+namespace LoopProjectFile {
+
+/*! \brief Identifies a cached value by group path, variable and model index
+ * (LOOP_SESSION_CACHE_TABLE for a whole record table) */
+struct SessionCacheKey {
+    std::string group;
+    std::string variable;
+    long long index;
+    SessionCacheKey(std::string group, std::string variable, long long index = LOOP_SESSION_CACHE_TABLE)
+        : group(group), variable(variable), index(index) {}
+    bool operator<(const SessionCacheKey& other) const
+    {
+        if (group != other.group) return group < other.group;
+        if (variable != other.variable) return variable < other.variable;
+        return index < other.index;
+    }
+};
+
+/*! \brief Counters for sizing a session cache */
+struct SessionCacheStatistics {
+    uint64_t hits;          /*!< Lookups served from the cache */
+    uint64_t misses;        /*!< Lookups that had to be read from the file */
+    uint64_t evictions;     /*!< Entries dropped to stay within the limit */
+    uint64_t invalidations; /*!< Entries dropped because their data was written */
+    size_t bytes;           /*!< Bytes currently held */
+    size_t entries;         /*!< Entries currently held */
+    size_t limit;           /*!< The limit in bytes (0 when the cache is disabled) */
+    SessionCacheStatistics() : hits(0), misses(0), evictions(0), invalidations(0), bytes(0), entries(0), limit(0) {}
+};
+
+/*! \brief A memory bounded least recently used cache of decoded models and tables
+ *
+ * Values are held by shared pointer so a value handed out stays valid after it is evicted.
+ * The cache is not locked, ProjectSession only uses it while holding GetNetCDFMutex().
+ */
+class SessionCache {
+public:
+    /*!
+     * \brief Constructor
+     *
+     * \param limit - the most bytes to hold, 0 disables the cache
+     */
+    explicit SessionCache(size_t limit = 0);
+
+    /*! \brief Sets the most bytes to hold, evicting the least recently used entries to fit */
+    void SetLimit(size_t limit);
+
+    /*! \brief Whether the cache holds anything at all */
+    bool IsEnabled() const { return statistics.limit > 0; }
+
+    /*!
+     * \brief Looks up a value, marking it most recently used
+     *
+     * \param key - the value to look up
+     *
+     * \return The value or an empty pointer on a miss
+     */
+    template <typename T>
+    std::shared_ptr<const T> Find(const SessionCacheKey& key)
+    {
+        return std::static_pointer_cast<const T>(FindEntry(key));
+    }
+
+    /*!
+     * \brief Adds or replaces a value. Values larger than the limit are not held
+     *
+     * \param key - the key of the value
+     * \param value - the value
+     * \param bytes - the memory used by the value
+     */
+    void Insert(const SessionCacheKey& key, std::shared_ptr<const void> value, size_t bytes);
+
+    /*! \brief Drops one value */
+    void Invalidate(const SessionCacheKey& key);
+
+    /*! \brief Drops every value of a group (e.g. all models of a model group) */
+    void InvalidateGroup(const std::string& group);
+
+    /*! \brief Drops every record table, keeping models */
+    void InvalidateTables();
+
+    /*! \brief Drops every value */
+    void Clear();
+
+    /*! \brief The counters and current size of the cache */
+    SessionCacheStatistics GetStatistics() const { return statistics; }
+
+    /*! \brief Zeros the hit, miss, eviction and invalidation counters */
+    void ResetStatistics();
+
+private:
+    struct Entry {
+        SessionCacheKey key;
+        std::shared_ptr<const void> value;
+        size_t bytes;
+    };
+
+    std::shared_ptr<const void> FindEntry(const SessionCacheKey& key);
+    void Erase(std::map<SessionCacheKey, std::list<Entry>::iterator>::iterator it);
+    void EvictToFit(size_t bytes);
+
+    std::list<Entry> entries;
+    std::map<SessionCacheKey, std::list<Entry>::iterator> index;
+    SessionCacheStatistics statistics;
+};
+
+} // namespace LoopProjectFile
+
+#endif
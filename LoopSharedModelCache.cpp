@@ -0,0 +1,255 @@
+#include "LoopSharedModelCache.h"
+#include "LoopProjectFile.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <sys/stat.h>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#define LOOP_SHARED_MODEL_MAGIC 0x4C504D43u
+#define LOOP_SHARED_MODEL_DATA_OFFSET 64
+
+namespace LoopProjectFile {
+
+// The layout at the start of every model segment, followed by the model data at
+// LOOP_SHARED_MODEL_DATA_OFFSET. ready is set last, once the data is complete.
+struct SharedModelHeader {
+    uint32_t magic;
+    std::atomic<uint32_t> ready;
+    int32_t dataShape[3];
+    uint64_t count;
+};
+
+SharedModelView::SharedModelView()
+    : data(NULL),
+      size(0),
+      mapping(NULL),
+      mappingSize(0)
+{
+}
+
+SharedModelView::~SharedModelView()
+{
+    Reset();
+}
+
+SharedModelView::SharedModelView(SharedModelView&& other)
+    : data(NULL),
+      size(0),
+      mapping(NULL),
+      mappingSize(0)
+{
+    *this = std::move(other);
+}
+
+SharedModelView& SharedModelView::operator=(SharedModelView&& other)
+{
+    if (this != &other) {
+        Reset();
+        data = other.data;
+        size = other.size;
+        dataShape.swap(other.dataShape);
+        mapping = other.mapping;
+        mappingSize = other.mappingSize;
+        privateData.swap(other.privateData);
+        other.data = NULL;
+        other.size = 0;
+        other.mapping = NULL;
+        other.mappingSize = 0;
+    }
+    return *this;
+}
+
+void SharedModelView::Reset()
+{
+#ifndef _WIN32
+    if (mapping) munmap(mapping, mappingSize);
+#endif
+    mapping = NULL;
+    mappingSize = 0;
+    data = NULL;
+    size = 0;
+    dataShape.clear();
+    std::vector<float>().swap(privateData);
+}
+
+SharedModelCache::SharedModelCache(std::string prefix)
+    : prefix(prefix)
+{
+    // POSIX shared memory names are a single component starting with a slash
+    if (this->prefix.empty() || this->prefix[0] != '/') this->prefix = "/" + this->prefix;
+}
+
+static LoopProjectFileResponse ReadModelFromFile(std::string filename, ModelType modelType, unsigned int index, std::vector<float>& data, std::vector<int>& dataShape, bool verbose)
+{
+    switch (modelType) {
+        case STRUCTURALMODEL: return GetStructuralModel(filename, data, dataShape, index, verbose);
+        case GEOPHYSICALMODEL: return GetGeophysicalModel(filename, data, dataShape, index, verbose);
+        case UNCERTAINTYMODEL: return GetUncertaintyModel(filename, data, dataShape, index, verbose);
+        default: return createErrorMsg(1,"Invalid model type for the shared model cache",verbose);
+    }
+}
+
+LoopProjectFileResponse SharedModelCache::GetSegmentName(std::string filename, ModelType modelType, unsigned int index, std::string& name)
+{
+    std::string groupName = GetModelGroupName(modelType);
+    if (groupName.empty()) return createErrorMsg(1,"Invalid model type for the shared model cache");
+    FileIdentity file;
+    if (!GetFileIdentity(filename, file)) return createErrorMsg(1,"File " + filename + " does not exist");
+    char identity[256];
+    snprintf(identity, sizeof(identity), "%llu:%llu:%llu:%lld.%09lld:%s:%u",
+        file.device, file.inode, file.size, file.modifiedSec, file.modifiedNsec, groupName.c_str(), index);
+    // 64 bit FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (const char* c=identity; *c; c++) {
+        hash ^= static_cast<unsigned char>(*c);
+        hash *= 1099511628211ull;
+    }
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), "_%016llx", static_cast<unsigned long long>(hash));
+    name = prefix + suffix;
+    return {0,""};
+}
+
+#ifndef _WIN32
+enum MapResult {
+    SEGMENT_MAPPED,
+    SEGMENT_MISSING, // Not published, or could not be mapped
+    SEGMENT_STALE    // Published but never completed by its publisher
+};
+
+// Maps a published segment read only, waiting for a concurrent publisher to finish
+static MapResult MapSegment(const std::string& name, const float*& data, size_t& size, std::vector<int>& dataShape, void*& mapping, size_t& mappingSize, bool verbose)
+{
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return SEGMENT_MISSING;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(LOOP_SHARED_MODEL_WAIT_MS);
+    struct stat buffer;
+    bool sized = false;
+    while (!(sized = (fstat(fd, &buffer) == 0 && static_cast<size_t>(buffer.st_size) >= LOOP_SHARED_MODEL_DATA_OFFSET))
+           && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (!sized) {
+        close(fd);
+        if (verbose) std::cout << "Timed out waiting for shared model " << name << std::endl;
+        return SEGMENT_STALE;
+    }
+    size_t length = static_cast<size_t>(buffer.st_size);
+    void* memory = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) return SEGMENT_MISSING;
+    const SharedModelHeader* header = static_cast<const SharedModelHeader*>(memory);
+    while (!header->ready.load(std::memory_order_acquire) && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (!header->ready.load(std::memory_order_acquire) || header->magic != LOOP_SHARED_MODEL_MAGIC
+        || LOOP_SHARED_MODEL_DATA_OFFSET + header->count * sizeof(float) > length) {
+        if (verbose) std::cout << "Shared model " << name << " is incomplete or invalid" << std::endl;
+        munmap(memory, length);
+        return SEGMENT_STALE;
+    }
+    data = reinterpret_cast<const float*>(static_cast<const char*>(memory) + LOOP_SHARED_MODEL_DATA_OFFSET);
+    size = static_cast<size_t>(header->count);
+    dataShape.assign(header->dataShape, header->dataShape + 3);
+    mapping = memory;
+    mappingSize = length;
+    return SEGMENT_MAPPED;
+}
+
+// Publishes a model under a new segment name. Returns false only if the model could not be shared
+static bool PublishSegment(const std::string& name, const std::vector<float>& data, const std::vector<int>& dataShape, bool verbose)
+{
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+        // Another process published (or is publishing) the same model first
+        if (errno == EEXIST) return true;
+        if (verbose) std::cout << "Failed to create shared model " << name << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    size_t length = LOOP_SHARED_MODEL_DATA_OFFSET + data.size() * sizeof(float);
+    void* memory = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(length)) == 0) {
+        memory = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (memory == MAP_FAILED) {
+        if (verbose) std::cout << "Failed to size shared model " << name << ": " << strerror(errno) << std::endl;
+        shm_unlink(name.c_str());
+        return false;
+    }
+    SharedModelHeader* header = static_cast<SharedModelHeader*>(memory);
+    header->magic = LOOP_SHARED_MODEL_MAGIC;
+    for (size_t i=0; i<3; i++) header->dataShape[i] = i < dataShape.size() ? dataShape[i] : 0;
+    header->count = data.size();
+    if (!data.empty()) memcpy(static_cast<char*>(memory) + LOOP_SHARED_MODEL_DATA_OFFSET, data.data(), data.size() * sizeof(float));
+    header->ready.store(1, std::memory_order_release);
+    munmap(memory, length);
+    return true;
+}
+#endif
+
+LoopProjectFileResponse SharedModelCache::GetModel(std::string filename, ModelType modelType, unsigned int index, SharedModelView& view, bool verbose)
+{
+    view.Reset();
+    std::string name;
+    LoopProjectFileResponse resp = GetSegmentName(filename, modelType, index, name);
+    if (resp.errorCode) {
+        if (verbose) std::cout << resp.errorMessage << std::endl;
+        return resp;
+    }
+#ifndef _WIN32
+    MapResult mapped = MapSegment(name, view.data, view.size, view.dataShape, view.mapping, view.mappingSize, verbose);
+    if (mapped == SEGMENT_MAPPED) return resp;
+#endif
+    std::vector<float> data;
+    std::vector<int> dataShape;
+    resp = ReadModelFromFile(filename, modelType, index, data, dataShape, verbose);
+    if (resp.errorCode) return resp;
+#ifndef _WIN32
+    // A publisher that died part way leaves a segment that never becomes ready. Remove it so
+    // the model is published again rather than every process timing out on it
+    if (mapped == SEGMENT_STALE) {
+        if (verbose) std::cout << "Replacing stale shared model " << name << std::endl;
+        shm_unlink(name.c_str());
+    }
+    if (PublishSegment(name, data, dataShape, verbose)
+        && MapSegment(name, view.data, view.size, view.dataShape, view.mapping, view.mappingSize, verbose) == SEGMENT_MAPPED) {
+        return resp;
+    }
+#endif
+    // The model could not be shared, so hand back the copy that was read
+    view.privateData.swap(data);
+    view.data = view.privateData.data();
+    view.size = view.privateData.size();
+    view.dataShape.swap(dataShape);
+    return resp;
+}
+
+LoopProjectFileResponse SharedModelCache::RemoveModel(std::string filename, ModelType modelType, unsigned int index, bool verbose)
+{
+    std::string name;
+    LoopProjectFileResponse resp = GetSegmentName(filename, modelType, index, name);
+    if (resp.errorCode) {
+        if (verbose) std::cout << resp.errorMessage << std::endl;
+        return resp;
+    }
+#ifndef _WIN32
+    if (shm_unlink(name.c_str()) != 0 && errno != ENOENT) {
+        resp = createErrorMsg(1,"Failed to remove shared model " + name + ": " + strerror(errno),verbose);
+    }
+#endif
+    return resp;
+}
+
+} // namespace LoopProjectFile
@@ -0,0 +1,126 @@
+#ifndef __LOOPSHAREDMODELCACHE_H
+#define __LOOPSHAREDMODELCACHE_H
+
+#include <string>
+#include <vector>
+
+#include "LoopProjectFileUtils.h"
+
+#define LOOP_SHARED_MODEL_CACHE_PREFIX "/loopmodel"
+#define LOOP_SHARED_MODEL_WAIT_MS 5000
+
+namespace LoopProjectFile {
+
+/*! \brief A read only view of one model held by a SharedModelCache
+ *
+ * The view maps the shared memory segment of the model read only, so every process on
+ * the node that views the same model shares one copy. If the model could not be shared
+ * the view holds a private copy instead (see IsShared()). The data stays valid until the
+ * view is destroyed or reset, even if the segment is removed from the cache meanwhile.
+ */
+class SharedModelView {
+public:
+    SharedModelView();
+
+    /*! \brief Destructor. Unmaps the model */
+    ~SharedModelView();
+
+    SharedModelView(SharedModelView&& other);
+    SharedModelView& operator=(SharedModelView&& other);
+
+    /*! \brief The model data in easting, northing, depth order (NULL if the view is empty) */
+    const float* GetData() const { return data; }
+
+    /*! \brief The number of values in the model */
+    size_t GetSize() const { return size; }
+
+    /*! \brief The dimensions of the model (easting, northing, depth) */
+    const std::vector<int>& GetDataShape() const { return dataShape; }
+
+    /*! \brief Whether the view maps a shared segment rather than holding a private copy */
+    bool IsShared() const { return mapping != NULL; }
+
+    /*! \brief Releases the model */
+    void Reset();
+
+private:
+    friend class SharedModelCache;
+
+    const float* data;
+    size_t size;
+    std::vector<int> dataShape;
+    void* mapping;
+    size_t mappingSize;
+    std::vector<float> privateData;
+
+    SharedModelView(const SharedModelView&) = delete;
+    SharedModelView& operator=(const SharedModelView&) = delete;
+};
+
+/*! \brief A cache of decoded models in POSIX shared memory, shared by the processes of one node
+ *
+ * Each model is stored in its own segment, named from the prefix and a hash of the file
+ * identity (device, inode, size and nanosecond modification time), the model group and the
+ * index. Rewriting the file changes its identity so stale models are not returned (unless the
+ * rewrite keeps the inode and size within the file system's timestamp resolution), but their
+ * segments stay in shared memory until removed with RemoveModel() or a reboot.
+ *
+ * The first process to ask for a model reads it from the file and publishes it; other
+ * processes map the published segment without touching the file. A segment whose publisher
+ * did not finish within LOOP_SHARED_MODEL_WAIT_MS (e.g. because it died) is removed and the
+ * model published again. Shared memory is not
+ * available on Windows, where GetModel() reads a private copy every time.
+ */
+class SharedModelCache {
+public:
+    /*!
+     * \brief Constructor
+     *
+     * \param prefix - the shared memory name prefix, separating caches of unrelated applications
+     */
+    explicit SharedModelCache(std::string prefix = LOOP_SHARED_MODEL_CACHE_PREFIX);
+
+    /*!
+     * \brief Gets a model, reading and publishing it if no process on the node has yet
+     *
+     * \param filename - the filename of the loop project file
+     * \param modelType - the model group to read from
+     * \param index - the index location of the model
+     * \param view - a reference to where the view of the model is to be returned
+     * \param verbose - a flag to toggle verbose message printing
+     *
+     * \return Response with success/fail of data retrieval with error message if it failed
+     */
+    LoopProjectFileResponse GetModel(std::string filename, ModelType modelType, unsigned int index, SharedModelView& view, bool verbose = false);
+
+    /*!
+     * \brief Removes a model from shared memory. Existing views remain valid
+     *
+     * \param filename - the filename of the loop project file
+     * \param modelType - the model group of the model
+     * \param index - the index location of the model
+     * \param verbose - a flag to toggle verbose message printing
+     *
+     * \return Response with success/fail of the removal with error message if it failed
+     */
+    LoopProjectFileResponse RemoveModel(std::string filename, ModelType modelType, unsigned int index, bool verbose = false);
+
+    /*!
+     * \brief The shared memory name of a model in the current version of a file
+     *
+     * \param filename - the filename of the loop project file
+     * \param modelType - the model group of the model
+     * \param index - the index location of the model
+     * \param name - a reference to where the segment name is to be copied
+     *
+     * \return Response with success/fail of identifying the file with error message if it failed
+     */
+    LoopProjectFileResponse GetSegmentName(std::string filename, ModelType modelType, unsigned int index, std::string& name);
+
+private:
+    std::string prefix;
+};
+
+} // namespace LoopProjectFile
+
+#endif
@@ -0,0 +1,184 @@
+#include "LoopSpatialIndex.h"
+
+#include <limits>
+
+namespace LoopProjectFile {
+
+std::vector<double> SpatialIndex::GetBounds(const LoopExtents& extents)
+{
+    std::vector<double> bounds;
+    bounds.push_back(extents.minEasting);
+    bounds.push_back(extents.maxEasting);
+    bounds.push_back(extents.minNorthing);
+    bounds.push_back(extents.maxNorthing);
+    bounds.push_back(std::min(extents.bottomDepth, extents.topDepth));
+    bounds.push_back(std::max(extents.bottomDepth, extents.topDepth));
+    return bounds;
+}
+
+// Scales a coordinate to a cell along one axis, clamping it to the bounds
+static unsigned long long Quantise(double value, double min, double max)
+{
+    const unsigned long long numCells = 1ULL << LOOP_SPATIAL_KEY_BITS;
+    if (!(max > min)) return 0;
+    double scaled = (value - min) / (max - min) * numCells;
+    if (!(scaled > 0)) return 0;
+    if (scaled >= numCells - 1) return numCells - 1;
+    return static_cast<unsigned long long>(scaled);
+}
+
+// Spreads the low 21 bits of a value so two zero bits separate each
+static unsigned long long SpreadBits(unsigned long long v)
+{
+    v &= 0x1fffffULL;
+    v = (v | v << 32) & 0x1f00000000ffffULL;
+    v = (v | v << 16) & 0x1f0000ff0000ffULL;
+    v = (v | v << 8) & 0x100f00f00f00f00fULL;
+    v = (v | v << 4) & 0x10c30c30c30c30c3ULL;
+    v = (v | v << 2) & 0x1249249249249249ULL;
+    return v;
+}
+
+// Reverses SpreadBits, gathering every third bit
+static unsigned long long CompactBits(unsigned long long v)
+{
+    v &= 0x1249249249249249ULL;
+    v = (v ^ (v >> 2)) & 0x10c30c30c30c30c3ULL;
+    v = (v ^ (v >> 4)) & 0x100f00f00f00f00fULL;
+    v = (v ^ (v >> 8)) & 0x1f0000ff0000ffULL;
+    v = (v ^ (v >> 16)) & 0x1f00000000ffffULL;
+    v = (v ^ (v >> 32)) & 0x1fffffULL;
+    return v;
+}
+
+unsigned long long SpatialIndex::MortonKey(const std::vector<double>& bounds, double easting, double northing, double altitude)
+{
+    return SpreadBits(Quantise(easting, bounds[0], bounds[1]))
+        | SpreadBits(Quantise(northing, bounds[2], bounds[3])) << 1
+        | SpreadBits(Quantise(altitude, bounds[4], bounds[5])) << 2;
+}
+
+void SpatialIndex::BuildDirectory(const std::vector<unsigned long long>& sortedKeys, unsigned int level, std::vector<SpatialDirectoryEntry>& directory)
+{
+    directory.clear();
+    unsigned int shift = 3 * (LOOP_SPATIAL_KEY_BITS - level);
+    for (size_t i=0; i<sortedKeys.size(); i++) {
+        unsigned long long cell = sortedKeys[i] >> shift;
+        if (!directory.empty() && directory.back().cell == cell) {
+            directory.back().count++;
+        } else {
+            SpatialDirectoryEntry entry = {cell, i, 1};
+            directory.push_back(entry);
+        }
+    }
+}
+
+void SpatialIndex::WriteDirectory(const netCDF::NcVar& recordsVar, const std::vector<SpatialDirectoryEntry>& directory, unsigned int level, const std::vector<double>& bounds)
+{
+    netCDF::NcGroup group = recordsVar.getParentGroup();
+    std::string name = recordsVar.getName() + LOOP_RECORD_DIRECTORY_SUFFIX;
+    auto vars = group.getVars();
+    netCDF::NcVar directoryVar;
+    if (vars.find(name) == vars.end()) {
+        netCDF::NcType entryType;
+        auto types = group.getTypes();
+        auto it = types.find(LOOP_SPATIAL_DIRECTORY_TYPE);
+        if (it != types.end()) {
+            entryType = it->second;
+        } else {
+            netCDF::NcCompoundType compoundType = group.addCompoundType(LOOP_SPATIAL_DIRECTORY_TYPE,sizeof(SpatialDirectoryEntry));
+            compoundType.addMember("cell",netCDF::ncUint64,offsetof(SpatialDirectoryEntry, cell));
+            compoundType.addMember("start",netCDF::ncUint64,offsetof(SpatialDirectoryEntry, start));
+            compoundType.addMember("count",netCDF::ncUint64,offsetof(SpatialDirectoryEntry, count));
+            entryType = compoundType;
+        }
+        netCDF::NcDim directoryIndex = group.addDim(name + "Index");
+        directoryVar = group.addVar(name,entryType,directoryIndex);
+    } else {
+        directoryVar = vars.find(name)->second;
+    }
+    if (!directory.empty()) {
+        std::vector<size_t> start; start.push_back(0);
+        std::vector<size_t> count; count.push_back(directory.size());
+        directoryVar.putVar(start,count,directory.data());
+    }
+    directoryVar.putAtt(LOOP_SPATIAL_DIRECTORY_LEVEL_ATTRIBUTE,netCDF::ncInt,static_cast<int>(level));
+    directoryVar.putAtt(LOOP_SPATIAL_DIRECTORY_BOUNDS_ATTRIBUTE,netCDF::ncDouble,bounds.size(),bounds.data());
+    // The entry count goes last as it is what marks the directory as up to date
+    unsigned long long entries = directory.size();
+    directoryVar.putAtt(LOOP_RECORD_DIRECTORY_ENTRIES_ATTRIBUTE,netCDF::ncUint64,entries);
+}
+
+bool SpatialIndex::ReadDirectory(const netCDF::NcVar& recordsVar, std::vector<SpatialDirectoryEntry>& directory, unsigned int& level, std::vector<double>& bounds)
+{
+    directory.clear();
+    bounds.clear();
+    level = 0;
+    netCDF::NcGroup group = recordsVar.getParentGroup();
+    auto vars = group.getVars();
+    auto var = vars.find(recordsVar.getName() + LOOP_RECORD_DIRECTORY_SUFFIX);
+    if (var == vars.end()) return false;
+    auto atts = var->second.getAtts();
+    unsigned long long entries = 0;
+    int storedLevel = 0;
+    if (!GetAttributeValue(atts, LOOP_RECORD_DIRECTORY_ENTRIES_ATTRIBUTE, &entries) || entries == 0) return false;
+    if (!GetAttributeValue(atts, LOOP_SPATIAL_DIRECTORY_LEVEL_ATTRIBUTE, &storedLevel)
+        || storedLevel < 0 || storedLevel > LOOP_SPATIAL_KEY_BITS) return false;
+    auto boundsAtt = atts.find(LOOP_SPATIAL_DIRECTORY_BOUNDS_ATTRIBUTE);
+    if (boundsAtt == atts.end() || boundsAtt->second.getAttLength() != 6) return false;
+    bounds.resize(6);
+    boundsAtt->second.getValues(bounds.data());
+    directory.resize(static_cast<size_t>(entries));
+    std::vector<size_t> start; start.push_back(0);
+    std::vector<size_t> count; count.push_back(directory.size());
+    var->second.getVar(start,count,directory.data());
+    level = static_cast<unsigned int>(storedLevel);
+    return true;
+}
+
+// Whether a cell along one axis overlaps [regionMin, regionMax]. The outer cells also hold the
+// records clamped into them from outside the bounds
+static bool CellOverlaps(unsigned long long cell, unsigned long long numCells, double min, double max, double regionMin, double regionMax)
+{
+    if (!(max > min)) return true;
+    double width = (max - min) / numCells;
+    double low = cell == 0 ? -std::numeric_limits<double>::infinity() : min + cell * width;
+    double high = cell + 1 >= numCells ? std::numeric_limits<double>::infinity() : min + (cell + 1) * width;
+    return low <= regionMax && high >= regionMin;
+}
+
+void SpatialIndex::GetRegionRanges(const std::vector<SpatialDirectoryEntry>& directory, unsigned int level, const std::vector<double>& bounds, const LoopExtents& region, std::vector<RecordStorage::RecordRange>& ranges)
+{
+    ranges.clear();
+    std::vector<double> regionBounds = GetBounds(region);
+    unsigned long long numCells = 1ULL << level;
+    for (auto it=directory.begin(); it!=directory.end(); it++) {
+        if (!CellOverlaps(CompactBits(it->cell), numCells, bounds[0], bounds[1], regionBounds[0], regionBounds[1])
+            || !CellOverlaps(CompactBits(it->cell >> 1), numCells, bounds[2], bounds[3], regionBounds[2], regionBounds[3])
+            || !CellOverlaps(CompactBits(it->cell >> 2), numCells, bounds[4], bounds[5], regionBounds[4], regionBounds[5])) {
+            continue;
+        }
+        size_t start = static_cast<size_t>(it->start);
+        size_t count = static_cast<size_t>(it->count);
+        if (!ranges.empty() && ranges.back().start + ranges.back().count == start) ranges.back().count += count;
+        else ranges.push_back({start, count});
+    }
+}
+
+void SpatialIndex::IntersectRanges(const std::vector<RecordStorage::RecordRange>& a, const std::vector<RecordStorage::RecordRange>& b, std::vector<RecordStorage::RecordRange>& ranges)
+{
+    ranges.clear();
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a.size() && j < b.size()) {
+        size_t start = std::max(a[i].start, b[j].start);
+        size_t endA = a[i].start + a[i].count;
+        size_t endB = b[j].start + b[j].count;
+        size_t end = std::min(endA, endB);
+        if (start < end) ranges.push_back({start, end - start});
+        if (endA < endB) i++;
+        else j++;
+    }
+}
+
+} // namespace LoopProjectFile
@@ -0,0 +1,241 @@
+#ifndef __LOOPSPATIALINDEX_H
+#define __LOOPSPATIALINDEX_H
+
+#include <netcdf>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+#include "LoopProjectFileUtils.h"
+#include "LoopExtents.h"
+#include "LoopDataCollection.h"
+#include "LoopRecordTables.h"
+#include "LoopRecordStorage.h"
+#include "LoopRecordFilter.h"
+
+#define LOOP_SPATIAL_KEY_BITS 21
+#define LOOP_SPATIAL_DIRECTORY_TYPE "spatialDirectoryEntry"
+#define LOOP_SPATIAL_DIRECTORY_LEVEL_ATTRIBUTE "directoryLevel"
+#define LOOP_SPATIAL_DIRECTORY_BOUNDS_ATTRIBUTE "directoryBounds"
+
+namespace LoopProjectFile {
+
+/*! \brief The run of stored records whose Morton keys fall within one directory cell */
+struct SpatialDirectoryEntry {
+    unsigned long long cell;  /*!< The Morton key of the cell (the top 3*level bits of the record keys) */
+    unsigned long long start; /*!< The storage index of the first record in the cell */
+    unsigned long long count; /*!< The number of records in the cell */
+};
+
+/*! \brief Morton (Z-order) ordered storage of observation tables
+ *
+ * Each record is given a key interleaving LOOP_SPATIAL_KEY_BITS bits of its easting, northing
+ * and altitude within the project extents. A spatially ordered table is stored sorted by this
+ * key, and the variable named by the table's variable followed by LOOP_RECORD_DIRECTORY_SUFFIX
+ * holds one SpatialDirectoryEntry per occupied cell of a coarser grid with 2^level cells along
+ * each axis. The extents used for the keys are kept with the directory so later changes to the
+ * project extents do not affect reads.
+ *
+ * Rewriting, updating or compacting the table marks the directory out of date and region reads
+ * fall back to a full filtered scan until the table is written spatially ordered again.
+ * Deleting records keeps the directory usable.
+ */
+namespace SpatialIndex {
+
+/*!
+ * \brief Gets the key bounds (minEasting, maxEasting, minNorthing, maxNorthing, minAltitude,
+ * maxAltitude) of a set of extents
+ *
+ * \param extents - the project extents
+ *
+ * \return The six key bounds
+ */
+std::vector<double> GetBounds(const LoopExtents& extents);
+
+/*!
+ * \brief Calculates the Morton key of a position, clamping positions outside the bounds
+ *
+ * \param bounds - the key bounds from GetBounds
+ * \param easting - the easting of the position
+ * \param northing - the northing of the position
+ * \param altitude - the altitude of the position
+ *
+ * \return The key interleaving LOOP_SPATIAL_KEY_BITS bits of each axis
+ */
+unsigned long long MortonKey(const std::vector<double>& bounds, double easting, double northing, double altitude);
+
+/*!
+ * \brief Groups sorted keys into directory cells
+ *
+ * \param sortedKeys - the keys of the stored records in storage order
+ * \param level - the bits per axis of a directory cell
+ * \param directory - a reference to return one entry per occupied cell
+ */
+void BuildDirectory(const std::vector<unsigned long long>& sortedKeys, unsigned int level, std::vector<SpatialDirectoryEntry>& directory);
+
+/*!
+ * \brief Writes the directory of a table, replacing any previous directory. Throws on netCDF errors
+ *
+ * \param recordsVar - the variable holding the records
+ * \param directory - the directory entries
+ * \param level - the bits per axis of a directory cell
+ * \param bounds - the key bounds the records were sorted with
+ */
+void WriteDirectory(const netCDF::NcVar& recordsVar, const std::vector<SpatialDirectoryEntry>& directory, unsigned int level, const std::vector<double>& bounds);
+
+/*!
+ * \brief Reads the directory of a table. Throws on netCDF errors
+ *
+ * \param recordsVar - the variable holding the records
+ * \param directory - a reference to return the directory entries
+ * \param level - a reference to return the bits per axis of a directory cell
+ * \param bounds - a reference to return the key bounds the records were sorted with
+ *
+ * \return Whether the table has an up to date directory
+ */
+bool ReadDirectory(const netCDF::NcVar& recordsVar, std::vector<SpatialDirectoryEntry>& directory, unsigned int& level, std::vector<double>& bounds);
+
+/*!
+ * \brief Gets the runs of stored records in the directory cells overlapping a region,
+ * merging neighbouring cells into single runs
+ *
+ * \param directory - the directory entries
+ * \param level - the bits per axis of a directory cell
+ * \param bounds - the key bounds the records were sorted with
+ * \param region - the region (easting, northing and altitude between bottomDepth and topDepth)
+ * \param ranges - a reference to return the runs in storage order
+ */
+void GetRegionRanges(const std::vector<SpatialDirectoryEntry>& directory, unsigned int level, const std::vector<double>& bounds, const LoopExtents& region, std::vector<RecordStorage::RecordRange>& ranges);
+
+/*!
+ * \brief Intersects two sets of runs of stored records
+ *
+ * \param a - the first runs in storage order
+ * \param b - the second runs in storage order
+ * \param ranges - a reference to return the runs present in both
+ */
+void IntersectRanges(const std::vector<RecordStorage::RecordRange>& a, const std::vector<RecordStorage::RecordRange>& b, std::vector<RecordStorage::RecordRange>& ranges);
+
+/*!
+ * \brief Sorts observations (e.g. std::vector<FaultObservation>) by their Morton keys, keeping
+ * the order of records with the same key
+ *
+ * \param bounds - the key bounds from GetBounds
+ * \param records - the records to sort
+ * \param keys - a reference to return the key of each sorted record
+ */
+template <typename T>
+void SortRecords(const std::vector<double>& bounds, std::vector<T>& records, std::vector<unsigned long long>& keys)
+{
+    std::vector<unsigned long long> unsortedKeys(records.size());
+    for (size_t i=0; i<records.size(); i++) {
+        unsortedKeys[i] = MortonKey(bounds, records[i].easting, records[i].northing, records[i].altitude);
+    }
+    std::vector<size_t> order(records.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&unsortedKeys](size_t a, size_t b) { return unsortedKeys[a] < unsortedKeys[b]; });
+    std::vector<T> sorted;
+    sorted.reserve(records.size());
+    keys.resize(records.size());
+    for (size_t i=0; i<order.size(); i++) {
+        sorted.push_back(records[order[i]]);
+        keys[i] = unsortedKeys[order[i]];
+    }
+    records.swap(sorted);
+}
+
+/*!
+ * \brief Writes an observation table with the given layout. With spatial ordering the records
+ * are sorted by Morton key within the project extents and a directory is written next to them
+ *
+ * \param rootNode - the rootNode of the netCDF Loop project file
+ * \param records - the observations to write
+ * \param options - the layout of the stored records
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of data insertion with error message if it failed
+ */
+template <typename T>
+LoopProjectFileResponse SetOrderedRecords(netCDF::NcGroup* rootNode, std::vector<T> records, const ObservationWriteOptions& options, bool verbose=false)
+{
+    if (!options.spatialOrder) return RecordTable<T>::Set(rootNode, records, verbose);
+    std::string variableName = RecordTable<T>::Variable();
+    if (options.directoryLevel > LOOP_SPATIAL_KEY_BITS) {
+        return createErrorMsg(1,"Directory level for " + variableName + " is finer than the spatial keys",verbose);
+    }
+    LoopExtents extents;
+    LoopProjectFileResponse resp = LoopExtents::GetExtents(rootNode, extents, verbose);
+    if (resp.errorCode) return createErrorMsg(1,"Spatial ordering of " + variableName + " needs the project extents",verbose);
+    std::vector<double> bounds = GetBounds(extents);
+    std::vector<unsigned long long> keys;
+    SortRecords(bounds, records, keys);
+    resp = RecordTable<T>::Set(rootNode, records, verbose);
+    if (resp.errorCode) return resp;
+    try {
+        netCDF::NcGroup group;
+        RecordStorage::FindGroup(rootNode, RecordTable<T>::GroupPath(), group);
+        std::vector<SpatialDirectoryEntry> directory;
+        BuildDirectory(keys, options.directoryLevel, directory);
+        WriteDirectory(group.getVar(variableName), directory, options.directoryLevel, bounds);
+    } catch (netCDF::exceptions::NcException& e) {
+        if (verbose) std::cout << e.what() << std::endl;
+        resp = createErrorMsg(1,"Failed to write the spatial directory of " + variableName,verbose);
+    }
+    return resp;
+}
+
+/*!
+ * \brief Retrieves the observations (e.g. std::vector<FaultObservation>) within a region. With
+ * an up to date directory only the cells overlapping the region are read, otherwise the whole
+ * table is scanned
+ *
+ * \param rootNode - the rootNode of the netCDF Loop project file
+ * \param region - the region (easting, northing and altitude between bottomDepth and topDepth)
+ * \param records - a reference to return the records within the region in storage order
+ * \param verbose - a flag to toggle verbose message printing
+ *
+ * \return Response with success/fail of data retrieval with error message if it failed
+ */
+template <typename T>
+LoopProjectFileResponse ReadRegion(netCDF::NcGroup* rootNode, const LoopExtents& region, std::vector<T>& records, bool verbose=false)
+{
+    std::string variableName = RecordTable<T>::Variable();
+    records.clear();
+    RecordFilter filter;
+    filter.Within(region);
+    LoopProjectFileResponse resp = {0,""};
+    try {
+        netCDF::NcGroup group;
+        if (!RecordStorage::FindGroup(rootNode, RecordTable<T>::GroupPath(), group)) {
+            return createErrorMsg(1,"No " + std::string(RecordTable<T>::GroupPath()) + " Group Node Present",verbose);
+        }
+        netCDF::NcVar recordsVar = group.getVar(variableName);
+        std::vector<SpatialDirectoryEntry> directory;
+        unsigned int level = 0;
+        std::vector<double> bounds;
+        if (!ReadDirectory(recordsVar, directory, level, bounds)) {
+            return RecordStorage::ScanRecords(rootNode, filter, records, LOOP_SCAN_BATCH_RECORDS, verbose);
+        }
+        resp = filter.Bind(recordsVar, verbose);
+        if (resp.errorCode) return resp;
+        std::vector<RecordStorage::RecordRange> cellRanges;
+        GetRegionRanges(directory, level, bounds, region, cellRanges);
+        std::vector<RecordStorage::RecordRange> liveRanges;
+        RecordStorage::GetLiveRanges(recordsVar, liveRanges);
+        std::vector<RecordStorage::RecordRange> ranges;
+        IntersectRanges(cellRanges, liveRanges, ranges);
+        size_t numRecords = RecordStorage::ScanRanges(recordsVar, ranges, filter, records, LOOP_SCAN_BATCH_RECORDS);
+        Metrics::RecordRead<T>(recordsVar,numRecords);
+    } catch (netCDF::exceptions::NcException& e) {
+        if (verbose) std::cout << e.what() << std::endl;
+        records.clear();
+        resp = createErrorMsg(1,"Failed to read a region of " + variableName + " from loop project file",verbose);
+    }
+    return resp;
+}
+
+} // namespace SpatialIndex
+
+} // namespace LoopProjectFile
+
+#endif
@@ -1,5 +1,8 @@
 #include "LoopStructuralModels.h"
 #include "LoopExtents.h"
+#include "LoopModelStorage.h"
+#include "LoopProjectFileMetrics.h"
+#include "LoopProjectFileTrace.h"
 
 namespace LoopProjectFile
 {
@@ -67,28 +70,9 @@ namespace LoopProjectFile
                 auto groups = rootNode->getGroups();
                 if (groups.find("StructuralModels") == groups.end())
                 {
-                    netCDF::NcGroup smGroup = rootNode->addGroup("StructuralModels");
-                    netCDF::NcDim eastingDim = smGroup.addDim("easting", extents[0]);
-                    netCDF::NcDim northingDim = smGroup.addDim("northing", extents[1]);
-                    netCDF::NcDim depthDim = smGroup.addDim("depth", extents[2]);
-                    netCDF::NcDim indexDim = smGroup.addDim("index");
-                    std::vector<netCDF::NcDim> dims;
-                    dims.push_back(eastingDim);
-                    dims.push_back(northingDim);
-                    dims.push_back(depthDim);
-                    dims.push_back(indexDim);
-                    netCDF::NcVar dataVar = smGroup.addVar("data", netCDF::ncFloat, dims);
-                    dims.clear();
-                    dims.push_back(indexDim);
-                    netCDF::NcVar minValVar = smGroup.addVar("minVal", netCDF::ncFloat, dims);
-                    netCDF::NcVar maxValVar = smGroup.addVar("maxVal", netCDF::ncFloat, dims);
-                    netCDF::NcVar validVar = smGroup.addVar("valid", netCDF::ncChar, dims);
-                    minValVar.setEndianness(netCDF::NcVar::EndianMode::nc_ENDIAN_LITTLE);
-                    maxValVar.setEndianness(netCDF::NcVar::EndianMode::nc_ENDIAN_LITTLE);
-                    dataVar.setEndianness(netCDF::NcVar::EndianMode::nc_ENDIAN_LITTLE);
-                    validVar.setEndianness(netCDF::NcVar::EndianMode::nc_ENDIAN_LITTLE);
-                    char valid = 0;
-                    validVar.setFill(true, valid);
+                    resp = ModelStorage::CreateModelGroup(rootNode, STRUCTURALMODEL, extents, ModelWriteOptions(), verbose);
+                    if (resp.errorCode)
+                        return resp;
                 }
                 netCDF::NcGroup smGroup = rootNode->getGroup("StructuralModels");
                 // Check data shape against extents shape
@@ -111,13 +95,15 @@ namespace LoopProjectFile
                 // Add data to project file
                 float min = NC_MAX_FLOAT;
                 float max = NC_MIN_FLOAT;
-                char valid = 1;
-                for (auto i = 0; i < data.size(); i++)
                 {
-                    if (data[i] > max)
-                        max = data[i];
-                    if (data[i] < min)
-                        min = data[i];
+                    LOOP_TRACE_SPAN("ModelStatistics", "stats");
+                    for (auto i = 0; i < data.size(); i++)
+                    {
+                        if (data[i] > max)
+                            max = data[i];
+                        if (data[i] < min)
+                            min = data[i];
+                    }
                 }
                 std::vector<size_t> start;
                 start.push_back(index);
@@ -126,10 +112,8 @@ namespace LoopProjectFile
                 netCDF::NcVar minValVar = smGroup.getVar("minVal");
                 netCDF::NcVar maxValVar = smGroup.getVar("maxVal");
                 netCDF::NcVar dataVar = smGroup.getVar("data");
-                netCDF::NcVar validVar = smGroup.getVar("valid");
                 minValVar.putVar(start, count, &min);
                 maxValVar.putVar(start, count, &max);
-                validVar.putVar(start, count, &valid);
                 start.clear();
                 start.push_back(0);
                 start.push_back(0);
@@ -140,7 +124,10 @@ namespace LoopProjectFile
                 count.push_back(dataShape[1]);
                 count.push_back(dataShape[2]);
                 count.push_back(1);
+                LOOP_TRACE_SPAN("WriteModel", "io");
                 dataVar.putVar(start, count, &data[0]);
+                Metrics::RecordWrite<float>(dataVar, data.size());
+                ModelStorage::MarkModelValid(smGroup, index);
             }
             catch (netCDF::exceptions::NcException &e)
             {
@@ -166,8 +153,10 @@ namespace LoopProjectFile
             {
                 netCDF::NcGroup smGroup = rootNode->getGroup("StructuralModels");
                 // Check data is in that index location
-                // ???How to check for data without going to an exception???
-                netCDF::NcDim indexDim = smGroup.getDim("index");
+                if (!ModelStorage::IsModelValid(smGroup, index))
+                {
+                    return createErrorMsg(1, "No structural model at index " + std::to_string(index) + " in loop project file", verbose);
+                }
 
                 netCDF::NcDim easting = smGroup.getDim("easting");
                 netCDF::NcDim northing = smGroup.getDim("northing");
@@ -189,7 +178,9 @@ namespace LoopProjectFile
                 count.push_back(dataShape[1]);
                 count.push_back(dataShape[2]);
                 count.push_back(1);
+                LOOP_TRACE_SPAN("ReadModel", "io");
                 dataVar.getVar(start, count, &data[0]);
+                Metrics::RecordRead<float>(dataVar, data.size());
             }
         }
         catch (netCDF::exceptions::NcException &)
@@ -207,18 +198,22 @@ namespace LoopProjectFile
         if (groups.find("StructuralModels") != groups.end())
         {
             netCDF::NcGroup structuralModelsGroup = rootNode->getGroup("StructuralModels");
-            structuralModelsGroup.getAtt("foliationInterpolator").getValues(&configuration.foliationInterpolator);
-            structuralModelsGroup.getAtt("foliationNumElements").getValues(&configuration.foliationNumElements);
-            structuralModelsGroup.getAtt("foliationBuffer").getValues(&configuration.foliationBuffer);
-            structuralModelsGroup.getAtt("foliationSolver").getValues(&configuration.foliationSolver);
-            structuralModelsGroup.getAtt("foliationDamp").getValues(&configuration.foliationDamp);
+            auto atts = structuralModelsGroup.getAtts();
+            bool found = true;
+            found &= GetAttributeValue(atts, "foliationInterpolator", &configuration.foliationInterpolator);
+            found &= GetAttributeValue(atts, "foliationNumElements", &configuration.foliationNumElements);
+            found &= GetAttributeValue(atts, "foliationBuffer", &configuration.foliationBuffer);
+            found &= GetAttributeValue(atts, "foliationSolver", &configuration.foliationSolver);
+            found &= GetAttributeValue(atts, "foliationDamp", &configuration.foliationDamp);
 
-            structuralModelsGroup.getAtt("faultInterpolator").getValues(&configuration.faultInterpolator);
-            structuralModelsGroup.getAtt("faultNumElements").getValues(&configuration.faultNumElements);
-            structuralModelsGroup.getAtt("faultDataRegion").getValues(&configuration.faultDataRegion);
-            structuralModelsGroup.getAtt("faultSolver").getValues(&configuration.faultSolver);
-            structuralModelsGroup.getAtt("faultCpw").getValues(&configuration.faultNpw);
-            structuralModelsGroup.getAtt("faultNpw").getValues(&configuration.faultCpw);
+            found &= GetAttributeValue(atts, "faultInterpolator", &configuration.faultInterpolator);
+            found &= GetAttributeValue(atts, "faultNumElements", &configuration.faultNumElements);
+            found &= GetAttributeValue(atts, "faultDataRegion", &configuration.faultDataRegion);
+            found &= GetAttributeValue(atts, "faultSolver", &configuration.faultSolver);
+            found &= GetAttributeValue(atts, "faultCpw", &configuration.faultCpw);
+            found &= GetAttributeValue(atts, "faultNpw", &configuration.faultNpw);
+            if (!found)
+                resp = createErrorMsg(1, "Missing Structural Models configuration attributes", verbose);
         }
         else
         {
@@ -238,6 +233,7 @@ namespace LoopProjectFile
                 rootNode->addGroup("StructuralModels");
             }
             netCDF::NcGroup structuralModelsGroup = rootNode->getGroup("StructuralModels");
+            MetadataBatch batch(&structuralModelsGroup);
             structuralModelsGroup.putAtt("foliationInterpolator", netCDF::ncChar, LOOP_CONFIGURATION_DEFAULT_STRING_LENGTH, configuration.foliationInterpolator);
             structuralModelsGroup.putAtt("foliationNumElements", netCDF::ncInt, configuration.foliationNumElements);
             structuralModelsGroup.putAtt("foliationBuffer", netCDF::ncDouble, configuration.foliationBuffer);
@@ -250,6 +246,7 @@ namespace LoopProjectFile
             structuralModelsGroup.putAtt("faultSolver", netCDF::ncChar, LOOP_CONFIGURATION_DEFAULT_STRING_LENGTH, configuration.faultSolver);
             structuralModelsGroup.putAtt("faultCpw", netCDF::ncInt, configuration.faultCpw);
             structuralModelsGroup.putAtt("faultNpw", netCDF::ncInt, configuration.faultNpw);
+            resp = batch.Commit(verbose);
         }
         catch (netCDF::exceptions::NcException &e)
         {
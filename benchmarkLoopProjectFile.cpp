@@ -0,0 +1,271 @@
+#include "LoopProjectFile.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+// Throughput and latency benchmarks for every table and model Get/Set path.
+//
+// Usage: LoopProjectFileBenchmarks [--min-exp N] [--max-exp N] [--repeats N]
+//                                  [--format json|csv] [--output FILE] [--file SCRATCHFILE]
+//
+// Each size 10^min-exp ... 10^max-exp is written to a fresh scratch project file. Record
+// tables are benchmarked with that many records and models with that many voxels. Results
+// go to stdout (or --output) as JSON (default) or CSV so runs can be diffed for regressions.
+
+struct BenchmarkOptions {
+    int minExponent;
+    int maxExponent;
+    int repeats;
+    std::string format;
+    std::string outputFile;
+    std::string scratchFile;
+    BenchmarkOptions() : minExponent(3), maxExponent(5), repeats(3), format("json"), scratchFile("benchmarkLoopProjectFile.loop3d") {}
+};
+
+struct BenchmarkResult {
+    std::string operation;
+    size_t records;
+    size_t bytes;
+    int repeats;
+    double minSeconds;
+    double meanSeconds;
+    int errors;
+};
+
+static double elapsedSeconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static BenchmarkResult makeResult(std::string operation, size_t records, size_t bytes, const std::vector<double>& timings, int errors)
+{
+    BenchmarkResult result;
+    result.operation = operation;
+    result.records = records;
+    result.bytes = bytes;
+    result.repeats = static_cast<int>(timings.size());
+    result.minSeconds = timings.empty() ? 0 : timings[0];
+    result.meanSeconds = 0;
+    for (size_t i=0; i<timings.size(); i++) {
+        if (timings[i] < result.minSeconds) result.minSeconds = timings[i];
+        result.meanSeconds += timings[i];
+    }
+    if (!timings.empty()) result.meanSeconds /= timings.size();
+    result.errors = errors;
+    return result;
+}
+
+template <typename T>
+static void benchmarkRecords(std::string name, std::string filename, size_t numRecords, const BenchmarkOptions& options,
+    LoopProjectFileResponse (*setter)(std::string, std::vector<T>, bool),
+    LoopProjectFileResponse (*getter)(std::string, std::vector<T>&, bool),
+    std::vector<BenchmarkResult>& results)
+{
+    std::vector<T> records(numRecords);
+    std::vector<double> timings;
+    int errors = 0;
+    for (int r=0; r<options.repeats; r++) {
+        auto start = std::chrono::steady_clock::now();
+        errors += setter(filename, records, false).errorCode;
+        timings.push_back(elapsedSeconds(start));
+    }
+    results.push_back(makeResult("Set" + name, numRecords, numRecords * sizeof(T), timings, errors));
+
+    timings.clear();
+    errors = 0;
+    for (int r=0; r<options.repeats; r++) {
+        records.clear();
+        auto start = std::chrono::steady_clock::now();
+        errors += getter(filename, records, false).errorCode;
+        timings.push_back(elapsedSeconds(start));
+        if (records.size() != numRecords) errors++;
+    }
+    results.push_back(makeResult("Get" + name, numRecords, numRecords * sizeof(T), timings, errors));
+}
+
+static void benchmarkModel(std::string name, std::string filename, const std::vector<int>& dataShape, const BenchmarkOptions& options,
+    LoopProjectFileResponse (*setter)(std::string, std::vector<float>, std::vector<int>, int, bool),
+    LoopProjectFileResponse (*getter)(std::string, std::vector<float>&, std::vector<int>&, int, bool),
+    std::vector<BenchmarkResult>& results)
+{
+    size_t numVoxels = static_cast<size_t>(dataShape[0]) * dataShape[1] * dataShape[2];
+    std::vector<float> data(numVoxels);
+    for (size_t i=0; i<numVoxels; i++) data[i] = static_cast<float>(i % 1000);
+    std::vector<double> timings;
+    int errors = 0;
+    for (int r=0; r<options.repeats; r++) {
+        auto start = std::chrono::steady_clock::now();
+        errors += setter(filename, data, dataShape, 0, false).errorCode;
+        timings.push_back(elapsedSeconds(start));
+    }
+    results.push_back(makeResult("Set" + name, numVoxels, numVoxels * sizeof(float), timings, errors));
+
+    timings.clear();
+    errors = 0;
+    std::vector<int> shape;
+    for (int r=0; r<options.repeats; r++) {
+        auto start = std::chrono::steady_clock::now();
+        errors += getter(filename, data, shape, 0, false).errorCode;
+        timings.push_back(elapsedSeconds(start));
+    }
+    results.push_back(makeResult("Get" + name, numVoxels, numVoxels * sizeof(float), timings, errors));
+}
+
+// Chooses a near cubic grid of about numVoxels and sets matching extents on the file
+static std::vector<int> setGridExtents(std::string filename, size_t numVoxels)
+{
+    int side = static_cast<int>(std::cbrt(static_cast<double>(numVoxels)) + 0.5);
+    if (side < 1) side = 1;
+    int depth = static_cast<int>(numVoxels / (static_cast<size_t>(side) * side));
+    if (depth < 1) depth = 1;
+    LoopProjectFile::LoopExtents extents;
+    extents.minEasting = 0;
+    extents.maxEasting = (side - 1) * 10.0;
+    extents.minNorthing = 0;
+    extents.maxNorthing = (side - 1) * 10.0;
+    extents.topDepth = 0;
+    extents.bottomDepth = -(depth - 1) * 10.0;
+    extents.minLatitude = 0;
+    extents.maxLatitude = 1;
+    extents.minLongitude = 0;
+    extents.maxLongitude = 1;
+    extents.spacingX = 10;
+    extents.spacingY = 10;
+    extents.spacingZ = 10;
+    extents.utmZone = 1;
+    extents.utmNorthSouth = 1;
+    extents.errored = false;
+    LoopProjectFile::SetExtents(filename, extents);
+    std::vector<int> dataShape;
+    dataShape.push_back(side);
+    dataShape.push_back(side);
+    dataShape.push_back(depth);
+    return dataShape;
+}
+
+static void runBenchmarks(size_t size, const BenchmarkOptions& options, std::vector<BenchmarkResult>& results)
+{
+    using namespace LoopProjectFile;
+    std::string filename = options.scratchFile;
+    std::remove(filename.c_str());
+    CreateBasicFile(filename);
+    std::vector<int> dataShape = setGridExtents(filename, size);
+
+    // Observations
+    benchmarkRecords<FaultObservation>("FaultObservations", filename, size, options, SetFaultObservations, GetFaultObservations, results);
+    benchmarkRecords<FoldObservation>("FoldObservations", filename, size, options, SetFoldObservations, GetFoldObservations, results);
+    benchmarkRecords<FoliationObservation>("FoliationObservations", filename, size, options, SetFoliationObservations, GetFoliationObservations, results);
+    benchmarkRecords<DiscontinuityObservation>("DiscontinuityObservations", filename, size, options, SetDiscontinuityObservations, GetDiscontinuityObservations, results);
+    benchmarkRecords<StratigraphicObservation>("StratigraphicObservations", filename, size, options, SetStratigraphicObservations, GetStratigraphicObservations, results);
+    benchmarkRecords<ContactObservation>("Contacts", filename, size, options, SetContacts, GetContacts, results);
+    // Drillholes
+    benchmarkRecords<DrillholeObservation>("DrillholeObservations", filename, size, options, SetDrillholeObservations, GetDrillholeObservations, results);
+    benchmarkRecords<DrillholeProperty>("DrillholeProperties", filename, size, options, SetDrillholeProperties, GetDrillholeProperties, results);
+    benchmarkRecords<DrillholeSurvey>("DrillholeSurveys", filename, size, options, SetDrillholeSurveys, GetDrillholeSurveys, results);
+    benchmarkRecords<DrillholeDescription>("DrillholeDescriptions", filename, size, options, SetDrillholeDescriptions, GetDrillholeDescriptions, results);
+    // Events
+    benchmarkRecords<FaultEvent>("FaultEvents", filename, size, options, SetFaultEvents, GetFaultEvents, results);
+    benchmarkRecords<FoldEvent>("FoldEvents", filename, size, options, SetFoldEvents, GetFoldEvents, results);
+    benchmarkRecords<FoliationEvent>("FoliationEvents", filename, size, options, SetFoliationEvents, GetFoliationEvents, results);
+    benchmarkRecords<DiscontinuityEvent>("DiscontinuityEvents", filename, size, options, SetDiscontinuityEvents, GetDiscontinuityEvents, results);
+    benchmarkRecords<StratigraphicLayer>("StratigraphicLayers", filename, size, options, SetStratigraphicLayers, GetStratigraphicLayers, results);
+    benchmarkRecords<EventRelationship>("EventRelationships", filename, size, options, SetEventRelationships, GetEventRelationships, results);
+    // Models
+    benchmarkModel("StructuralModel", filename, dataShape, options, SetStructuralModel, GetStructuralModel, results);
+    benchmarkModel("GeophysicalModel", filename, dataShape, options, SetGeophysicalModel, GetGeophysicalModel, results);
+    benchmarkModel("UncertaintyModel", filename, dataShape, options, SetUncertaintyModel, GetUncertaintyModel, results);
+
+    std::remove(filename.c_str());
+}
+
+static double recordsPerSecond(const BenchmarkResult& result)
+{
+    return result.meanSeconds > 0 ? result.records / result.meanSeconds : 0;
+}
+
+static double megabytesPerSecond(const BenchmarkResult& result)
+{
+    return result.meanSeconds > 0 ? result.bytes / result.meanSeconds / (1024.0 * 1024.0) : 0;
+}
+
+static void writeJson(std::ostream& out, const std::vector<BenchmarkResult>& results)
+{
+    out << "{\n  \"benchmark\": \"LoopProjectFileBenchmarks\",\n  \"version\": \""
+        << LoopVersionMajor << "." << LoopVersionMinor << "." << LoopVersionSub << "\",\n  \"results\": [\n";
+    for (size_t i=0; i<results.size(); i++) {
+        const BenchmarkResult& r = results[i];
+        out << "    {\"operation\": \"" << r.operation << "\", \"records\": " << r.records
+            << ", \"bytes\": " << r.bytes << ", \"repeats\": " << r.repeats
+            << ", \"min_seconds\": " << r.minSeconds << ", \"mean_seconds\": " << r.meanSeconds
+            << ", \"records_per_second\": " << recordsPerSecond(r) << ", \"mb_per_second\": " << megabytesPerSecond(r)
+            << ", \"errors\": " << r.errors << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+static void writeCsv(std::ostream& out, const std::vector<BenchmarkResult>& results)
+{
+    out << "operation,records,bytes,repeats,min_seconds,mean_seconds,records_per_second,mb_per_second,errors\n";
+    for (size_t i=0; i<results.size(); i++) {
+        const BenchmarkResult& r = results[i];
+        out << r.operation << "," << r.records << "," << r.bytes << "," << r.repeats << ","
+            << r.minSeconds << "," << r.meanSeconds << "," << recordsPerSecond(r) << ","
+            << megabytesPerSecond(r) << "," << r.errors << "\n";
+    }
+}
+
+static bool parseOptions(int argc, char** argv, BenchmarkOptions& options)
+{
+    for (int i=1; i<argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--min-exp" && hasValue) options.minExponent = atoi(argv[++i]);
+        else if (arg == "--max-exp" && hasValue) options.maxExponent = atoi(argv[++i]);
+        else if (arg == "--repeats" && hasValue) options.repeats = atoi(argv[++i]);
+        else if (arg == "--format" && hasValue) options.format = argv[++i];
+        else if (arg == "--output" && hasValue) options.outputFile = argv[++i];
+        else if (arg == "--file" && hasValue) options.scratchFile = argv[++i];
+        else {
+            std::cout << "Unknown or incomplete option " << arg << std::endl;
+            return false;
+        }
+    }
+    if (options.minExponent < 0 || options.maxExponent > 8 || options.minExponent > options.maxExponent || options.repeats < 1) {
+        std::cout << "Invalid size range or repeat count" << std::endl;
+        return false;
+    }
+    if (options.format != "json" && options.format != "csv") {
+        std::cout << "Format must be json or csv" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main (int argc, char** argv)
+{
+    BenchmarkOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cout << "Usage: " << argv[0] << " [--min-exp N] [--max-exp N] [--repeats N] [--format json|csv] [--output FILE] [--file SCRATCHFILE]" << std::endl;
+        return 1;
+    }
+
+    std::vector<BenchmarkResult> results;
+    for (int exponent=options.minExponent; exponent<=options.maxExponent; exponent++) {
+        size_t size = 1;
+        for (int i=0; i<exponent; i++) size *= 10;
+        std::cerr << "Benchmarking size " << size << std::endl;
+        runBenchmarks(size, options, results);
+    }
+
+    std::ofstream file;
+    if (!options.outputFile.empty()) file.open(options.outputFile.c_str());
+    std::ostream& out = options.outputFile.empty() ? std::cout : file;
+    if (options.format == "csv") writeCsv(out, results);
+    else writeJson(out, results);
+
+    int errors = 0;
+    for (size_t i=0; i<results.size(); i++) errors += results[i].errors;
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,77 @@
+#include "LoopProjectFile.h"
+#include "LoopProjectClient.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <unistd.h>
+
+// Latency benchmark for the project server. Times the same getters called directly on the
+// file and through LoopProjectFile::Client, reporting the mean and 99th percentile call time.
+// An in-process server is started on a temporary socket unless a running server is given.
+//
+// Usage: LoopProjectFileServerBenchmark [filename] [calls] [socket]
+
+template <typename Call>
+static int timeCalls(std::string label, std::string path, int calls, Call call)
+{
+    std::vector<double> micros;
+    int errors = 0;
+    for (int i=0; i<calls; i++) {
+        auto start = std::chrono::steady_clock::now();
+        LoopProjectFileResponse resp = call();
+        micros.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        errors += resp.errorCode;
+    }
+    std::sort(micros.begin(), micros.end());
+    double total = 0;
+    for (size_t i=0; i<micros.size(); i++) total += micros[i];
+    std::cout << label << "," << path << "," << calls << "," << total / calls << ","
+        << micros[static_cast<size_t>(0.99 * (micros.size() - 1))] << std::endl;
+    return errors;
+}
+
+int main (int argc, char** argv)
+{
+    std::string filename = argc > 1 ? argv[1] : "testLoopProjectFile.loop3d";
+    int calls = argc > 2 ? atoi(argv[2]) : 200;
+    if (calls < 1) calls = 1;
+
+    LoopProjectFile::ProjectServer server;
+    std::string socketPath;
+    if (argc > 3) {
+        socketPath = argv[3];
+    } else {
+        socketPath = "/tmp/loopprojectserver_bench_" + std::to_string(getpid()) + ".sock";
+        LoopProjectFileResponse resp = server.Start(socketPath);
+        if (resp.errorCode) {
+            std::cout << resp.errorMessage << std::endl;
+            return 1;
+        }
+    }
+    LoopProjectFileResponse resp = LoopProjectFile::Client::Connect(socketPath);
+    if (resp.errorCode) {
+        std::cout << resp.errorMessage << std::endl;
+        return 1;
+    }
+
+    LoopProjectFile::LoopExtents extents;
+    std::vector<LoopProjectFile::FaultObservation> faultObservations;
+    std::vector<float> data;
+    std::vector<int> dataShape;
+    int errors = 0;
+    // Warm the server's handle so the first timed call is not an open
+    LoopProjectFile::Client::GetExtents(filename, extents);
+
+    std::cout << "call,path,calls,mean_us,p99_us" << std::endl;
+    errors += timeCalls("GetExtents", "direct", calls, [&]() { return LoopProjectFile::GetExtents(filename, extents); });
+    errors += timeCalls("GetExtents", "server", calls, [&]() { return LoopProjectFile::Client::GetExtents(filename, extents); });
+    errors += timeCalls("GetFaultObservations", "direct", calls, [&]() { return LoopProjectFile::GetFaultObservations(filename, faultObservations); });
+    errors += timeCalls("GetFaultObservations", "server", calls, [&]() { return LoopProjectFile::Client::GetFaultObservations(filename, faultObservations); });
+    errors += timeCalls("GetStructuralModel", "direct", calls, [&]() { return LoopProjectFile::GetStructuralModel(filename, data, dataShape, 0); });
+    errors += timeCalls("GetStructuralModel", "server", calls, [&]() { return LoopProjectFile::Client::GetStructuralModel(filename, data, dataShape, 0); });
+
+    LoopProjectFile::Client::Disconnect();
+    server.Stop();
+    if (errors) std::cout << errors << " calls failed" << std::endl;
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,67 @@
+#include "LoopProjectFile.h"
+#include "LoopProjectReaderPool.h"
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+
+// Scaling benchmark for ProjectReaderPool. Each thread repeatedly reads a model and the
+// fault observations from the same project file and reduces the model outside the netCDF
+// lock, as a post-processing job would.
+//
+// Usage: LoopProjectFileReaderPoolBenchmark [filename] [maxThreads] [readsPerThread]
+
+static void readerThread(LoopProjectFile::ProjectReaderPool* pool, int reads, std::atomic<int>* errors, std::atomic<long long>* bytes)
+{
+    std::vector<float> data;
+    std::vector<int> dataShape;
+    std::vector<LoopProjectFile::FaultObservation> faultObservations;
+    for (int i=0; i<reads; i++) {
+        LoopProjectFileResponse resp = pool->ReadModel(LoopProjectFile::STRUCTURALMODEL, 0, data, dataShape);
+        if (resp.errorCode) { (*errors)++; continue; }
+        double sum = 0;
+        for (size_t j=0; j<data.size(); j++) sum += data[j];
+        volatile double sink = sum;
+        (void)sink;
+        faultObservations.clear();
+        resp = pool->Read(LoopProjectFile::DataCollection::GetFaultObservations, faultObservations);
+        if (resp.errorCode) (*errors)++;
+        *bytes += data.size() * sizeof(float) + faultObservations.size() * sizeof(LoopProjectFile::FaultObservation);
+    }
+}
+
+int main (int argc, char** argv)
+{
+    std::string filename = argc > 1 ? argv[1] : "testLoopProjectFile.loop3d";
+    unsigned int maxThreads = argc > 2 ? (unsigned int)atoi(argv[2]) : std::thread::hardware_concurrency();
+    int reads = argc > 3 ? atoi(argv[3]) : 50;
+    if (maxThreads == 0) maxThreads = 1;
+
+    LoopProjectFile::ProjectReaderPool pool;
+    LoopProjectFileResponse resp = pool.Open(filename, true);
+    if (resp.errorCode) {
+        std::cout << resp.errorMessage << std::endl;
+        return 1;
+    }
+
+    std::cout << "threads,seconds,reads_per_second,MB_per_second,speedup" << std::endl;
+    double baseline = 0;
+    int totalErrors = 0;
+    for (unsigned int numThreads=1; numThreads<=maxThreads; numThreads++) {
+        std::atomic<int> errors(0);
+        std::atomic<long long> bytes(0);
+        std::vector<std::thread> threads;
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned int t=0; t<numThreads; t++) threads.push_back(std::thread(readerThread, &pool, reads, &errors, &bytes));
+        for (size_t t=0; t<threads.size(); t++) threads[t].join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double readsPerSecond = numThreads * reads / seconds;
+        if (numThreads == 1) baseline = readsPerSecond;
+        std::cout << numThreads << "," << seconds << "," << readsPerSecond << ","
+            << bytes / seconds / (1024.0 * 1024.0) << "," << readsPerSecond / baseline << std::endl;
+        totalErrors += errors;
+    }
+    pool.Close();
+    if (totalErrors) std::cout << totalErrors << " reads failed" << std::endl;
+    return totalErrors ? 1 : 0;
+}
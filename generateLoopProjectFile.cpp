@@ -0,0 +1,514 @@
+#include "LoopProjectFile.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+// Generates large synthetic loop project files for load testing.
+//
+// Every table is generated in batches from its own random stream seeded from --seed, so
+// the same options always produce the same file regardless of batch size. Only one batch
+// (or one model realisation) is held in memory at a time which allows multi-GB outputs.
+//
+// Usage: LoopProjectFileGenerator [options]
+//   --output FILE              project file to create (default generated.loop3d)
+//   --force                    replace the output file if it exists
+//   --seed N                   random seed (default 1)
+//   --easting MIN MAX          UTM easting extents (default 0 10000)
+//   --northing MIN MAX         UTM northing extents (default 0 10000)
+//   --depth TOP BOTTOM         depth extents (default 0 -5000)
+//   --spacing X Y Z            grid spacing in metres (default 100 100 100)
+//   --realisations N           structural model realisations (default 1)
+//   --geophysical-models N     geophysical models (default 0)
+//   --fault-observations N     (and --fold-observations, --foliation-observations,
+//                              --discontinuity-observations, --stratigraphic-observations,
+//                              --contacts) number of records of each observation type
+//   --drillholes N             number of drillholes (default 0)
+//   --intervals N              logged intervals per drillhole (default 10)
+//   --surveys N                surveys per drillhole (default 3)
+//   --fault-events N           (and --fold-events, --foliation-events,
+//                              --discontinuity-events, --layers) number of events of each type
+//   --batch N                  records generated and written per batch (default 100000)
+
+struct GeneratorOptions {
+    std::string outputFile;
+    bool force;
+    unsigned long long seed;
+    double minEasting, maxEasting, minNorthing, maxNorthing, topDepth, bottomDepth;
+    double spacingX, spacingY, spacingZ;
+    int realisations;
+    int geophysicalModels;
+    size_t faultObservations, foldObservations, foliationObservations;
+    size_t discontinuityObservations, stratigraphicObservations, contacts;
+    size_t drillholes, intervals, surveys;
+    size_t faultEvents, foldEvents, foliationEvents, discontinuityEvents, layers;
+    size_t batchSize;
+    GeneratorOptions()
+        : outputFile("generated.loop3d"), force(false), seed(1),
+          minEasting(0), maxEasting(10000), minNorthing(0), maxNorthing(10000), topDepth(0), bottomDepth(-5000),
+          spacingX(100), spacingY(100), spacingZ(100), realisations(1), geophysicalModels(0),
+          faultObservations(1000), foldObservations(1000), foliationObservations(1000),
+          discontinuityObservations(1000), stratigraphicObservations(1000), contacts(1000),
+          drillholes(0), intervals(10), surveys(3),
+          faultEvents(20), foldEvents(5), foliationEvents(5), discontinuityEvents(5), layers(10),
+          batchSize(100000) {}
+};
+
+// Stream identifiers so each table draws from an independent deterministic sequence
+enum GeneratorStream {
+    FAULTOBSERVATIONSTREAM = 1,
+    FOLDOBSERVATIONSTREAM,
+    FOLIATIONOBSERVATIONSTREAM,
+    DISCONTINUITYOBSERVATIONSTREAM,
+    STRATIGRAPHICOBSERVATIONSTREAM,
+    CONTACTSTREAM,
+    DRILLHOLEDESCRIPTIONSTREAM,
+    DRILLHOLEOBSERVATIONSTREAM,
+    DRILLHOLESURVEYSTREAM,
+    EVENTSTREAM,
+    RELATIONSHIPSTREAM,
+    MODELSTREAM = 1000
+};
+
+static std::mt19937_64 makeStream(const GeneratorOptions& options, unsigned long long stream)
+{
+    std::seed_seq seq{static_cast<unsigned int>(options.seed), static_cast<unsigned int>(options.seed >> 32), static_cast<unsigned int>(stream)};
+    return std::mt19937_64(seq);
+}
+
+static double uniform(std::mt19937_64& rng, double minVal, double maxVal)
+{
+    return std::uniform_real_distribution<double>(minVal, maxVal)(rng);
+}
+
+// Writes a table of total records in batches. The first batch goes through the library
+// setter (which creates the group and variable) and later batches are appended in place
+template <typename T, typename Fill>
+static LoopProjectFileResponse writeTable(const GeneratorOptions& options, size_t total,
+    std::string parentGroup, std::string groupName, std::string variableName,
+    LoopProjectFileResponse (*setter)(std::string, std::vector<T>, bool), Fill fill)
+{
+    LoopProjectFileResponse resp = {0,""};
+    if (total == 0) return resp;
+    std::vector<T> batch;
+    size_t written = 0;
+    netCDF::NcFile file;
+    bool fileOpen = false;
+    while (written < total && !resp.errorCode) {
+        size_t count = std::min(options.batchSize, total - written);
+        batch.resize(count);
+        for (size_t i=0; i<count; i++) {
+            batch[i] = T();
+            fill(batch[i], written + i);
+        }
+        if (written == 0) {
+            resp = setter(options.outputFile, batch, false);
+        } else {
+            try {
+                if (!fileOpen) {
+                    if (LoopProjectFile::OpenProjectFile(options.outputFile, file, false)) {
+                        return LoopProjectFile::createErrorMsg(1,"Failure to reopen " + options.outputFile);
+                    }
+                    fileOpen = true;
+                }
+                netCDF::NcVar var = file.getGroup(parentGroup).getGroup(groupName).getVar(variableName);
+                std::vector<size_t> start(1, written);
+                std::vector<size_t> counts(1, count);
+                var.putVar(start, counts, &batch[0]);
+            } catch (netCDF::exceptions::NcException& e) {
+                std::cout << e.what() << std::endl;
+                resp = LoopProjectFile::createErrorMsg(1,"Failed to append to " + variableName);
+            }
+        }
+        written += count;
+    }
+    if (fileOpen) LoopProjectFile::CloseProjectFile(&file);
+    std::cout << "  " << variableName << ": " << written << " records" << std::endl;
+    return resp;
+}
+
+static void setName(char* destination, size_t length, std::string prefix, size_t index)
+{
+    std::string name = prefix + " " + std::to_string(index);
+    strncpy_s(destination, name.c_str(), length - 1);
+    destination[length - 1] = 0;
+}
+
+template <typename T>
+static void fillLocation(T& record, std::mt19937_64& rng, const GeneratorOptions& options, int eventId)
+{
+    record.eventId = eventId;
+    record.easting = uniform(rng, options.minEasting, options.maxEasting);
+    record.northing = uniform(rng, options.minNorthing, options.maxNorthing);
+    record.altitude = uniform(rng, options.bottomDepth, options.topDepth);
+}
+
+// Event identifiers are unique across all event types, each type taking the next block
+struct EventBases {
+    int fault;
+    int fold;
+    int foliation;
+    int discontinuity;
+    int layer;
+};
+
+static EventBases makeEventBases(const GeneratorOptions& options)
+{
+    EventBases bases;
+    bases.fault = 0;
+    bases.fold = bases.fault + static_cast<int>(options.faultEvents);
+    bases.foliation = bases.fold + static_cast<int>(options.foldEvents);
+    bases.discontinuity = bases.foliation + static_cast<int>(options.foliationEvents);
+    bases.layer = bases.discontinuity + static_cast<int>(options.discontinuityEvents);
+    return bases;
+}
+
+static int generateObservations(const GeneratorOptions& options, const EventBases& bases)
+{
+    using namespace LoopProjectFile;
+    int errors = 0;
+    int numFaults = options.faultEvents ? static_cast<int>(options.faultEvents) : 1;
+    int numLayers = options.layers ? static_cast<int>(options.layers) : 1;
+
+    std::mt19937_64 rng = makeStream(options, FAULTOBSERVATIONSTREAM);
+    errors += writeTable<FaultObservation>(options, options.faultObservations, "DataCollection", "Observations", "faultObservations", SetFaultObservations,
+        [&](FaultObservation& obs, size_t) {
+            fillLocation(obs, rng, options, bases.fault + static_cast<int>(rng() % numFaults));
+            obs.dipdir = uniform(rng, 0, 360);
+            obs.dip = uniform(rng, 30, 90);
+            obs.displacement = uniform(rng, 0, 500);
+        }).errorCode;
+
+    rng = makeStream(options, FOLDOBSERVATIONSTREAM);
+    errors += writeTable<FoldObservation>(options, options.foldObservations, "DataCollection", "Observations", "foldObservations", SetFoldObservations,
+        [&](FoldObservation& obs, size_t) {
+            fillLocation(obs, rng, options, bases.fold + static_cast<int>(rng() % (options.foldEvents ? options.foldEvents : 1)));
+            obs.axisX = uniform(rng, -1, 1);
+            obs.axisY = uniform(rng, -1, 1);
+            obs.axisZ = uniform(rng, -1, 1);
+        }).errorCode;
+
+    rng = makeStream(options, FOLIATIONOBSERVATIONSTREAM);
+    errors += writeTable<FoliationObservation>(options, options.foliationObservations, "DataCollection", "Observations", "foliationObservations", SetFoliationObservations,
+        [&](FoliationObservation& obs, size_t) {
+            fillLocation(obs, rng, options, bases.foliation + static_cast<int>(rng() % (options.foliationEvents ? options.foliationEvents : 1)));
+            obs.dipdir = uniform(rng, 0, 360);
+            obs.dip = uniform(rng, 0, 90);
+        }).errorCode;
+
+    rng = makeStream(options, DISCONTINUITYOBSERVATIONSTREAM);
+    errors += writeTable<DiscontinuityObservation>(options, options.discontinuityObservations, "DataCollection", "Observations", "discontinuityObservations", SetDiscontinuityObservations,
+        [&](DiscontinuityObservation& obs, size_t) {
+            fillLocation(obs, rng, options, bases.discontinuity + static_cast<int>(rng() % (options.discontinuityEvents ? options.discontinuityEvents : 1)));
+            obs.dipdir = uniform(rng, 0, 360);
+            obs.dip = uniform(rng, 0, 90);
+        }).errorCode;
+
+    rng = makeStream(options, STRATIGRAPHICOBSERVATIONSTREAM);
+    errors += writeTable<StratigraphicObservation>(options, options.stratigraphicObservations, "DataCollection", "Observations", "stratigraphicObservations", SetStratigraphicObservations,
+        [&](StratigraphicObservation& obs, size_t) {
+            int layer = static_cast<int>(rng() % numLayers);
+            fillLocation(obs, rng, options, bases.layer + layer);
+            obs.dipdir = uniform(rng, 0, 360);
+            obs.dip = uniform(rng, 0, 60);
+            setName(obs.layer, LOOP_NAME_LENGTH, "Layer", layer);
+        }).errorCode;
+
+    rng = makeStream(options, CONTACTSTREAM);
+    errors += writeTable<ContactObservation>(options, options.contacts, "DataCollection", "Contacts", "contacts", SetContacts,
+        [&](ContactObservation& obs, size_t) {
+            fillLocation(obs, rng, options, bases.layer + static_cast<int>(rng() % numLayers));
+        }).errorCode;
+    return errors;
+}
+
+static int generateDrillholes(const GeneratorOptions& options)
+{
+    using namespace LoopProjectFile;
+    if (options.drillholes == 0) return 0;
+    int errors = 0;
+    double holeDepth = options.topDepth - options.bottomDepth;
+
+    // The collar positions are kept so the intervals start at their collar
+    std::vector<double> collarEastings(options.drillholes);
+    std::vector<double> collarNorthings(options.drillholes);
+    std::mt19937_64 rng = makeStream(options, DRILLHOLEDESCRIPTIONSTREAM);
+    errors += writeTable<DrillholeDescription>(options, options.drillholes, "ExtractedInformation", "DrillholeInformation", "drillholeDescriptions", SetDrillholeDescriptions,
+        [&](DrillholeDescription& hole, size_t i) {
+            hole.collarId = static_cast<int>(i);
+            setName(hole.name, LOOP_NAME_LENGTH, "Drillhole", i);
+            hole.easting = uniform(rng, options.minEasting, options.maxEasting);
+            hole.northing = uniform(rng, options.minNorthing, options.maxNorthing);
+            hole.altitude = options.topDepth;
+            collarEastings[i] = hole.easting;
+            collarNorthings[i] = hole.northing;
+        }).errorCode;
+
+    rng = makeStream(options, DRILLHOLEOBSERVATIONSTREAM);
+    double intervalLength = holeDepth / options.intervals;
+    errors += writeTable<DrillholeObservation>(options, options.drillholes * options.intervals, "DataCollection", "Drillholes", "drillholeObservations", SetDrillholeObservations,
+        [&](DrillholeObservation& obs, size_t i) {
+            size_t hole = i / options.intervals;
+            size_t interval = i % options.intervals;
+            obs.eventId = static_cast<int>(hole);
+            obs.easting = obs.toEasting = collarEastings[hole];
+            obs.northing = obs.toNorthing = collarNorthings[hole];
+            obs.from = interval * intervalLength;
+            obs.to = (interval + 1) * intervalLength;
+            obs.altitude = options.topDepth - obs.from;
+            obs.toAltitude = options.topDepth - obs.to;
+            setName(obs.unit, LOOP_DRILLHOLE_UNIT_LENGTH, "Unit", rng() % (options.layers ? options.layers : 1));
+        }).errorCode;
+
+    rng = makeStream(options, DRILLHOLESURVEYSTREAM);
+    errors += writeTable<DrillholeSurvey>(options, options.drillholes * options.surveys, "DataCollection", "Drillholes", "drillholeSurveys", SetDrillholeSurveys,
+        [&](DrillholeSurvey& survey, size_t i) {
+            survey.collarId = static_cast<double>(i / options.surveys);
+            survey.depth = (i % options.surveys) * holeDepth / options.surveys;
+            survey.angle1 = uniform(rng, 0, 360);
+            survey.angle2 = uniform(rng, 60, 90);
+        }).errorCode;
+    return errors;
+}
+
+template <typename T>
+static void fillEvent(T& event, std::mt19937_64& rng, int eventId, std::string prefix, size_t index)
+{
+    event.eventId = eventId;
+    event.minAge = uniform(rng, 0, 100);
+    event.maxAge = event.minAge + uniform(rng, 0, 10);
+    event.enabled = 1;
+    event.rank = 0;
+    setName(event.name, LOOP_NAME_LENGTH, prefix, index);
+}
+
+static int generateEvents(const GeneratorOptions& options, const EventBases& bases)
+{
+    using namespace LoopProjectFile;
+    int errors = 0;
+
+    std::mt19937_64 rng = makeStream(options, EVENTSTREAM);
+    errors += writeTable<FaultEvent>(options, options.faultEvents, "ExtractedInformation", "EventLog", "faultEvents", SetFaultEvents,
+        [&](FaultEvent& event, size_t i) {
+            fillEvent(event, rng, bases.fault + static_cast<int>(i), "Fault", i);
+            event.avgDisplacement = uniform(rng, 0, 1000);
+            event.avgDownthrowDir = uniform(rng, 0, 360);
+            event.influenceDistance = uniform(rng, 100, 2000);
+            event.verticalRadius = uniform(rng, 500, 5000);
+            event.horizontalRadius = uniform(rng, 500, 5000);
+            event.centreEasting = uniform(rng, options.minEasting, options.maxEasting);
+            event.centreNorthing = uniform(rng, options.minNorthing, options.maxNorthing);
+            event.centreAltitude = uniform(rng, options.bottomDepth, options.topDepth);
+        }).errorCode;
+    errors += writeTable<FoldEvent>(options, options.foldEvents, "ExtractedInformation", "EventLog", "foldEvents", SetFoldEvents,
+        [&](FoldEvent& event, size_t i) {
+            fillEvent(event, rng, bases.fold + static_cast<int>(i), "Fold", i);
+            event.wavelength = uniform(rng, 500, 5000);
+            event.amplitude = uniform(rng, 50, 500);
+        }).errorCode;
+    errors += writeTable<FoliationEvent>(options, options.foliationEvents, "ExtractedInformation", "EventLog", "foliationEvents", SetFoliationEvents,
+        [&](FoliationEvent& event, size_t i) {
+            fillEvent(event, rng, bases.foliation + static_cast<int>(i), "Foliation", i);
+            event.lowerScalarValue = uniform(rng, 0, 0.5);
+            event.upperScalarValue = event.lowerScalarValue + uniform(rng, 0, 0.5);
+        }).errorCode;
+    errors += writeTable<DiscontinuityEvent>(options, options.discontinuityEvents, "ExtractedInformation", "EventLog", "discontinuityEvents", SetDiscontinuityEvents,
+        [&](DiscontinuityEvent& event, size_t i) {
+            fillEvent(event, rng, bases.discontinuity + static_cast<int>(i), "Discontinuity", i);
+            event.scalarValue = uniform(rng, 0, 1);
+        }).errorCode;
+    errors += writeTable<StratigraphicLayer>(options, options.layers, "ExtractedInformation", "StratigraphicInformation", "stratigraphicLayers", SetStratigraphicLayers,
+        [&](StratigraphicLayer& layer, size_t i) {
+            fillEvent(layer, rng, bases.layer + static_cast<int>(i), "Layer", i);
+            layer.thickness = uniform(rng, 10, 500);
+            layer.colour1Red = layer.colour2Red = static_cast<char>(rng() & 0x7f);
+            layer.colour1Green = layer.colour2Green = static_cast<char>(rng() & 0x7f);
+            layer.colour1Blue = layer.colour2Blue = static_cast<char>(rng() & 0x7f);
+        }).errorCode;
+
+    // Consecutive layers are conformable, every fault cuts a layer and later faults
+    // abut, splay from or overprint an earlier fault
+    std::vector<EventRelationship> relationships;
+    rng = makeStream(options, RELATIONSHIPSTREAM);
+    for (size_t i=1; i<options.layers; i++) {
+        EventRelationship rel;
+        rel.eventId1 = bases.layer + static_cast<int>(i - 1);
+        rel.eventId2 = bases.layer + static_cast<int>(i);
+        rel.type = STRATA_STRATA;
+        rel.angle = 0;
+        relationships.push_back(rel);
+    }
+    for (size_t i=0; i<options.faultEvents; i++) {
+        if (options.layers) {
+            EventRelationship rel;
+            rel.eventId1 = bases.fault + static_cast<int>(i);
+            rel.eventId2 = bases.layer + static_cast<int>(rng() % options.layers);
+            rel.type = FAULT_STRATA;
+            rel.angle = uniform(rng, 0, 90);
+            relationships.push_back(rel);
+        }
+        if (i > 0 && uniform(rng, 0, 1) < 0.3) {
+            EventRelationship rel;
+            rel.eventId1 = bases.fault + static_cast<int>(i);
+            rel.eventId2 = bases.fault + static_cast<int>(rng() % i);
+            rel.type = static_cast<RelationshipType>(FAULT_FAULT_SPLAY + rng() % 3);
+            rel.angle = uniform(rng, 0, 90);
+            relationships.push_back(rel);
+        }
+    }
+    if (!relationships.empty()) {
+        LoopProjectFileResponse resp = SetEventRelationships(options.outputFile, relationships, false);
+        errors += resp.errorCode;
+        std::cout << "  eventRelationships: " << relationships.size() << " records" << std::endl;
+    }
+    return errors;
+}
+
+// Each realisation is a folded and faulted layered scalar field perturbed per realisation
+static int generateModels(const GeneratorOptions& options, const std::vector<int>& dataShape)
+{
+    using namespace LoopProjectFile;
+    int errors = 0;
+    size_t numVoxels = static_cast<size_t>(dataShape[0]) * dataShape[1] * dataShape[2];
+    std::vector<float> data(numVoxels);
+    const double pi = 3.14159265358979323846;
+    // Write each ensemble in a single pass without fill
+    if (options.realisations) errors += PrepareModels(options.outputFile, STRUCTURALMODEL, ModelWriteOptions::Ensemble(options.realisations)).errorCode;
+    if (options.geophysicalModels) errors += PrepareModels(options.outputFile, GEOPHYSICALMODEL, ModelWriteOptions::Ensemble(options.geophysicalModels)).errorCode;
+    for (int model=0; model<options.realisations + options.geophysicalModels; model++) {
+        bool structural = model < options.realisations;
+        std::mt19937_64 rng = makeStream(options, MODELSTREAM + model);
+        double wavelength = uniform(rng, 2000, 8000);
+        double amplitude = uniform(rng, 50, 400);
+        double faultEasting = uniform(rng, options.minEasting, options.maxEasting);
+        double throwDistance = uniform(rng, 0, 300);
+        std::normal_distribution<float> noise(0.0f, structural ? 1.0f : 0.05f);
+        for (int i=0; i<dataShape[0]; i++) {
+            double x = options.minEasting + i * options.spacingX;
+            for (int j=0; j<dataShape[1]; j++) {
+                double y = options.minNorthing + j * options.spacingY;
+                double fold = amplitude * std::sin(2 * pi * x / wavelength) * std::cos(2 * pi * y / wavelength);
+                double offset = x > faultEasting ? throwDistance : 0;
+                size_t base = (static_cast<size_t>(i) * dataShape[1] + j) * dataShape[2];
+                for (int k=0; k<dataShape[2]; k++) {
+                    double z = options.bottomDepth + k * options.spacingZ;
+                    double value = z + fold + offset;
+                    // Geophysical models hold a density like property of the layering
+                    if (!structural) value = 2.6 + 0.2 * std::sin(value / 200.0);
+                    data[base + k] = static_cast<float>(value) + noise(rng);
+                }
+            }
+        }
+        LoopProjectFileResponse resp = structural
+            ? SetStructuralModel(options.outputFile, data, dataShape, model, false)
+            : SetGeophysicalModel(options.outputFile, data, dataShape, model - options.realisations, false);
+        if (resp.errorCode) std::cout << resp.errorMessage << std::endl;
+        errors += resp.errorCode;
+    }
+    if (options.realisations) std::cout << "  structural models: " << options.realisations << " x " << numVoxels << " voxels" << std::endl;
+    if (options.geophysicalModels) std::cout << "  geophysical models: " << options.geophysicalModels << " x " << numVoxels << " voxels" << std::endl;
+    return errors;
+}
+
+static bool parseOptions(int argc, char** argv, GeneratorOptions& options)
+{
+    for (int i=1; i<argc; i++) {
+        std::string arg = argv[i];
+        int remaining = argc - i - 1;
+        if (arg == "--force") options.force = true;
+        else if (arg == "--output" && remaining >= 1) options.outputFile = argv[++i];
+        else if (arg == "--seed" && remaining >= 1) options.seed = strtoull(argv[++i], NULL, 10);
+        else if (arg == "--easting" && remaining >= 2) { options.minEasting = atof(argv[++i]); options.maxEasting = atof(argv[++i]); }
+        else if (arg == "--northing" && remaining >= 2) { options.minNorthing = atof(argv[++i]); options.maxNorthing = atof(argv[++i]); }
+        else if (arg == "--depth" && remaining >= 2) { options.topDepth = atof(argv[++i]); options.bottomDepth = atof(argv[++i]); }
+        else if (arg == "--spacing" && remaining >= 3) { options.spacingX = atof(argv[++i]); options.spacingY = atof(argv[++i]); options.spacingZ = atof(argv[++i]); }
+        else if (arg == "--realisations" && remaining >= 1) options.realisations = atoi(argv[++i]);
+        else if (arg == "--geophysical-models" && remaining >= 1) options.geophysicalModels = atoi(argv[++i]);
+        else if (arg == "--fault-observations" && remaining >= 1) options.faultObservations = strtoull(argv[++i], NULL, 10);
+        else if (arg == "--fold-observations" && remaining >= 1) options.foldObservations = strtoull(argv[++i], NULL, 10);
+        else if (arg == "--foliation-observations" && remaining >= 1) options.foliationObservations = strtoull(argv[++i], NULL, 10);
+        else if (arg == "--discontinuity-observations" && remaining >= 1) options.discontinuityObservations = strtoull(argv[++i], NULL, 10);
+        else if (arg == "--stratigraphic-observations" && remaining >= 1) options.stratigraphicObservations = strtoull(argv[++i], NULL, 10);
+        else if (arg == "--contacts" && remaining >= 1) options.contacts = strtoull(argv[++i], NULL, 10);
+        else if (arg == "--drillholes" && remaining >= 1) options.drillholes = strtoull(argv[++i], NULL, 10);
+        else if (arg == "--intervals" && remaining >= 1) options.intervals = strtoull(argv[++i], NULL, 10);
+        else if (arg == "--surveys" && remaining >= 1) options.surveys = strtoull(argv[++i], NULL, 10);
+        else if (arg == "--fault-events" && remaining >= 1) options.faultEvents = strtoull(argv[++i], NULL, 10);
+        else if (arg == "--fold-events" && remaining >= 1) options.foldEvents = strtoull(argv[++i], NULL, 10);
+        else if (arg == "--foliation-events" && remaining >= 1) options.foliationEvents = strtoull(argv[++i], NULL, 10);
+        else if (arg == "--discontinuity-events" && remaining >= 1) options.discontinuityEvents = strtoull(argv[++i], NULL, 10);
+        else if (arg == "--layers" && remaining >= 1) options.layers = strtoull(argv[++i], NULL, 10);
+        else if (arg == "--batch" && remaining >= 1) options.batchSize = strtoull(argv[++i], NULL, 10);
+        else {
+            std::cout << "Unknown or incomplete option " << arg << std::endl;
+            return false;
+        }
+    }
+    if (options.maxEasting <= options.minEasting || options.maxNorthing <= options.minNorthing || options.topDepth <= options.bottomDepth) {
+        std::cout << "Extents must have max > min and top > bottom" << std::endl;
+        return false;
+    }
+    if (options.spacingX <= 0 || options.spacingY <= 0 || options.spacingZ <= 0 || options.batchSize == 0
+        || options.intervals == 0 || options.surveys == 0 || options.realisations < 0 || options.geophysicalModels < 0) {
+        std::cout << "Spacing, batch, interval and survey counts must be positive" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main (int argc, char** argv)
+{
+    GeneratorOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cout << "See the top of generateLoopProjectFile.cpp for the available options" << std::endl;
+        return 1;
+    }
+    struct stat buffer;
+    if (stat(options.outputFile.c_str(), &buffer) == 0) {
+        if (!options.force) {
+            std::cout << "File " << options.outputFile << " already exists, use --force to replace it" << std::endl;
+            return 1;
+        }
+        std::remove(options.outputFile.c_str());
+    }
+
+    std::cout << "Generating " << options.outputFile << " with seed " << options.seed << std::endl;
+    int errors = LoopProjectFile::CreateBasicFile(options.outputFile).errorCode;
+
+    LoopProjectFile::LoopExtents extents;
+    extents.minEasting = options.minEasting;
+    extents.maxEasting = options.maxEasting;
+    extents.minNorthing = options.minNorthing;
+    extents.maxNorthing = options.maxNorthing;
+    extents.topDepth = options.topDepth;
+    extents.bottomDepth = options.bottomDepth;
+    extents.minLatitude = 0;
+    extents.maxLatitude = 1;
+    extents.minLongitude = 0;
+    extents.maxLongitude = 1;
+    extents.spacingX = options.spacingX;
+    extents.spacingY = options.spacingY;
+    extents.spacingZ = options.spacingZ;
+    extents.utmZone = 1;
+    extents.utmNorthSouth = 1;
+    extents.errored = false;
+    errors += LoopProjectFile::SetExtents(options.outputFile, extents).errorCode;
+
+    // Same grid size calculation as the extents validity check
+    std::vector<int> dataShape;
+    dataShape.push_back(static_cast<int>((options.maxEasting - options.minEasting) / options.spacingX + 1));
+    dataShape.push_back(static_cast<int>((options.maxNorthing - options.minNorthing) / options.spacingY + 1));
+    dataShape.push_back(static_cast<int>((options.topDepth - options.bottomDepth) / options.spacingZ + 1));
+
+    EventBases bases = makeEventBases(options);
+    errors += generateObservations(options, bases);
+    errors += generateDrillholes(options);
+    errors += generateEvents(options, bases);
+    errors += generateModels(options, dataShape);
+
+    if (errors) std::cout << "Generation finished with " << errors << " errors" << std::endl;
+    else std::cout << "Generation finished" << std::endl;
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,45 @@
+#include "LoopProjectFile.h"
+#include "LoopProjectServer.h"
+#include <csignal>
+#include <cstring>
+
+// Local project server daemon. Keeps the project files it is asked about open and serves
+// reads to LoopProjectFile::Client callers (see LoopProjectClient.h) until interrupted.
+//
+// Usage: LoopProjectFileServer [--socket PATH] [--verbose]
+
+int main (int argc, char** argv)
+{
+    std::string socketPath = LOOP_SERVER_DEFAULT_SOCKET;
+    bool verbose = false;
+    for (int i=1; i<argc; i++) {
+        if (!strcmp(argv[i], "--socket") && i + 1 < argc) {
+            socketPath = argv[++i];
+        } else if (!strcmp(argv[i], "--verbose")) {
+            verbose = true;
+        } else {
+            std::cout << "Usage: " << argv[0] << " [--socket PATH] [--verbose]" << std::endl;
+            return 1;
+        }
+    }
+
+    // Block the stop signals in every thread and wait for them here
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGHUP);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+    LoopProjectFile::ProjectServer server;
+    LoopProjectFileResponse resp = server.Start(socketPath, verbose);
+    if (resp.errorCode) {
+        std::cout << resp.errorMessage << std::endl;
+        return 1;
+    }
+    std::cout << "Serving loop project files on " << socketPath << std::endl;
+    int signal = 0;
+    sigwait(&signals, &signal);
+    server.Stop();
+    return 0;
+}
@@ -1,5 +1,15 @@
 #include "LoopProjectFile.h"
+#include "LoopProjectFileAsync.h"
+#include "LoopModelPrefetcher.h"
+#include "LoopSharedModelCache.h"
+#include "LoopProjectValidation.h"
+#include "LoopProjectIntegrity.h"
+#ifndef _WIN32
+#include "LoopProjectClient.h"
+#endif
 #include <sys/stat.h>
+#include <algorithm>
+#include <cstdio>
 
 int testLoopProjectFileCreateFunctions(std::string filename);
 int testLoopProjectFileSetFunctions(std::string filename);
@@ -27,6 +37,57 @@ int main (int argc, char** argv)
         std::cout << "Loop Project File " << filename << " checked out as NOT valid" << std::endl;
     }
 
+    // Validate alongside a file with an orphaned fault observation, then again from the cache
+    std::string orphanFilename = "testValidation.loop3d";
+    std::remove(orphanFilename.c_str());
+    errors += LoopProjectFile::CreateBasicFile(orphanFilename).errorCode;
+    std::vector<LoopProjectFile::FaultEvent> orphanEvents(2);
+    orphanEvents[1].eventId = 1;
+    errors += LoopProjectFile::SetFaultEvents(orphanFilename,orphanEvents).errorCode;
+    std::vector<LoopProjectFile::FaultObservation> orphanObservations(3);
+    orphanObservations[1].eventId = 1;
+    orphanObservations[2].eventId = 7;
+    errors += LoopProjectFile::SetFaultObservations(orphanFilename,orphanObservations).errorCode;
+    std::vector<std::string> validationFiles;
+    validationFiles.push_back(filename);
+    validationFiles.push_back(orphanFilename);
+    std::vector<LoopProjectFile::ValidationReport> reports;
+    LoopProjectFile::FileIdentity unvalidatedIdentity;
+    LoopProjectFile::GetFileIdentity(filename,unvalidatedIdentity);
+    errors += LoopProjectFile::Validation::ValidateFiles(validationFiles,reports,2,true).errorCode;
+    std::vector<std::string>& orphanProblems = reports[1].problems;
+    if (reports[1].valid || std::find(orphanProblems.begin(), orphanProblems.end(),
+        "1 faultObservations records have an unknown eventId (not in faultEvents, first at record 2)") == orphanProblems.end()) {
+        std::cout << "Validation did not report the orphaned fault observation" << std::endl;
+        errors++;
+    }
+    LoopProjectFile::IntegrityReport integrity;
+    errors += LoopProjectFile::Integrity::CheckReferences(orphanFilename,integrity,2).errorCode;
+    if (integrity.GetOrphanCount() != 1 || integrity.checks.empty() || integrity.checks[0].orphanIndices.size() != 1
+        || integrity.checks[0].orphanIndices[0] != 2) {
+        std::cout << "Integrity check did not find the orphaned fault observation" << std::endl;
+        errors++;
+    }
+#ifndef _WIN32
+    LoopProjectFile::ValidationReport cachedReport;
+    errors += LoopProjectFile::Validation::ValidateFile(filename,cachedReport,true).errorCode;
+    if (!cachedReport.cached || cachedReport.valid != reports[0].valid || cachedReport.problems != reports[0].problems) {
+        std::cout << "Validation of an unchanged file was not taken from the cache" << std::endl;
+        errors++;
+    }
+    std::remove((filename + LOOP_VALIDATION_CACHE_SUFFIX).c_str());
+    std::remove((orphanFilename + LOOP_VALIDATION_CACHE_SUFFIX).c_str());
+#endif
+    LoopProjectFile::FileIdentity validatedIdentity;
+    LoopProjectFile::GetFileIdentity(filename,validatedIdentity);
+    if (validatedIdentity != unvalidatedIdentity) {
+        std::cout << "Validation modified the project file" << std::endl;
+        errors++;
+    }
+    for (auto it=reports[0].problems.begin(); it!=reports[0].problems.end(); it++) {
+        std::cout << "Validation problem in " << filename << ": " << *it << std::endl;
+    }
+
     return errors;
 }
 
@@ -75,6 +136,27 @@ int testLoopProjectFileSetFunctions(std::string filename)
     if (resp.errorCode) std::cout << resp.errorMessage << std::endl;
     errors += resp.errorCode;
 
+    // Build a project in memory, take its image and read it back from the buffer
+    std::vector<char> projectImage;
+    LoopProjectFile::ProjectSession memorySession;
+    resp = memorySession.CreateInMemory(true);
+    errors += resp.errorCode;
+    resp = memorySession.Write(LoopProjectFile::LoopExtents::SetExtents,extents);
+    errors += resp.errorCode;
+    resp = memorySession.ToBuffer(projectImage);
+    errors += resp.errorCode;
+    memorySession.Close();
+    resp = memorySession.OpenFromMemory(projectImage.data(),projectImage.size(),true,true);
+    errors += resp.errorCode;
+    LoopProjectFile::LoopExtents memoryExtents;
+    resp = memorySession.Read(LoopProjectFile::LoopExtents::GetExtents,memoryExtents);
+    errors += resp.errorCode;
+    if (memoryExtents.maxEasting != extents.maxEasting || memoryExtents.utmZone != extents.utmZone) {
+        std::cout << "Extents read from an in memory project do not match" << std::endl;
+        errors++;
+    }
+    memorySession.Close();
+
     // Create some fault observations and save them to the file
     std::vector<LoopProjectFile::FaultObservation> faultObservations;
     for (auto i=0; i<10; i++) {
@@ -147,6 +229,74 @@ int testLoopProjectFileSetFunctions(std::string filename)
     if (resp.errorCode) std::cout << resp.errorMessage << std::endl;
     errors += resp.errorCode;
 
+    // Preallocate an unfilled uncertainty ensemble and write into the middle of it
+    resp = LoopProjectFile::PrepareModels(filename,LoopProjectFile::UNCERTAINTYMODEL,LoopProjectFile::ModelWriteOptions::Ensemble(4),true);
+    if (resp.errorCode) std::cout << resp.errorMessage << std::endl;
+    errors += resp.errorCode;
+    resp = LoopProjectFile::SetUncertaintyModel(filename,data,dataShape,2,true);
+    if (resp.errorCode) std::cout << resp.errorMessage << std::endl;
+    errors += resp.errorCode;
+    std::vector<char> validUncertainty;
+    resp = LoopProjectFile::ListValidModels(filename,LoopProjectFile::UNCERTAINTYMODEL,validUncertainty,true);
+    errors += resp.errorCode;
+    std::vector<float> unwrittenData;
+    std::vector<int> unwrittenShape;
+    if (validUncertainty != std::vector<char>{0,0,1,0}
+        || !LoopProjectFile::GetUncertaintyModel(filename,unwrittenData,unwrittenShape,0,false).errorCode) {
+        std::cout << "Unwritten uncertainty models in the preallocated ensemble are not flagged as missing" << std::endl;
+        errors++;
+    }
+
+    // Write the structural model configuration as one metadata batch through a session and
+    // check distinct values read back into the right fields
+    LoopProjectFile::StructuralModelsConfiguration smConfiguration;
+    smConfiguration.faultCpw = 7;
+    smConfiguration.faultNpw = 3;
+    LoopProjectFile::ProjectSession metadataSession;
+    resp = metadataSession.Open(filename,false,true);
+    errors += resp.errorCode;
+    resp = metadataSession.BeginMetadataBatch();
+    errors += resp.errorCode;
+    resp = metadataSession.Write(LoopProjectFile::StructuralModels::SetStructuralModelsConfiguration,smConfiguration);
+    errors += resp.errorCode;
+    resp = metadataSession.CommitMetadataBatch();
+    errors += resp.errorCode;
+    LoopProjectFile::StructuralModelsConfiguration smReadBack;
+    resp = metadataSession.Read(LoopProjectFile::StructuralModels::GetStructuralModelsConfiguration,smReadBack);
+    errors += resp.errorCode;
+    if (smReadBack.faultCpw != 7 || smReadBack.faultNpw != 3) {
+        std::cout << "Structural models configuration did not round trip" << std::endl;
+        errors++;
+    }
+
+    // Edit the fault events several times in write back mode, reading back the unflushed
+    // edit, and check only the last edit reaches the file on closing
+    resp = metadataSession.SetWriteBack(true);
+    errors += resp.errorCode;
+    std::vector<LoopProjectFile::FaultEvent> editedFaultEvents = faultEvents;
+    editedFaultEvents[0].minAge = 100.0;
+    resp = metadataSession.WriteTable(editedFaultEvents);
+    errors += resp.errorCode;
+    std::vector<LoopProjectFile::FaultEvent> pendingFaultEvents;
+    resp = metadataSession.ReadTable(pendingFaultEvents);
+    errors += resp.errorCode;
+    resp = metadataSession.WriteTable(faultEvents);
+    errors += resp.errorCode;
+    if (pendingFaultEvents.size() != faultEvents.size() || pendingFaultEvents[0].minAge != 100.0
+        || metadataSession.GetPendingTableCount() != 1) {
+        std::cout << "Write back session did not hold the fault event edits" << std::endl;
+        errors++;
+    }
+    resp = metadataSession.Close();
+    errors += resp.errorCode;
+    std::vector<LoopProjectFile::FaultEvent> flushedFaultEvents;
+    resp = LoopProjectFile::GetFaultEvents(filename,flushedFaultEvents,true);
+    errors += resp.errorCode;
+    if (flushedFaultEvents.size() != faultEvents.size() || flushedFaultEvents[0].minAge != faultEvents[0].minAge) {
+        std::cout << "Write back session did not flush the fault events on closing" << std::endl;
+        errors++;
+    }
+
     // check contacts
     std::vector<LoopProjectFile::ContactObservation> contactObservations;
     for (auto i=0; i<5; i++) {
@@ -160,6 +310,47 @@ int testLoopProjectFileSetFunctions(std::string filename)
     if (resp.errorCode) std::cout << resp.errorMessage << std::endl;
     errors += resp.errorCode;
 
+    // Update one contact, delete another and compact, then check rewriting the whole table
+    // brings every contact back
+    std::vector<LoopProjectFile::ContactObservation> editedContacts(1,contactObservations[1]);
+    editedContacts[0].easting = 10;
+    resp = LoopProjectFile::UpdateRecords(filename,std::vector<size_t>(1,1),editedContacts,true);
+    errors += resp.errorCode;
+    resp = LoopProjectFile::DeleteRecords<LoopProjectFile::ContactObservation>(filename,std::vector<size_t>(1,0),false,true);
+    errors += resp.errorCode;
+    for (int compacted=0; compacted<2; compacted++) {
+        editedContacts.clear();
+        resp = LoopProjectFile::GetContacts(filename,editedContacts,true);
+        errors += resp.errorCode;
+        if (editedContacts.size() != 4 || editedContacts[0].easting != 10 || editedContacts[3].easting != 4) {
+            std::cout << "Contacts were not updated and deleted in place" << std::endl;
+            errors++;
+        }
+        resp = LoopProjectFile::CompactRecords<LoopProjectFile::ContactObservation>(filename,true);
+        errors += resp.errorCode;
+    }
+    resp = LoopProjectFile::SetContacts(filename,contactObservations,true);
+    errors += resp.errorCode;
+    editedContacts.clear();
+    resp = LoopProjectFile::GetContacts(filename,editedContacts,true);
+    errors += resp.errorCode;
+    if (editedContacts.size() != contactObservations.size() || editedContacts[1].easting != 1) {
+        std::cout << "Rewriting the contacts did not clear the deleted records" << std::endl;
+        errors++;
+    }
+
+    // Page through the contacts and check the count matches without reading the records
+    size_t numContacts = 0;
+    resp = LoopProjectFile::GetRecordCount<LoopProjectFile::ContactObservation>(filename,numContacts,true);
+    errors += resp.errorCode;
+    editedContacts.clear();
+    resp = LoopProjectFile::GetContacts(filename,editedContacts,3,10,true);
+    errors += resp.errorCode;
+    if (numContacts != contactObservations.size() || editedContacts.size() != 2 || editedContacts[0].easting != 3) {
+        std::cout << "Contacts range read returned " << editedContacts.size() << " of " << numContacts << " records" << std::endl;
+        errors++;
+    }
+
     // check drillhole observations
     std::vector<LoopProjectFile::DrillholeObservation> drillholeObservations;
     for (auto i=0; i<5; i++) {
@@ -221,6 +412,59 @@ int testLoopProjectFileGetFunctions(std::string filename)
         << std::endl;
     }
 
+    // Scan the fault observations in small batches for steep dips within a range of eastings
+    std::vector<LoopProjectFile::FaultObservation> steepFaultObservations;
+    LoopProjectFile::RecordFilter steepFilter;
+    steepFilter.Range("dip",6,90).Range("easting",0,8).In("eventId",std::vector<int>(1,0));
+    resp = LoopProjectFile::ScanRecords(filename,steepFilter,steepFaultObservations,4,true);
+    errors += resp.errorCode;
+    if (steepFaultObservations.size() != 3 || steepFaultObservations[0].dip != 6) {
+        std::cout << "Filtered scan returned " << steepFaultObservations.size() << " fault observations" << std::endl;
+        errors++;
+    }
+
+    // Bulk load the same fault observations and check they match
+    LoopProjectFile::BulkVector<LoopProjectFile::FaultObservation> bulkFaultObservations;
+    resp = LoopProjectFile::GetFaultObservations(filename,bulkFaultObservations,true);
+    if (resp.errorCode) std::cout << resp.errorMessage << std::endl;
+    errors += resp.errorCode;
+    if (bulkFaultObservations.size() != faultObservations.size()) {
+        std::cout << "Bulk loaded fault observations do not match" << std::endl;
+        errors++;
+    } else {
+        for (size_t i=0; i<bulkFaultObservations.size(); i++) {
+            if (bulkFaultObservations[i].easting != faultObservations[i].easting
+                || bulkFaultObservations[i].dip != faultObservations[i].dip) {
+                std::cout << "Bulk loaded fault observation " << i << " does not match" << std::endl;
+                errors++;
+                break;
+            }
+        }
+    }
+
+    // Read the fault observations again through the async API while counting them on the worker pool
+    std::future<LoopProjectFile::Async::Result<std::vector<LoopProjectFile::FaultObservation> > > asyncFaultObservations
+        = LoopProjectFile::Async::GetFaultObservations(filename,true);
+    LoopProjectFile::Async::Result<std::vector<LoopProjectFile::FaultObservation> > asyncResult = asyncFaultObservations.get();
+    errors += asyncResult.response.errorCode;
+    std::vector<LoopProjectFile::FaultObservation>* asyncData = &asyncResult.data;
+    size_t asyncCount = LoopProjectFile::Async::RunOnWorkerPool([asyncData]() { return asyncData->size(); }).get();
+    if (asyncCount != faultObservations.size()) {
+        std::cout << "Async loaded fault observations do not match" << std::endl;
+        errors++;
+    }
+
+    // Queue more completion callbacks than there are worker threads and wait for all of them
+    unsigned int numCallbacks = LoopProjectFile::Async::GetWorkerPool().GetThreadCount() + 2;
+    std::vector<std::promise<int> > callbackDone(numCallbacks);
+    for (unsigned int i=0; i<numCallbacks; i++) {
+        std::promise<int>* done = &callbackDone[i];
+        LoopProjectFile::Async::OnComplete<LoopProjectFile::Async::Result<LoopProjectFile::LoopExtents> >(
+            LoopProjectFile::Async::GetExtents(filename),
+            [done](LoopProjectFile::Async::Result<LoopProjectFile::LoopExtents> result) { done->set_value(result.response.errorCode); });
+    }
+    for (unsigned int i=0; i<numCallbacks; i++) errors += callbackDone[i].get_future().get();
+
     // And check those fold observations
     std::vector<LoopProjectFile::FoldObservation> foldObservations;
     resp = LoopProjectFile::GetFoldObservations(filename,foldObservations,true);
@@ -234,6 +478,29 @@ int testLoopProjectFileGetFunctions(std::string filename)
         << std::endl;
     }
 
+    // Rewrite the fold observations in spatial order and read back only those in the western edge
+    std::vector<LoopProjectFile::FoldObservation> orderedFoldObservations;
+    double foldEastings[] = {2400.0, 1100.0, 1800.0, 1200.0, 2300.0, 1150.0};
+    for (auto i=0; i<6; i++) {
+        LoopProjectFile::FoldObservation foldObs;
+        foldObs.eventId = i;
+        foldObs.easting = foldEastings[i];
+        foldObs.northing = 1500.0;
+        foldObs.altitude = -1500.0;
+        orderedFoldObservations.push_back(foldObs);
+    }
+    resp = LoopProjectFile::SetFoldObservations(filename,orderedFoldObservations,LoopProjectFile::ObservationWriteOptions::SpatiallyOrdered(),true);
+    errors += resp.errorCode;
+    LoopProjectFile::LoopExtents westernEdge = extents;
+    westernEdge.maxEasting = 1300.0;
+    std::vector<LoopProjectFile::FoldObservation> westernFoldObservations;
+    resp = LoopProjectFile::ReadRegion(filename,westernEdge,westernFoldObservations,true);
+    errors += resp.errorCode;
+    if (westernFoldObservations.size() != 3 || westernFoldObservations[0].easting != 1100.0) {
+        std::cout << "Region read returned " << westernFoldObservations.size() << " fold observations" << std::endl;
+        errors++;
+    }
+
     // Check fault events are there
     std::vector<LoopProjectFile::FaultEvent> faultEvents;
     resp = LoopProjectFile::GetFaultEvents(filename,faultEvents,true);
@@ -269,6 +536,118 @@ int testLoopProjectFileGetFunctions(std::string filename)
                         broken = true;
                     }
     }
+    // List the valid structural models and check a missing index is rejected without reading it
+    std::vector<char> validModels;
+    resp = LoopProjectFile::ListValidModels(filename,LoopProjectFile::STRUCTURALMODEL,validModels,true);
+    errors += resp.errorCode;
+    std::vector<float> missingData;
+    std::vector<int> missingShape;
+    if (validModels.empty() || !validModels[0]
+        || !LoopProjectFile::GetStructuralModel(filename,missingData,missingShape,(int)validModels.size(),false).errorCode) {
+        std::cout << "Valid structural models do not match the models written" << std::endl;
+        errors++;
+    }
+    std::vector<char> missingFileModels;
+    if (!LoopProjectFile::ListValidModels("missingLoopProjectFile.loop3d",LoopProjectFile::STRUCTURALMODEL,missingFileModels,false).errorCode) {
+        std::cout << "Listing the models of a missing file did not fail" << std::endl;
+        errors++;
+    }
+    // Read the structural model through the async API and check the value range from the worker pool
+    LoopProjectFile::Async::Result<LoopProjectFile::Async::ModelData> asyncModel
+        = LoopProjectFile::Async::GetStructuralModel(filename,0,true).get();
+    errors += asyncModel.response.errorCode;
+    if (asyncModel.data.data.size() != data.size() || asyncModel.data.minValue != 0.0f
+        || asyncModel.data.maxValue != (float)(shapeX+shapeY+shapeZ-3)) {
+        std::cout << "Async loaded structural model range does not match" << std::endl;
+        errors++;
+    }
+    // Walk the structural models with the prefetcher and check the first matches the direct read
+    LoopProjectFile::ModelPrefetcher prefetcher;
+    resp = prefetcher.Open(filename,LoopProjectFile::STRUCTURALMODEL,0,true);
+    errors += resp.errorCode;
+    while (!resp.errorCode && prefetcher.HasNext()) {
+        const float* prefetched = NULL;
+        unsigned int modelIndex = 0;
+        resp = prefetcher.Next(prefetched,modelIndex);
+        errors += resp.errorCode;
+        if (!resp.errorCode && modelIndex == 0 && !std::equal(data.begin(),data.end(),prefetched)) {
+            std::cout << "Prefetched structural model does not match direct read" << std::endl;
+            errors++;
+        }
+    }
+    prefetcher.Close();
+
+    // Read the same model through a session with a chunk cache sized for whole model reads
+    LoopProjectFile::ProjectSession session;
+    resp = session.Open(filename,true,true);
+    errors += resp.errorCode;
+    LoopProjectFile::ChunkCacheSettings cacheSettings;
+    resp = session.ApplyChunkCachePreset(LoopProjectFile::STRUCTURALMODEL,LoopProjectFile::WHOLEMODEL,&cacheSettings);
+    errors += resp.errorCode;
+    std::vector<float> sessionData;
+    std::vector<int> sessionShape;
+    resp = session.ReadModel(LoopProjectFile::STRUCTURALMODEL,0,sessionData,sessionShape);
+    errors += resp.errorCode;
+    if (sessionData != data) {
+        std::cout << "Session read structural model does not match direct read" << std::endl;
+        errors++;
+    }
+
+    // Repeated reads through the session cache are served from memory
+    session.SetCacheLimit(64 * 1024 * 1024);
+    std::vector<LoopProjectFile::FaultObservation> cachedFaultObservations;
+    for (int i=0; i<2; i++) {
+        resp = session.ReadModel(LoopProjectFile::STRUCTURALMODEL,0,sessionData,sessionShape);
+        errors += resp.errorCode;
+        resp = session.ReadTable(cachedFaultObservations);
+        errors += resp.errorCode;
+    }
+    LoopProjectFile::SessionCacheStatistics cacheStatistics = session.GetCacheStatistics();
+    if (cacheStatistics.hits != 2 || cacheStatistics.misses != 2 || sessionData != data) {
+        std::cout << "Session cache recorded " << cacheStatistics.hits << " hits and " << cacheStatistics.misses << " misses" << std::endl;
+        errors++;
+    }
+    session.Close();
+
+    // Share the same model through the shared memory model cache and check both views match
+    LoopProjectFile::SharedModelCache sharedCache("/loopmodeltest");
+    LoopProjectFile::SharedModelView firstView;
+    LoopProjectFile::SharedModelView secondView;
+    resp = sharedCache.GetModel(filename,LoopProjectFile::STRUCTURALMODEL,0,firstView,true);
+    errors += resp.errorCode;
+    resp = sharedCache.GetModel(filename,LoopProjectFile::STRUCTURALMODEL,0,secondView,true);
+    errors += resp.errorCode;
+    if (firstView.GetSize() != data.size() || secondView.GetSize() != data.size()
+        || !std::equal(data.begin(),data.end(),firstView.GetData())
+        || !std::equal(data.begin(),data.end(),secondView.GetData())) {
+        std::cout << "Shared structural model does not match direct read" << std::endl;
+        errors++;
+    }
+    resp = sharedCache.RemoveModel(filename,LoopProjectFile::STRUCTURALMODEL,0,true);
+    errors += resp.errorCode;
+
+#ifndef _WIN32
+    // Read the same data through a local project server
+    LoopProjectFile::ProjectServer server;
+    resp = server.Start("testLoopProjectServer.sock",true);
+    errors += resp.errorCode;
+    resp = LoopProjectFile::Client::Connect("testLoopProjectServer.sock",true);
+    errors += resp.errorCode;
+    std::vector<float> serverData;
+    std::vector<int> serverShape;
+    resp = LoopProjectFile::Client::GetStructuralModel(filename,serverData,serverShape,0,true);
+    errors += resp.errorCode;
+    std::vector<LoopProjectFile::FaultObservation> serverFaultObservations;
+    resp = LoopProjectFile::Client::GetFaultObservations(filename,serverFaultObservations,true);
+    errors += resp.errorCode;
+    if (serverData != data || serverShape != dataShape || serverFaultObservations.size() != faultObservations.size()) {
+        std::cout << "Data read through the project server does not match direct read" << std::endl;
+        errors++;
+    }
+    LoopProjectFile::Client::Disconnect();
+    server.Stop();
+#endif
+
     // Check that those contacts are in the file
     std::vector<LoopProjectFile::ContactObservation> contactObservations;
     resp = LoopProjectFile::GetContacts(filename,contactObservations,true);
@@ -296,5 +675,57 @@ int testLoopProjectFileGetFunctions(std::string filename)
         << std::endl;
     }
 
+    // Load the whole project into a snapshot and check it agrees with the individual reads
+    LoopProjectFile::ProjectSnapshot snapshot;
+    resp = LoopProjectFile::LoadProjectSnapshot(filename,snapshot,true,true);
+    if (resp.errorCode) std::cout << resp.errorMessage << std::endl;
+    errors += resp.errorCode;
+    if (snapshot.faultObservations.size() != faultObservations.size()
+        || snapshot.drillholeObservations.size() != drillholeObservations.size()
+        || snapshot.structuralModels.GetModelSize() != data.size()) {
+        std::cout << "Project snapshot does not match individual reads" << std::endl;
+        errors++;
+    }
+    std::cout << "Project snapshot used " << snapshot.arena.GetBytesUsed() << " bytes in "
+        << snapshot.arena.GetBlockCount() << " block(s)" << std::endl;
+
+    // Take an inventory and check it sizes the tables and models without reading them
+    LoopProjectFile::ProjectInventory inventory;
+    resp = LoopProjectFile::GetProjectInventory(filename,inventory,true);
+    errors += resp.errorCode;
+    const LoopProjectFile::ModelInventory& smInventory = inventory.models[LoopProjectFile::STRUCTURALMODEL];
+    if (inventory.tables.empty() || inventory.tables[0].records != faultObservations.size()
+        || smInventory.dataShape != dataShape || smInventory.validIndices.empty() || smInventory.validIndices[0] != 0) {
+        std::cout << "Project inventory does not match the file contents" << std::endl;
+        errors++;
+    }
+    std::cout << "Project inventory: " << inventory.GetDecodedTableBytes() << " table bytes, "
+        << inventory.GetDecodedModelBytes() << " model bytes, " << inventory.fileBytes << " bytes on disk" << std::endl;
+
+    // Read the fault observations with metrics on and check the records were counted
+    LoopProjectFile::Metrics::Reset();
+    LoopProjectFile::Metrics::Enable();
+    faultObservations.clear();
+    resp = LoopProjectFile::GetFaultObservations(filename,faultObservations,true);
+    errors += resp.errorCode;
+    LoopProjectFile::Metrics::Enable(false);
+    LoopProjectFile::Metrics::MetricsEntry faultMetrics;
+    if (!LoopProjectFile::Metrics::GetMetrics("GetFaultObservations",faultMetrics)
+        || faultMetrics.calls != 1 || faultMetrics.recordsRead != faultObservations.size()) {
+        std::cout << "Metrics did not record the fault observation read" << std::endl;
+        errors++;
+    }
+    std::cout << LoopProjectFile::Metrics::ToJson();
+
+    // Trace a snapshot load when the library was built with tracing
+    if (LoopProjectFile::Trace::IsCompiledIn()) {
+        resp = LoopProjectFile::Trace::Start("testLoopProjectFile.trace.json",true);
+        errors += resp.errorCode;
+        LoopProjectFile::ProjectSnapshot tracedSnapshot;
+        errors += LoopProjectFile::LoadProjectSnapshot(filename,tracedSnapshot,true,false).errorCode;
+        resp = LoopProjectFile::Trace::Stop(true);
+        errors += resp.errorCode;
+    }
+
     return errors;
 }